@@ -23,5 +23,11 @@
 
 
 #include "../srcs/GEMM/CPU/sgemm.h"
+#include "../srcs/GEMM/CPU/dgemm.h"
+#include "../srcs/GEMM/CPU/igemm.h"
+#include "../srcs/GEMM/CPU/GEMM3.h"
+#include "../srcs/GEMM/CPU/PackedMatrix.h"
+#include "../srcs/GEMM/CPU/gemv.h"
 
-#include "../srcs/basic_calculations/operators/operators.h"
\ No newline at end of file
+#include "../srcs/basic_calculations/operators/operators.h"
+#include "../srcs/basic_calculations/SFU/cpu_sfu.h"
\ No newline at end of file
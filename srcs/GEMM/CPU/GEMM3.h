@@ -0,0 +1,217 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+
+#ifndef _CPU_GEMM3_H_
+#define _CPU_GEMM3_H_
+
+#include "sgemm_blocked.h"
+#include "dgemm.h"
+#include "gemm_fill_info.h"
+#include "../../classes/MatrixArray.h"
+
+
+// The batched GEMM on the CPU, dst[i] = A[i] * B[i] (+ C[i]), by decx::gemm_blocked_batched()
+
+
+namespace de
+{
+    namespace cpu
+    {
+        /**
+        * @brief dst[i] = A[i] * B[i] for all the matrices of the arrays. The small products of a long
+        * array are computed one per thread, the large ones are cut among the threads as de::cpu::GEMM() does.
+        */
+        _DECX_API_ de::DH GEMM3(de::MatrixArray<float>& A, de::MatrixArray<float>& B, de::MatrixArray<float>& dst);
+
+
+        _DECX_API_ de::DH GEMM3(de::MatrixArray<double>& A, de::MatrixArray<double>& B, de::MatrixArray<double>& dst);
+
+
+        /**
+        * @brief dst[i] = A[i] * B[i] + C[i], dst can be C (but not A or B)
+        */
+        _DECX_API_ de::DH GEMM3(de::MatrixArray<float>& A, de::MatrixArray<float>& B, de::MatrixArray<float>& C,
+            de::MatrixArray<float>& dst);
+
+
+        _DECX_API_ de::DH GEMM3(de::MatrixArray<double>& A, de::MatrixArray<double>& B, de::MatrixArray<double>& C,
+            de::MatrixArray<double>& dst);
+
+
+        /**
+        * @brief dst[i] = A[i] * B, B is shared by all the products and is packed once for the whole batch
+        */
+        _DECX_API_ de::DH GEMM3(de::MatrixArray<float>& A, de::Matrix<float>& B, de::MatrixArray<float>& dst);
+
+
+        _DECX_API_ de::DH GEMM3(de::MatrixArray<double>& A, de::Matrix<double>& B, de::MatrixArray<double>& dst);
+    }
+}
+
+
+
+namespace decx
+{
+    /**
+    * @brief Check the shapes of the arrays, shape dst (unless it is C) and run the batch. dst must not be
+    * A or B (DECX_FAIL_OperandAliasing).
+    * @param B_shared : B is a single matrix (stride 0) if not NULL, then B is ignored
+    * @param C : NULL for none
+    */
+    template <typename T, typename _info_type>
+    static void _GEMM3_caller(decx::_MatrixArray<T>* A, decx::_MatrixArray<T>* B, decx::_Matrix<T>* B_shared,
+        decx::_MatrixArray<T>* C, decx::_MatrixArray<T>* dst, de::DH* handle);
+}
+
+
+
+template <typename T, typename _info_type>
+static void decx::_GEMM3_caller(decx::_MatrixArray<T>* A, decx::_MatrixArray<T>* B, decx::_Matrix<T>* B_shared,
+    decx::_MatrixArray<T>* C, decx::_MatrixArray<T>* dst, de::DH* handle)
+{
+    const uint M = A->height, K = A->width, batch = A->ArrayNumber;
+    const uint K_B = B_shared != NULL ? B_shared->height : B->height;
+    const uint N = B_shared != NULL ? B_shared->width : B->width;
+
+    if (K != K_B || (C != NULL && (C->height != M || C->width != N))) {
+        decx::MDim_Not_Matching(handle);
+        return;
+    }
+    if ((B_shared == NULL && B->ArrayNumber != batch) || (C != NULL && C->ArrayNumber != batch)) {
+        decx::Matrix_number_not_matching(handle);
+        return;
+    }
+    // dst is written while later blocks of A and B are still read, and re_construct() would free them
+    if (dst == A || dst == B) {
+        decx::err::OperandAliasing(handle);
+        Print_Error_Message(4, OPERAND_ALIASING);
+        return;
+    }
+
+    if (dst != C) {
+        dst->re_construct(N, M, batch, decx::DATA_STORE_TYPE::Page_Default);
+    }
+
+    _info_type info;
+    info.A = A->MatArr.ptr;         info.lda = A->pitch;
+    info.C = dst->MatArr.ptr;       info.ldc = dst->pitch;
+    if (B_shared != NULL) {
+        info.B = B_shared->Mat.ptr; info.ldb = B_shared->pitch;
+    }
+    else {
+        info.B = B->MatArr.ptr;     info.ldb = B->pitch;
+    }
+    info.M = M;
+    info.N = N;
+    info.K = K;
+    info.alpha = 1;
+    info.beta = 1;
+    info.S = C != NULL ? C->MatArr.ptr : NULL;
+    info.lds = C != NULL ? C->pitch : 0;
+
+    decx::_gemm_batch_strides strides;
+    strides.A = A->_plane;
+    strides.B = B_shared != NULL ? 0 : B->_plane;
+    strides.C = dst->_plane;
+    strides.S = C != NULL ? C->_plane : 0;
+
+    if (!decx::gemm_blocked_batched(&info, batch, &strides)) {
+        decx::err::AllocateFailure(handle);
+        Print_Error_Message(4, ALLOC_FAIL);
+        return;
+    }
+
+    decx::Success(handle);
+}
+
+
+
+de::DH de::cpu::GEMM3(de::MatrixArray<float>& A, de::MatrixArray<float>& B, de::MatrixArray<float>& dst)
+{
+    decx::_MatrixArray<float>* _A = dynamic_cast<decx::_MatrixArray<float>*>(&A);
+    decx::_MatrixArray<float>* _B = dynamic_cast<decx::_MatrixArray<float>*>(&B);
+    decx::_MatrixArray<float>* _dst = dynamic_cast<decx::_MatrixArray<float>*>(&dst);
+
+    de::DH handle;
+    decx::_GEMM3_caller<float, decx::_sgemm_blocked_info>(_A, _B, NULL, NULL, _dst, &handle);
+    return handle;
+}
+
+
+
+de::DH de::cpu::GEMM3(de::MatrixArray<double>& A, de::MatrixArray<double>& B, de::MatrixArray<double>& dst)
+{
+    decx::_MatrixArray<double>* _A = dynamic_cast<decx::_MatrixArray<double>*>(&A);
+    decx::_MatrixArray<double>* _B = dynamic_cast<decx::_MatrixArray<double>*>(&B);
+    decx::_MatrixArray<double>* _dst = dynamic_cast<decx::_MatrixArray<double>*>(&dst);
+
+    de::DH handle;
+    decx::_GEMM3_caller<double, decx::_dgemm_blocked_info>(_A, _B, NULL, NULL, _dst, &handle);
+    return handle;
+}
+
+
+
+de::DH de::cpu::GEMM3(de::MatrixArray<float>& A, de::MatrixArray<float>& B, de::MatrixArray<float>& C,
+    de::MatrixArray<float>& dst)
+{
+    decx::_MatrixArray<float>* _A = dynamic_cast<decx::_MatrixArray<float>*>(&A);
+    decx::_MatrixArray<float>* _B = dynamic_cast<decx::_MatrixArray<float>*>(&B);
+    decx::_MatrixArray<float>* _C = dynamic_cast<decx::_MatrixArray<float>*>(&C);
+    decx::_MatrixArray<float>* _dst = dynamic_cast<decx::_MatrixArray<float>*>(&dst);
+
+    de::DH handle;
+    decx::_GEMM3_caller<float, decx::_sgemm_blocked_info>(_A, _B, NULL, _C, _dst, &handle);
+    return handle;
+}
+
+
+
+de::DH de::cpu::GEMM3(de::MatrixArray<double>& A, de::MatrixArray<double>& B, de::MatrixArray<double>& C,
+    de::MatrixArray<double>& dst)
+{
+    decx::_MatrixArray<double>* _A = dynamic_cast<decx::_MatrixArray<double>*>(&A);
+    decx::_MatrixArray<double>* _B = dynamic_cast<decx::_MatrixArray<double>*>(&B);
+    decx::_MatrixArray<double>* _C = dynamic_cast<decx::_MatrixArray<double>*>(&C);
+    decx::_MatrixArray<double>* _dst = dynamic_cast<decx::_MatrixArray<double>*>(&dst);
+
+    de::DH handle;
+    decx::_GEMM3_caller<double, decx::_dgemm_blocked_info>(_A, _B, NULL, _C, _dst, &handle);
+    return handle;
+}
+
+
+
+de::DH de::cpu::GEMM3(de::MatrixArray<float>& A, de::Matrix<float>& B, de::MatrixArray<float>& dst)
+{
+    decx::_MatrixArray<float>* _A = dynamic_cast<decx::_MatrixArray<float>*>(&A);
+    decx::_Matrix<float>* _B = dynamic_cast<decx::_Matrix<float>*>(&B);
+    decx::_MatrixArray<float>* _dst = dynamic_cast<decx::_MatrixArray<float>*>(&dst);
+
+    de::DH handle;
+    decx::_GEMM3_caller<float, decx::_sgemm_blocked_info>(_A, NULL, _B, NULL, _dst, &handle);
+    return handle;
+}
+
+
+
+de::DH de::cpu::GEMM3(de::MatrixArray<double>& A, de::Matrix<double>& B, de::MatrixArray<double>& dst)
+{
+    decx::_MatrixArray<double>* _A = dynamic_cast<decx::_MatrixArray<double>*>(&A);
+    decx::_Matrix<double>* _B = dynamic_cast<decx::_Matrix<double>*>(&B);
+    decx::_MatrixArray<double>* _dst = dynamic_cast<decx::_MatrixArray<double>*>(&dst);
+
+    de::DH handle;
+    decx::_GEMM3_caller<double, decx::_dgemm_blocked_info>(_A, NULL, _B, NULL, _dst, &handle);
+    return handle;
+}
+
+
+#endif
@@ -0,0 +1,424 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+
+#ifndef _PACKED_MATRIX_H_
+#define _PACKED_MATRIX_H_
+
+#include "sgemm_blocked.h"
+#include "gemm_fill_info.h"
+#include "../../classes/Matrix.h"
+#include <stdio.h>
+
+
+namespace de
+{
+    namespace cpu
+    {
+        /**
+        * The B operand of de::cpu::GEMM(), packed once into the panels the micro-kernel reads, so the
+        * GEMMs against it neither pack nor allocate for B. The layout follows the micro-kernel of the
+        * de::CPU_ISA in use at the packing, a GEMM under a kernel of other NR reports DECX_FAIL_PackedLayout.
+        */
+        class _DECX_API_ PackedMatrix
+        {
+        public:
+            PackedMatrix() {}
+
+
+            // N, the width of op(B)
+            virtual uint Width() = 0;
+
+
+            // K, the height of op(B)
+            virtual uint Height() = 0;
+
+
+            virtual size_t TotalBytes() = 0;
+
+
+            virtual void release() = 0;
+
+
+            ~PackedMatrix() {}
+        };
+
+
+        _DECX_API_ de::cpu::PackedMatrix& CreatePackedMatrixRef();
+
+
+        _DECX_API_ de::cpu::PackedMatrix* CreatePackedMatrixPtr();
+
+
+        /**
+        * @brief Pack op(B) into dst, op() transposes B if trans_flag has de::cpu::GEMM_TransB (the other flags
+        * are ignored)
+        */
+        _DECX_API_ de::DH PackMatrix(de::Matrix<float>& B, de::cpu::PackedMatrix& dst,
+            const int trans_flag = de::cpu::GEMM_NoTrans);
+
+
+        /**
+        * @brief dst = alpha * op(A) * B, B is prepacked. Only de::cpu::GEMM_TransA of trans_flag is applied,
+        * B was transposed (or not) when packed.
+        */
+        _DECX_API_ de::DH GEMM(de::Matrix<float>& A, de::cpu::PackedMatrix& B, de::Matrix<float>& dst,
+            const float alpha = 1.f, const int trans_flag = de::cpu::GEMM_NoTrans);
+
+
+        /**
+        * @brief dst = alpha * op(A) * B + beta * C, B is prepacked, see de::cpu::GEMM() for C and dst
+        */
+        _DECX_API_ de::DH GEMM(de::Matrix<float>& A, de::cpu::PackedMatrix& B, de::Matrix<float>& C,
+            de::Matrix<float>& dst, const float alpha = 1.f, const float beta = 1.f,
+            const int trans_flag = de::cpu::GEMM_NoTrans);
+
+
+        /**
+        * @brief Write the packed matrix to the file, to be loaded by de::cpu::LoadPackedMatrix(). A file that
+        * can not be opened reports DECX_FAIL_FileNotExist, a failed or short write DECX_FAIL_FileIO.
+        */
+        _DECX_API_ de::DH SavePackedMatrix(de::cpu::PackedMatrix& src, const char* path);
+
+
+        /**
+        * @brief Read the packed matrix saved by de::cpu::SavePackedMatrix(). The file has to be packed
+        * for a micro-kernel of the same NR as the one in use, or DECX_FAIL_PackedLayout is reported.
+        */
+        _DECX_API_ de::DH LoadPackedMatrix(const char* path, de::cpu::PackedMatrix& dst);
+    }
+}
+
+
+
+namespace decx
+{
+    class _PackedMatrix;
+
+
+    /**
+    * The header of the files of de::cpu::SavePackedMatrix(), followed by the packed elements
+    */
+    struct _packed_matrix_header
+    {
+        char magic[8];              // "DECXPKB"
+        int version;
+        int elem_size;              // sizeof of the packed element
+        int K, N;
+        int kc, NR, KP;             // the layout, see decx::gemm_prepack_B()
+        size_t length;              // in elements
+    };
+
+
+    /**
+    * @brief Fill info of dst = alpha * op(A) * B + beta * C with the prepacked B, and shape dst unless it is C
+    * @return false if the shapes or the layout do not match, the error is written to handle
+    */
+    static bool _GEMM_packed_fill_info(decx::_sgemm_blocked_info* info, decx::_Matrix<float>* A,
+        decx::_PackedMatrix* B, decx::_Matrix<float>* C, decx::_Matrix<float>* dst, const float alpha,
+        const float beta, const int trans_flag, de::DH* handle);
+}
+
+
+
+class decx::_PackedMatrix : public de::cpu::PackedMatrix
+{
+public:
+    decx::PtrInfo<float> data;
+    size_t length;              // in floats
+
+    int K, N;
+    int kc, NR;                 // the layout, kc and NR of the packing
+
+
+    _PackedMatrix() : length(0), K(0), N(0), kc(0), NR(0) {}
+
+
+    /**
+    * @brief Reallocate data if the length changes
+    * @return false if the allocation fails
+    */
+    bool re_construct(const int _K, const int _N, const int _kc, const int _NR, const size_t _length)
+    {
+        if (this->data.ptr == NULL || this->length != _length) {
+            if (this->data.ptr != NULL) {
+                decx::alloc::_host_virtual_page_dealloc(&this->data);
+            }
+            if (decx::alloc::_host_virtual_page_malloc<float>(&this->data, _length * sizeof(float))) {
+                this->release();
+                return false;
+            }
+        }
+        this->length = _length;
+        this->K = _K;               this->N = _N;
+        this->kc = _kc;             this->NR = _NR;
+        return true;
+    }
+
+
+    virtual uint Width() { return this->N; }
+
+
+    virtual uint Height() { return this->K; }
+
+
+    virtual size_t TotalBytes() { return this->length * sizeof(float); }
+
+
+    // frees data and clears the shape, a released object reports 0 x 0
+    virtual void release()
+    {
+        if (this->data.ptr != NULL) {
+            decx::alloc::_host_virtual_page_dealloc(&this->data);
+        }
+        this->length = 0;
+        this->K = 0;                this->N = 0;
+        this->kc = 0;               this->NR = 0;
+    }
+
+
+    virtual ~_PackedMatrix()
+    {
+        if (this->data.ptr != NULL) {
+            this->release();
+        }
+    }
+};
+
+
+
+static bool decx::_GEMM_packed_fill_info(decx::_sgemm_blocked_info* info, decx::_Matrix<float>* A,
+    decx::_PackedMatrix* B, decx::_Matrix<float>* C, decx::_Matrix<float>* dst, const float alpha,
+    const float beta, const int trans_flag, de::DH* handle)
+{
+    if (B->data.ptr == NULL || B->NR != info->uk.nr) {
+        decx::err::PackedLayoutError(handle);
+        return false;
+    }
+
+    info->transA = (trans_flag & de::cpu::GEMM_TransA) != 0;
+    const uint M = info->transA ? A->width : A->height;
+    const uint K = info->transA ? A->height : A->width;
+
+    if (K != B->K || (C != NULL && (C->height != M || C->width != B->N))) {
+        decx::MDim_Not_Matching(handle);
+        return false;
+    }
+    if (dst == A) {
+        decx::err::OperandAliasing(handle);
+        Print_Error_Message(4, OPERAND_ALIASING);
+        return false;
+    }
+
+    if (dst != C) {
+        dst->re_construct(B->N, M, decx::DATA_STORE_TYPE::Page_Default);
+    }
+
+    info->A = A->Mat.ptr;           info->lda = A->pitch;
+    info->pB = B->data.ptr;
+    info->C = dst->Mat.ptr;         info->ldc = dst->pitch;
+    info->M = M;
+    info->N = B->N;
+    info->K = K;
+    // the kc-blocks follow the packing, it may come from a host of other caches
+    info->bs.kc = B->kc;
+
+    info->alpha = alpha;
+    info->beta = beta;
+    info->S = (C != NULL && beta != 0) ? C->Mat.ptr : NULL;
+    info->lds = C != NULL ? C->pitch : 0;
+    return true;
+}
+
+
+
+de::cpu::PackedMatrix& de::cpu::CreatePackedMatrixRef()
+{
+    return *(new decx::_PackedMatrix());
+}
+
+
+
+de::cpu::PackedMatrix* de::cpu::CreatePackedMatrixPtr()
+{
+    return new decx::_PackedMatrix();
+}
+
+
+
+de::DH de::cpu::PackMatrix(de::Matrix<float>& B, de::cpu::PackedMatrix& dst, const int trans_flag)
+{
+    decx::_Matrix<float>* _B = dynamic_cast<decx::_Matrix<float>*>(&B);
+    decx::_PackedMatrix* _dst = dynamic_cast<decx::_PackedMatrix*>(&dst);
+
+    de::DH handle;
+    decx::_sgemm_blocked_info info;
+    info.transB = (trans_flag & de::cpu::GEMM_TransB) != 0;
+    info.B = _B->Mat.ptr;           info.ldb = _B->pitch;
+    info.K = info.transB ? _B->width : _B->height;
+    info.N = info.transB ? _B->height : _B->width;
+
+    if (!_dst->re_construct(info.K, info.N, info.bs.kc, info.uk.nr, decx::gemm_prepacked_B_len(&info))) {
+        decx::err::AllocateFailure(&handle);
+        Print_Error_Message(4, ALLOC_FAIL);
+        return handle;
+    }
+    decx::gemm_prepack_B(&info, _dst->data.ptr);
+
+    decx::Success(&handle);
+    return handle;
+}
+
+
+
+de::DH de::cpu::GEMM(de::Matrix<float>& A, de::cpu::PackedMatrix& B, de::Matrix<float>& dst,
+    const float alpha, const int trans_flag)
+{
+    decx::_Matrix<float>* _A = dynamic_cast<decx::_Matrix<float>*>(&A);
+    decx::_PackedMatrix* _B = dynamic_cast<decx::_PackedMatrix*>(&B);
+    decx::_Matrix<float>* _dst = dynamic_cast<decx::_Matrix<float>*>(&dst);
+
+    de::DH handle;
+    decx::_sgemm_blocked_info info;
+    if (!decx::_GEMM_packed_fill_info(&info, _A, _B, NULL, _dst, alpha, 0.f, trans_flag, &handle)) {
+        return handle;
+    }
+
+    if (!decx::sgemm_blocked(&info, NULL)) {
+        decx::err::AllocateFailure(&handle);
+        Print_Error_Message(4, ALLOC_FAIL);
+        return handle;
+    }
+
+    decx::Success(&handle);
+    return handle;
+}
+
+
+
+de::DH de::cpu::GEMM(de::Matrix<float>& A, de::cpu::PackedMatrix& B, de::Matrix<float>& C,
+    de::Matrix<float>& dst, const float alpha, const float beta, const int trans_flag)
+{
+    decx::_Matrix<float>* _A = dynamic_cast<decx::_Matrix<float>*>(&A);
+    decx::_PackedMatrix* _B = dynamic_cast<decx::_PackedMatrix*>(&B);
+    decx::_Matrix<float>* _C = dynamic_cast<decx::_Matrix<float>*>(&C);
+    decx::_Matrix<float>* _dst = dynamic_cast<decx::_Matrix<float>*>(&dst);
+
+    de::DH handle;
+    decx::_sgemm_blocked_info info;
+    if (!decx::_GEMM_packed_fill_info(&info, _A, _B, _C, _dst, alpha, beta, trans_flag, &handle)) {
+        return handle;
+    }
+
+    if (!decx::sgemm_blocked(&info, NULL)) {
+        decx::err::AllocateFailure(&handle);
+        Print_Error_Message(4, ALLOC_FAIL);
+        return handle;
+    }
+
+    decx::Success(&handle);
+    return handle;
+}
+
+
+
+de::DH de::cpu::SavePackedMatrix(de::cpu::PackedMatrix& src, const char* path)
+{
+    decx::_PackedMatrix* _src = dynamic_cast<decx::_PackedMatrix*>(&src);
+
+    de::DH handle;
+    FILE* fp = fopen(path, "wb");
+    if (fp == NULL) {
+        decx::err::FileNotExist(&handle);
+        return handle;
+    }
+
+    decx::_packed_matrix_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "DECXPKB", 8);
+    header.version = 1;
+    header.elem_size = sizeof(float);
+    header.K = _src->K;             header.N = _src->N;
+    header.kc = _src->kc;           header.NR = _src->NR;
+    header.KP = 1;
+    header.length = _src->length;
+
+    // a short write (a full disk ...) may only show up when the buffer of fp is flushed by fclose()
+    bool _written = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+        fwrite(_src->data.ptr, sizeof(float), _src->length, fp) == _src->length;
+    _written = (fclose(fp) == 0) && _written;
+
+    if (!_written) {
+        decx::err::FileIOError(&handle);
+        Print_Error_Message(4, FILE_IO_ERROR);
+        return handle;
+    }
+    decx::Success(&handle);
+    return handle;
+}
+
+
+
+de::DH de::cpu::LoadPackedMatrix(const char* path, de::cpu::PackedMatrix& dst)
+{
+    decx::_PackedMatrix* _dst = dynamic_cast<decx::_PackedMatrix*>(&dst);
+
+    de::DH handle;
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) {
+        decx::err::FileNotExist(&handle);
+        return handle;
+    }
+
+    decx::_packed_matrix_header header;
+    const decx::_sgemm_blocked_info info;
+    if (fread(&header, sizeof(header), 1, fp) != 1 && ferror(fp) != 0) {
+        fclose(fp);
+        decx::err::FileIOError(&handle);
+        Print_Error_Message(4, FILE_IO_ERROR);
+        return handle;
+    }
+    // the length is checked against the shape, a broken (or short) file does not read out of the buffer
+    if (feof(fp) != 0 || memcmp(header.magic, "DECXPKB", 8) != 0 ||
+        header.version != 1 || header.elem_size != sizeof(float) || header.KP != 1 ||
+        header.NR != info.uk.nr || header.kc <= 0 || header.K < 0 || header.N < 0 ||
+        header.length != decx::utils::ceil<size_t>(header.N, header.NR) * header.NR * (size_t)header.K) {
+        fclose(fp);
+        decx::err::PackedLayoutError(&handle);
+        return handle;
+    }
+
+    if (!_dst->re_construct(header.K, header.N, header.kc, header.NR, header.length)) {
+        fclose(fp);
+        decx::err::AllocateFailure(&handle);
+        Print_Error_Message(4, ALLOC_FAIL);
+        return handle;
+    }
+    const bool _read = fread(_dst->data.ptr, sizeof(float), header.length, fp) == header.length;
+    // a file cut short is broken, an error of the stream is not
+    const bool _io_error = ferror(fp) != 0;
+    fclose(fp);
+
+    if (!_read) {
+        _dst->release();
+        if (_io_error) {
+            decx::err::FileIOError(&handle);
+            Print_Error_Message(4, FILE_IO_ERROR);
+        }
+        else {
+            decx::err::PackedLayoutError(&handle);
+        }
+        return handle;
+    }
+    decx::Success(&handle);
+    return handle;
+}
+
+
+#endif
@@ -0,0 +1,102 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+
+#ifndef _DGEMM_H_
+#define _DGEMM_H_
+
+#include "gemm_blocked.h"
+#include "dgemm_micro_kernel.h"
+#include "gemm_fill_info.h"
+#include "../../classes/Matrix.h"
+
+
+namespace de
+{
+    namespace cpu
+    {
+        /**
+        * @brief dst = alpha * op(A) * op(B) in double, op() transposes the operands flagged by trans_flag
+        * (de::cpu::GEMM_Trans). The same packed, blocked algorithm as the float one.
+        */
+        _DECX_API_ de::DH GEMM(de::Matrix<double>& A, de::Matrix<double>& B, de::Matrix<double>& dst,
+            const double alpha = 1.0, const int trans_flag = de::cpu::GEMM_NoTrans);
+
+
+        /**
+        * @brief dst = alpha * op(A) * op(B) + beta * C in double, see de::cpu::GEMM() of float for C and dst
+        */
+        _DECX_API_ de::DH GEMM(de::Matrix<double>& A, de::Matrix<double>& B, de::Matrix<double>& C, de::Matrix<double>& dst,
+            const double alpha = 1.0, const double beta = 1.0, const int trans_flag = de::cpu::GEMM_NoTrans);
+    }
+}
+
+
+namespace decx
+{
+    // takes the micro-kernel of the de::CPU_ISA in use
+    struct _dgemm_blocked_info : public decx::_gemm_blocked_info<double, double, double, 1>
+    {
+        _dgemm_blocked_info() : decx::_gemm_blocked_info<double, double, double, 1>(decx::_dgemm_ukernels) {}
+    };
+}
+
+
+
+de::DH de::cpu::GEMM(de::Matrix<double>& A, de::Matrix<double>& B, de::Matrix<double>& dst,
+    const double alpha, const int trans_flag)
+{
+    decx::_Matrix<double>* _A = dynamic_cast<decx::_Matrix<double>*>(&A);
+    decx::_Matrix<double>* _B = dynamic_cast<decx::_Matrix<double>*>(&B);
+    decx::_Matrix<double>* _dst = dynamic_cast<decx::_Matrix<double>*>(&dst);
+
+    de::DH handle;
+    decx::_dgemm_blocked_info info;
+    if (!decx::_GEMM_fill_info(&info, _A, _B, (decx::_Matrix<double>*)NULL, _dst, alpha, 0.0, trans_flag, &handle)) {
+        return handle;
+    }
+
+    if (!decx::gemm_blocked(&info, (double*)NULL)) {
+        decx::err::AllocateFailure(&handle);
+        Print_Error_Message(4, ALLOC_FAIL);
+        return handle;
+    }
+
+    decx::Success(&handle);
+    return handle;
+}
+
+
+
+de::DH de::cpu::GEMM(de::Matrix<double>& A, de::Matrix<double>& B, de::Matrix<double>& C, de::Matrix<double>& dst,
+    const double alpha, const double beta, const int trans_flag)
+{
+    decx::_Matrix<double>* _A = dynamic_cast<decx::_Matrix<double>*>(&A);
+    decx::_Matrix<double>* _B = dynamic_cast<decx::_Matrix<double>*>(&B);
+    decx::_Matrix<double>* _C = dynamic_cast<decx::_Matrix<double>*>(&C);
+    decx::_Matrix<double>* _dst = dynamic_cast<decx::_Matrix<double>*>(&dst);
+
+    de::DH handle;
+    decx::_dgemm_blocked_info info;
+    if (!decx::_GEMM_fill_info(&info, _A, _B, _C, _dst, alpha, beta, trans_flag, &handle)) {
+        return handle;
+    }
+
+    if (!decx::gemm_blocked(&info, (double*)NULL)) {
+        decx::err::AllocateFailure(&handle);
+        Print_Error_Message(4, ALLOC_FAIL);
+        return handle;
+    }
+
+    decx::Success(&handle);
+    return handle;
+}
+
+
+#endif
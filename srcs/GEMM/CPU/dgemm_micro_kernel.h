@@ -0,0 +1,303 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+
+#ifndef _DGEMM_MICRO_KERNEL_H_
+#define _DGEMM_MICRO_KERNEL_H_
+
+#include "gemm_ukernel.h"
+
+
+/**
+* The micro-kernels of the packed DGEMM, one for each de::CPU_ISA (the interface is in gemm_ukernel.h).
+* The register tiles take the same registers as those of the SGEMM, with half of the columns :
+*   SSE4.2  : 6 x 4,  12 of the 16 xmm registers hold C
+*   AVX2    : 6 x 8,  12 of the 16 ymm registers hold C
+*   AVX-512 : 12 x 16, 24 of the 32 zmm registers hold C
+*/
+
+
+namespace decx
+{
+    typedef decx::_gemm_ukernel<double, double> _dgemm_ukernel;
+
+
+    // the micro-kernel of the de::CPU_ISA in use
+    decx::_dgemm_ukernel _dgemm_ukernels;
+}
+
+
+
+// ------------------------------------------ SSE4.2 ------------------------------------------------
+
+
+#define _DGEMM_MK_ROW_SSE_(r) {                                     \
+    _a = _mm_set1_pd(pA[r]);                                        \
+    c##r##0 = _mm_add_pd(c##r##0, _mm_mul_pd(_a, _b0));             \
+    c##r##1 = _mm_add_pd(c##r##1, _mm_mul_pd(_a, _b1));             \
+}
+
+
+#define _DGEMM_MK_STORE_ROW_SSE_(r) {                                                               \
+    c##r##0 = _mm_mul_pd(c##r##0, _alpha);                                                          \
+    c##r##1 = _mm_mul_pd(c##r##1, _alpha);                                                          \
+    if (S != NULL) {                                                                                \
+        c##r##0 = _mm_add_pd(c##r##0, _mm_mul_pd(_beta, _mm_loadu_pd(S + r * lds)));                \
+        c##r##1 = _mm_add_pd(c##r##1, _mm_mul_pd(_beta, _mm_loadu_pd(S + r * lds + 2)));            \
+    }                                                                                               \
+    _mm_storeu_pd(C + r * ldc, c##r##0);                                                            \
+    _mm_storeu_pd(C + r * ldc + 2, c##r##1);                                                        \
+}
+
+
+_DECX_ISA_BEGIN_SSE42_
+namespace decx
+{
+    namespace sse42
+    {
+        static void _dgemm_kernel_6x4(const int kc, const double* pA, const double* pB, double* C,
+            const size_t ldc, const double* S, const size_t lds, const double alpha, const double beta)
+        {
+            __m128d c00 = _mm_setzero_pd(), c01 = _mm_setzero_pd(),
+                c10 = _mm_setzero_pd(), c11 = _mm_setzero_pd(),
+                c20 = _mm_setzero_pd(), c21 = _mm_setzero_pd(),
+                c30 = _mm_setzero_pd(), c31 = _mm_setzero_pd(),
+                c40 = _mm_setzero_pd(), c41 = _mm_setzero_pd(),
+                c50 = _mm_setzero_pd(), c51 = _mm_setzero_pd();
+            __m128d _a, _b0, _b1;
+
+            for (int k = 0; k < kc; ++k) {
+                _mm_prefetch((const char*)(pA + 8 * 6), _MM_HINT_T0);
+
+                _b0 = _mm_load_pd(pB);
+                _b1 = _mm_load_pd(pB + 2);
+
+                _DGEMM_MK_ROW_SSE_(0);
+                _DGEMM_MK_ROW_SSE_(1);
+                _DGEMM_MK_ROW_SSE_(2);
+                _DGEMM_MK_ROW_SSE_(3);
+                _DGEMM_MK_ROW_SSE_(4);
+                _DGEMM_MK_ROW_SSE_(5);
+
+                pA += 6;
+                pB += 4;
+            }
+
+            const __m128d _alpha = _mm_set1_pd(alpha), _beta = _mm_set1_pd(beta);
+            _DGEMM_MK_STORE_ROW_SSE_(0);
+            _DGEMM_MK_STORE_ROW_SSE_(1);
+            _DGEMM_MK_STORE_ROW_SSE_(2);
+            _DGEMM_MK_STORE_ROW_SSE_(3);
+            _DGEMM_MK_STORE_ROW_SSE_(4);
+            _DGEMM_MK_STORE_ROW_SSE_(5);
+        }
+    }
+}
+_DECX_ISA_END_
+
+
+
+// ------------------------------------------- AVX2 -------------------------------------------------
+
+
+#define _DGEMM_MK_ROW_(r) {                                         \
+    _a = _mm256_broadcast_sd(pA + r);                               \
+    c##r##0 = _mm256_fmadd_pd(_a, _b0, c##r##0);                    \
+    c##r##1 = _mm256_fmadd_pd(_a, _b1, c##r##1);                    \
+}
+
+
+#define _DGEMM_MK_STORE_ROW_(r) {                                                                   \
+    c##r##0 = _mm256_mul_pd(c##r##0, _alpha);                                                       \
+    c##r##1 = _mm256_mul_pd(c##r##1, _alpha);                                                       \
+    if (S != NULL) {                                                                                \
+        c##r##0 = _mm256_fmadd_pd(_beta, _mm256_loadu_pd(S + r * lds), c##r##0);                    \
+        c##r##1 = _mm256_fmadd_pd(_beta, _mm256_loadu_pd(S + r * lds + 4), c##r##1);                \
+    }                                                                                               \
+    _mm256_storeu_pd(C + r * ldc, c##r##0);                                                         \
+    _mm256_storeu_pd(C + r * ldc + 4, c##r##1);                                                     \
+}
+
+
+_DECX_ISA_BEGIN_AVX2_
+namespace decx
+{
+    namespace avx2
+    {
+        static void _dgemm_kernel_6x8(const int kc, const double* pA, const double* pB, double* C,
+            const size_t ldc, const double* S, const size_t lds, const double alpha, const double beta)
+        {
+            __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd(),
+                c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd(),
+                c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd(),
+                c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd(),
+                c40 = _mm256_setzero_pd(), c41 = _mm256_setzero_pd(),
+                c50 = _mm256_setzero_pd(), c51 = _mm256_setzero_pd();
+            __m256d _a, _b0, _b1;
+
+            for (int r = 0; r < 6; ++r) {
+                _mm_prefetch((const char*)(C + r * ldc), _MM_HINT_T0);
+                _mm_prefetch((const char*)(C + r * ldc + 7), _MM_HINT_T0);
+            }
+
+            for (int k = 0; k < kc; ++k) {
+                _mm_prefetch((const char*)(pA + 8 * 6), _MM_HINT_T0);
+
+                _b0 = _mm256_load_pd(pB);
+                _b1 = _mm256_load_pd(pB + 4);
+
+                _DGEMM_MK_ROW_(0);
+                _DGEMM_MK_ROW_(1);
+                _DGEMM_MK_ROW_(2);
+                _DGEMM_MK_ROW_(3);
+                _DGEMM_MK_ROW_(4);
+                _DGEMM_MK_ROW_(5);
+
+                pA += 6;
+                pB += 8;
+            }
+
+            const __m256d _alpha = _mm256_set1_pd(alpha), _beta = _mm256_set1_pd(beta);
+            _DGEMM_MK_STORE_ROW_(0);
+            _DGEMM_MK_STORE_ROW_(1);
+            _DGEMM_MK_STORE_ROW_(2);
+            _DGEMM_MK_STORE_ROW_(3);
+            _DGEMM_MK_STORE_ROW_(4);
+            _DGEMM_MK_STORE_ROW_(5);
+        }
+    }
+}
+_DECX_ISA_END_
+
+
+
+// ------------------------------------------ AVX-512 -----------------------------------------------
+
+
+#define _DGEMM_MK_ROW_512_(r) {                                     \
+    _a = _mm512_set1_pd(pA[r]);                                     \
+    c##r##_0 = _mm512_fmadd_pd(_a, _b0, c##r##_0);                  \
+    c##r##_1 = _mm512_fmadd_pd(_a, _b1, c##r##_1);                  \
+}
+
+
+#define _DGEMM_MK_STORE_ROW_512_(r) {                                                               \
+    c##r##_0 = _mm512_mul_pd(c##r##_0, _alpha);                                                     \
+    c##r##_1 = _mm512_mul_pd(c##r##_1, _alpha);                                                     \
+    if (S != NULL) {                                                                                \
+        c##r##_0 = _mm512_fmadd_pd(_beta, _mm512_loadu_pd(S + r * lds), c##r##_0);                  \
+        c##r##_1 = _mm512_fmadd_pd(_beta, _mm512_loadu_pd(S + r * lds + 8), c##r##_1);              \
+    }                                                                                               \
+    _mm512_storeu_pd(C + r * ldc, c##r##_0);                                                        \
+    _mm512_storeu_pd(C + r * ldc + 8, c##r##_1);                                                    \
+}
+
+
+_DECX_ISA_BEGIN_AVX512_
+namespace decx
+{
+    namespace avx512
+    {
+        static void _dgemm_kernel_12x16(const int kc, const double* pA, const double* pB, double* C,
+            const size_t ldc, const double* S, const size_t lds, const double alpha, const double beta)
+        {
+            __m512d c0_0 = _mm512_setzero_pd(), c0_1 = _mm512_setzero_pd(),
+                c1_0 = _mm512_setzero_pd(), c1_1 = _mm512_setzero_pd(),
+                c2_0 = _mm512_setzero_pd(), c2_1 = _mm512_setzero_pd(),
+                c3_0 = _mm512_setzero_pd(), c3_1 = _mm512_setzero_pd(),
+                c4_0 = _mm512_setzero_pd(), c4_1 = _mm512_setzero_pd(),
+                c5_0 = _mm512_setzero_pd(), c5_1 = _mm512_setzero_pd(),
+                c6_0 = _mm512_setzero_pd(), c6_1 = _mm512_setzero_pd(),
+                c7_0 = _mm512_setzero_pd(), c7_1 = _mm512_setzero_pd(),
+                c8_0 = _mm512_setzero_pd(), c8_1 = _mm512_setzero_pd(),
+                c9_0 = _mm512_setzero_pd(), c9_1 = _mm512_setzero_pd(),
+                c10_0 = _mm512_setzero_pd(), c10_1 = _mm512_setzero_pd(),
+                c11_0 = _mm512_setzero_pd(), c11_1 = _mm512_setzero_pd();
+            __m512d _a, _b0, _b1;
+
+            for (int r = 0; r < 12; ++r) {
+                _mm_prefetch((const char*)(C + r * ldc), _MM_HINT_T0);
+                _mm_prefetch((const char*)(C + r * ldc + 15), _MM_HINT_T0);
+            }
+
+            for (int k = 0; k < kc; ++k) {
+                _mm_prefetch((const char*)(pA + 8 * 12), _MM_HINT_T0);
+
+                // the workspace given by the user is aligned to 32 bytes only
+                _b0 = _mm512_loadu_pd(pB);
+                _b1 = _mm512_loadu_pd(pB + 8);
+
+                _DGEMM_MK_ROW_512_(0);
+                _DGEMM_MK_ROW_512_(1);
+                _DGEMM_MK_ROW_512_(2);
+                _DGEMM_MK_ROW_512_(3);
+                _DGEMM_MK_ROW_512_(4);
+                _DGEMM_MK_ROW_512_(5);
+                _DGEMM_MK_ROW_512_(6);
+                _DGEMM_MK_ROW_512_(7);
+                _DGEMM_MK_ROW_512_(8);
+                _DGEMM_MK_ROW_512_(9);
+                _DGEMM_MK_ROW_512_(10);
+                _DGEMM_MK_ROW_512_(11);
+
+                pA += 12;
+                pB += 16;
+            }
+
+            const __m512d _alpha = _mm512_set1_pd(alpha), _beta = _mm512_set1_pd(beta);
+            _DGEMM_MK_STORE_ROW_512_(0);
+            _DGEMM_MK_STORE_ROW_512_(1);
+            _DGEMM_MK_STORE_ROW_512_(2);
+            _DGEMM_MK_STORE_ROW_512_(3);
+            _DGEMM_MK_STORE_ROW_512_(4);
+            _DGEMM_MK_STORE_ROW_512_(5);
+            _DGEMM_MK_STORE_ROW_512_(6);
+            _DGEMM_MK_STORE_ROW_512_(7);
+            _DGEMM_MK_STORE_ROW_512_(8);
+            _DGEMM_MK_STORE_ROW_512_(9);
+            _DGEMM_MK_STORE_ROW_512_(10);
+            _DGEMM_MK_STORE_ROW_512_(11);
+        }
+    }
+}
+_DECX_ISA_END_
+
+
+
+namespace decx
+{
+    static void _select_dgemm_ukernel(const int isa)
+    {
+        decx::_dgemm_ukernel* uk = &decx::_dgemm_ukernels;
+        switch (isa)
+        {
+        case de::CPU_ISA::ISA_AVX512:
+            uk->mr = 12;        uk->nr = 16;
+            uk->full = &decx::avx512::_dgemm_kernel_12x16;
+            uk->edge = &decx::_gemm_kernel_edge<double, double, &decx::avx512::_dgemm_kernel_12x16, 12, 16>;
+            break;
+        case de::CPU_ISA::ISA_AVX2:
+            uk->mr = 6;         uk->nr = 8;
+            uk->full = &decx::avx2::_dgemm_kernel_6x8;
+            uk->edge = &decx::_gemm_kernel_edge<double, double, &decx::avx2::_dgemm_kernel_6x8, 6, 8>;
+            break;
+        default:
+            uk->mr = 6;         uk->nr = 4;
+            uk->full = &decx::sse42::_dgemm_kernel_6x4;
+            uk->edge = &decx::_gemm_kernel_edge<double, double, &decx::sse42::_dgemm_kernel_6x4, 6, 4>;
+            break;
+        }
+    }
+
+
+    static decx::_ISA_dispatch_reg _dgemm_ukernels_reg(&decx::_select_dgemm_ukernel);
+}
+
+
+#endif
@@ -0,0 +1,604 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+
+#ifndef _GEMM_BLOCKED_H_
+#define _GEMM_BLOCKED_H_
+
+#include "gemm_utils.h"
+#include "gemm_ukernel.h"
+#include "../../core/allocators/scratch_arena.h"
+#include "../../core/allocators.h"
+#include <atomic>
+
+
+/**
+* The packed, cache-blocked GEMM (the Goto / BLIS algorithm), for all the element types. For each tile
+* of C computed by one thread :
+*
+*   for jc in [0, N) step nc                    -- B panel (kc x nc) packed, stays in L3
+*       for pc in [0, K) step kc
+*           pack B[pc : pc + kc, jc : jc + nc]
+*           for ic in [0, M) step mc            -- A block (mc x kc) packed, stays in L2
+*               pack A[ic : ic + mc, pc : pc + kc]
+*               for jr in [0, nc) step NR               -- B micro-panel (kc x NR) stays in L1
+*                   for ir in [0, mc) step MR
+*                       C[MR, NR] (+)= A micro-panel * B micro-panel   (decx::_gemm_ukernel)
+*
+* The block sizes are derived from the caches detected by de::InitCPUInfo(), see decx::_gemm_block_sizes.
+* MR and NR are of the micro-kernel of the de::CPU_ISA in use.
+*
+* The general form C = alpha * op(A) * op(B) + beta * S costs no extra pass : op() (the transposes) is
+* applied by the packing, which copies the elements anyway, and alpha and beta by the stores of the
+* micro-kernel. The first kc-block stores alpha * AB + beta * S, the next ones alpha * AB + C.
+*
+* The operands are packed in groups of _KP consecutive k (_KP = 1 for float and double, 2 for int8, whose
+* micro-kernel multiplies pairs of int16 at once). K is padded with zeros to a multiple of _KP.
+*/
+
+
+// used when the caches are not detected
+#define _GEMM_DEFAULT_L1_ (32 << 10)
+#define _GEMM_DEFAULT_L2_ (256 << 10)
+#define _GEMM_DEFAULT_L3_ (8 << 20)
+
+
+namespace decx
+{
+    struct _gemm_block_sizes;
+
+
+    /**
+    * @param _Ti : the type of the elements of A and B
+    * @param _Tp : the type A and B are packed to
+    * @param _To : the type of C
+    * @param _KP : the number of k packed together
+    */
+    template <typename _Ti, typename _Tp, typename _To, int _KP>
+    struct _gemm_blocked_info;
+
+
+    /**
+    * @brief Pack the block of op(A) (mc x kc, at A with pitch lda) into the micro-panels of MR rows,
+    * the rows beyond mc and the k beyond kc are padded with zeros
+    * @param trans : true if A is stored transposed (kc x mc), then a row of a micro-panel is a run of A
+    */
+    template <typename _Ti, typename _Tp, int _KP>
+    static void _gemm_pack_A(const _Ti* A, const size_t lda, _Tp* pA, const int mc, const int kc, const int MR,
+        const bool trans);
+
+
+    /**
+    * @brief Pack the panel of op(B) (kc x nc, at B with pitch ldb) into the micro-panels of NR cols,
+    * the cols beyond nc and the k beyond kc are padded with zeros
+    * @param trans : true if B is stored transposed (nc x kc)
+    */
+    template <typename _Ti, typename _Tp, int _KP>
+    static void _gemm_pack_B(const _Ti* B, const size_t ldb, _Tp* pB, const int kc, const int nc, const int NR,
+        const bool trans);
+
+
+    /**
+    * @param kc : the length of the packed panels, in k (a multiple of _KP)
+    * @param S : the block added to the product (scaled by beta), the same size as C, NULL for none
+    */
+    template <typename _Tp, typename _To, int _KP>
+    static void _gemm_macro_kernel(const decx::_gemm_ukernel<_Tp, _To>* uk, const _Tp* pA, const _Tp* pB, _To* C,
+        const size_t ldc, const _To* S, const size_t lds, const _To alpha, const _To beta,
+        const int mc, const int nc, const int kc);
+
+
+    /**
+    * @brief Compute the tile of C of rows [row_beg, row_end) and cols [col_beg, col_end) on the calling thread
+    * @param buffer : room for the packed blocks, at least decx::_gemm_tile_buffer_len() elements
+    */
+    template <typename _Ti, typename _Tp, typename _To, int _KP>
+    static void _gemm_blocked_tile(const decx::_gemm_blocked_info<_Ti, _Tp, _To, _KP>* info, const int row_beg,
+        const int row_end, const int col_beg, const int col_end, _Tp* buffer);
+
+
+    /**
+    * @brief C = beta * S (or 0 if S is NULL), the whole result when K is 0 and no kc-block is run
+    */
+    template <typename _Ti, typename _Tp, typename _To, int _KP>
+    static void _gemm_empty_product(const decx::_gemm_blocked_info<_Ti, _Tp, _To, _KP>* info, _To* C, const _To* S);
+
+
+    // in elements of _Tp
+    template <typename _Ti, typename _Tp, typename _To, int _KP>
+    static size_t _gemm_tile_buffer_len(const decx::_gemm_blocked_info<_Ti, _Tp, _To, _KP>* info, const int rows,
+        const int cols);
+
+
+    /**
+    * @return The length (in elements of _Tp) of the workspace decx::gemm_blocked() needs for the problem
+    */
+    template <typename _Ti, typename _Tp, typename _To, int _KP>
+    static size_t gemm_blocked_workspace_len(const decx::_gemm_blocked_info<_Ti, _Tp, _To, _KP>* info);
+
+
+    /**
+    * @brief C = alpha * op(A) * op(B) + beta * S, multithreaded by decx::utils::_sgemm_grid
+    * @param workspace : room for the packed blocks of all the tiles, at least decx::gemm_blocked_workspace_len()
+    * elements. If NULL, each tile takes its buffer from the scratch arena of the thread computing it
+    * @return false if a buffer can not be allocated
+    */
+    template <typename _Ti, typename _Tp, typename _To, int _KP>
+    static bool gemm_blocked(const decx::_gemm_blocked_info<_Ti, _Tp, _To, _KP>* info, _Tp* workspace);
+
+
+    /**
+    * @return The length (in elements of _Tp) of the whole op(B) of info packed by decx::gemm_prepack_B()
+    */
+    template <typename _Ti, typename _Tp, typename _To, int _KP>
+    static size_t gemm_prepacked_B_len(const decx::_gemm_blocked_info<_Ti, _Tp, _To, _KP>* info);
+
+
+    /**
+    * @brief Pack the whole op(B) of info at once, multithreaded. The kc-blocks are stored one after another,
+    * each as all the micro-panels of NR cols across N, so the panel (pc, jc) the tiles read is at
+    * pB + pc * ceil(N, NR) * NR + jc * kc. Set the result to info->pB to skip the packing of B.
+    */
+    template <typename _Ti, typename _Tp, typename _To, int _KP>
+    static void gemm_prepack_B(const decx::_gemm_blocked_info<_Ti, _Tp, _To, _KP>* info, _Tp* pB);
+
+
+    // the distances between the consecutive products of a batch, in elements, 0 shares the operand by all
+    struct _gemm_batch_strides
+    {
+        size_t A, B, C, S;
+    };
+
+
+    /**
+    * @brief The batch of batch_num products, the i-th is info with A, B, C and S moved by i strides.
+    * The threads are shared by the batch first : each product gets thread_num / batch_num of them
+    * (at least one) to cut it by decx::utils::_sgemm_grid, and all the tiles of all the products are
+    * taken by the threads dynamically. So a batch of many small products runs one product per thread,
+    * and a short batch of large products is cut inside the products. Each thread packs all its tiles
+    * in the one buffer taken from its scratch arena. If B is shared (strides->B is 0) by more than one
+    * product, op(B) is packed once by decx::gemm_prepack_B() to a buffer of the memory pool, and no tile
+    * packs B again.
+    * @return false if a buffer can not be allocated
+    */
+    template <typename _Ti, typename _Tp, typename _To, int _KP>
+    static bool gemm_blocked_batched(const decx::_gemm_blocked_info<_Ti, _Tp, _To, _KP>* info, const size_t batch_num,
+        const decx::_gemm_batch_strides* strides);
+}
+
+
+
+struct decx::_gemm_block_sizes
+{
+    int mc, kc, nc;
+
+    /**
+    * kc : a micro-panel of B (kc x NR) takes half of L1, the other half is for A and C.
+    * mc : a block of A (mc x kc) takes half of L2.
+    * nc : a panel of B (kc x nc) takes half of the share of L3 of one thread.
+    * @param elem_size : the size of one packed element
+    */
+    _gemm_block_sizes(const int MR, const int NR, const size_t elem_size)
+    {
+        const bool _detected = decx::cpI.is_init;
+        const size_t L1 = (_detected && decx::cpI.L1d_size) ? decx::cpI.L1d_size : _GEMM_DEFAULT_L1_;
+        const size_t L2 = (_detected && decx::cpI.L2_size) ? decx::cpI.L2_size : _GEMM_DEFAULT_L2_;
+        const size_t L3 = (_detected && decx::cpI.L3_size) ? decx::cpI.L3_size : _GEMM_DEFAULT_L3_;
+        const size_t _L3_sharers = _detected ?
+            decx::utils::clamp_min<size_t>(decx::cpI.cpu_concurrency / decx::utils::clamp_min<uint>(decx::cpI.socket_num, 1), 1) : 1;
+
+        size_t _kc = L1 / 2 / (NR * elem_size);
+        _kc = decx::utils::clamp_max<size_t>(decx::utils::clamp_min<size_t>(_kc, 64), 1024) & ~(size_t)7;
+
+        size_t _mc = L2 / 2 / (_kc * elem_size);
+        _mc = decx::utils::clamp_max<size_t>(decx::utils::clamp_min<size_t>(_mc, MR * 4), 1020);
+        _mc -= _mc % MR;
+
+        size_t _nc = L3 / 2 / _L3_sharers / (_kc * elem_size);
+        _nc = decx::utils::clamp_max<size_t>(decx::utils::clamp_min<size_t>(_nc, NR * 16), 8192);
+        _nc -= _nc % NR;
+
+        this->kc = (int)_kc;
+        this->mc = (int)_mc;
+        this->nc = (int)_nc;
+    }
+};
+
+
+
+template <typename _Ti, typename _Tp, typename _To, int _KP>
+struct decx::_gemm_blocked_info
+{
+    const _Ti* A, * B;
+    _To* C;
+    size_t lda, ldb, ldc;       // the pitches, in elements
+    int M, N, K;                // op(A) is M x K, op(B) is K x N
+
+    // C = alpha * op(A) * op(B) + beta * S, S is M x N, NULL for none. S can be C (accumulating in place)
+    const _To* S;
+    size_t lds;
+    _To alpha, beta;
+    bool transA, transB;        // true if A (or B) is stored transposed, then lda (ldb) is the pitch of the stored one
+
+    // op(B) packed by decx::gemm_prepack_B() with the same uk.nr and bs.kc, aligned to 32 bytes (host_mem_alignment
+    // of the memory pool) for the aligned loads of the SSE4.2 and AVX2 micro-kernels, the AVX-512 ones load it
+    // unaligned. NULL to pack B on the fly
+    const _Tp* pB;
+
+    // a copy of the micro-kernel in use, taken at the construction
+    decx::_gemm_ukernel<_Tp, _To> uk;
+    decx::_gemm_block_sizes bs;
+
+
+    // C = A * B by default
+    _gemm_blocked_info(const decx::_gemm_ukernel<_Tp, _To>& _uk) :
+        S(NULL), lds(0), alpha(1), beta(0), transA(false), transB(false), pB(NULL),
+        uk(_uk), bs(uk.mr, uk.nr, sizeof(_Tp)) {}
+};
+
+
+
+template <typename _Ti, typename _Tp, int _KP>
+static void decx::_gemm_pack_A(const _Ti* A, const size_t lda, _Tp* pA, const int mc, const int kc, const int MR,
+    const bool trans)
+{
+    const int _kcp = decx::utils::ceil<int>(kc, _KP) * _KP;
+
+    for (int i = 0; i < mc; i += MR) {
+        const int mr = decx::utils::clamp_max<int>(mc - i, MR);
+        // the element (r, k) of the micro-panel is at ((k / _KP) * MR + r) * _KP + k % _KP
+        if (trans) {
+            const _Ti* _src = A + i;
+            for (int k = 0; k < kc; ++k) {
+                _Tp* _dst = pA + (k / _KP) * MR * _KP + k % _KP;
+                for (int r = 0; r < mr; ++r) {
+                    _dst[r * _KP] = (_Tp)_src[r];
+                }
+                _src += lda;
+            }
+        }
+        else {
+            for (int r = 0; r < mr; ++r) {
+                const _Ti* _src = A + (size_t)(i + r) * lda;
+                for (int k = 0; k < kc; ++k) {
+                    pA[((k / _KP) * MR + r) * _KP + k % _KP] = (_Tp)_src[k];
+                }
+            }
+        }
+        for (int r = mr; r < MR; ++r) {
+            for (int k = 0; k < _kcp; ++k) {
+                pA[((k / _KP) * MR + r) * _KP + k % _KP] = 0;
+            }
+        }
+        for (int k = kc; k < _kcp; ++k) {
+            for (int r = 0; r < mr; ++r) {
+                pA[((k / _KP) * MR + r) * _KP + k % _KP] = 0;
+            }
+        }
+        pA += (size_t)_kcp * MR;
+    }
+}
+
+
+
+template <typename _Ti, typename _Tp, int _KP>
+static void decx::_gemm_pack_B(const _Ti* B, const size_t ldb, _Tp* pB, const int kc, const int nc, const int NR,
+    const bool trans)
+{
+    const int _kcp = decx::utils::ceil<int>(kc, _KP) * _KP;
+
+    for (int j = 0; j < nc; j += NR) {
+        const int nr = decx::utils::clamp_max<int>(nc - j, NR);
+        // the element (k, c) of the micro-panel is at ((k / _KP) * NR + c) * _KP + k % _KP
+        if (trans) {
+            // the cols of the micro-panel are the rows of B
+            for (int c = 0; c < nr; ++c) {
+                const _Ti* _src = B + (size_t)(j + c) * ldb;
+                for (int k = 0; k < kc; ++k) {
+                    pB[((k / _KP) * NR + c) * _KP + k % _KP] = (_Tp)_src[k];
+                }
+            }
+        }
+        else {
+            // plain copies, this runs on the hosts of any de::CPU_ISA
+            const _Ti* _src = B + j;
+            for (int k = 0; k < kc; ++k) {
+                _Tp* _dst = pB + (k / _KP) * NR * _KP + k % _KP;
+                for (int c = 0; c < nr; ++c) {
+                    _dst[c * _KP] = (_Tp)_src[c];
+                }
+                _src += ldb;
+            }
+        }
+        for (int k = 0; k < _kcp; ++k) {
+            for (int c = (k < kc ? nr : 0); c < NR; ++c) {
+                pB[((k / _KP) * NR + c) * _KP + k % _KP] = 0;
+            }
+        }
+        pB += (size_t)_kcp * NR;
+    }
+}
+
+
+
+template <typename _Tp, typename _To, int _KP>
+static void decx::_gemm_macro_kernel(const decx::_gemm_ukernel<_Tp, _To>* uk, const _Tp* pA, const _Tp* pB, _To* C,
+    const size_t ldc, const _To* S, const size_t lds, const _To alpha, const _To beta,
+    const int mc, const int nc, const int kc)
+{
+    for (int j = 0; j < nc; j += uk->nr) {
+        const int nr = decx::utils::clamp_max<int>(nc - j, uk->nr);
+        const _Tp* _pB = pB + (size_t)j * kc;
+
+        for (int i = 0; i < mc; i += uk->mr) {
+            const int mr = decx::utils::clamp_max<int>(mc - i, uk->mr);
+            const _Tp* _pA = pA + (size_t)i * kc;
+            _To* _C = C + (size_t)i * ldc + j;
+            const _To* _S = S != NULL ? S + (size_t)i * lds + j : NULL;
+
+            if (mr == uk->mr && nr == uk->nr) {
+                uk->full(kc / _KP, _pA, _pB, _C, ldc, _S, lds, alpha, beta);
+            }
+            else {
+                uk->edge(kc / _KP, _pA, _pB, _C, ldc, _S, lds, alpha, beta, mr, nr);
+            }
+        }
+    }
+}
+
+
+
+template <typename _Ti, typename _Tp, typename _To, int _KP>
+static size_t decx::_gemm_tile_buffer_len(const decx::_gemm_blocked_info<_Ti, _Tp, _To, _KP>* info, const int rows,
+    const int cols)
+{
+    const decx::_gemm_block_sizes* bs = &info->bs;
+    const size_t _mc = decx::utils::clamp_max<size_t>(decx::utils::ceil<size_t>(rows, info->uk.mr) * info->uk.mr, bs->mc);
+    const size_t _nc = decx::utils::clamp_max<size_t>(decx::utils::ceil<size_t>(cols, info->uk.nr) * info->uk.nr, bs->nc);
+    const size_t _kc = decx::utils::ceil<size_t>(decx::utils::clamp_max<size_t>(info->K, bs->kc), _KP) * _KP;
+
+    // both the blocks start at 64 bytes, the prepacked B takes no room
+    const size_t _align = 64 / sizeof(_Tp);
+    return decx::utils::ceil<size_t>(_mc * _kc, _align) * _align +
+        (info->pB != NULL ? 0 : decx::utils::ceil<size_t>(_kc * _nc, _align) * _align);
+}
+
+
+
+template <typename _Ti, typename _Tp, typename _To, int _KP>
+static void decx::_gemm_blocked_tile(const decx::_gemm_blocked_info<_Ti, _Tp, _To, _KP>* info, const int row_beg,
+    const int row_end, const int col_beg, const int col_end, _Tp* buffer)
+{
+    const decx::_gemm_block_sizes* bs = &info->bs;
+    const size_t _kc_max = decx::utils::ceil<size_t>(decx::utils::clamp_max<size_t>(info->K, bs->kc), _KP) * _KP;
+    const size_t _mc_max = decx::utils::clamp_max<size_t>(
+        decx::utils::ceil<size_t>(row_end - row_beg, info->uk.mr) * info->uk.mr, bs->mc);
+
+    _Tp* pA = buffer;
+    _Tp* pB = buffer + decx::utils::ceil<size_t>(_mc_max * _kc_max, 64 / sizeof(_Tp)) * (64 / sizeof(_Tp));
+    const size_t _N_pad = decx::utils::ceil<size_t>(info->N, info->uk.nr) * info->uk.nr;
+
+    for (int jc = col_beg; jc < col_end; jc += bs->nc) {
+        const int nc = decx::utils::clamp_max<int>(col_end - jc, bs->nc);
+
+        for (int pc = 0; pc < info->K; pc += bs->kc) {
+            const int kc = decx::utils::clamp_max<int>(info->K - pc, bs->kc);
+            const int _kcp = decx::utils::ceil<int>(kc, _KP) * _KP;
+            if (info->pB != NULL) {
+                pB = (_Tp*)info->pB + (size_t)pc * _N_pad + (size_t)jc * _kcp;
+            }
+            else {
+                const _Ti* _B = info->transB ? info->B + (size_t)jc * info->ldb + pc : info->B + (size_t)pc * info->ldb + jc;
+                decx::_gemm_pack_B<_Ti, _Tp, _KP>(_B, info->ldb, pB, kc, nc, info->uk.nr, info->transB);
+            }
+
+            for (int ic = row_beg; ic < row_end; ic += bs->mc) {
+                const int mc = decx::utils::clamp_max<int>(row_end - ic, bs->mc);
+                const _Ti* _A = info->transA ? info->A + (size_t)pc * info->lda + ic : info->A + (size_t)ic * info->lda + pc;
+                decx::_gemm_pack_A<_Ti, _Tp, _KP>(_A, info->lda, pA, mc, kc, info->uk.mr, info->transA);
+
+                _To* _C = info->C + (size_t)ic * info->ldc + jc;
+                // the first kc-block takes beta * S, the next ones accumulate onto C
+                if (pc == 0) {
+                    decx::_gemm_macro_kernel<_Tp, _To, _KP>(&info->uk, pA, pB, _C, info->ldc,
+                        info->S != NULL ? info->S + (size_t)ic * info->lds + jc : NULL, info->lds,
+                        info->alpha, info->beta, mc, nc, _kcp);
+                }
+                else {
+                    decx::_gemm_macro_kernel<_Tp, _To, _KP>(&info->uk, pA, pB, _C, info->ldc, _C, info->ldc,
+                        info->alpha, (_To)1, mc, nc, _kcp);
+                }
+            }
+        }
+    }
+}
+
+
+
+template <typename _Ti, typename _Tp, typename _To, int _KP>
+static void decx::_gemm_empty_product(const decx::_gemm_blocked_info<_Ti, _Tp, _To, _KP>* info, _To* C, const _To* S)
+{
+    for (int i = 0; i < info->M; ++i) {
+        _To* _C = C + (size_t)i * info->ldc;
+        for (int j = 0; j < info->N; ++j) {
+            _C[j] = S != NULL ? info->beta * S[(size_t)i * info->lds + j] : (_To)0;
+        }
+    }
+}
+
+
+
+template <typename _Ti, typename _Tp, typename _To, int _KP>
+static size_t decx::gemm_blocked_workspace_len(const decx::_gemm_blocked_info<_Ti, _Tp, _To, _KP>* info)
+{
+    const int MR = info->uk.mr, NR = info->uk.nr;
+    const int _row_units = decx::utils::ceil<int>(info->M, MR);
+    const int _col_units = decx::utils::ceil<int>(info->N, NR);
+    const decx::utils::_sgemm_grid grid(_row_units, _col_units,
+        (size_t)info->M * (size_t)info->N * (size_t)info->K,
+        decx::thread_pool.get_current_thread_num(), make_int2(MR, NR));
+
+    const size_t _tile_len = decx::_gemm_tile_buffer_len(info,
+        decx::utils::ceil<int>(_row_units, grid._grid.x) * MR,
+        decx::utils::ceil<int>(_col_units, grid._grid.y) * NR);
+
+    return _tile_len * (size_t)grid._grid.x * (size_t)grid._grid.y;
+}
+
+
+
+template <typename _Ti, typename _Tp, typename _To, int _KP>
+static bool decx::gemm_blocked(const decx::_gemm_blocked_info<_Ti, _Tp, _To, _KP>* info, _Tp* workspace)
+{
+    // op(A) * op(B) is empty, the tiles would store nothing
+    if (info->K == 0) {
+        decx::_gemm_empty_product(info, info->C, info->S);
+        return true;
+    }
+
+    const int MR = info->uk.mr, NR = info->uk.nr;
+    const int _row_units = decx::utils::ceil<int>(info->M, MR);
+    const int _col_units = decx::utils::ceil<int>(info->N, NR);
+    const decx::utils::_sgemm_grid grid(_row_units, _col_units,
+        (size_t)info->M * (size_t)info->N * (size_t)info->K,
+        decx::thread_pool.get_current_thread_num(), make_int2(MR, NR));
+
+    // all the tiles share one upper bound of the length of the buffer
+    const size_t _tile_len = decx::_gemm_tile_buffer_len(info,
+        decx::utils::ceil<int>(_row_units, grid._grid.x) * MR,
+        decx::utils::ceil<int>(_col_units, grid._grid.y) * NR);
+
+    std::atomic<bool> _failed(false);
+
+    decx::parallel_for(0, (size_t)grid._grid.x * (size_t)grid._grid.y, [&](const size_t _beg, const size_t _end) {
+        decx::ScratchMarker marker(&decx::_tl_scratch_arena);
+        _Tp* _buffer = workspace == NULL ? decx::_tl_scratch_arena.allocate<_Tp>(_tile_len) : NULL;
+
+        for (size_t t = _beg; t < _end; ++t) {
+            const int _r = (int)(t / grid._grid.y), _c = (int)(t % grid._grid.y);
+            const int2 _rows = grid.rows_of(_r), _cols = grid.lanes_of(_c);
+
+            _Tp* _buf = workspace == NULL ? _buffer : workspace + t * _tile_len;
+            if (_buf == NULL) {
+                _failed.store(true, std::memory_order_relaxed);
+                return;
+            }
+            decx::_gemm_blocked_tile(info,
+                _rows.x * MR, decx::utils::clamp_max<int>(_rows.y * MR, info->M),
+                _cols.x * NR, decx::utils::clamp_max<int>(_cols.y * NR, info->N), _buf);
+        }
+    }, 1, decx::Partition_Dynamic);
+
+    return !_failed.load(std::memory_order_relaxed);
+}
+
+
+
+template <typename _Ti, typename _Tp, typename _To, int _KP>
+static size_t decx::gemm_prepacked_B_len(const decx::_gemm_blocked_info<_Ti, _Tp, _To, _KP>* info)
+{
+    const size_t _N_pad = decx::utils::ceil<size_t>(info->N, info->uk.nr) * info->uk.nr;
+    return _N_pad * (decx::utils::ceil<size_t>(info->K, _KP) * _KP);
+}
+
+
+
+template <typename _Ti, typename _Tp, typename _To, int _KP>
+static void decx::gemm_prepack_B(const decx::_gemm_blocked_info<_Ti, _Tp, _To, _KP>* info, _Tp* pB)
+{
+    const int NR = info->uk.nr, kc_max = info->bs.kc;
+    const size_t _panels = decx::utils::ceil<size_t>(info->N, NR);
+    const size_t _blocks = decx::utils::ceil<size_t>(info->K, kc_max);
+
+    decx::parallel_for(0, _blocks * _panels, [&](const size_t _beg, const size_t _end) {
+        for (size_t t = _beg; t < _end; ++t) {
+            const int pc = (int)(t / _panels) * kc_max, jc = (int)(t % _panels) * NR;
+            const int kc = decx::utils::clamp_max<int>(info->K - pc, kc_max);
+            const int _kcp = decx::utils::ceil<int>(kc, _KP) * _KP;
+
+            const _Ti* _B = info->transB ? info->B + (size_t)jc * info->ldb + pc : info->B + (size_t)pc * info->ldb + jc;
+            decx::_gemm_pack_B<_Ti, _Tp, _KP>(_B, info->ldb, pB + (size_t)pc * _panels * NR + (size_t)jc * _kcp,
+                kc, decx::utils::clamp_max<int>(info->N - jc, NR), NR, info->transB);
+        }
+    });
+}
+
+
+
+template <typename _Ti, typename _Tp, typename _To, int _KP>
+static bool decx::gemm_blocked_batched(const decx::_gemm_blocked_info<_Ti, _Tp, _To, _KP>* info, const size_t batch_num,
+    const decx::_gemm_batch_strides* strides)
+{
+    if (info->K == 0) {
+        for (size_t i = 0; i < batch_num; ++i) {
+            decx::_gemm_empty_product(info, info->C + i * strides->C,
+                info->S != NULL ? info->S + i * strides->S : NULL);
+        }
+        return true;
+    }
+
+    const int MR = info->uk.mr, NR = info->uk.nr;
+    const int _row_units = decx::utils::ceil<int>(info->M, MR);
+    const int _col_units = decx::utils::ceil<int>(info->N, NR);
+    const size_t _thr = decx::thread_pool.get_current_thread_num();
+    const decx::utils::_sgemm_grid grid(_row_units, _col_units,
+        (size_t)info->M * (size_t)info->N * (size_t)info->K,
+        decx::utils::clamp_min<size_t>(_thr / decx::utils::clamp_min<size_t>(batch_num, 1), 1), make_int2(MR, NR));
+
+    // the shared B is packed once for the whole batch, instead of by every tile of every product
+    decx::_gemm_blocked_info<_Ti, _Tp, _To, _KP> _proto = *info;
+    decx::PtrInfo<_Tp> _pB;
+    const bool _prepack = strides->B == 0 && info->pB == NULL && batch_num > 1;
+    if (_prepack) {
+        if (decx::alloc::_host_virtual_page_malloc<_Tp>(&_pB, decx::gemm_prepacked_B_len(info) * sizeof(_Tp))) {
+            return false;
+        }
+        decx::gemm_prepack_B(info, _pB.ptr);
+        _proto.pB = _pB.ptr;
+    }
+
+    const size_t _tile_num = (size_t)grid._grid.x * (size_t)grid._grid.y;
+    const size_t _tile_len = decx::_gemm_tile_buffer_len(&_proto,
+        decx::utils::ceil<int>(_row_units, grid._grid.x) * MR,
+        decx::utils::ceil<int>(_col_units, grid._grid.y) * NR);
+
+    std::atomic<bool> _failed(false);
+
+    decx::parallel_for(0, batch_num * _tile_num, [&](const size_t _beg, const size_t _end) {
+        decx::ScratchMarker marker(&decx::_tl_scratch_arena);
+        _Tp* _buffer = decx::_tl_scratch_arena.allocate<_Tp>(_tile_len);
+        if (_buffer == NULL) {
+            _failed.store(true, std::memory_order_relaxed);
+            return;
+        }
+
+        decx::_gemm_blocked_info<_Ti, _Tp, _To, _KP> _info = _proto;
+        for (size_t t = _beg; t < _end; ++t) {
+            const size_t _i = t / _tile_num, _tile = t % _tile_num;
+            _info.A = info->A + _i * strides->A;
+            _info.B = info->B + _i * strides->B;
+            _info.C = info->C + _i * strides->C;
+            _info.S = info->S != NULL ? info->S + _i * strides->S : NULL;
+
+            const int _r = (int)(_tile / grid._grid.y), _c = (int)(_tile % grid._grid.y);
+            const int2 _rows = grid.rows_of(_r), _cols = grid.lanes_of(_c);
+            decx::_gemm_blocked_tile(&_info,
+                _rows.x * MR, decx::utils::clamp_max<int>(_rows.y * MR, info->M),
+                _cols.x * NR, decx::utils::clamp_max<int>(_cols.y * NR, info->N), _buffer);
+        }
+    }, 1, decx::Partition_Dynamic);
+
+    if (_prepack) {
+        decx::alloc::_host_virtual_page_dealloc(&_pB);
+    }
+    return !_failed.load(std::memory_order_relaxed);
+}
+
+
+#endif
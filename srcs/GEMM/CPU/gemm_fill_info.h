@@ -0,0 +1,93 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+
+#ifndef _GEMM_FILL_INFO_H_
+#define _GEMM_FILL_INFO_H_
+
+#include "gemm_blocked.h"
+#include "../../classes/Matrix.h"
+
+
+namespace de
+{
+    namespace cpu
+    {
+        // combined by '|', tells de::cpu::GEMM() which operands are to be transposed
+        enum GEMM_Trans
+        {
+            GEMM_NoTrans = 0x00,
+            GEMM_TransA = 0x01,
+            GEMM_TransB = 0x02,
+        };
+    }
+}
+
+
+namespace decx
+{
+    /**
+    * @brief Check the shapes of op(A), op(B) and C (if not NULL), and shape dst to M x N unless it is C.
+    * Shared by de::cpu::GEMM() of all the element types.
+    * @return false if the shapes do not match or dst is A or B, the error is written to handle
+    */
+    template <typename _Ti, typename _Tp, typename _To, int _KP>
+    static bool _GEMM_fill_info(decx::_gemm_blocked_info<_Ti, _Tp, _To, _KP>* info, decx::_Matrix<_Ti>* A,
+        decx::_Matrix<_Ti>* B, decx::_Matrix<_To>* C, decx::_Matrix<_To>* dst, const _To alpha, const _To beta,
+        const int trans_flag, de::DH* handle);
+}
+
+
+
+template <typename _Ti, typename _Tp, typename _To, int _KP>
+static bool decx::_GEMM_fill_info(decx::_gemm_blocked_info<_Ti, _Tp, _To, _KP>* info, decx::_Matrix<_Ti>* A,
+    decx::_Matrix<_Ti>* B, decx::_Matrix<_To>* C, decx::_Matrix<_To>* dst, const _To alpha, const _To beta,
+    const int trans_flag, de::DH* handle)
+{
+    info->transA = (trans_flag & de::cpu::GEMM_TransA) != 0;
+    info->transB = (trans_flag & de::cpu::GEMM_TransB) != 0;
+
+    const uint M = info->transA ? A->width : A->height;
+    const uint K = info->transA ? A->height : A->width;
+    const uint K_B = info->transB ? B->width : B->height;
+    const uint N = info->transB ? B->height : B->width;
+
+    if (K != K_B || (C != NULL && (C->height != M || C->width != N))) {
+        decx::MDim_Not_Matching(handle);
+        return false;
+    }
+
+    // dst is written while later blocks of A and B are still read, and re_construct() would free them
+    if ((void*)dst == (void*)A || (void*)dst == (void*)B) {
+        decx::err::OperandAliasing(handle);
+        Print_Error_Message(4, OPERAND_ALIASING);
+        return false;
+    }
+
+    if (dst != C) {
+        dst->re_construct(N, M, decx::DATA_STORE_TYPE::Page_Default);
+    }
+
+    info->A = A->Mat.ptr;           info->lda = A->pitch;
+    info->B = B->Mat.ptr;           info->ldb = B->pitch;
+    info->C = dst->Mat.ptr;         info->ldc = dst->pitch;
+    info->M = M;
+    info->N = N;
+    info->K = K;
+
+    info->alpha = alpha;
+    // beta = 0 drops C, C is not read at all then
+    info->beta = beta;
+    info->S = (C != NULL && beta != 0) ? C->Mat.ptr : NULL;
+    info->lds = C != NULL ? C->pitch : 0;
+    return true;
+}
+
+
+#endif
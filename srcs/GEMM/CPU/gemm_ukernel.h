@@ -0,0 +1,88 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+
+#ifndef _GEMM_UKERNEL_H_
+#define _GEMM_UKERNEL_H_
+
+#include "../../core/basic.h"
+#include "../../core/configs/cpu_isa.h"
+
+
+/**
+* The interface of the micro-kernels of the packed GEMM (gemm_blocked.h), shared by all the element
+* types. _Tp is the type the operands are packed to, _To the type of C :
+*   float x float -> float      (sgemm_micro_kernel.h)
+*   double x double -> double   (dgemm_micro_kernel.h)
+*   int8 x int8 -> int32        (igemm_micro_kernel.h, packed to int16)
+*/
+
+
+namespace decx
+{
+    template <typename _Tp, typename _To>
+    struct _gemm_kernel_ptrs
+    {
+        typedef void (*_full)(const int, const _Tp*, const _Tp*, _To*, const size_t,
+            const _To*, const size_t, const _To, const _To);
+
+        typedef void (*_edge)(const int, const _Tp*, const _Tp*, _To*, const size_t,
+            const _To*, const size_t, const _To, const _To, const int, const int);
+    };
+
+
+    template <typename _Tp, typename _To>
+    struct _gemm_ukernel
+    {
+        int mr, nr;
+
+        /**
+        * C[mr, nr] = alpha * A_panel * B_panel + beta * S[mr, nr]
+        * @param kc : the length of the panels, in k-groups (see decx::_gemm_blocked_info)
+        * @param pA : the packed panel of A, kc x mr, the mr k-groups of one kc are contiguous
+        * @param pB : the packed panel of B, kc x nr, the nr k-groups of one kc are contiguous (aligned to 32 bytes)
+        * @param ldc : the pitch of C, in elements
+        * @param S : the tile added to the product, NULL for none (S is never read then, so beta = 0 drops
+        * even the NaNs of S). S can be C itself, each element is read before it is written
+        * @param lds : the pitch of S, in elements
+        */
+        typename decx::_gemm_kernel_ptrs<_Tp, _To>::_full full;
+
+        // the same as full, but only the first mr rows and nr cols of C (the last 2 params) are written
+        typename decx::_gemm_kernel_ptrs<_Tp, _To>::_edge edge;
+    };
+
+
+    /**
+    * @brief Computes the whole register tile into a local tile, then writes the valid part of it.
+    * The panels are still of full size (padded with zeros).
+    */
+    template <typename _Tp, typename _To, typename decx::_gemm_kernel_ptrs<_Tp, _To>::_full _kernel, int _MR, int _NR>
+    static void _gemm_kernel_edge(const int kc, const _Tp* pA, const _Tp* pB, _To* C, const size_t ldc,
+        const _To* S, const size_t lds, const _To alpha, const _To beta, const int mr, const int nr);
+}
+
+
+
+template <typename _Tp, typename _To, typename decx::_gemm_kernel_ptrs<_Tp, _To>::_full _kernel, int _MR, int _NR>
+static void decx::_gemm_kernel_edge(const int kc, const _Tp* pA, const _Tp* pB, _To* C, const size_t ldc,
+    const _To* S, const size_t lds, const _To alpha, const _To beta, const int mr, const int nr)
+{
+    __align__(64) _To _tile[_MR * _NR];
+    _kernel(kc, pA, pB, _tile, _NR, NULL, 0, alpha, 0);
+
+    for (int i = 0; i < mr; ++i) {
+        for (int j = 0; j < nr; ++j) {
+            C[i * ldc + j] = S != NULL ? _tile[i * _NR + j] + beta * S[i * lds + j] : _tile[i * _NR + j];
+        }
+    }
+}
+
+
+#endif
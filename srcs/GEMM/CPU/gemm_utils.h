@@ -11,7 +11,7 @@
 #define _GEMM_UTILS_H_
 
 #include "../../core/basic.h"
-#include "../../core/thread_management/thread_pool.h"
+#include "../../core/thread_management/parallel_for.h"
 
 
 
@@ -39,18 +39,27 @@ namespace decx
     * dims_pkg.x : linear length (hB) (wA)
     * dims_pkg.y : global_wB
     */
-    template <int thread_num> void sort_MatB_16(float* srcB, float* dstB, const int2& dims_pkg);
+    void sort_MatB_16(float* srcB, float* dstB, const int2& dims_pkg);
 
     /**
     * wB can be divided by 8 into integer
     * dims_pkg.x : linear length (hB) (wA)
     * dims_pkg.y : global_wB
     */
-    template <int thread_num> void sort_MatB_16_w8(float* srcB, float* dstB, const int2& dims_pkg);
+    void sort_MatB_16_w8(float* srcB, float* dstB, const int2& dims_pkg);
+
+    /**
+    * The same as decx::sort_MatB_16() and decx::sort_MatB_16_w8(), but on the calling thread only
+    * dims_pkg.x : linear length (hB) (wA)
+    * dims_pkg.y : global_wB
+    */
+    void sort_MatB_ST(float* srcB, float* dstB, const int2& dims_pkg);
 }
 
 
 
+// the former kernels, used by decx::sgemm_caller() only
+_DECX_ISA_BEGIN_AVX2_
 void _THREAD_FUNCTION_ decx::_avx256_sort_ST_MatB(float* srcB, float* dstB, const int4& dims_pkg)
 {
     size_t dex_src = 0, dex_dst = 0, tmp_dex_src = 0,
@@ -101,71 +110,157 @@ void _THREAD_FUNCTION_ decx::_avx256_sort_ST_MatB_w8(float* srcB, float* dstB, c
         tmp_dex_src += (size_t)dims_pkg.z;
     }
 }
+_DECX_ISA_END_
 
 
 
-template <int thread_num>
 void decx::sort_MatB_16(float* srcB, float* dstB, const int2& dims_pkg)
 {
-    std::future<void>* __async_stream = new std::future<void>[16];
+    const int lane_num = dims_pkg.y / 16;
+
+    decx::parallel_for(0, lane_num, [&](const size_t _beg, const size_t _end) {
+        decx::_avx256_sort_ST_MatB(srcB + _beg * 16,
+                                   dstB + _beg * 16 * (size_t)dims_pkg.x,
+                                   make_int4(dims_pkg.x, (int)(_end - _beg) * 16, dims_pkg.y, 0));
+    });
+}
+
+
+
+
+void decx::sort_MatB_16_w8(float* srcB, float* dstB, const int2& dims_pkg)
+{
+    const int lane_num = (dims_pkg.y - 8) / 16;
+
+    // the last unit is the 8-wide lane at the very right side
+    decx::parallel_for(0, lane_num + 1, [&](const size_t _beg, const size_t _end) {
+        if (_end == lane_num + 1) {
+            decx::_avx256_sort_ST_MatB_w8(srcB + _beg * 16,
+                                          dstB + _beg * 16 * (size_t)dims_pkg.x,
+                                          make_int4(dims_pkg.x, (int)(lane_num - _beg) * 16 + 8, dims_pkg.y, 0));
+        }
+        else {
+            decx::_avx256_sort_ST_MatB(srcB + _beg * 16,
+                                       dstB + _beg * 16 * (size_t)dims_pkg.x,
+                                       make_int4(dims_pkg.x, (int)(_end - _beg) * 16, dims_pkg.y, 0));
+        }
+    });
+}
 
-    int lane_num = dims_pkg.y / 16;
 
-    int4 proc_dims = make_int4(dims_pkg.x, (lane_num / thread_num) * 16, dims_pkg.y, 0);
-    size_t B_frag = (size_t)dims_pkg.x * (size_t)proc_dims.y;
-    int4 proc_dim_last = make_int4(dims_pkg.x, ((lane_num / thread_num) + lane_num % thread_num) * 16, dims_pkg.y, 0);
 
-    for (int i = 0; i < thread_num - 1; ++i) {
-        __async_stream[i] = decx::thread_pool.register_task(
-            _avx256_sort_ST_MatB,
-            srcB + i * (size_t)proc_dims.y,
-            dstB + i * B_frag,
-            proc_dims);
+void decx::sort_MatB_ST(float* srcB, float* dstB, const int2& dims_pkg)
+{
+    if (dims_pkg.y % 16) {
+        decx::_avx256_sort_ST_MatB_w8(srcB, dstB, make_int4(dims_pkg.x, dims_pkg.y, dims_pkg.y, 0));
     }
-    __async_stream[thread_num - 1] = decx::thread_pool.register_task(
-        _avx256_sort_ST_MatB,
-        srcB + (thread_num - 1) * (size_t)proc_dims.y,
-        dstB + (thread_num - 1) * B_frag,
-        proc_dim_last);
-
-    for (int i = 0; i < thread_num; ++i) {
-        __async_stream[i].get();
+    else {
+        decx::_avx256_sort_ST_MatB(srcB, dstB, make_int4(dims_pkg.x, dims_pkg.y, dims_pkg.y, 0));
     }
 }
 
+// ----------------------------- end sort ---------------------------------------
+
 
 
+// ----------------------------- thread grid ------------------------------------
 
-template <int thread_num>
-void decx::sort_MatB_16_w8(float* srcB, float* dstB, const int2& dims_pkg)
+// below this M * N * K, sgemm runs on the calling thread only, the dispatch costs more than the math
+#define _SGEMM_ST_MAX_MNK_ (1 << 19)
+
+// the least M * N * K worth one more thread
+#define _SGEMM_MNK_PER_THREAD_ (1 << 18)
+
+// a grid may have up to 1 / _SGEMM_GRID_SLACK_DENO_ more blocks in a tile than the best balanced one,
+// if its tiles are closer to square
+#define _SGEMM_GRID_SLACK_DENO_ 16
+
+
+namespace decx
+{
+    namespace utils
+    {
+        struct _sgemm_grid;
+    }
+}
+
+
+/**
+* The 2D partition of C among the threads. C is cut into row blocks (of unit_size.x rows) and
+* lanes (of unit_size.y columns). The grid (_grid.x rows, _grid.y cols of tiles) is chosen from all the
+* grids of at most thread_num tiles, by
+*   1. the blocks in one tile, which is the time the slowest thread takes, should be at most
+*      1 + 1 / _SGEMM_GRID_SLACK_DENO_ times the least possible;
+*   2. among those, the least (rows + cols) of a tile, since a tile reads (rows + cols) * K floats
+*      of A and B;
+*   3. then the fewest tiles.
+* So the tall-skinny C is cut by rows only, the short-wide C by cols only, and the square C into
+* (nearly) square tiles.
+*/
+struct decx::utils::_sgemm_grid
 {
-    std::future<void>* __async_stream = new std::future<void>[thread_num];
+    int2 _grid;
+    int _row_blocks, _lanes;
 
-    int lane_num = (dims_pkg.y - 8) / 16;
 
-    int4 proc_dims = make_int4(dims_pkg.x, (lane_num / thread_num) * 16, dims_pkg.y, 0);
-    size_t B_frag = (size_t)dims_pkg.x * (size_t)proc_dims.y;
-    int4 proc_dim_last = make_int4(dims_pkg.x, ((lane_num / thread_num) + lane_num % thread_num) * 16 + 8, dims_pkg.y, 0);
+    _sgemm_grid(const int row_blocks, const int lanes, const size_t MNK, const size_t thread_num,
+        const int2 unit_size)
+    {
+        this->_row_blocks = row_blocks;
+        this->_lanes = lanes;
+
+        size_t _thr = decx::utils::clamp_min<size_t>(MNK / _SGEMM_MNK_PER_THREAD_, 1);
+        _thr = decx::utils::clamp_max<size_t>(_thr, thread_num);
+        if (MNK < _SGEMM_ST_MAX_MNK_) {
+            _thr = 1;
+        }
 
-    for (int i = 0; i < thread_num - 1; ++i) {
-        __async_stream[i] = decx::thread_pool.register_task(
-            _avx256_sort_ST_MatB,
-            srcB + i * (size_t)proc_dims.y,
-            dstB + i * B_frag,
-            proc_dims);
+        // the least blocks in one tile over all the grids
+        size_t _min_blocks = (size_t)row_blocks * (size_t)lanes;
+        for (size_t gr = 1; gr <= _thr && gr <= (size_t)row_blocks; ++gr) {
+            const size_t gc = decx::utils::clamp_max<size_t>(_thr / gr, lanes);
+            _min_blocks = decx::utils::clamp_max<size_t>(_min_blocks,
+                decx::utils::ceil<size_t>(row_blocks, gr) * decx::utils::ceil<size_t>(lanes, gc));
+        }
+
+        this->_grid = make_int2(1, 1);
+        size_t _best_edge = (size_t)-1, _best_tiles = (size_t)-1;
+        for (size_t gr = 1; gr <= _thr && gr <= (size_t)row_blocks; ++gr) {
+            const size_t gc = decx::utils::clamp_max<size_t>(_thr / gr, lanes);
+            const size_t _tile_r = decx::utils::ceil<size_t>(row_blocks, gr),
+                _tile_c = decx::utils::ceil<size_t>(lanes, gc);
+
+            if (_tile_r * _tile_c * _SGEMM_GRID_SLACK_DENO_ > _min_blocks * (_SGEMM_GRID_SLACK_DENO_ + 1)) {
+                continue;
+            }
+            const size_t _edge = _tile_r * unit_size.x + _tile_c * unit_size.y;
+            if (_edge < _best_edge || (_edge == _best_edge && gr * gc < _best_tiles)) {
+                this->_grid = make_int2((int)gr, (int)gc);
+                _best_edge = _edge;
+                _best_tiles = gr * gc;
+            }
+        }
     }
-    __async_stream[thread_num - 1] = decx::thread_pool.register_task(
-        _avx256_sort_ST_MatB_w8,
-        srcB + (thread_num - 1) * (size_t)proc_dims.y,
-        dstB + (thread_num - 1) * B_frag,
-        proc_dim_last);
-
-    for (int i = 0; i < thread_num; ++i) {
-        __async_stream[i].get();
+
+
+    bool is_single_thread() const {
+        return this->_grid.x * this->_grid.y == 1;
     }
-}
 
-// ----------------------------- end sort ---------------------------------------
+    // the range of the row blocks of the i-th row of the tiles, [.x, .y)
+    int2 rows_of(const int i) const {
+        return make_int2((int)(((size_t)i * this->_row_blocks) / this->_grid.x),
+            (int)(((size_t)(i + 1) * this->_row_blocks) / this->_grid.x));
+    }
+
+    // the range of the lanes of the i-th col of the tiles, [.x, .y)
+    int2 lanes_of(const int i) const {
+        return make_int2((int)(((size_t)i * this->_lanes) / this->_grid.y),
+            (int)(((size_t)(i + 1) * this->_lanes) / this->_grid.y));
+    }
+};
+
+// ----------------------------- end thread grid --------------------------------
 
 
 #endif
\ No newline at end of file
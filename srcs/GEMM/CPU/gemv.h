@@ -0,0 +1,254 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+
+#ifndef _GEMV_H_
+#define _GEMV_H_
+
+#include "gemv_kernels.h"
+#include "gemm_fill_info.h"
+#include "../../classes/Matrix.h"
+#include "../../classes/Vector.h"
+#include "../../core/thread_management/parallel_for.h"
+
+
+// the least elements of A one thread takes, below it the call runs on the calling thread only
+#define _GEMV_MIN_ELEMS_PER_THREAD_ (1 << 15)
+
+
+namespace de
+{
+    namespace cpu
+    {
+        /**
+        * @brief y = alpha * op(A) * x, op() transposes A if trans_flag has de::cpu::GEMM_TransA (the other flags
+        * are ignored). A is read once, row by row, in both the forms. y must not be x.
+        */
+        _DECX_API_ de::DH GEMV(de::Matrix<float>& A, de::Vector<float>& x, de::Vector<float>& y,
+            const float alpha = 1.f, const int trans_flag = de::cpu::GEMM_NoTrans);
+
+
+        _DECX_API_ de::DH GEMV(de::Matrix<double>& A, de::Vector<double>& x, de::Vector<double>& y,
+            const double alpha = 1.0, const int trans_flag = de::cpu::GEMM_NoTrans);
+
+
+        /**
+        * @brief y = alpha * op(A) * x + beta * z, pass z as y to accumulate in place. y must not be x
+        * (DECX_FAIL_OperandAliasing).
+        */
+        _DECX_API_ de::DH GEMV(de::Matrix<float>& A, de::Vector<float>& x, de::Vector<float>& z, de::Vector<float>& y,
+            const float alpha = 1.f, const float beta = 1.f, const int trans_flag = de::cpu::GEMM_NoTrans);
+
+
+        _DECX_API_ de::DH GEMV(de::Matrix<double>& A, de::Vector<double>& x, de::Vector<double>& z, de::Vector<double>& y,
+            const double alpha = 1.0, const double beta = 1.0, const int trans_flag = de::cpu::GEMM_NoTrans);
+
+
+        /**
+        * @brief The rank-1 update A += alpha * x * y^T, A is (length of x) x (length of y)
+        */
+        _DECX_API_ de::DH GER(de::Vector<float>& x, de::Vector<float>& y, de::Matrix<float>& A, const float alpha = 1.f);
+
+
+        _DECX_API_ de::DH GER(de::Vector<double>& x, de::Vector<double>& y, de::Matrix<double>& A, const double alpha = 1.0);
+    }
+}
+
+
+
+namespace decx
+{
+    /**
+    * @brief Run the GEMV of info on the thread pool : the N form is cut by rows, the T form by cols, each thread
+    * takes at least _GEMV_MIN_ELEMS_PER_THREAD_ elements of A
+    */
+    template <typename T>
+    static void gemv(const decx::_gemv_info<T>* info, const bool trans, const decx::_gemv_kernel_table<T>* kernels);
+
+
+    // cut by rows, as the N form of decx::gemv()
+    template <typename T>
+    static void ger(const decx::_ger_info<T>* info, const decx::_gemv_kernel_table<T>* kernels);
+
+
+    /**
+    * @brief Check the shapes and that y is not x, shape y unless it is z, and run decx::gemv(), shared by
+    * de::cpu::GEMV() of float and double
+    * @param z : NULL for none
+    */
+    template <typename T>
+    static void _GEMV_caller(decx::_Matrix<T>* A, decx::_Vector<T>* x, decx::_Vector<T>* z, decx::_Vector<T>* y,
+        const T alpha, const T beta, const int trans_flag, const decx::_gemv_kernel_table<T>* kernels, de::DH* handle);
+
+
+    template <typename T>
+    static void _GER_caller(decx::_Vector<T>* x, decx::_Vector<T>* y, decx::_Matrix<T>* A, const T alpha,
+        const decx::_gemv_kernel_table<T>* kernels, de::DH* handle);
+}
+
+
+
+template <typename T>
+static void decx::gemv(const decx::_gemv_info<T>* info, const bool trans, const decx::_gemv_kernel_table<T>* kernels)
+{
+    if (trans) {
+        // the chunks start at the multiples of 32 cols, the vectors of the kernel do not straddle them
+        const size_t _grain = decx::utils::ceil<size_t>(decx::utils::clamp_min<size_t>(
+            _GEMV_MIN_ELEMS_PER_THREAD_ / decx::utils::clamp_min<size_t>(info->M, 1), 32), 32) * 32;
+        decx::parallel_for(0, info->N, [&](const size_t _beg, const size_t _end) {
+            kernels->gemv_T(info, (int)_beg, (int)_end);
+        }, _grain);
+    }
+    else {
+        const size_t _grain = decx::utils::ceil<size_t>(decx::utils::clamp_min<size_t>(
+            _GEMV_MIN_ELEMS_PER_THREAD_ / decx::utils::clamp_min<size_t>(info->N, 1), 4), 4) * 4;
+        decx::parallel_for(0, info->M, [&](const size_t _beg, const size_t _end) {
+            kernels->gemv_N(info, (int)_beg, (int)_end);
+        }, _grain);
+    }
+}
+
+
+
+template <typename T>
+static void decx::ger(const decx::_ger_info<T>* info, const decx::_gemv_kernel_table<T>* kernels)
+{
+    const size_t _grain = decx::utils::clamp_min<size_t>(
+        _GEMV_MIN_ELEMS_PER_THREAD_ / decx::utils::clamp_min<size_t>(info->N, 1), 1);
+    decx::parallel_for(0, info->M, [&](const size_t _beg, const size_t _end) {
+        kernels->ger(info, (int)_beg, (int)_end);
+    }, _grain);
+}
+
+
+
+template <typename T>
+static void decx::_GEMV_caller(decx::_Matrix<T>* A, decx::_Vector<T>* x, decx::_Vector<T>* z, decx::_Vector<T>* y,
+    const T alpha, const T beta, const int trans_flag, const decx::_gemv_kernel_table<T>* kernels, de::DH* handle)
+{
+    const bool trans = (trans_flag & de::cpu::GEMM_TransA) != 0;
+    const size_t _len_x = trans ? A->height : A->width;
+    const size_t _len_y = trans ? A->width : A->height;
+
+    if (x->length != _len_x || (z != NULL && z->length != _len_y)) {
+        decx::MDim_Not_Matching(handle);
+        return;
+    }
+    // y is written while x is still read (and re_construct() would free x), only z may be y
+    if (y == x) {
+        decx::err::OperandAliasing(handle);
+        Print_Error_Message(4, OPERAND_ALIASING);
+        return;
+    }
+    if (y != z) {
+        y->re_construct(_len_y, decx::DATA_STORE_TYPE::Page_Default);
+    }
+
+    decx::_gemv_info<T> info;
+    info.A = A->Mat.ptr;            info.lda = A->pitch;
+    info.M = A->height;             info.N = A->width;
+    info.x = x->Vec.ptr;            info.y = y->Vec.ptr;
+    info.alpha = alpha;
+    info.beta = beta;
+    // beta = 0 drops z, z is not read at all then
+    info.z = (z != NULL && beta != 0) ? z->Vec.ptr : NULL;
+
+    decx::gemv(&info, trans, kernels);
+    decx::Success(handle);
+}
+
+
+
+template <typename T>
+static void decx::_GER_caller(decx::_Vector<T>* x, decx::_Vector<T>* y, decx::_Matrix<T>* A, const T alpha,
+    const decx::_gemv_kernel_table<T>* kernels, de::DH* handle)
+{
+    if (x->length != A->height || y->length != A->width) {
+        decx::MDim_Not_Matching(handle);
+        return;
+    }
+
+    decx::_ger_info<T> info;
+    info.A = A->Mat.ptr;            info.lda = A->pitch;
+    info.M = A->height;             info.N = A->width;
+    info.x = x->Vec.ptr;            info.y = y->Vec.ptr;
+    info.alpha = alpha;
+
+    decx::ger(&info, kernels);
+    decx::Success(handle);
+}
+
+
+
+de::DH de::cpu::GEMV(de::Matrix<float>& A, de::Vector<float>& x, de::Vector<float>& y,
+    const float alpha, const int trans_flag)
+{
+    de::DH handle;
+    decx::_GEMV_caller<float>(dynamic_cast<decx::_Matrix<float>*>(&A), dynamic_cast<decx::_Vector<float>*>(&x),
+        NULL, dynamic_cast<decx::_Vector<float>*>(&y), alpha, 0.f, trans_flag, &decx::_sgemv_kernels, &handle);
+    return handle;
+}
+
+
+
+de::DH de::cpu::GEMV(de::Matrix<double>& A, de::Vector<double>& x, de::Vector<double>& y,
+    const double alpha, const int trans_flag)
+{
+    de::DH handle;
+    decx::_GEMV_caller<double>(dynamic_cast<decx::_Matrix<double>*>(&A), dynamic_cast<decx::_Vector<double>*>(&x),
+        NULL, dynamic_cast<decx::_Vector<double>*>(&y), alpha, 0.0, trans_flag, &decx::_dgemv_kernels, &handle);
+    return handle;
+}
+
+
+
+de::DH de::cpu::GEMV(de::Matrix<float>& A, de::Vector<float>& x, de::Vector<float>& z, de::Vector<float>& y,
+    const float alpha, const float beta, const int trans_flag)
+{
+    de::DH handle;
+    decx::_GEMV_caller<float>(dynamic_cast<decx::_Matrix<float>*>(&A), dynamic_cast<decx::_Vector<float>*>(&x),
+        dynamic_cast<decx::_Vector<float>*>(&z), dynamic_cast<decx::_Vector<float>*>(&y), alpha, beta, trans_flag,
+        &decx::_sgemv_kernels, &handle);
+    return handle;
+}
+
+
+
+de::DH de::cpu::GEMV(de::Matrix<double>& A, de::Vector<double>& x, de::Vector<double>& z, de::Vector<double>& y,
+    const double alpha, const double beta, const int trans_flag)
+{
+    de::DH handle;
+    decx::_GEMV_caller<double>(dynamic_cast<decx::_Matrix<double>*>(&A), dynamic_cast<decx::_Vector<double>*>(&x),
+        dynamic_cast<decx::_Vector<double>*>(&z), dynamic_cast<decx::_Vector<double>*>(&y), alpha, beta, trans_flag,
+        &decx::_dgemv_kernels, &handle);
+    return handle;
+}
+
+
+
+de::DH de::cpu::GER(de::Vector<float>& x, de::Vector<float>& y, de::Matrix<float>& A, const float alpha)
+{
+    de::DH handle;
+    decx::_GER_caller<float>(dynamic_cast<decx::_Vector<float>*>(&x), dynamic_cast<decx::_Vector<float>*>(&y),
+        dynamic_cast<decx::_Matrix<float>*>(&A), alpha, &decx::_sgemv_kernels, &handle);
+    return handle;
+}
+
+
+
+de::DH de::cpu::GER(de::Vector<double>& x, de::Vector<double>& y, de::Matrix<double>& A, const double alpha)
+{
+    de::DH handle;
+    decx::_GER_caller<double>(dynamic_cast<decx::_Vector<double>*>(&x), dynamic_cast<decx::_Vector<double>*>(&y),
+        dynamic_cast<decx::_Matrix<double>*>(&A), alpha, &decx::_dgemv_kernels, &handle);
+    return handle;
+}
+
+
+#endif
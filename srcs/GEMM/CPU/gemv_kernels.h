@@ -0,0 +1,346 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+
+#ifndef _GEMV_KERNELS_H_
+#define _GEMV_KERNELS_H_
+
+#include "../../core/basic.h"
+#include "../../core/configs/cpu_isa.h"
+
+
+/**
+* The kernels of GEMV and GER, for float and double. They are bound by the memory, so each reads every element
+* of A once, in the order it is stored :
+*   GEMV N (y = A * x)   : 4 rows at a time, one accumulator each, x is read once per 4 rows (it stays in L1)
+*   GEMV T (y = A^T * x) : 4 rows at a time are added onto a block of _GEMV_T_BLOCK_ sums (it stays in L1),
+*                          so A is read in 4 sequential streams and not down the cols
+*   GER (A += x * y^T)   : row by row, y stays in L1
+* The kernels compute the rows (or the cols for T) in [beg, end), the callers cut the range among the threads.
+* The vector operations are written once for both the types, by the overloads of decx::sse42::_gemv_vec<T>
+* and decx::avx2::_gemv_vec<T>. AVX-512 uses the AVX2 kernels, the loads are the bound.
+*/
+
+
+// the cols of A the T form sums at a time, in elements
+#define _GEMV_T_BLOCK_ 1024
+
+
+namespace decx
+{
+    template <typename T>
+    struct _gemv_info
+    {
+        const T* A;
+        size_t lda;
+        int M, N;                   // A is M x N as stored
+        const T* x;
+        T* y;
+        // y = alpha * op(A) * x + beta * z, z can be y, NULL for none
+        const T* z;
+        T alpha, beta;
+    };
+
+
+    template <typename T>
+    struct _ger_info
+    {
+        T* A;
+        size_t lda;
+        int M, N;
+        const T* x, * y;            // x of M, y of N
+        T alpha;
+    };
+
+
+    template <typename T>
+    struct _gemv_kernel_table
+    {
+        void(*gemv_N)(const decx::_gemv_info<T>*, const int row_beg, const int row_end);
+        void(*gemv_T)(const decx::_gemv_info<T>*, const int col_beg, const int col_end);
+        void(*ger)(const decx::_ger_info<T>*, const int row_beg, const int row_end);
+    };
+
+
+    // the kernels of the de::CPU_ISA in use
+    decx::_gemv_kernel_table<float> _sgemv_kernels;
+    decx::_gemv_kernel_table<double> _dgemv_kernels;
+}
+
+
+
+// ------------------------------------------ SSE4.2 ------------------------------------------------
+
+
+_DECX_ISA_BEGIN_SSE42_
+namespace decx
+{
+    namespace sse42
+    {
+        template <typename T> struct _gemv_vec;
+
+
+        template <> struct _gemv_vec<float>
+        {
+            typedef __m128 V;
+            static const int W = 4;
+            static inline V zero() { return _mm_setzero_ps(); }
+            static inline V set1(const float a) { return _mm_set1_ps(a); }
+            static inline V load(const float* p) { return _mm_loadu_ps(p); }
+            static inline void store(float* p, const V v) { _mm_storeu_ps(p, v); }
+            static inline V fma(const V a, const V b, const V c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+            static inline float hsum(const V v)
+            {
+                const __m128 _s = _mm_add_ps(v, _mm_movehl_ps(v, v));
+                return _mm_cvtss_f32(_mm_add_ss(_s, _mm_shuffle_ps(_s, _s, 1)));
+            }
+        };
+
+
+        template <> struct _gemv_vec<double>
+        {
+            typedef __m128d V;
+            static const int W = 2;
+            static inline V zero() { return _mm_setzero_pd(); }
+            static inline V set1(const double a) { return _mm_set1_pd(a); }
+            static inline V load(const double* p) { return _mm_loadu_pd(p); }
+            static inline void store(double* p, const V v) { _mm_storeu_pd(p, v); }
+            static inline V fma(const V a, const V b, const V c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+            static inline double hsum(const V v) { return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v))); }
+        };
+    }
+}
+_DECX_ISA_END_
+
+
+
+// ------------------------------------------- AVX2 -------------------------------------------------
+
+
+_DECX_ISA_BEGIN_AVX2_
+namespace decx
+{
+    namespace avx2
+    {
+        template <typename T> struct _gemv_vec;
+
+
+        template <> struct _gemv_vec<float>
+        {
+            typedef __m256 V;
+            static const int W = 8;
+            static inline V zero() { return _mm256_setzero_ps(); }
+            static inline V set1(const float a) { return _mm256_set1_ps(a); }
+            static inline V load(const float* p) { return _mm256_loadu_ps(p); }
+            static inline void store(float* p, const V v) { _mm256_storeu_ps(p, v); }
+            static inline V fma(const V a, const V b, const V c) { return _mm256_fmadd_ps(a, b, c); }
+            static inline float hsum(const V v)
+            {
+                __m128 _s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+                _s = _mm_add_ps(_s, _mm_movehl_ps(_s, _s));
+                return _mm_cvtss_f32(_mm_add_ss(_s, _mm_shuffle_ps(_s, _s, 1)));
+            }
+        };
+
+
+        template <> struct _gemv_vec<double>
+        {
+            typedef __m256d V;
+            static const int W = 4;
+            static inline V zero() { return _mm256_setzero_pd(); }
+            static inline V set1(const double a) { return _mm256_set1_pd(a); }
+            static inline V load(const double* p) { return _mm256_loadu_pd(p); }
+            static inline void store(double* p, const V v) { _mm256_storeu_pd(p, v); }
+            static inline V fma(const V a, const V b, const V c) { return _mm256_fmadd_pd(a, b, c); }
+            static inline double hsum(const V v)
+            {
+                const __m128d _s = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+                return _mm_cvtsd_f64(_mm_add_sd(_s, _mm_unpackhi_pd(_s, _s)));
+            }
+        };
+    }
+}
+_DECX_ISA_END_
+
+
+
+/**
+* The kernels, written once on _gemv_vec. Defined for each ISA by including them in the namespace of the ISA
+* with the target of the ISA on.
+*/
+#define _DECX_GEMV_KERNELS_                                                                                 \
+template <typename T>                                                                                       \
+static void _gemv_N(const decx::_gemv_info<T>* info, const int row_beg, const int row_end)                  \
+{                                                                                                           \
+    typedef _gemv_vec<T> _vec;                                                                              \
+    const int N = info->N, _Nv = N - N % _vec::W;                                                           \
+    const T* x = info->x;                                                                                   \
+                                                                                                            \
+    int i = row_beg;                                                                                        \
+    for (; i + 4 <= row_end; i += 4) {                                                                      \
+        const T* A0 = info->A + (size_t)i * info->lda;                                                      \
+        const T* A1 = A0 + info->lda, * A2 = A1 + info->lda, * A3 = A2 + info->lda;                         \
+        typename _vec::V s0 = _vec::zero(), s1 = _vec::zero(), s2 = _vec::zero(), s3 = _vec::zero();        \
+        for (int j = 0; j < _Nv; j += _vec::W) {                                                            \
+            const typename _vec::V _x = _vec::load(x + j);                                                  \
+            s0 = _vec::fma(_vec::load(A0 + j), _x, s0);                                                     \
+            s1 = _vec::fma(_vec::load(A1 + j), _x, s1);                                                     \
+            s2 = _vec::fma(_vec::load(A2 + j), _x, s2);                                                     \
+            s3 = _vec::fma(_vec::load(A3 + j), _x, s3);                                                     \
+        }                                                                                                   \
+        T _r[4] = { _vec::hsum(s0), _vec::hsum(s1), _vec::hsum(s2), _vec::hsum(s3) };                       \
+        for (int j = _Nv; j < N; ++j) {                                                                     \
+            _r[0] += A0[j] * x[j];      _r[1] += A1[j] * x[j];                                              \
+            _r[2] += A2[j] * x[j];      _r[3] += A3[j] * x[j];                                              \
+        }                                                                                                   \
+        for (int r = 0; r < 4; ++r) {                                                                       \
+            info->y[i + r] = info->z != NULL ? info->alpha * _r[r] + info->beta * info->z[i + r] :          \
+                info->alpha * _r[r];                                                                        \
+        }                                                                                                   \
+    }                                                                                                       \
+    for (; i < row_end; ++i) {                                                                              \
+        const T* A0 = info->A + (size_t)i * info->lda;                                                      \
+        typename _vec::V s0 = _vec::zero();                                                                 \
+        for (int j = 0; j < _Nv; j += _vec::W) {                                                            \
+            s0 = _vec::fma(_vec::load(A0 + j), _vec::load(x + j), s0);                                      \
+        }                                                                                                   \
+        T _r = _vec::hsum(s0);                                                                              \
+        for (int j = _Nv; j < N; ++j) { _r += A0[j] * x[j]; }                                               \
+        info->y[i] = info->z != NULL ? info->alpha * _r + info->beta * info->z[i] : info->alpha * _r;       \
+    }                                                                                                       \
+}                                                                                                           \
+                                                                                                            \
+                                                                                                            \
+template <typename T>                                                                                       \
+static void _gemv_T(const decx::_gemv_info<T>* info, const int col_beg, const int col_end)                  \
+{                                                                                                           \
+    typedef _gemv_vec<T> _vec;                                                                              \
+    T _acc[_GEMV_T_BLOCK_];                                                                                 \
+    const typename _vec::V _alpha = _vec::set1(info->alpha), _beta = _vec::set1(info->beta);                \
+                                                                                                            \
+    for (int jc = col_beg; jc < col_end; jc += _GEMV_T_BLOCK_) {                                            \
+        const int nc = decx::utils::clamp_max<int>(col_end - jc, _GEMV_T_BLOCK_), _ncv = nc - nc % _vec::W; \
+        for (int j = 0; j < nc; ++j) { _acc[j] = 0; }                                                       \
+                                                                                                            \
+        int i = 0;                                                                                          \
+        for (; i + 4 <= info->M; i += 4) {                                                                  \
+            const T* A0 = info->A + (size_t)i * info->lda + jc;                                             \
+            const T* A1 = A0 + info->lda, * A2 = A1 + info->lda, * A3 = A2 + info->lda;                     \
+            const T* x = info->x + i;                                                                       \
+            const typename _vec::V x0 = _vec::set1(x[0]), x1 = _vec::set1(x[1]), x2 = _vec::set1(x[2]),     \
+                x3 = _vec::set1(x[3]);                                                                      \
+            for (int j = 0; j < _ncv; j += _vec::W) {                                                       \
+                typename _vec::V s = _vec::load(_acc + j);                                                  \
+                s = _vec::fma(_vec::load(A0 + j), x0, s);                                                   \
+                s = _vec::fma(_vec::load(A1 + j), x1, s);                                                   \
+                s = _vec::fma(_vec::load(A2 + j), x2, s);                                                   \
+                s = _vec::fma(_vec::load(A3 + j), x3, s);                                                   \
+                _vec::store(_acc + j, s);                                                                   \
+            }                                                                                               \
+            for (int j = _ncv; j < nc; ++j) {                                                               \
+                _acc[j] += A0[j] * x[0] + A1[j] * x[1] + A2[j] * x[2] + A3[j] * x[3];                       \
+            }                                                                                               \
+        }                                                                                                   \
+        for (; i < info->M; ++i) {                                                                          \
+            const T* A0 = info->A + (size_t)i * info->lda + jc;                                             \
+            const typename _vec::V x0 = _vec::set1(info->x[i]);                                             \
+            for (int j = 0; j < _ncv; j += _vec::W) {                                                       \
+                _vec::store(_acc + j, _vec::fma(_vec::load(A0 + j), x0, _vec::load(_acc + j)));             \
+            }                                                                                               \
+            for (int j = _ncv; j < nc; ++j) { _acc[j] += A0[j] * info->x[i]; }                              \
+        }                                                                                                   \
+                                                                                                            \
+        T* y = info->y + jc;                                                                                \
+        const T* z = info->z != NULL ? info->z + jc : NULL;                                                 \
+        for (int j = 0; j < _ncv; j += _vec::W) {                                                           \
+            typename _vec::V _r = _vec::fma(_vec::load(_acc + j), _alpha, _vec::zero());                    \
+            if (z != NULL) { _r = _vec::fma(_vec::load(z + j), _beta, _r); }                                \
+            _vec::store(y + j, _r);                                                                         \
+        }                                                                                                   \
+        for (int j = _ncv; j < nc; ++j) {                                                                   \
+            y[j] = z != NULL ? info->alpha * _acc[j] + info->beta * z[j] : info->alpha * _acc[j];           \
+        }                                                                                                   \
+    }                                                                                                       \
+}                                                                                                           \
+                                                                                                            \
+                                                                                                            \
+template <typename T>                                                                                       \
+static void _ger(const decx::_ger_info<T>* info, const int row_beg, const int row_end)                      \
+{                                                                                                           \
+    typedef _gemv_vec<T> _vec;                                                                              \
+    const int N = info->N, _Nv = N - N % _vec::W;                                                           \
+                                                                                                            \
+    for (int i = row_beg; i < row_end; ++i) {                                                               \
+        T* _A = info->A + (size_t)i * info->lda;                                                            \
+        const T _ax = info->alpha * info->x[i];                                                             \
+        const typename _vec::V _axv = _vec::set1(_ax);                                                      \
+        for (int j = 0; j < _Nv; j += _vec::W) {                                                            \
+            _vec::store(_A + j, _vec::fma(_vec::load(info->y + j), _axv, _vec::load(_A + j)));              \
+        }                                                                                                   \
+        for (int j = _Nv; j < N; ++j) { _A[j] += _ax * info->y[j]; }                                        \
+    }                                                                                                       \
+}                                                                                                           \
+
+
+
+_DECX_ISA_BEGIN_SSE42_
+namespace decx
+{
+    namespace sse42
+    {
+        _DECX_GEMV_KERNELS_
+    }
+}
+_DECX_ISA_END_
+
+
+_DECX_ISA_BEGIN_AVX2_
+namespace decx
+{
+    namespace avx2
+    {
+        _DECX_GEMV_KERNELS_
+    }
+}
+_DECX_ISA_END_
+
+
+
+namespace decx
+{
+    static void _select_gemv_kernels(const int isa)
+    {
+        switch (isa)
+        {
+        case de::CPU_ISA::ISA_AVX512:
+        case de::CPU_ISA::ISA_AVX2:
+            decx::_sgemv_kernels.gemv_N = &decx::avx2::_gemv_N<float>;
+            decx::_sgemv_kernels.gemv_T = &decx::avx2::_gemv_T<float>;
+            decx::_sgemv_kernels.ger = &decx::avx2::_ger<float>;
+            decx::_dgemv_kernels.gemv_N = &decx::avx2::_gemv_N<double>;
+            decx::_dgemv_kernels.gemv_T = &decx::avx2::_gemv_T<double>;
+            decx::_dgemv_kernels.ger = &decx::avx2::_ger<double>;
+            break;
+        default:
+            decx::_sgemv_kernels.gemv_N = &decx::sse42::_gemv_N<float>;
+            decx::_sgemv_kernels.gemv_T = &decx::sse42::_gemv_T<float>;
+            decx::_sgemv_kernels.ger = &decx::sse42::_ger<float>;
+            decx::_dgemv_kernels.gemv_N = &decx::sse42::_gemv_N<double>;
+            decx::_dgemv_kernels.gemv_T = &decx::sse42::_gemv_T<double>;
+            decx::_dgemv_kernels.ger = &decx::sse42::_ger<double>;
+            break;
+        }
+    }
+
+
+    static decx::_ISA_dispatch_reg _gemv_kernels_reg(&decx::_select_gemv_kernels);
+}
+
+
+#endif
@@ -0,0 +1,104 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+
+#ifndef _IGEMM_H_
+#define _IGEMM_H_
+
+#include "gemm_blocked.h"
+#include "igemm_micro_kernel.h"
+#include "gemm_fill_info.h"
+#include "../../classes/Matrix.h"
+
+
+namespace de
+{
+    namespace cpu
+    {
+        /**
+        * @brief dst = alpha * op(A) * op(B), A and B of int8 (signed char), dst of int32, for the quantized models.
+        * The products are exact (no intermediate saturation), the int32 sums wrap around on overflow
+        * (K up to 2^31 / 128^2 = 131072 is always safe). op() as de::cpu::GEMM() of float.
+        */
+        _DECX_API_ de::DH GEMM(de::Matrix<signed char>& A, de::Matrix<signed char>& B, de::Matrix<int>& dst,
+            const int alpha = 1, const int trans_flag = de::cpu::GEMM_NoTrans);
+
+
+        /**
+        * @brief dst = alpha * op(A) * op(B) + beta * C, A and B of int8 (signed char), C and dst of int32,
+        * see de::cpu::GEMM() of float for C and dst
+        */
+        _DECX_API_ de::DH GEMM(de::Matrix<signed char>& A, de::Matrix<signed char>& B, de::Matrix<int>& C, de::Matrix<int>& dst,
+            const int alpha = 1, const int beta = 1, const int trans_flag = de::cpu::GEMM_NoTrans);
+    }
+}
+
+
+namespace decx
+{
+    // takes the micro-kernel of the de::CPU_ISA in use, A and B are packed to int16, in pairs of k
+    struct _igemm_blocked_info : public decx::_gemm_blocked_info<signed char, short, int, 2>
+    {
+        _igemm_blocked_info() : decx::_gemm_blocked_info<signed char, short, int, 2>(decx::_igemm_ukernels) {}
+    };
+}
+
+
+
+de::DH de::cpu::GEMM(de::Matrix<signed char>& A, de::Matrix<signed char>& B, de::Matrix<int>& dst,
+    const int alpha, const int trans_flag)
+{
+    decx::_Matrix<signed char>* _A = dynamic_cast<decx::_Matrix<signed char>*>(&A);
+    decx::_Matrix<signed char>* _B = dynamic_cast<decx::_Matrix<signed char>*>(&B);
+    decx::_Matrix<int>* _dst = dynamic_cast<decx::_Matrix<int>*>(&dst);
+
+    de::DH handle;
+    decx::_igemm_blocked_info info;
+    if (!decx::_GEMM_fill_info(&info, _A, _B, (decx::_Matrix<int>*)NULL, _dst, alpha, 0, trans_flag, &handle)) {
+        return handle;
+    }
+
+    if (!decx::gemm_blocked(&info, (short*)NULL)) {
+        decx::err::AllocateFailure(&handle);
+        Print_Error_Message(4, ALLOC_FAIL);
+        return handle;
+    }
+
+    decx::Success(&handle);
+    return handle;
+}
+
+
+
+de::DH de::cpu::GEMM(de::Matrix<signed char>& A, de::Matrix<signed char>& B, de::Matrix<int>& C, de::Matrix<int>& dst,
+    const int alpha, const int beta, const int trans_flag)
+{
+    decx::_Matrix<signed char>* _A = dynamic_cast<decx::_Matrix<signed char>*>(&A);
+    decx::_Matrix<signed char>* _B = dynamic_cast<decx::_Matrix<signed char>*>(&B);
+    decx::_Matrix<int>* _C = dynamic_cast<decx::_Matrix<int>*>(&C);
+    decx::_Matrix<int>* _dst = dynamic_cast<decx::_Matrix<int>*>(&dst);
+
+    de::DH handle;
+    decx::_igemm_blocked_info info;
+    if (!decx::_GEMM_fill_info(&info, _A, _B, _C, _dst, alpha, beta, trans_flag, &handle)) {
+        return handle;
+    }
+
+    if (!decx::gemm_blocked(&info, (short*)NULL)) {
+        decx::err::AllocateFailure(&handle);
+        Print_Error_Message(4, ALLOC_FAIL);
+        return handle;
+    }
+
+    decx::Success(&handle);
+    return handle;
+}
+
+
+#endif
@@ -0,0 +1,307 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+
+#ifndef _IGEMM_MICRO_KERNEL_H_
+#define _IGEMM_MICRO_KERNEL_H_
+
+#include "gemm_ukernel.h"
+
+
+/**
+* The micro-kernels of the int8 x int8 -> int32 GEMM (the interface is in gemm_ukernel.h). The int8
+* operands are packed to int16, in pairs of consecutive k, so that one pmaddwd multiplies two k of a
+* row of A (broadcast as one int32) by two k of the NR cols of B and adds the pairs into int32. The
+* products of int16 never saturate, unlike those of pmaddubsw (uint8 x int8, summed into int16),
+* so all of [-128, 127] is exact.
+*   SSE4.2              : 6 x 8,  pmaddwd + paddd
+*   AVX2                : 6 x 16, vpmaddwd + vpaddd
+*   AVX-512 with VNNI   : 12 x 32, vpdpwssd (the multiply-add in one instruction)
+* The AVX-512 hosts without VNNI use the AVX2 kernel.
+*/
+
+
+namespace decx
+{
+    typedef decx::_gemm_ukernel<short, int> _igemm_ukernel;
+
+
+    // the micro-kernel of the de::CPU_ISA in use
+    decx::_igemm_ukernel _igemm_ukernels;
+}
+
+
+
+// ------------------------------------------ SSE4.2 ------------------------------------------------
+
+
+#define _IGEMM_MK_ROW_SSE_(r) {                                                 \
+    _a = _mm_set1_epi32(((const int*)pA)[r]);                                   \
+    c##r##0 = _mm_add_epi32(c##r##0, _mm_madd_epi16(_a, _b0));                  \
+    c##r##1 = _mm_add_epi32(c##r##1, _mm_madd_epi16(_a, _b1));                  \
+}
+
+
+#define _IGEMM_MK_STORE_ROW_SSE_(r) {                                                               \
+    c##r##0 = _mm_mullo_epi32(c##r##0, _alpha);                                                     \
+    c##r##1 = _mm_mullo_epi32(c##r##1, _alpha);                                                     \
+    if (S != NULL) {                                                                                \
+        c##r##0 = _mm_add_epi32(c##r##0, _mm_mullo_epi32(_beta, _mm_loadu_si128((const __m128i*)(S + r * lds))));       \
+        c##r##1 = _mm_add_epi32(c##r##1, _mm_mullo_epi32(_beta, _mm_loadu_si128((const __m128i*)(S + r * lds + 4))));   \
+    }                                                                                               \
+    _mm_storeu_si128((__m128i*)(C + r * ldc), c##r##0);                                             \
+    _mm_storeu_si128((__m128i*)(C + r * ldc + 4), c##r##1);                                         \
+}
+
+
+_DECX_ISA_BEGIN_SSE42_
+namespace decx
+{
+    namespace sse42
+    {
+        static void _igemm_kernel_6x8(const int kc, const short* pA, const short* pB, int* C,
+            const size_t ldc, const int* S, const size_t lds, const int alpha, const int beta)
+        {
+            __m128i c00 = _mm_setzero_si128(), c01 = _mm_setzero_si128(),
+                c10 = _mm_setzero_si128(), c11 = _mm_setzero_si128(),
+                c20 = _mm_setzero_si128(), c21 = _mm_setzero_si128(),
+                c30 = _mm_setzero_si128(), c31 = _mm_setzero_si128(),
+                c40 = _mm_setzero_si128(), c41 = _mm_setzero_si128(),
+                c50 = _mm_setzero_si128(), c51 = _mm_setzero_si128();
+            __m128i _a, _b0, _b1;
+
+            // kc counts the pairs of k
+            for (int k = 0; k < kc; ++k) {
+                _mm_prefetch((const char*)(pA + 16 * 6), _MM_HINT_T0);
+
+                _b0 = _mm_load_si128((const __m128i*)pB);
+                _b1 = _mm_load_si128((const __m128i*)(pB + 8));
+
+                _IGEMM_MK_ROW_SSE_(0);
+                _IGEMM_MK_ROW_SSE_(1);
+                _IGEMM_MK_ROW_SSE_(2);
+                _IGEMM_MK_ROW_SSE_(3);
+                _IGEMM_MK_ROW_SSE_(4);
+                _IGEMM_MK_ROW_SSE_(5);
+
+                pA += 12;
+                pB += 16;
+            }
+
+            const __m128i _alpha = _mm_set1_epi32(alpha), _beta = _mm_set1_epi32(beta);
+            _IGEMM_MK_STORE_ROW_SSE_(0);
+            _IGEMM_MK_STORE_ROW_SSE_(1);
+            _IGEMM_MK_STORE_ROW_SSE_(2);
+            _IGEMM_MK_STORE_ROW_SSE_(3);
+            _IGEMM_MK_STORE_ROW_SSE_(4);
+            _IGEMM_MK_STORE_ROW_SSE_(5);
+        }
+    }
+}
+_DECX_ISA_END_
+
+
+
+// ------------------------------------------- AVX2 -------------------------------------------------
+
+
+#define _IGEMM_MK_ROW_(r) {                                                     \
+    _a = _mm256_set1_epi32(((const int*)pA)[r]);                                \
+    c##r##0 = _mm256_add_epi32(c##r##0, _mm256_madd_epi16(_a, _b0));            \
+    c##r##1 = _mm256_add_epi32(c##r##1, _mm256_madd_epi16(_a, _b1));            \
+}
+
+
+#define _IGEMM_MK_STORE_ROW_(r) {                                                                   \
+    c##r##0 = _mm256_mullo_epi32(c##r##0, _alpha);                                                  \
+    c##r##1 = _mm256_mullo_epi32(c##r##1, _alpha);                                                  \
+    if (S != NULL) {                                                                                \
+        c##r##0 = _mm256_add_epi32(c##r##0, _mm256_mullo_epi32(_beta, _mm256_loadu_si256((const __m256i*)(S + r * lds))));     \
+        c##r##1 = _mm256_add_epi32(c##r##1, _mm256_mullo_epi32(_beta, _mm256_loadu_si256((const __m256i*)(S + r * lds + 8)))); \
+    }                                                                                               \
+    _mm256_storeu_si256((__m256i*)(C + r * ldc), c##r##0);                                          \
+    _mm256_storeu_si256((__m256i*)(C + r * ldc + 8), c##r##1);                                      \
+}
+
+
+_DECX_ISA_BEGIN_AVX2_
+namespace decx
+{
+    namespace avx2
+    {
+        static void _igemm_kernel_6x16(const int kc, const short* pA, const short* pB, int* C,
+            const size_t ldc, const int* S, const size_t lds, const int alpha, const int beta)
+        {
+            __m256i c00 = _mm256_setzero_si256(), c01 = _mm256_setzero_si256(),
+                c10 = _mm256_setzero_si256(), c11 = _mm256_setzero_si256(),
+                c20 = _mm256_setzero_si256(), c21 = _mm256_setzero_si256(),
+                c30 = _mm256_setzero_si256(), c31 = _mm256_setzero_si256(),
+                c40 = _mm256_setzero_si256(), c41 = _mm256_setzero_si256(),
+                c50 = _mm256_setzero_si256(), c51 = _mm256_setzero_si256();
+            __m256i _a, _b0, _b1;
+
+            for (int r = 0; r < 6; ++r) {
+                _mm_prefetch((const char*)(C + r * ldc), _MM_HINT_T0);
+                _mm_prefetch((const char*)(C + r * ldc + 15), _MM_HINT_T0);
+            }
+
+            // kc counts the pairs of k
+            for (int k = 0; k < kc; ++k) {
+                _mm_prefetch((const char*)(pA + 16 * 6), _MM_HINT_T0);
+
+                _b0 = _mm256_load_si256((const __m256i*)pB);
+                _b1 = _mm256_load_si256((const __m256i*)(pB + 16));
+
+                _IGEMM_MK_ROW_(0);
+                _IGEMM_MK_ROW_(1);
+                _IGEMM_MK_ROW_(2);
+                _IGEMM_MK_ROW_(3);
+                _IGEMM_MK_ROW_(4);
+                _IGEMM_MK_ROW_(5);
+
+                pA += 12;
+                pB += 32;
+            }
+
+            const __m256i _alpha = _mm256_set1_epi32(alpha), _beta = _mm256_set1_epi32(beta);
+            _IGEMM_MK_STORE_ROW_(0);
+            _IGEMM_MK_STORE_ROW_(1);
+            _IGEMM_MK_STORE_ROW_(2);
+            _IGEMM_MK_STORE_ROW_(3);
+            _IGEMM_MK_STORE_ROW_(4);
+            _IGEMM_MK_STORE_ROW_(5);
+        }
+    }
+}
+_DECX_ISA_END_
+
+
+
+// -------------------------------------- AVX-512 with VNNI -----------------------------------------
+
+
+#define _IGEMM_MK_ROW_VNNI_(r) {                                    \
+    _a = _mm512_set1_epi32(((const int*)pA)[r]);                    \
+    c##r##_0 = _mm512_dpwssd_epi32(c##r##_0, _a, _b0);              \
+    c##r##_1 = _mm512_dpwssd_epi32(c##r##_1, _a, _b1);              \
+}
+
+
+#define _IGEMM_MK_STORE_ROW_VNNI_(r) {                                                              \
+    c##r##_0 = _mm512_mullo_epi32(c##r##_0, _alpha);                                                \
+    c##r##_1 = _mm512_mullo_epi32(c##r##_1, _alpha);                                                \
+    if (S != NULL) {                                                                                \
+        c##r##_0 = _mm512_add_epi32(c##r##_0, _mm512_mullo_epi32(_beta, _mm512_loadu_si512(S + r * lds)));         \
+        c##r##_1 = _mm512_add_epi32(c##r##_1, _mm512_mullo_epi32(_beta, _mm512_loadu_si512(S + r * lds + 16)));    \
+    }                                                                                               \
+    _mm512_storeu_si512(C + r * ldc, c##r##_0);                                                     \
+    _mm512_storeu_si512(C + r * ldc + 16, c##r##_1);                                                \
+}
+
+
+_DECX_ISA_BEGIN_AVX512_VNNI_
+namespace decx
+{
+    namespace avx512
+    {
+        static void _igemm_kernel_12x32_vnni(const int kc, const short* pA, const short* pB, int* C,
+            const size_t ldc, const int* S, const size_t lds, const int alpha, const int beta)
+        {
+            __m512i c0_0 = _mm512_setzero_si512(), c0_1 = _mm512_setzero_si512(),
+                c1_0 = _mm512_setzero_si512(), c1_1 = _mm512_setzero_si512(),
+                c2_0 = _mm512_setzero_si512(), c2_1 = _mm512_setzero_si512(),
+                c3_0 = _mm512_setzero_si512(), c3_1 = _mm512_setzero_si512(),
+                c4_0 = _mm512_setzero_si512(), c4_1 = _mm512_setzero_si512(),
+                c5_0 = _mm512_setzero_si512(), c5_1 = _mm512_setzero_si512(),
+                c6_0 = _mm512_setzero_si512(), c6_1 = _mm512_setzero_si512(),
+                c7_0 = _mm512_setzero_si512(), c7_1 = _mm512_setzero_si512(),
+                c8_0 = _mm512_setzero_si512(), c8_1 = _mm512_setzero_si512(),
+                c9_0 = _mm512_setzero_si512(), c9_1 = _mm512_setzero_si512(),
+                c10_0 = _mm512_setzero_si512(), c10_1 = _mm512_setzero_si512(),
+                c11_0 = _mm512_setzero_si512(), c11_1 = _mm512_setzero_si512();
+            __m512i _a, _b0, _b1;
+
+            for (int r = 0; r < 12; ++r) {
+                _mm_prefetch((const char*)(C + r * ldc), _MM_HINT_T0);
+                _mm_prefetch((const char*)(C + r * ldc + 31), _MM_HINT_T0);
+            }
+
+            // kc counts the pairs of k
+            for (int k = 0; k < kc; ++k) {
+                _mm_prefetch((const char*)(pA + 16 * 12), _MM_HINT_T0);
+
+                // the workspace given by the user is aligned to 32 bytes only
+                _b0 = _mm512_loadu_si512(pB);
+                _b1 = _mm512_loadu_si512(pB + 32);
+
+                _IGEMM_MK_ROW_VNNI_(0);
+                _IGEMM_MK_ROW_VNNI_(1);
+                _IGEMM_MK_ROW_VNNI_(2);
+                _IGEMM_MK_ROW_VNNI_(3);
+                _IGEMM_MK_ROW_VNNI_(4);
+                _IGEMM_MK_ROW_VNNI_(5);
+                _IGEMM_MK_ROW_VNNI_(6);
+                _IGEMM_MK_ROW_VNNI_(7);
+                _IGEMM_MK_ROW_VNNI_(8);
+                _IGEMM_MK_ROW_VNNI_(9);
+                _IGEMM_MK_ROW_VNNI_(10);
+                _IGEMM_MK_ROW_VNNI_(11);
+
+                pA += 24;
+                pB += 64;
+            }
+
+            const __m512i _alpha = _mm512_set1_epi32(alpha), _beta = _mm512_set1_epi32(beta);
+            _IGEMM_MK_STORE_ROW_VNNI_(0);
+            _IGEMM_MK_STORE_ROW_VNNI_(1);
+            _IGEMM_MK_STORE_ROW_VNNI_(2);
+            _IGEMM_MK_STORE_ROW_VNNI_(3);
+            _IGEMM_MK_STORE_ROW_VNNI_(4);
+            _IGEMM_MK_STORE_ROW_VNNI_(5);
+            _IGEMM_MK_STORE_ROW_VNNI_(6);
+            _IGEMM_MK_STORE_ROW_VNNI_(7);
+            _IGEMM_MK_STORE_ROW_VNNI_(8);
+            _IGEMM_MK_STORE_ROW_VNNI_(9);
+            _IGEMM_MK_STORE_ROW_VNNI_(10);
+            _IGEMM_MK_STORE_ROW_VNNI_(11);
+        }
+    }
+}
+_DECX_ISA_END_
+
+
+
+namespace decx
+{
+    static void _select_igemm_ukernel(const int isa)
+    {
+        decx::_igemm_ukernel* uk = &decx::_igemm_ukernels;
+        if (isa == de::CPU_ISA::ISA_AVX512 && decx::utils::detect_CPU_VNNI()) {
+            uk->mr = 12;        uk->nr = 32;
+            uk->full = &decx::avx512::_igemm_kernel_12x32_vnni;
+            uk->edge = &decx::_gemm_kernel_edge<short, int, &decx::avx512::_igemm_kernel_12x32_vnni, 12, 32>;
+        }
+        else if (isa >= de::CPU_ISA::ISA_AVX2) {
+            uk->mr = 6;         uk->nr = 16;
+            uk->full = &decx::avx2::_igemm_kernel_6x16;
+            uk->edge = &decx::_gemm_kernel_edge<short, int, &decx::avx2::_igemm_kernel_6x16, 6, 16>;
+        }
+        else {
+            uk->mr = 6;         uk->nr = 8;
+            uk->full = &decx::sse42::_igemm_kernel_6x8;
+            uk->edge = &decx::_gemm_kernel_edge<short, int, &decx::sse42::_igemm_kernel_6x8, 6, 8>;
+        }
+    }
+
+
+    static decx::_ISA_dispatch_reg _igemm_ukernels_reg(&decx::_select_igemm_ukernel);
+}
+
+
+#endif
@@ -11,19 +11,73 @@
 #ifndef _SGEMM_H_
 #define _SGEMM_H_
 
-#include "sgemm_callers.h"
+#include "sgemm_blocked.h"
+#include "sgemm_small.h"
+#include "sgemm_strassen.h"
+#include "gemm_fill_info.h"
 #include "../../classes/Matrix.h"
+#include "../../classes/Vector.h"
+#include "../../core/allocators/scratch_arena.h"
 
 
 namespace de
 {
     namespace cpu
     {
+        /**
+        * @brief dst = A * B. The large products take the levels of the Strassen-Winograd recursion
+        * de::cpu::SetStrassenLevels() allows (none by default). dst must not be A or B.
+        */
         _DECX_API_ de::DH sgemm(de::Matrix<float>& A, de::Matrix<float>& B, de::Matrix<float>& dst);
+
+        /**
+        * @brief The same as de::cpu::sgemm(A, B, dst), but the packed blocks of A and B are stored in workspace.
+        * The workspace is enlarged if it is shorter than needed, and left as is otherwise, so the
+        * repeated calls of the same shape allocate nothing.
+        */
+        _DECX_API_ de::DH sgemm(de::Matrix<float>& A, de::Matrix<float>& B, de::Matrix<float>& dst,
+            de::Vector<float>& workspace);
+
+
+        /**
+        * @brief dst = alpha * op(A) * op(B), op() transposes the operands flagged by trans_flag (de::cpu::GEMM_Trans).
+        * The transposes are done while packing, and alpha is applied by the stores, no extra pass is made.
+        */
+        _DECX_API_ de::DH GEMM(de::Matrix<float>& A, de::Matrix<float>& B, de::Matrix<float>& dst,
+            const float alpha = 1.f, const int trans_flag = de::cpu::GEMM_NoTrans);
+
+
+        /**
+        * @brief dst = alpha * op(A) * op(B) + beta * C. C is read by the stores of the first block of
+        * the products, and is never read if beta is 0. Pass C as dst to accumulate in place (C is kept as is,
+        * not reallocated), dst must not be A or B (DECX_FAIL_OperandAliasing).
+        */
+        _DECX_API_ de::DH GEMM(de::Matrix<float>& A, de::Matrix<float>& B, de::Matrix<float>& C, de::Matrix<float>& dst,
+            const float alpha = 1.f, const float beta = 1.f, const int trans_flag = de::cpu::GEMM_NoTrans);
     }
 }
 
 
+namespace decx
+{
+    static void _sgemm_fill_info(decx::_sgemm_blocked_info* info, decx::_Matrix<float>* A,
+        decx::_Matrix<float>* B, decx::_Matrix<float>* dst);
+}
+
+
+
+static void decx::_sgemm_fill_info(decx::_sgemm_blocked_info* info, decx::_Matrix<float>* A,
+    decx::_Matrix<float>* B, decx::_Matrix<float>* dst)
+{
+    info->A = A->Mat.ptr;           info->lda = A->pitch;
+    info->B = B->Mat.ptr;           info->ldb = B->pitch;
+    info->C = dst->Mat.ptr;         info->ldc = dst->pitch;
+    info->M = A->height;
+    info->N = B->width;
+    info->K = A->width;
+}
+
+
 
 de::DH de::cpu::sgemm(de::Matrix<float>& A, de::Matrix<float>& B, de::Matrix<float>& dst)
 {
@@ -36,24 +90,147 @@ de::DH de::cpu::sgemm(de::Matrix<float>& A, de::Matrix<float>& B, de::Matrix<flo
         decx::MDim_Not_Matching(&handle);
         return handle;
     }
+    if (_dst == _A || _dst == _B) {
+        decx::err::OperandAliasing(&handle);
+        Print_Error_Message(4, OPERAND_ALIASING);
+        return handle;
+    }
 
-    _dst->re_construct(_A->width, _B->height, decx::DATA_STORE_TYPE::Page_Default);
+    _dst->re_construct(_B->width, _A->height, decx::DATA_STORE_TYPE::Page_Default);
     
-    int4 dims_info = make_int4(_A->pitch, _A->height, _dst->pitch, 0);
-    int2 sort_dims_info = make_int2(_A->pitch, _B->pitch);
-    
-    decx::PtrInfo<float> B_buffer;
-    int res = decx::alloc::_host_virtual_page_malloc<float>(&B_buffer,
-        static_cast<size_t>(_B->pitch) * static_cast<size_t>(_A->pitch) * sizeof(float));
-    if (res) {
+    decx::_sgemm_blocked_info info;
+    decx::_sgemm_fill_info(&info, _A, _B, _dst);
+
+    if (decx::sgemm_small_eligible(&info)) {
+        decx::sgemm_small(&info);
+        decx::Success(&handle);
+        return handle;
+    }
+
+    // the workspace of the levels is allocated from the memory pool, the packed blocks are taken
+    // from the scratch arenas of the threads
+    const int _levels = decx::sgemm_strassen_depth(info.M, info.N, info.K, decx::_sgemm_strassen_levels);
+    if (!(_levels > 0 ? decx::sgemm_strassen(&info, _levels) : decx::sgemm_blocked(&info, NULL))) {
         decx::err::AllocateFailure(&handle);
         Print_Error_Message(4, ALLOC_FAIL);
         return handle;
     }
 
-    decx::sgemm_caller<3, 4>(_A->Mat.ptr, _B->Mat.ptr, B_buffer.ptr, _dst->Mat.ptr, &dims_info);
-    
-    decx::alloc::_dealloc_Hv(B_buffer.block);
+    decx::Success(&handle);
+    return handle;
+}
+
+
+
+de::DH de::cpu::sgemm(de::Matrix<float>& A, de::Matrix<float>& B, de::Matrix<float>& dst,
+    de::Vector<float>& workspace)
+{
+    decx::_Matrix<float>* _A = dynamic_cast<decx::_Matrix<float>*>(&A);
+    decx::_Matrix<float>* _B = dynamic_cast<decx::_Matrix<float>*>(&B);
+    decx::_Matrix<float>* _dst = dynamic_cast<decx::_Matrix<float>*>(&dst);
+    decx::_Vector<float>* _workspace = dynamic_cast<decx::_Vector<float>*>(&workspace);
+
+    de::DH handle;
+    if (_A->width != _B->height) {
+        decx::MDim_Not_Matching(&handle);
+        return handle;
+    }
+    if (_dst == _A || _dst == _B) {
+        decx::err::OperandAliasing(&handle);
+        Print_Error_Message(4, OPERAND_ALIASING);
+        return handle;
+    }
+
+    _dst->re_construct(_B->width, _A->height, decx::DATA_STORE_TYPE::Page_Default);
+
+    decx::_sgemm_blocked_info info;
+    decx::_sgemm_fill_info(&info, _A, _B, _dst);
+
+    // the small ones need no workspace
+    if (decx::sgemm_small_eligible(&info)) {
+        decx::sgemm_small(&info);
+        decx::Success(&handle);
+        return handle;
+    }
+
+    const size_t buffer_len = decx::sgemm_blocked_workspace_len(&info);
+    if (_workspace->length < buffer_len) {
+        _workspace->re_construct(buffer_len, decx::DATA_STORE_TYPE::Page_Default);
+        if (_workspace->Vec.ptr == NULL) {
+            decx::err::AllocateFailure(&handle);
+            Print_Error_Message(4, ALLOC_FAIL);
+            return handle;
+        }
+    }
+
+    if (!decx::sgemm_blocked(&info, _workspace->Vec.ptr)) {
+        decx::err::AllocateFailure(&handle);
+        Print_Error_Message(4, ALLOC_FAIL);
+        return handle;
+    }
+
+    decx::Success(&handle);
+    return handle;
+}
+
+
+
+de::DH de::cpu::GEMM(de::Matrix<float>& A, de::Matrix<float>& B, de::Matrix<float>& dst,
+    const float alpha, const int trans_flag)
+{
+    decx::_Matrix<float>* _A = dynamic_cast<decx::_Matrix<float>*>(&A);
+    decx::_Matrix<float>* _B = dynamic_cast<decx::_Matrix<float>*>(&B);
+    decx::_Matrix<float>* _dst = dynamic_cast<decx::_Matrix<float>*>(&dst);
+
+    de::DH handle;
+    decx::_sgemm_blocked_info info;
+    if (!decx::_GEMM_fill_info(&info, _A, _B, (decx::_Matrix<float>*)NULL, _dst, alpha, 0.f, trans_flag, &handle)) {
+        return handle;
+    }
+
+    if (decx::sgemm_small_eligible(&info)) {
+        decx::sgemm_small(&info);
+        decx::Success(&handle);
+        return handle;
+    }
+
+    if (!decx::sgemm_blocked(&info, NULL)) {
+        decx::err::AllocateFailure(&handle);
+        Print_Error_Message(4, ALLOC_FAIL);
+        return handle;
+    }
+
+    decx::Success(&handle);
+    return handle;
+}
+
+
+
+de::DH de::cpu::GEMM(de::Matrix<float>& A, de::Matrix<float>& B, de::Matrix<float>& C, de::Matrix<float>& dst,
+    const float alpha, const float beta, const int trans_flag)
+{
+    decx::_Matrix<float>* _A = dynamic_cast<decx::_Matrix<float>*>(&A);
+    decx::_Matrix<float>* _B = dynamic_cast<decx::_Matrix<float>*>(&B);
+    decx::_Matrix<float>* _C = dynamic_cast<decx::_Matrix<float>*>(&C);
+    decx::_Matrix<float>* _dst = dynamic_cast<decx::_Matrix<float>*>(&dst);
+
+    de::DH handle;
+    decx::_sgemm_blocked_info info;
+    if (!decx::_GEMM_fill_info(&info, _A, _B, _C, _dst, alpha, beta, trans_flag, &handle)) {
+        return handle;
+    }
+
+    if (decx::sgemm_small_eligible(&info)) {
+        decx::sgemm_small(&info);
+        decx::Success(&handle);
+        return handle;
+    }
+
+    if (!decx::sgemm_blocked(&info, NULL)) {
+        decx::err::AllocateFailure(&handle);
+        Print_Error_Message(4, ALLOC_FAIL);
+        return handle;
+    }
 
     decx::Success(&handle);
     return handle;
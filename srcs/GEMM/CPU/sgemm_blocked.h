@@ -0,0 +1,61 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+
+#ifndef _SGEMM_BLOCKED_H_
+#define _SGEMM_BLOCKED_H_
+
+#include "gemm_blocked.h"
+#include "sgemm_micro_kernel.h"
+
+
+// The float instance of the packed, cache-blocked GEMM (gemm_blocked.h)
+
+
+namespace decx
+{
+    struct _sgemm_blocked_info;
+
+
+    /**
+    * @return The length (in floats) of the workspace decx::sgemm_blocked() needs for the problem
+    */
+    static size_t sgemm_blocked_workspace_len(const decx::_sgemm_blocked_info* info);
+
+
+    /**
+    * @brief C = alpha * op(A) * op(B) + beta * S, see decx::gemm_blocked()
+    */
+    static bool sgemm_blocked(const decx::_sgemm_blocked_info* info, float* workspace);
+}
+
+
+
+// takes the micro-kernel of the de::CPU_ISA in use
+struct decx::_sgemm_blocked_info : public decx::_gemm_blocked_info<float, float, float, 1>
+{
+    _sgemm_blocked_info() : decx::_gemm_blocked_info<float, float, float, 1>(decx::_sgemm_ukernels) {}
+};
+
+
+
+static size_t decx::sgemm_blocked_workspace_len(const decx::_sgemm_blocked_info* info)
+{
+    return decx::gemm_blocked_workspace_len<float, float, float, 1>(info);
+}
+
+
+
+static bool decx::sgemm_blocked(const decx::_sgemm_blocked_info* info, float* workspace)
+{
+    return decx::gemm_blocked<float, float, float, 1>(info, workspace);
+}
+
+
+#endif
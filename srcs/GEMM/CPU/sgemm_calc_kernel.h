@@ -20,18 +20,22 @@
 
 
 
+// the former kernels, used by decx::sgemm_caller() only
+_DECX_ISA_BEGIN_AVX2_
+
+
 /* (__linear, wB, hA) */
 #define _SGEMM_CALC_KERNEL_16(a_dex){    \
 tp_b[0] = _mm256_load_ps(B + dex_B);       dex_B += 8;  \
 tp_b[1] = _mm256_load_ps(B + dex_B);       dex_B += 8;  \
-tp_c[0] = _mm256_fmadd_ps(_mm256_set1_ps(tp_a.m256_f32[a_dex]), tp_b[0], tp_c[0]);  \
-tp_c[1] = _mm256_fmadd_ps(_mm256_set1_ps(tp_a.m256_f32[a_dex]), tp_b[1], tp_c[1]);  \
+tp_c[0] = _mm256_fmadd_ps(_mm256_permutevar8x32_ps(tp_a, _mm256_set1_epi32(a_dex)), tp_b[0], tp_c[0]);  \
+tp_c[1] = _mm256_fmadd_ps(_mm256_permutevar8x32_ps(tp_a, _mm256_set1_epi32(a_dex)), tp_b[1], tp_c[1]);  \
 }
 
 
 #define _SGEMM_CALC_KERNEL_8(a_dex){    \
 tp_b = _mm256_load_ps(B + dex_B);          dex_B += 8;  \
-tp_c = _mm256_fmadd_ps(_mm256_set1_ps(tp_a.m256_f32[a_dex]), tp_b, tp_c);   \
+tp_c = _mm256_fmadd_ps(_mm256_permutevar8x32_ps(tp_a, _mm256_set1_epi32(a_dex)), tp_b, tp_c);   \
 }
 
 
@@ -772,6 +776,7 @@ void _THREAD_FUNCTION_ decx::_avx256_sgemm_block_flexibleH_first(float* A, float
         dex_A += (size_t)__linear - sgemm_BL_Linear;
     }
 }
+_DECX_ISA_END_
 
 
 #endif
\ No newline at end of file
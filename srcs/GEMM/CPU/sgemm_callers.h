@@ -75,116 +75,14 @@ namespace decx
         float* A, float* B, float* C, const int __linear, const int global_wB, const int loc_hA, const int loc_wB);
 
 
-    /**
-    * @param : glo_dims.x -> __linear (wA) (hB) .y -> global_hA .z -> global_wB (16x) .w -> ȱʡ
-    * @param : proc_dim.x -> local_hA .y -> local_wB
-    */
-    template <int threadDim_x, int threadDim_y>
-    static void sgemm_Dblock_FH_FL_FW(float* A, float* B, float* C, const int4* glo_dim, const int2* proc_dim, const size_t& fake_wB);
-
-
-    /**
-    * @param : glo_dims.x -> __linear (wA) (hB) .y -> global_hA .z -> global_wB (16x) .w -> ȱʡ
-    * @param : proc_dim.x -> local_hA .y -> local_wB
-    */
-    template <int threadDim_x, int threadDim_y>
-    static void sgemm_Dblock_FH_LL_FW(float* A, float* B, float* C, const int4* glo_dim, const int2* proc_dim, const size_t& fake_wB);
-
-
-
-    /**
-    * @param : glo_dims.x -> __linear (wA) (hB) .y -> global_hA .z -> global_wB (16x) .w -> ȱʡ
-    * @param : proc_dim.x -> local_hA .y -> local_wB
-    */
-    template <int threadDim_x, int threadDim_y>
-    static void sgemm_Dblock_FH_FL_LW16(float* A, float* B, float* C, const int4* glo_dim, const int2* proc_dim,
-        const int wB_left, const size_t& fake_wB);
-
-
-    /**
-    * @param : glo_dims.x -> __linear (wA) (hB) .y -> global_hA .z -> global_wB (16x) .w -> ȱʡ
-    * @param : proc_dim.x -> local_hA .y -> local_wB
-    */
-    template <int threadDim_x, int threadDim_y>
-    static void sgemm_Dblock_FH_LL_LW16(float* A, float* B, float* C, const int4* glo_dim, const int2* proc_dim,
-        const int wB_left, const size_t& fake_wB);
-
-    /**
-    * @param : glo_dims.x -> __linear (wA) (hB) .y -> global_hA .z -> global_wB (16x) .w -> ȱʡ
-    * @param : proc_dim.x -> local_hA .y -> local_wB
-    */
-    template <int threadDim_x, int threadDim_y>
-    static void sgemm_Dblock_FH_FL_LW8(float* A, float* B, float* C, const int4* glo_dim, const int2* proc_dim,
-        const int wB_left, const size_t& fake_wB);
-
-    /**
-    * @param : glo_dims.x -> __linear (wA) (hB) .y -> global_hA .z -> global_wB (16x) .w -> ȱʡ
-    * @param : proc_dim.x -> local_hA .y -> local_wB
-    */
-    template <int threadDim_x, int threadDim_y>
-    static void sgemm_Dblock_FH_LL_LW8(float* A, float* B, float* C, const int4* glo_dim, const int2* proc_dim,
-        const int wB_left, const size_t& fake_wB);
-
-    /**
-    * @param : glo_dims.x -> __linear (wA) (hB) .y -> global_hA .z -> global_wB (16x) .w -> ȱʡ
-    * @param : proc_dim.x -> local_hA .y -> local_wB
-    */
-    template <int threadDim_x, int threadDim_y>
-    static void sgemm_Dblock_LH_FL_FW(float* A, float* B, float* C, const int4* glo_dim, const int2* proc_dim,
-        const int hA_left, const size_t& fake_wB);
-
-    /**
-    * @param : glo_dims.x -> __linear (wA) (hB) .y -> global_hA .z -> global_wB (16x) .w -> ȱʡ
-    * @param : proc_dim.x -> local_hA .y -> local_wB
-    */
-    template <int threadDim_x, int threadDim_y>
-    static void sgemm_Dblock_LH_FL_LW16(float* A, float* B, float* C, const int4* glo_dim, const int2* proc_dim,
-        const int wB_left, const int hA_left, const size_t& fake_wB);
-
-
-    template <int threadDim_x, int threadDim_y>
-    static void sgemm_Dblock_LH_LL_FW(float* A, float* B, float* C, const int4* glo_dim,
-        const int2* proc_dim, const int hA_left, const size_t& fake_wB);
-
-    template <int threadDim_x, int threadDim_y>
-    static void sgemm_Dblock_LH_LL_LW16(float* A, float* B, float* C, const int4* glo_dim, const int2* proc_dim,
-        const int wB_left, const int hA_left, const size_t& fake_wB);
-
-    template <int threadDim_x, int threadDim_y>
-    static void sgemm_Dblock_LH_FL_LW8(float* A, float* B, float* C, const int4* glo_dim, const int2* proc_dim,
-        const int wB_left, const int hA_left, const size_t& fake_wB);
-
-    template <int threadDim_x, int threadDim_y>
-    static void sgemm_Dblock_LH_LL_LW8(float* A, float* B, float* C, const int4* glo_dim, const int2* proc_dim,
-        const int wB_left, const int hA_left, const size_t& fake_wB);
-
-
-    /**
-    * @param dims_pkg : (in __m128).x -> __linear (wA) (hB) .y -> hA .z -> wB (16x) .w -> ȱʡ
-    */
-    template <int threadDim_x, int threadDim_y>
-    static void sgemm_caller_FH_W16(float* A, float* B, float* C, const int4* glo_dim);
-
-
-    /**
-    * @param dims_pkg : (in __m128).x -> __linear (wA) (hB) .y -> hA .z -> wB (16x) .w -> ȱʡ
-    */
-    template <int threadDim_x, int threadDim_y>
-    static void sgemm_caller_LH_W16(float* A, float* B, float* C, const int4* glo_dim);
-
 
     /**
-    * @param dims_pkg : (in __m128).x -> __linear (wA) (hB) .y -> hA .z -> wB (16x) .w -> ȱʡ
+    * @brief Compute the tile of C of rows [row_beg, row_end) and of the 16-float lanes of B
+    * [lane_beg, lane_end) on the calling thread, selects the kernel by the shape of the tile
+    * @param glo_dim : .x -> __linear (wA) (hB) .y -> global_hA .z -> global_wB (8x) .w -> unused
     */
-    template <int threadDim_x, int threadDim_y>
-    static void sgemm_caller_FH_W8(float* A, float* B, float* C, const int4* glo_dim);
-
-
-    /**
-    * @param dims_pkg : (in __m128).x -> __linear (wA) (hB) .y -> hA .z -> wB (16x) .w -> ȱʡ
-    */
-    template <int threadDim_x, int threadDim_y>
-    static void sgemm_caller_LH_W8(float* A, float* B, float* C, const int4* glo_dim);
+    static void _sgemm_tile(float* A, float* B, float* C, const int4* glo_dim,
+        const int row_beg, const int row_end, const int lane_beg, const int lane_end);
 
 
     /**
@@ -192,9 +90,8 @@ namespace decx
     * @param B : pointer of matrix B
     * @param tmp_B : pointer of matrix tmp_B
     * @param dst : pointer of matrix dst
-    * @param dims_pkg : (in __m128).x -> __linear (wA) (hB) .y -> hA .z -> wB (16x) .w -> ȱʡ
+    * @param glo_dim : .x -> __linear (wA) (hB) .y -> hA .z -> wB (8x) .w -> unused
     */
-    template <int threadDim_x, int threadDim_y>
     static void sgemm_caller(float* A, float* B, float* tmp_B, float* dst, const int4* glo_dim);
 }
 
@@ -640,613 +537,68 @@ static void _THREAD_FUNCTION_ decx::_ST_sgemm_Dblock_LH_FL_W8(
 // --------------------------------------------------------------------------------------------------------
 
 
-
-template <int threadDim_x, int threadDim_y>
-void decx::sgemm_Dblock_FH_FL_FW(float* A, float* B, float* C, const int4* glo_dim, const int2* proc_dim, const size_t& fake_wB)
-{
-    std::future<void> __async_stream[threadDim_x * threadDim_y];
-
-    int sum = 0;
-    for (int i = 0; i < threadDim_x; ++i) {
-        for (int j = 0; j < threadDim_y; ++j) {
-            __async_stream[sum] = decx::thread_pool.register_task(
-                decx::_ST_sgemm_Dblock_FH_FL_W16,
-                A + i * (size_t)proc_dim->x * (size_t)glo_dim->x,
-                B + j * (size_t)fake_wB,
-                C + (i * (size_t)proc_dim->x * (size_t)glo_dim->z) + j * (size_t)proc_dim->y,
-                glo_dim->x, glo_dim->z, proc_dim->x, proc_dim->y);
-            ++sum;
-        }
-    }
-
-    for (int i = 0; i < threadDim_x * threadDim_y; ++i) {
-        __async_stream[i].get();
-    }
-}
-
-
-
-template <int threadDim_x, int threadDim_y>
-void decx::sgemm_Dblock_FH_LL_FW(float* A, float* B, float* C, const int4* glo_dim, const int2* proc_dim, const size_t& fake_wB)
-{
-    std::future<void> __async_stream[threadDim_x * threadDim_y];
-
-    int sum = 0;
-    for (int i = 0; i < threadDim_x; ++i) {
-        for (int j = 0; j < threadDim_y; ++j) {
-            __async_stream[sum] = decx::thread_pool.register_task(
-                decx::_ST_sgemm_Dblock_FH_LL_W16,
-                A + i * (size_t)proc_dim->x * (size_t)glo_dim->x,
-                B + j * (size_t)fake_wB,
-                C + (i * (size_t)proc_dim->x * (size_t)glo_dim->z) + j * (size_t)proc_dim->y,
-                glo_dim->x, glo_dim->z, proc_dim->x, proc_dim->y);
-            ++sum;
-        }
-    }
-
-    for (int i = 0; i < threadDim_x * threadDim_y; ++i) {
-        __async_stream[i].get();
-    }
-}
-
-
-
-template <int threadDim_x, int threadDim_y>
-void decx::sgemm_Dblock_FH_FL_LW16(float* A, float* B, float* C, const int4* glo_dim, const int2* proc_dim,
-    const int wB_left, const size_t& fake_wB)
-{
-    std::future<void> __async_stream[threadDim_x * threadDim_y];
-
-    int sum = 0;
-
-    for (int i = 0; i < threadDim_x; ++i) {
-        for (int j = 0; j < threadDim_y - 1; ++j) {
-            __async_stream[sum] = decx::thread_pool.register_task(
-                decx::_ST_sgemm_Dblock_FH_FL_W16,
-                A + i * (size_t)proc_dim->y * (size_t)glo_dim->x,
-                B + j * (size_t)fake_wB,
-                C + (i * (size_t)proc_dim->x * (size_t)glo_dim->z) + j * (size_t)proc_dim->y,
-                glo_dim->x, glo_dim->z, proc_dim->x, proc_dim->y);
-            ++sum;
-        }
-    }
-
-    for (int i = 0; i < threadDim_x; ++i) {
-        __async_stream[sum] = decx::thread_pool.register_task(
-            decx::_ST_sgemm_Dblock_FH_FL_W16,
-            A + i * (size_t)proc_dim->y * (size_t)glo_dim->x,
-            B + (threadDim_y - 1) * (size_t)fake_wB,
-            C + (i * (size_t)proc_dim->x * (size_t)glo_dim->z) + (threadDim_y - 1) * (size_t)proc_dim->y,
-            glo_dim->x, glo_dim->z, proc_dim->x, wB_left);
-        ++sum;
-    }
-
-    for (int i = 0; i < threadDim_x * threadDim_y; ++i) {
-        __async_stream[i].get();
-    }
-}
-
-
-
-template <int threadDim_x, int threadDim_y>
-void decx::sgemm_Dblock_FH_LL_LW16(float* A, float* B, float* C, const int4* glo_dim, const int2* proc_dim,
-    const int wB_left, const size_t& fake_wB)
-{
-    std::future<void> __async_stream[threadDim_x * threadDim_y];
-    int sum = 0;
-    for (int i = 0; i < threadDim_x; ++i) {
-        for (int j = 0; j < threadDim_y - 1; ++j) {
-            __async_stream[sum] = decx::thread_pool.register_task(
-                    decx::_ST_sgemm_Dblock_FH_FL_W16,
-                    A + i * (size_t)proc_dim->y * (size_t)glo_dim->x,
-                    B + j * (size_t)fake_wB,
-                    C + (i * (size_t)proc_dim->x * (size_t)glo_dim->z) + j * (size_t)proc_dim->y,
-                    glo_dim->x, glo_dim->z, proc_dim->x, proc_dim->y);
-            ++sum;
-        }
-    }
-
-    for (int i = 0; i < threadDim_x; ++i) {
-        __async_stream[sum] = decx::thread_pool.register_task(
-            decx::_ST_sgemm_Dblock_FH_LL_W16,
-            A + i * (size_t)proc_dim->y * (size_t)glo_dim->x,
-            B + (threadDim_y - 1) * (size_t)fake_wB,
-            C + (i * (size_t)proc_dim->x * (size_t)glo_dim->z) + (threadDim_y - 1) * (size_t)proc_dim->y,
-            glo_dim->x, glo_dim->z, proc_dim->x, wB_left);
-        ++sum;
-    }
-
-    for (int i = 0; i < threadDim_x * threadDim_y; ++i) {
-        __async_stream[i].get();
-    }
-}
-
-
-
-template <int threadDim_x, int threadDim_y>
-void decx::sgemm_Dblock_FH_FL_LW8(float* A, float* B, float* C, const int4* glo_dim, const int2* proc_dim,
-    const int wB_left, const size_t& fake_wB)
+static void decx::_sgemm_tile(float* A, float* B, float* C, const int4* glo_dim,
+    const int row_beg, const int row_end, const int lane_beg, const int lane_end)
 {
-    std::future<void>* __async_stream = new std::future<void>[threadDim_x * threadDim_y];
-    int sum = 0;
-    for (int i = 0; i < threadDim_x; ++i) {
-        for (int j = 0; j < threadDim_y - 1; ++j) {
-            __async_stream[sum] = decx::thread_pool.register_task(
-                decx::_ST_sgemm_Dblock_FH_FL_W16,
-                A + i * (size_t)proc_dim->y * (size_t)glo_dim->x,
-                B + j * (size_t)fake_wB,
-                C + (i * (size_t)proc_dim->x * (size_t)glo_dim->z) + j * (size_t)proc_dim->y,
-                glo_dim->x, glo_dim->z, proc_dim->x, proc_dim->y);
-            ++sum;
-        }
-    }
-
-    for (int i = 0; i < threadDim_x; ++i) {
-        __async_stream[sum] = decx::thread_pool.register_task(
-            decx::_ST_sgemm_Dblock_FH_FL_W8,
-            A + i * (size_t)proc_dim->y * (size_t)glo_dim->x,
-            B + (threadDim_y - 1) * (size_t)fake_wB,
-            C + (i * (size_t)proc_dim->x * (size_t)glo_dim->z) + (threadDim_y - 1) * (size_t)proc_dim->y,
-            glo_dim->x, glo_dim->z, proc_dim->x, wB_left);
-        ++sum;
-    }
-
-    for (int i = 0; i < threadDim_x * threadDim_y; ++i) {
-        __async_stream[i].get();
-    }
+    const int loc_hA = row_end - row_beg;
+    // the last lane is 8 floats wide when wB = 16N + 8
+    const int loc_wB = decx::utils::clamp_max<int>(lane_end * 16, glo_dim->z) - lane_beg * 16;
+    const bool _W8 = (lane_end * 16 > glo_dim->z);
+    const bool _LH = (loc_hA % sgemm_BL_hA) != 0;
+    const bool _LL = (glo_dim->x % sgemm_BL_Linear) != 0;
+
+    float* _A = A + (size_t)row_beg * (size_t)glo_dim->x;
+    float* _B = B + (size_t)lane_beg * 16 * (size_t)glo_dim->x;
+    float* _C = C + (size_t)row_beg * (size_t)glo_dim->z + (size_t)lane_beg * 16;
+
+    typedef void (*_kernel_type)(float*, float*, float*, const int, const int, const int, const int);
+    // indexed by (_W8, _LH, _LL)
+    static const _kernel_type _kernels[8] = {
+        decx::_ST_sgemm_Dblock_FH_FL_W16, decx::_ST_sgemm_Dblock_FH_LL_W16,
+        decx::_ST_sgemm_Dblock_LH_FL_W16, decx::_ST_sgemm_Dblock_LH_LL_W16,
+        decx::_ST_sgemm_Dblock_FH_FL_W8,  decx::_ST_sgemm_Dblock_FH_LL_W8,
+        decx::_ST_sgemm_Dblock_LH_FL_W8,  decx::_ST_sgemm_Dblock_LH_LL_W8 };
+
+    _kernels[((int)_W8 << 2) | ((int)_LH << 1) | (int)_LL](_A, _B, _C, glo_dim->x, glo_dim->z, loc_hA, loc_wB);
 }
 
 
 
-template <int threadDim_x, int threadDim_y>
-static void decx::sgemm_Dblock_FH_LL_LW8(float* A, float* B, float* C, const int4* glo_dim, const int2* proc_dim,
-    const int wB_left, const size_t& fake_wB)
+static void decx::sgemm_caller(float* A, float* B, float* tmp_B, float* dst, const int4* glo_dim)
 {
-    std::future<void>* __async_stream = new std::future<void>[threadDim_x * threadDim_y];
-    int sum = 0;
-    for (int i = 0; i < threadDim_x; ++i) {
-        for (int j = 0; j < threadDim_y - 1; ++j) {
-            __async_stream[sum] = decx::thread_pool.register_task(
-                decx::_ST_sgemm_Dblock_FH_LL_W16,
-                A + i * (size_t)proc_dim->y * (size_t)glo_dim->x,
-                B + j * (size_t)fake_wB,
-                C + (i * (size_t)proc_dim->x * (size_t)glo_dim->z) + j * (size_t)proc_dim->y,
-                glo_dim->x, glo_dim->z, proc_dim->x, proc_dim->y);
-            ++sum;
-        }
-    }
+    const int row_blocks = decx::utils::ceil<int>(glo_dim->y, sgemm_BL_hA);
+    const int lane_num = decx::utils::ceil<int>(glo_dim->z, 16);
 
-    for (int i = 0; i < threadDim_x; ++i) {
-        __async_stream[sum] = decx::thread_pool.register_task(
-            decx::_ST_sgemm_Dblock_FH_LL_W8,
-            A + i * (size_t)proc_dim->y * (size_t)glo_dim->x,
-            B + (threadDim_y - 1) * (size_t)fake_wB,
-            C + (i * (size_t)proc_dim->x * (size_t)glo_dim->z) + (threadDim_y - 1) * (size_t)proc_dim->y,
-            glo_dim->x, glo_dim->z, proc_dim->x, wB_left);
-        ++sum;
-    }
+    const decx::utils::_sgemm_grid grid(row_blocks, lane_num,
+        (size_t)glo_dim->x * (size_t)glo_dim->y * (size_t)glo_dim->z,
+        decx::thread_pool.get_current_thread_num(), make_int2(sgemm_BL_hA, 16));
 
-    for (int i = 0; i < threadDim_x * threadDim_y; ++i) {
-        __async_stream[i].get();
+    const int2 sort_dims_info = make_int2(glo_dim->x, glo_dim->z);
+    if (grid.is_single_thread()) {
+        decx::sort_MatB_ST(B, tmp_B, sort_dims_info);
+        decx::_sgemm_tile(A, tmp_B, dst, glo_dim, 0, glo_dim->y, 0, lane_num);
+        return;
     }
-}
-
-
 
-template <int threadDim_x, int threadDim_y>
-static void decx::sgemm_Dblock_LH_FL_FW(float* A, float* B, float* C, const int4* glo_dim, const int2* proc_dim, 
-    const int hA_left, const size_t& fake_wB)
-{
-    std::future<void> __async_stream[threadDim_x * threadDim_y];
-    int sum = 0;
-
-    for (int i = 0; i < threadDim_x - 1; ++i) {
-        for (int j = 0; j < threadDim_y; ++j) {
-            __async_stream[sum] = decx::thread_pool.register_task(
-                decx::_ST_sgemm_Dblock_FH_FL_W16,
-                A + i * (size_t)proc_dim->x * (size_t)glo_dim->x,
-                B + j * (size_t)fake_wB,
-                C + (i * (size_t)proc_dim->x * (size_t)glo_dim->z) + j * (size_t)proc_dim->y,
-                glo_dim->x, glo_dim->z, proc_dim->x, proc_dim->y);
-            ++sum;
-        }
-    }
-    for (int j = 0; j < threadDim_y; ++j) {
-        __async_stream[sum] = decx::thread_pool.register_task(
-            decx::_ST_sgemm_Dblock_LH_FL_W16,
-            A + (threadDim_x - 1) * (size_t)proc_dim->x * (size_t)glo_dim->x,
-            B + j * (size_t)fake_wB,
-            C + ((threadDim_x - 1) * (size_t)proc_dim->x * (size_t)glo_dim->z) + j * (size_t)proc_dim->y,
-            glo_dim->x, glo_dim->z, hA_left, proc_dim->y);
-        ++sum;
-    }
-    
-    for (int i = 0; i < threadDim_x * threadDim_y; ++i) {
-        __async_stream[i].get();
-    }
-}
-
-
-
-template <int threadDim_x, int threadDim_y>
-void decx::sgemm_Dblock_LH_FL_LW16(float* A, float* B, float* C, const int4* glo_dim, const int2* proc_dim,
-    const int wB_left, const int hA_left, const size_t& fake_wB)
-{
-    std::future<void> __async_stream[threadDim_x * threadDim_y];
-
-    int sum = 0;
-
-    for (int i = 0; i < threadDim_x - 1; ++i) {
-        for (int j = 0; j < threadDim_y - 1; ++j) {
-            __async_stream[sum] = decx::thread_pool.register_task(
-                decx::_ST_sgemm_Dblock_FH_FL_W16,
-                A + i * (size_t)proc_dim->x * (size_t)glo_dim->x,
-                B + j * (size_t)fake_wB,
-                C + (i * (size_t)proc_dim->x * (size_t)glo_dim->z) + j * (size_t)proc_dim->y,
-                glo_dim->x, glo_dim->z, proc_dim->x, proc_dim->y);
-            ++sum;
-        }
-    }
-    for (int j = 0; j < threadDim_y - 1; ++j) {
-        __async_stream[sum] = decx::thread_pool.register_task(
-            decx::_ST_sgemm_Dblock_LH_FL_W16,
-            A + (threadDim_x - 1) * (size_t)proc_dim->x * (size_t)glo_dim->x,
-            B + j * (size_t)fake_wB,
-            C + ((threadDim_x - 1) * (size_t)proc_dim->x * (size_t)glo_dim->z) + j * (size_t)proc_dim->y,
-            glo_dim->x, glo_dim->z, hA_left, proc_dim->y);
-        ++sum;
-    }
-    // left weight_B
-    for (int i = 0; i < threadDim_x - 1; ++i) {
-        __async_stream[sum] = decx::thread_pool.register_task(
-            decx::_ST_sgemm_Dblock_FH_FL_W16,
-            A + i * (size_t)proc_dim->x * (size_t)glo_dim->x,
-            B + (threadDim_y - 1) * (size_t)fake_wB,
-            C + (i * (size_t)proc_dim->x * (size_t)glo_dim->z) + (threadDim_y - 1) * (size_t)proc_dim->y,
-            glo_dim->x, glo_dim->z, proc_dim->x, wB_left);
-        ++sum;
-    }
-    __async_stream[sum] = decx::thread_pool.register_task(
-        decx::_ST_sgemm_Dblock_LH_FL_W16,
-        A + (threadDim_x - 1) * (size_t)proc_dim->x * (size_t)glo_dim->x,
-        B + (threadDim_y - 1) * (size_t)fake_wB,
-        C + ((threadDim_x - 1) * (size_t)proc_dim->x * (size_t)glo_dim->z) + (threadDim_y - 1) * (size_t)proc_dim->y,
-        glo_dim->x, glo_dim->z, hA_left, wB_left);
-
-    for (int i = 0; i < threadDim_x * threadDim_y; ++i) {
-        __async_stream[i].get();
-    }
-}
-
-
-
-
-template <int threadDim_x, int threadDim_y>
-void decx::sgemm_Dblock_LH_LL_FW(float* A, float* B, float* C, const int4* glo_dim, 
-    const int2* proc_dim, const int hA_left, const size_t& fake_wB)
-{
-    std::future<void> __async_stream[threadDim_x * threadDim_y];
-    int sum = 0;
-
-    for (int i = 0; i < threadDim_x - 1; ++i) {
-        for (int j = 0; j < threadDim_y; ++j) {
-            __async_stream[sum] = decx::thread_pool.register_task(
-                decx::_ST_sgemm_Dblock_FH_LL_W16,
-                A + i * (size_t)proc_dim->x * (size_t)glo_dim->x,
-                B + j * (size_t)fake_wB,
-                C + (i * (size_t)proc_dim->x * (size_t)glo_dim->z) + j * (size_t)proc_dim->y,
-                glo_dim->x, glo_dim->z, proc_dim->x, proc_dim->y);
-            ++sum;
-        }
-    }
-    for (int j = 0; j < threadDim_y; ++j) {
-        __async_stream[sum] = decx::thread_pool.register_task(
-            decx::_ST_sgemm_Dblock_LH_LL_W16,
-            A + (threadDim_x - 1) * (size_t)proc_dim->x * (size_t)glo_dim->x,
-            B + j * (size_t)fake_wB,
-            C + ((threadDim_x - 1) * (size_t)proc_dim->x * (size_t)glo_dim->z) + j * (size_t)proc_dim->y,
-            glo_dim->x, glo_dim->z, hA_left, proc_dim->y);
-        ++sum;
-    }
-
-    for (int i = 0; i < threadDim_x * threadDim_y; ++i) {
-        __async_stream[i].get();
-    }
-}
-
-
-
-template <int threadDim_x, int threadDim_y>
-void decx::sgemm_Dblock_LH_LL_LW16(float* A, float* B, float* C, const int4* glo_dim, const int2* proc_dim,
-    const int wB_left, const int hA_left, const size_t& fake_wB)
-{
-    std::future<void> __async_stream[threadDim_x * threadDim_y];
-
-    int sum = 0;
-
-    for (int i = 0; i < threadDim_x - 1; ++i) {
-        for (int j = 0; j < threadDim_y - 1; ++j) {
-            __async_stream[sum] = decx::thread_pool.register_task(
-                decx::_ST_sgemm_Dblock_FH_LL_W16,
-                A + i * (size_t)proc_dim->x * (size_t)glo_dim->x,
-                B + j * (size_t)fake_wB,
-                C + (i * (size_t)proc_dim->x * (size_t)glo_dim->z) + j * (size_t)proc_dim->y,
-                glo_dim->x, glo_dim->z, proc_dim->x, proc_dim->y);
-            ++sum;
-        }
-    }
-    for (int j = 0; j < threadDim_y - 1; ++j) {
-        __async_stream[sum] = decx::thread_pool.register_task(
-            decx::_ST_sgemm_Dblock_LH_LL_W16,
-            A + (threadDim_x - 1) * (size_t)proc_dim->x * (size_t)glo_dim->x,
-            B + j * (size_t)fake_wB,
-            C + ((threadDim_x - 1) * (size_t)proc_dim->x * (size_t)glo_dim->z) + j * (size_t)proc_dim->y,
-            glo_dim->x, glo_dim->z, hA_left, proc_dim->y);
-        ++sum;
-    }
-    // left weight_B
-    for (int i = 0; i < threadDim_x - 1; ++i) {
-        __async_stream[sum] = decx::thread_pool.register_task(
-            decx::_ST_sgemm_Dblock_FH_LL_W16,
-            A + i * (size_t)proc_dim->x * (size_t)glo_dim->x,
-            B + (threadDim_y - 1) * (size_t)fake_wB,
-            C + (i * (size_t)proc_dim->x * (size_t)glo_dim->z) + (threadDim_y - 1) * (size_t)proc_dim->y,
-            glo_dim->x, glo_dim->z, proc_dim->x, wB_left);
-        ++sum;
-    }
-    __async_stream[sum] = decx::thread_pool.register_task(
-        decx::_ST_sgemm_Dblock_LH_LL_W16,
-        A + (threadDim_x - 1) * (size_t)proc_dim->x * (size_t)glo_dim->x,
-        B + (threadDim_y - 1) * (size_t)fake_wB,
-        C + ((threadDim_x - 1) * (size_t)proc_dim->x * (size_t)glo_dim->z) + (threadDim_y - 1) * (size_t)proc_dim->y,
-        glo_dim->x, glo_dim->z, hA_left, wB_left);
-
-    for (int i = 0; i < threadDim_x * threadDim_y; ++i) {
-        __async_stream[i].get();
-    }
-}
-
-
-
-
-template <int threadDim_x, int threadDim_y>
-void decx::sgemm_Dblock_LH_FL_LW8(float* A, float* B, float* C, const int4* glo_dim, const int2* proc_dim,
-    const int wB_left, const int hA_left, const size_t& fake_wB)
-{
-    std::future<void>* __async_stream = new std::future<void>[threadDim_x * threadDim_y];
-    int sum = 0;
-    for (int i = 0; i < threadDim_x - 1; ++i) {
-        for (int j = 0; j < threadDim_y - 1; ++j) {
-            __async_stream[sum] = decx::thread_pool.register_task(
-                decx::_ST_sgemm_Dblock_FH_FL_W16,
-                A + i * (size_t)proc_dim->x * (size_t)glo_dim->x,
-                B + j * (size_t)fake_wB,
-                C + (i * (size_t)proc_dim->x * (size_t)glo_dim->z) + j * (size_t)proc_dim->y,
-                glo_dim->x, glo_dim->z, proc_dim->x, proc_dim->y);
-            ++sum;
-        }
-    }
-    for (int j = 0; j < threadDim_y - 1; ++j) {
-        __async_stream[sum] = decx::thread_pool.register_task(
-            decx::_ST_sgemm_Dblock_LH_FL_W16,
-            A + (threadDim_x - 1) * (size_t)proc_dim->x * (size_t)glo_dim->x,
-            B + j * (size_t)fake_wB,
-            C + ((threadDim_x - 1) * (size_t)proc_dim->x * (size_t)glo_dim->z) + j * (size_t)proc_dim->y,
-            glo_dim->x, glo_dim->z, hA_left, proc_dim->y);
-        ++sum;
-    }
-    // left wieght_B
-    for (int i = 0; i < threadDim_x - 1; ++i) {
-        __async_stream[sum] = decx::thread_pool.register_task(
-            decx::_ST_sgemm_Dblock_FH_FL_W8,
-            A + i * (size_t)proc_dim->x * (size_t)glo_dim->x,
-            B + (threadDim_y - 1) * (size_t)fake_wB,
-            C + (i * (size_t)proc_dim->x * (size_t)glo_dim->z) + (threadDim_y - 1) * (size_t)proc_dim->y,
-            glo_dim->x, glo_dim->z, proc_dim->x, wB_left);
-        ++sum;
-    }
-    __async_stream[sum] = decx::thread_pool.register_task(
-        decx::_ST_sgemm_Dblock_LH_FL_W8,
-        A + (threadDim_x - 1) * (size_t)proc_dim->x * (size_t)glo_dim->x,
-        B + (threadDim_y - 1) * (size_t)fake_wB,
-        C + ((threadDim_x - 1) * (size_t)proc_dim->x * (size_t)glo_dim->z) + (threadDim_y - 1) * (size_t)proc_dim->y,
-        glo_dim->x, glo_dim->z, hA_left, wB_left);
-
-    for (int i = 0; i < threadDim_x * threadDim_y; ++i) {
-        __async_stream[i].get();
-    }
-}
-
-
-
-
-template <int threadDim_x, int threadDim_y>
-void decx::sgemm_Dblock_LH_LL_LW8(float* A, float* B, float* C, const int4* glo_dim, const int2* proc_dim,
-    const int wB_left, const int hA_left, const size_t& fake_wB)
-{
-    std::future<void>* __async_stream = new std::future<void>[threadDim_x * threadDim_y];
-    int sum = 0;
-    for (int i = 0; i < threadDim_x - 1; ++i) {
-        for (int j = 0; j < threadDim_y - 1; ++j) {
-            __async_stream[sum] = decx::thread_pool.register_task(
-                decx::_ST_sgemm_Dblock_FH_LL_W16,
-                A + i * (size_t)proc_dim->x * (size_t)glo_dim->x,
-                B + j * (size_t)fake_wB,
-                C + (i * (size_t)proc_dim->x * (size_t)glo_dim->z) + j * (size_t)proc_dim->y,
-                glo_dim->x, glo_dim->z, proc_dim->x, proc_dim->y);
-            ++sum;
-        }
-    }
-    for (int j = 0; j < threadDim_y - 1; ++j) {
-        __async_stream[sum] = decx::thread_pool.register_task(
-            decx::_ST_sgemm_Dblock_LH_LL_W16,
-            A + (threadDim_x - 1) * (size_t)proc_dim->x * (size_t)glo_dim->x,
-            B + j * (size_t)fake_wB,
-            C + ((threadDim_x - 1) * (size_t)proc_dim->x * (size_t)glo_dim->z) + j * (size_t)proc_dim->y,
-            glo_dim->x, glo_dim->z, hA_left, proc_dim->y);
-        ++sum;
-    }
-    // left wieght_B
-    for (int i = 0; i < threadDim_x - 1; ++i) {
-        __async_stream[sum] = decx::thread_pool.register_task(
-            decx::_ST_sgemm_Dblock_FH_LL_W8,
-            A + i * (size_t)proc_dim->x * (size_t)glo_dim->x,
-            B + (threadDim_y - 1) * (size_t)fake_wB,
-            C + (i * (size_t)proc_dim->x * (size_t)glo_dim->z) + (threadDim_y - 1) * (size_t)proc_dim->y,
-            glo_dim->x, glo_dim->z, proc_dim->x, wB_left);
-        ++sum;
-    }
-    __async_stream[sum] = decx::thread_pool.register_task(
-        decx::_ST_sgemm_Dblock_LH_LL_W8,
-        A + (threadDim_x - 1) * (size_t)proc_dim->x * (size_t)glo_dim->x,
-        B + (threadDim_y - 1) * (size_t)fake_wB,
-        C + ((threadDim_x - 1) * (size_t)proc_dim->x * (size_t)glo_dim->z) + (threadDim_y - 1) * (size_t)proc_dim->y,
-        glo_dim->x, glo_dim->z, hA_left, wB_left);
-
-    for (int i = 0; i < threadDim_x * threadDim_y; ++i) {
-        __async_stream[i].get();
-    }
-}
-
-
-
-// ----------------------------------------------------------------------------------------------------------
-
-
-template <int threadDim_x, int threadDim_y>
-static void decx::sgemm_caller_FH_W16(float* A, float* B, float* C, const int4* glo_dim)
-{
-    int lane_num = glo_dim->z / 16;
-    int2 proc_dim = make_int2(glo_dim->y / threadDim_x, (lane_num / threadDim_y) * 16);
-    size_t fake_wB = (size_t)glo_dim->x * (size_t)proc_dim.y;
-
-    if (glo_dim->x % sgemm_BL_Linear) {        // Left Linear
-        if (lane_num % threadDim_y)
-        {       // LW16
-            decx::sgemm_Dblock_FH_LL_LW16<threadDim_x, threadDim_y>(A, B, C, glo_dim, &proc_dim,
-                ((lane_num / threadDim_y) + (lane_num % threadDim_y)) * 16,
-                fake_wB);
-        }
-        else {      // FW
-            decx::sgemm_Dblock_FH_LL_FW<threadDim_x, threadDim_y>(
-                A, B, C, glo_dim, &proc_dim, fake_wB);
-        }
+    if (glo_dim->z % 16) {      // width_B = 16N + 8
+        decx::sort_MatB_16_w8(B, tmp_B, sort_dims_info);
     }
-    else {      // Full Linear
-        if (lane_num % threadDim_y) {       // LW16
-            decx::sgemm_Dblock_FH_FL_LW16<threadDim_x, threadDim_y>(
-                A, B, C, glo_dim, &proc_dim, 
-                ((lane_num / threadDim_y) + (lane_num % threadDim_y)) * 16, 
-                fake_wB);
-        }
-        else {      // FW
-            decx::sgemm_Dblock_FH_FL_FW<threadDim_x, threadDim_y>(
-                A, B, C, glo_dim, &proc_dim, fake_wB);
-        }
+    else {      // width_B = 16N
+        decx::sort_MatB_16(B, tmp_B, sort_dims_info);
     }
-}
 
-
-template <int threadDim_x, int threadDim_y>
-static void decx::sgemm_caller_LH_W16(float* A, float* B, float* C, const int4* glo_dim)
-{
-    int Wlane = glo_dim->z / 16;
-    int Hlane = glo_dim->y / sgemm_BL_hA;
-
-    int2 proc_dim = make_int2((Hlane / threadDim_x) * sgemm_BL_hA, (Wlane / threadDim_y) * 16);
-    size_t fake_wB = (size_t)glo_dim->x * (size_t)proc_dim.y;
-    int HLeft = ((Hlane / threadDim_x) + (Hlane % threadDim_x)) * sgemm_BL_hA + (glo_dim->y % sgemm_BL_hA);
-
-    if (glo_dim->x % sgemm_BL_Linear) {        // Left Linear
-        if (Wlane % threadDim_y){       // Left Width_B 16x
-            decx::sgemm_Dblock_LH_LL_LW16<threadDim_x, threadDim_y>(A, B, C, glo_dim, &proc_dim,
-                ((Wlane / threadDim_y) + (Wlane % threadDim_y)) * 16,
-                HLeft, fake_wB);
-        }
-        else {      // Full Width_B
-            decx::sgemm_Dblock_LH_LL_FW<threadDim_x, threadDim_y>(
-                A, B, C, glo_dim, &proc_dim, HLeft, fake_wB);
-        }
-    }
-    else {      // Full Linear
-        if (Wlane % threadDim_y) {       // Left Width_B 16x
-            decx::sgemm_Dblock_LH_FL_LW16<threadDim_x, threadDim_y>(
-                A, B, C, glo_dim, &proc_dim,
-                ((Wlane / threadDim_y) + (Wlane % threadDim_y)) * 16,
-                HLeft, fake_wB);
+    // one tile per task, the tiles are taken by the threads one by one
+    decx::parallel_for(0, (size_t)grid._grid.x * (size_t)grid._grid.y, [&](const size_t _beg, const size_t _end) {
+        for (size_t t = _beg; t < _end; ++t) {
+            const int _r = (int)(t / grid._grid.y), _c = (int)(t % grid._grid.y);
+            const int2 _rows = grid.rows_of(_r), _lanes = grid.lanes_of(_c);
+            decx::_sgemm_tile(A, tmp_B, dst, glo_dim,
+                _rows.x * sgemm_BL_hA, decx::utils::clamp_max<int>(_rows.y * sgemm_BL_hA, glo_dim->y),
+                _lanes.x, _lanes.y);
         }
-        else {      // Full Width_B
-            decx::sgemm_Dblock_LH_FL_FW<threadDim_x, threadDim_y>(
-                A, B, C, glo_dim, &proc_dim, HLeft, fake_wB);
-        }
-    }
+    }, 1, decx::Partition_Dynamic);
 }
 
 
-template <int threadDim_x, int threadDim_y>
-static void decx::sgemm_caller_FH_W8(float* A, float* B, float* C, const int4* glo_dim)
-{
-    int lane_num = (glo_dim->z - 8) / 16;
-    int2 proc_dim = make_int2(glo_dim->y / threadDim_x, (lane_num / threadDim_y) * 16);
-    size_t fake_wB = (size_t)glo_dim->x * (size_t)proc_dim.y;
-    int _wB_left = ((lane_num / threadDim_y) + (lane_num % threadDim_y)) * 16 + 8;
-
-    if (glo_dim->x % sgemm_BL_Linear) {        // LL
-        decx::sgemm_Dblock_FH_LL_LW8<threadDim_x, threadDim_y>(A, B, C, glo_dim, &proc_dim, _wB_left, fake_wB);
-    }
-    else {      // FL
-        decx::sgemm_Dblock_FH_FL_LW8<threadDim_x, threadDim_y>(A, B, C, glo_dim, &proc_dim, _wB_left, fake_wB);
-    }
-}
-
-
-template <int threadDim_x, int threadDim_y>
-static void decx::sgemm_caller_LH_W8(float* A, float* B, float* C, const int4* glo_dim)
-{
-    int lane_num = (glo_dim->z - 8) / 16;
-    int Hlane = glo_dim->y / sgemm_BL_hA;
-
-    int2 proc_dim = make_int2((Hlane / threadDim_x) * sgemm_BL_hA, (lane_num / threadDim_y) * 16);
-    size_t fake_wB = (size_t)glo_dim->x * (size_t)proc_dim.y;
-    int _wB_left = ((lane_num / threadDim_y) + (lane_num % threadDim_y)) * 16 + 8;
-
-    int HLeft = ((Hlane / threadDim_x) + (Hlane % threadDim_x)) * sgemm_BL_hA + (glo_dim->y % sgemm_BL_hA);
-
-    if (glo_dim->x % sgemm_BL_Linear) {        // Left Linear
-        decx::sgemm_Dblock_LH_LL_LW8<threadDim_x, threadDim_y>(A, B, C, glo_dim, &proc_dim, _wB_left, HLeft, fake_wB);
-    }
-    else {      // Full Linear
-        decx::sgemm_Dblock_LH_FL_LW8<threadDim_x, threadDim_y>(A, B, C, glo_dim, &proc_dim, _wB_left, HLeft, fake_wB);
-    }
-}
-
-
-// -------------------------------------------------------------------------------------------
-
-
-template <int threadDim_x, int threadDim_y>
-static void decx::sgemm_caller(float* A, float* B, float* tmp_B, float* dst, const int4 *glo_dim)
-{
-    int2 sort_dims_info = make_int2(glo_dim->x, glo_dim->z);
-    if (glo_dim->z % 16) {      // width_B = 16N + 8
-        decx::sort_MatB_16_w8<threadDim_x * threadDim_y>(B, tmp_B, sort_dims_info);
-        if (glo_dim->y % sgemm_BL_hA) {     // left height_A
-            decx::sgemm_caller_LH_W8<threadDim_x, threadDim_y>(A, tmp_B, dst, glo_dim);
-        }
-        else {      // full height_A
-            decx::sgemm_caller_FH_W8<threadDim_x, threadDim_y>(A, tmp_B, dst, glo_dim);
-        }
-    }
-    else {      // width_B = 16N
-        decx::sort_MatB_16<threadDim_x * threadDim_y>(B, tmp_B, sort_dims_info);
-        if (glo_dim->y % sgemm_BL_hA) {     // left height_A
-            decx::sgemm_caller_LH_W16<threadDim_x, threadDim_y>(A, tmp_B, dst, glo_dim);
-        }
-        else {      // full height_A
-            decx::sgemm_caller_FH_W16<threadDim_x, threadDim_y>(A, tmp_B, dst, glo_dim);
-        }
-    }
-}
-
 
 #endif
\ No newline at end of file
@@ -0,0 +1,308 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+
+#ifndef _SGEMM_MICRO_KERNEL_H_
+#define _SGEMM_MICRO_KERNEL_H_
+
+#include "gemm_ukernel.h"
+
+
+/**
+* The micro-kernels of the packed SGEMM, one for each de::CPU_ISA (the interface is in gemm_ukernel.h).
+* Each keeps a register tile of C (MR x NR) in the vector registers for the whole length of the packed panels :
+*   SSE4.2  : 6 x 8,  12 of the 16 xmm registers hold C
+*   AVX2    : 6 x 16, 12 of the 16 ymm registers hold C
+*   AVX-512 : 12 x 32, 24 of the 32 zmm registers hold C
+* The sizes are read from decx::_sgemm_ukernels at runtime, the packing follows them.
+*/
+#define _SGEMM_MAX_MR_ 12
+#define _SGEMM_MAX_NR_ 32
+
+
+namespace decx
+{
+    typedef decx::_gemm_ukernel<float, float> _sgemm_ukernel;
+
+
+    // the micro-kernel of the de::CPU_ISA in use
+    decx::_sgemm_ukernel _sgemm_ukernels;
+}
+
+
+
+// ------------------------------------------ SSE4.2 ------------------------------------------------
+
+
+#define _SGEMM_MK_ROW_SSE_(r) {                                     \
+    _a = _mm_set1_ps(pA[r]);                                        \
+    c##r##0 = _mm_add_ps(c##r##0, _mm_mul_ps(_a, _b0));             \
+    c##r##1 = _mm_add_ps(c##r##1, _mm_mul_ps(_a, _b1));             \
+}
+
+
+#define _SGEMM_MK_STORE_ROW_SSE_(r) {                                                               \
+    c##r##0 = _mm_mul_ps(c##r##0, _alpha);                                                          \
+    c##r##1 = _mm_mul_ps(c##r##1, _alpha);                                                          \
+    if (S != NULL) {                                                                                \
+        c##r##0 = _mm_add_ps(c##r##0, _mm_mul_ps(_beta, _mm_loadu_ps(S + r * lds)));                \
+        c##r##1 = _mm_add_ps(c##r##1, _mm_mul_ps(_beta, _mm_loadu_ps(S + r * lds + 4)));            \
+    }                                                                                               \
+    _mm_storeu_ps(C + r * ldc, c##r##0);                                                            \
+    _mm_storeu_ps(C + r * ldc + 4, c##r##1);                                                        \
+}
+
+
+_DECX_ISA_BEGIN_SSE42_
+namespace decx
+{
+    namespace sse42
+    {
+        static void _sgemm_kernel_6x8(const int kc, const float* pA, const float* pB, float* C,
+            const size_t ldc, const float* S, const size_t lds, const float alpha, const float beta)
+        {
+            __m128 c00 = _mm_setzero_ps(), c01 = _mm_setzero_ps(),
+                c10 = _mm_setzero_ps(), c11 = _mm_setzero_ps(),
+                c20 = _mm_setzero_ps(), c21 = _mm_setzero_ps(),
+                c30 = _mm_setzero_ps(), c31 = _mm_setzero_ps(),
+                c40 = _mm_setzero_ps(), c41 = _mm_setzero_ps(),
+                c50 = _mm_setzero_ps(), c51 = _mm_setzero_ps();
+            __m128 _a, _b0, _b1;
+
+            for (int k = 0; k < kc; ++k) {
+                _mm_prefetch((const char*)(pA + 8 * 6), _MM_HINT_T0);
+
+                _b0 = _mm_load_ps(pB);
+                _b1 = _mm_load_ps(pB + 4);
+
+                _SGEMM_MK_ROW_SSE_(0);
+                _SGEMM_MK_ROW_SSE_(1);
+                _SGEMM_MK_ROW_SSE_(2);
+                _SGEMM_MK_ROW_SSE_(3);
+                _SGEMM_MK_ROW_SSE_(4);
+                _SGEMM_MK_ROW_SSE_(5);
+
+                pA += 6;
+                pB += 8;
+            }
+
+            const __m128 _alpha = _mm_set1_ps(alpha), _beta = _mm_set1_ps(beta);
+            _SGEMM_MK_STORE_ROW_SSE_(0);
+            _SGEMM_MK_STORE_ROW_SSE_(1);
+            _SGEMM_MK_STORE_ROW_SSE_(2);
+            _SGEMM_MK_STORE_ROW_SSE_(3);
+            _SGEMM_MK_STORE_ROW_SSE_(4);
+            _SGEMM_MK_STORE_ROW_SSE_(5);
+        }
+    }
+}
+_DECX_ISA_END_
+
+
+
+// ------------------------------------------- AVX2 -------------------------------------------------
+
+
+#define _SGEMM_MK_ROW_(r) {                                         \
+    _a = _mm256_broadcast_ss(pA + r);                               \
+    c##r##0 = _mm256_fmadd_ps(_a, _b0, c##r##0);                    \
+    c##r##1 = _mm256_fmadd_ps(_a, _b1, c##r##1);                    \
+}
+
+
+#define _SGEMM_MK_STORE_ROW_(r) {                                                                   \
+    c##r##0 = _mm256_mul_ps(c##r##0, _alpha);                                                       \
+    c##r##1 = _mm256_mul_ps(c##r##1, _alpha);                                                       \
+    if (S != NULL) {                                                                                \
+        c##r##0 = _mm256_fmadd_ps(_beta, _mm256_loadu_ps(S + r * lds), c##r##0);                    \
+        c##r##1 = _mm256_fmadd_ps(_beta, _mm256_loadu_ps(S + r * lds + 8), c##r##1);                \
+    }                                                                                               \
+    _mm256_storeu_ps(C + r * ldc, c##r##0);                                                         \
+    _mm256_storeu_ps(C + r * ldc + 8, c##r##1);                                                     \
+}
+
+
+_DECX_ISA_BEGIN_AVX2_
+namespace decx
+{
+    namespace avx2
+    {
+        static void _sgemm_kernel_6x16(const int kc, const float* pA, const float* pB, float* C,
+            const size_t ldc, const float* S, const size_t lds, const float alpha, const float beta)
+        {
+            __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps(),
+                c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps(),
+                c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps(),
+                c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps(),
+                c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps(),
+                c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+            __m256 _a, _b0, _b1;
+
+            // C is touched only after the loop, have it in L1 by then
+            for (int r = 0; r < 6; ++r) {
+                _mm_prefetch((const char*)(C + r * ldc), _MM_HINT_T0);
+                _mm_prefetch((const char*)(C + r * ldc + 15), _MM_HINT_T0);
+            }
+
+            for (int k = 0; k < kc; ++k) {
+                // the micro-panel of A streams from L2
+                _mm_prefetch((const char*)(pA + 8 * 6), _MM_HINT_T0);
+
+                _b0 = _mm256_load_ps(pB);
+                _b1 = _mm256_load_ps(pB + 8);
+
+                _SGEMM_MK_ROW_(0);
+                _SGEMM_MK_ROW_(1);
+                _SGEMM_MK_ROW_(2);
+                _SGEMM_MK_ROW_(3);
+                _SGEMM_MK_ROW_(4);
+                _SGEMM_MK_ROW_(5);
+
+                pA += 6;
+                pB += 16;
+            }
+
+            const __m256 _alpha = _mm256_set1_ps(alpha), _beta = _mm256_set1_ps(beta);
+            _SGEMM_MK_STORE_ROW_(0);
+            _SGEMM_MK_STORE_ROW_(1);
+            _SGEMM_MK_STORE_ROW_(2);
+            _SGEMM_MK_STORE_ROW_(3);
+            _SGEMM_MK_STORE_ROW_(4);
+            _SGEMM_MK_STORE_ROW_(5);
+        }
+    }
+}
+_DECX_ISA_END_
+
+
+
+// ------------------------------------------ AVX-512 -----------------------------------------------
+
+
+#define _SGEMM_MK_ROW_512_(r) {                                     \
+    _a = _mm512_set1_ps(pA[r]);                                     \
+    c##r##_0 = _mm512_fmadd_ps(_a, _b0, c##r##_0);                  \
+    c##r##_1 = _mm512_fmadd_ps(_a, _b1, c##r##_1);                  \
+}
+
+
+#define _SGEMM_MK_STORE_ROW_512_(r) {                                                               \
+    c##r##_0 = _mm512_mul_ps(c##r##_0, _alpha);                                                     \
+    c##r##_1 = _mm512_mul_ps(c##r##_1, _alpha);                                                     \
+    if (S != NULL) {                                                                                \
+        c##r##_0 = _mm512_fmadd_ps(_beta, _mm512_loadu_ps(S + r * lds), c##r##_0);                  \
+        c##r##_1 = _mm512_fmadd_ps(_beta, _mm512_loadu_ps(S + r * lds + 16), c##r##_1);             \
+    }                                                                                               \
+    _mm512_storeu_ps(C + r * ldc, c##r##_0);                                                        \
+    _mm512_storeu_ps(C + r * ldc + 16, c##r##_1);                                                   \
+}
+
+
+_DECX_ISA_BEGIN_AVX512_
+namespace decx
+{
+    namespace avx512
+    {
+        static void _sgemm_kernel_12x32(const int kc, const float* pA, const float* pB, float* C,
+            const size_t ldc, const float* S, const size_t lds, const float alpha, const float beta)
+        {
+            __m512 c0_0 = _mm512_setzero_ps(), c0_1 = _mm512_setzero_ps(),
+                c1_0 = _mm512_setzero_ps(), c1_1 = _mm512_setzero_ps(),
+                c2_0 = _mm512_setzero_ps(), c2_1 = _mm512_setzero_ps(),
+                c3_0 = _mm512_setzero_ps(), c3_1 = _mm512_setzero_ps(),
+                c4_0 = _mm512_setzero_ps(), c4_1 = _mm512_setzero_ps(),
+                c5_0 = _mm512_setzero_ps(), c5_1 = _mm512_setzero_ps(),
+                c6_0 = _mm512_setzero_ps(), c6_1 = _mm512_setzero_ps(),
+                c7_0 = _mm512_setzero_ps(), c7_1 = _mm512_setzero_ps(),
+                c8_0 = _mm512_setzero_ps(), c8_1 = _mm512_setzero_ps(),
+                c9_0 = _mm512_setzero_ps(), c9_1 = _mm512_setzero_ps(),
+                c10_0 = _mm512_setzero_ps(), c10_1 = _mm512_setzero_ps(),
+                c11_0 = _mm512_setzero_ps(), c11_1 = _mm512_setzero_ps();
+            __m512 _a, _b0, _b1;
+
+            for (int r = 0; r < 12; ++r) {
+                _mm_prefetch((const char*)(C + r * ldc), _MM_HINT_T0);
+                _mm_prefetch((const char*)(C + r * ldc + 31), _MM_HINT_T0);
+            }
+
+            for (int k = 0; k < kc; ++k) {
+                _mm_prefetch((const char*)(pA + 8 * 12), _MM_HINT_T0);
+
+                // the workspace given by the user is aligned to 32 bytes only
+                _b0 = _mm512_loadu_ps(pB);
+                _b1 = _mm512_loadu_ps(pB + 16);
+
+                _SGEMM_MK_ROW_512_(0);
+                _SGEMM_MK_ROW_512_(1);
+                _SGEMM_MK_ROW_512_(2);
+                _SGEMM_MK_ROW_512_(3);
+                _SGEMM_MK_ROW_512_(4);
+                _SGEMM_MK_ROW_512_(5);
+                _SGEMM_MK_ROW_512_(6);
+                _SGEMM_MK_ROW_512_(7);
+                _SGEMM_MK_ROW_512_(8);
+                _SGEMM_MK_ROW_512_(9);
+                _SGEMM_MK_ROW_512_(10);
+                _SGEMM_MK_ROW_512_(11);
+
+                pA += 12;
+                pB += 32;
+            }
+
+            const __m512 _alpha = _mm512_set1_ps(alpha), _beta = _mm512_set1_ps(beta);
+            _SGEMM_MK_STORE_ROW_512_(0);
+            _SGEMM_MK_STORE_ROW_512_(1);
+            _SGEMM_MK_STORE_ROW_512_(2);
+            _SGEMM_MK_STORE_ROW_512_(3);
+            _SGEMM_MK_STORE_ROW_512_(4);
+            _SGEMM_MK_STORE_ROW_512_(5);
+            _SGEMM_MK_STORE_ROW_512_(6);
+            _SGEMM_MK_STORE_ROW_512_(7);
+            _SGEMM_MK_STORE_ROW_512_(8);
+            _SGEMM_MK_STORE_ROW_512_(9);
+            _SGEMM_MK_STORE_ROW_512_(10);
+            _SGEMM_MK_STORE_ROW_512_(11);
+        }
+    }
+}
+_DECX_ISA_END_
+
+
+
+namespace decx
+{
+    static void _select_sgemm_ukernel(const int isa)
+    {
+        decx::_sgemm_ukernel* uk = &decx::_sgemm_ukernels;
+        switch (isa)
+        {
+        case de::CPU_ISA::ISA_AVX512:
+            uk->mr = 12;        uk->nr = 32;
+            uk->full = &decx::avx512::_sgemm_kernel_12x32;
+            uk->edge = &decx::_gemm_kernel_edge<float, float, &decx::avx512::_sgemm_kernel_12x32, 12, 32>;
+            break;
+        case de::CPU_ISA::ISA_AVX2:
+            uk->mr = 6;         uk->nr = 16;
+            uk->full = &decx::avx2::_sgemm_kernel_6x16;
+            uk->edge = &decx::_gemm_kernel_edge<float, float, &decx::avx2::_sgemm_kernel_6x16, 6, 16>;
+            break;
+        default:
+            uk->mr = 6;         uk->nr = 8;
+            uk->full = &decx::sse42::_sgemm_kernel_6x8;
+            uk->edge = &decx::_gemm_kernel_edge<float, float, &decx::sse42::_sgemm_kernel_6x8, 6, 8>;
+            break;
+        }
+    }
+
+
+    static decx::_ISA_dispatch_reg _sgemm_ukernels_reg(&decx::_select_sgemm_ukernel);
+}
+
+
+#endif
@@ -0,0 +1,427 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+
+#ifndef _SGEMM_SMALL_H_
+#define _SGEMM_SMALL_H_
+
+#include "gemm_blocked.h"
+
+
+/**
+* The small SGEMM, C = alpha * A * B + beta * S for M * N * K up to _SGEMM_SMALL_MAX_MNK_. At these sizes the
+* packing, the thread pool and the edge handling of the blocked SGEMM cost more than the products, so the
+* kernels here read A and B as they are, on the calling thread.
+*
+* A few rows of C are kept in the vector registers while k runs over the whole K :
+*   N = 4, 8, 16, 32 : the kernels specialized on N, the loops over the cols and the vectors are unrolled
+*                      at compile time, and no lane is masked
+*   other N          : the generic kernel, the cols are taken 2 vectors at a time and the last ones masked
+* The rows are taken 6 (or 8) at a time, as many as fit the registers, the rest one by one.
+* AVX-512 uses the AVX2 kernels, a row of C of these sizes is at most 4 ymm.
+*
+* The kernels are not specialized on K. With the loop over k of a constant trip count (K = 4, 8, 16, 32
+* under each N above, so the compiler unrolls it), the cubes of 8 to 32 ran within 5% of these and 4 x 4 x 4
+* slower on SSE4.2 : the loop is a few instructions against the loads and FMAs of a k, and the time of the
+* smallest products goes to the call and to the stores, not to the loop.
+*/
+
+
+// M * N * K of the largest products the small SGEMM takes, 32 x 32 x 32. Beyond it the blocked SGEMM, even on
+// one thread, is faster
+#define _SGEMM_SMALL_MAX_MNK_ (1 << 15)
+
+
+namespace decx
+{
+    typedef decx::_gemm_blocked_info<float, float, float, 1> _sgemm_small_info;
+
+
+    typedef void(*_sgemm_small_kernel_ptr)(const decx::_sgemm_small_info*);
+
+
+    struct _sgemm_small_kernel_table
+    {
+        // the kernels of N = 4, 8, 16 and 32
+        decx::_sgemm_small_kernel_ptr fixed[4];
+        decx::_sgemm_small_kernel_ptr generic;
+    };
+
+
+    // the kernels of the de::CPU_ISA in use
+    decx::_sgemm_small_kernel_table _sgemm_small_kernels;
+
+
+    /**
+    * @return true if the product is for decx::sgemm_small() : small, no transposes, B not prepacked
+    */
+    static bool sgemm_small_eligible(const decx::_sgemm_small_info* info);
+
+
+    /**
+    * @brief C = alpha * A * B + beta * S on the calling thread, picks the kernel of N
+    */
+    static void sgemm_small(const decx::_sgemm_small_info* info);
+}
+
+
+
+// ------------------------------------------ SSE4.2 ------------------------------------------------
+
+
+_DECX_ISA_BEGIN_SSE42_
+namespace decx
+{
+    namespace sse42
+    {
+        static inline __m128 _sgemm_small_out(const __m128 acc, const float* S, const __m128 alpha, const __m128 beta)
+        {
+            return S != NULL ? _mm_add_ps(_mm_mul_ps(acc, alpha), _mm_mul_ps(_mm_loadu_ps(S), beta)) :
+                _mm_mul_ps(acc, alpha);
+        }
+
+
+        // the cols [j, j + 4 * _V) of _R rows of C from row i
+        template <int _V, int _R>
+        static void _sgemm_small_rows(const decx::_sgemm_small_info* info, const int i, const int j)
+        {
+            const __m128 _alpha = _mm_set1_ps(info->alpha), _beta = _mm_set1_ps(info->beta);
+            const float* A = info->A + (size_t)i * info->lda;
+            __m128 acc[_R][_V];
+
+            for (int r = 0; r < _R; ++r) {
+                for (int v = 0; v < _V; ++v) { acc[r][v] = _mm_setzero_ps(); }
+            }
+            for (int k = 0; k < info->K; ++k) {
+                const float* B = info->B + (size_t)k * info->ldb + j;
+                __m128 b[_V];
+                for (int v = 0; v < _V; ++v) { b[v] = _mm_loadu_ps(B + v * 4); }
+
+                for (int r = 0; r < _R; ++r) {
+                    const __m128 a = _mm_set1_ps(A[r * info->lda + k]);
+                    for (int v = 0; v < _V; ++v) { acc[r][v] = _mm_add_ps(acc[r][v], _mm_mul_ps(a, b[v])); }
+                }
+            }
+            for (int r = 0; r < _R; ++r) {
+                float* C = info->C + (size_t)(i + r) * info->ldc + j;
+                const float* S = info->S != NULL ? info->S + (size_t)(i + r) * info->lds + j : NULL;
+                for (int v = 0; v < _V; ++v) {
+                    _mm_storeu_ps(C + v * 4, decx::sse42::_sgemm_small_out(acc[r][v], S != NULL ? S + v * 4 : NULL, _alpha, _beta));
+                }
+            }
+        }
+
+
+        /**
+        * N = _N, by the blocks of 8 cols (one of 4 when _N = 4) : 6 x 2 xmm of C (8 x 1 for _N = 4),
+        * B and a broadcast of A take the rest of the 16 registers
+        */
+        template <int _N>
+        static void _sgemm_small_fixed(const decx::_sgemm_small_info* info)
+        {
+            const int _V = _N >= 8 ? 2 : 1;
+            const int _R = _N >= 8 ? 6 : 8;
+
+            for (int j = 0; j < _N; j += _V * 4) {
+                int i = 0;
+                for (; i + _R <= info->M; i += _R) {
+                    decx::sse42::_sgemm_small_rows<_V, _R>(info, i, j);
+                }
+                for (; i < info->M; ++i) {
+                    decx::sse42::_sgemm_small_rows<_V, 1>(info, i, j);
+                }
+            }
+        }
+
+
+        // the cols [j, j + nr) (nr <= 8) of _R rows of C from row i, the lanes beyond nr are neither loaded nor stored
+        template <int _R>
+        static void _sgemm_small_generic_block(const decx::_sgemm_small_info* info, const int i, const int j, const int nr)
+        {
+            const __m128 _alpha = _mm_set1_ps(info->alpha), _beta = _mm_set1_ps(info->beta);
+            const float* A = info->A + (size_t)i * info->lda;
+            __m128 acc[_R][2];
+            float _tmp[8] = { 0 };
+
+            for (int r = 0; r < _R; ++r) {
+                acc[r][0] = _mm_setzero_ps();       acc[r][1] = _mm_setzero_ps();
+            }
+            for (int k = 0; k < info->K; ++k) {
+                const float* B = info->B + (size_t)k * info->ldb + j;
+                __m128 b0, b1;
+                if (nr == 8) {
+                    b0 = _mm_loadu_ps(B);           b1 = _mm_loadu_ps(B + 4);
+                }
+                else {
+                    for (int c = 0; c < nr; ++c) { _tmp[c] = B[c]; }
+                    b0 = _mm_loadu_ps(_tmp);        b1 = _mm_loadu_ps(_tmp + 4);
+                }
+                for (int r = 0; r < _R; ++r) {
+                    const __m128 a = _mm_set1_ps(A[r * info->lda + k]);
+                    acc[r][0] = _mm_add_ps(acc[r][0], _mm_mul_ps(a, b0));
+                    acc[r][1] = _mm_add_ps(acc[r][1], _mm_mul_ps(a, b1));
+                }
+            }
+            for (int r = 0; r < _R; ++r) {
+                float* C = info->C + (size_t)(i + r) * info->ldc + j;
+                const float* S = info->S != NULL ? info->S + (size_t)(i + r) * info->lds + j : NULL;
+                if (nr == 8) {
+                    _mm_storeu_ps(C, decx::sse42::_sgemm_small_out(acc[r][0], S, _alpha, _beta));
+                    _mm_storeu_ps(C + 4, decx::sse42::_sgemm_small_out(acc[r][1], S != NULL ? S + 4 : NULL, _alpha, _beta));
+                }
+                else {
+                    _mm_storeu_ps(_tmp, _mm_mul_ps(acc[r][0], _alpha));
+                    _mm_storeu_ps(_tmp + 4, _mm_mul_ps(acc[r][1], _alpha));
+                    for (int c = 0; c < nr; ++c) {
+                        C[c] = S != NULL ? _tmp[c] + info->beta * S[c] : _tmp[c];
+                    }
+                }
+            }
+        }
+
+
+        static void _sgemm_small_generic(const decx::_sgemm_small_info* info)
+        {
+            for (int j = 0; j < info->N; j += 8) {
+                const int nr = decx::utils::clamp_max<int>(info->N - j, 8);
+                int i = 0;
+                for (; i + 6 <= info->M; i += 6) {
+                    decx::sse42::_sgemm_small_generic_block<6>(info, i, j, nr);
+                }
+                for (; i < info->M; ++i) {
+                    decx::sse42::_sgemm_small_generic_block<1>(info, i, j, nr);
+                }
+            }
+        }
+    }
+}
+_DECX_ISA_END_
+
+
+
+// ------------------------------------------- AVX2 -------------------------------------------------
+
+
+_DECX_ISA_BEGIN_AVX2_
+namespace decx
+{
+    namespace avx2
+    {
+        static inline __m256 _sgemm_small_out(const __m256 acc, const float* S, const __m256 alpha, const __m256 beta)
+        {
+            return S != NULL ? _mm256_fmadd_ps(_mm256_loadu_ps(S), beta, _mm256_mul_ps(acc, alpha)) :
+                _mm256_mul_ps(acc, alpha);
+        }
+
+
+        // the cols [j, j + 8 * _V) of _R rows of C from row i
+        template <int _V, int _R>
+        static void _sgemm_small_rows(const decx::_sgemm_small_info* info, const int i, const int j)
+        {
+            const __m256 _alpha = _mm256_set1_ps(info->alpha), _beta = _mm256_set1_ps(info->beta);
+            const float* A = info->A + (size_t)i * info->lda;
+            __m256 acc[_R][_V];
+
+            for (int r = 0; r < _R; ++r) {
+                for (int v = 0; v < _V; ++v) { acc[r][v] = _mm256_setzero_ps(); }
+            }
+            for (int k = 0; k < info->K; ++k) {
+                const float* B = info->B + (size_t)k * info->ldb + j;
+                __m256 b[_V];
+                for (int v = 0; v < _V; ++v) { b[v] = _mm256_loadu_ps(B + v * 8); }
+
+                for (int r = 0; r < _R; ++r) {
+                    const __m256 a = _mm256_broadcast_ss(A + r * info->lda + k);
+                    for (int v = 0; v < _V; ++v) { acc[r][v] = _mm256_fmadd_ps(a, b[v], acc[r][v]); }
+                }
+            }
+            for (int r = 0; r < _R; ++r) {
+                float* C = info->C + (size_t)(i + r) * info->ldc + j;
+                const float* S = info->S != NULL ? info->S + (size_t)(i + r) * info->lds + j : NULL;
+                for (int v = 0; v < _V; ++v) {
+                    _mm256_storeu_ps(C + v * 8, decx::avx2::_sgemm_small_out(acc[r][v], S != NULL ? S + v * 8 : NULL, _alpha, _beta));
+                }
+            }
+        }
+
+
+        // N = 4, _R rows of one xmm each
+        template <int _R>
+        static void _sgemm_small_rows_4(const decx::_sgemm_small_info* info, const int i)
+        {
+            const __m128 _alpha = _mm_set1_ps(info->alpha), _beta = _mm_set1_ps(info->beta);
+            const float* A = info->A + (size_t)i * info->lda;
+            __m128 acc[_R];
+
+            for (int r = 0; r < _R; ++r) { acc[r] = _mm_setzero_ps(); }
+            for (int k = 0; k < info->K; ++k) {
+                const __m128 b = _mm_loadu_ps(info->B + (size_t)k * info->ldb);
+                for (int r = 0; r < _R; ++r) {
+                    acc[r] = _mm_fmadd_ps(_mm_broadcast_ss(A + r * info->lda + k), b, acc[r]);
+                }
+            }
+            for (int r = 0; r < _R; ++r) {
+                __m128 _res = _mm_mul_ps(acc[r], _alpha);
+                if (info->S != NULL) {
+                    _res = _mm_fmadd_ps(_mm_loadu_ps(info->S + (size_t)(i + r) * info->lds), _beta, _res);
+                }
+                _mm_storeu_ps(info->C + (size_t)(i + r) * info->ldc, _res);
+            }
+        }
+
+
+        /**
+        * N = _N, by the blocks of 16 cols (one of 8 when _N = 8) : 6 x 2 ymm of C (8 x 1 for _N = 8),
+        * as the micro-kernel of the blocked SGEMM, B and a broadcast of A take the rest of the 16 registers
+        */
+        template <int _N>
+        static void _sgemm_small_fixed(const decx::_sgemm_small_info* info)
+        {
+            const int _V = _N >= 16 ? 2 : 1;
+            const int _R = _N >= 16 ? 6 : 8;
+
+            for (int j = 0; j < _N; j += _V * 8) {
+                int i = 0;
+                for (; i + _R <= info->M; i += _R) {
+                    decx::avx2::_sgemm_small_rows<_V, _R>(info, i, j);
+                }
+                for (; i < info->M; ++i) {
+                    decx::avx2::_sgemm_small_rows<_V, 1>(info, i, j);
+                }
+            }
+        }
+
+
+        static void _sgemm_small_fixed_4(const decx::_sgemm_small_info* info)
+        {
+            int i = 0;
+            for (; i + 8 <= info->M; i += 8) {
+                decx::avx2::_sgemm_small_rows_4<8>(info, i);
+            }
+            for (; i < info->M; ++i) {
+                decx::avx2::_sgemm_small_rows_4<1>(info, i);
+            }
+        }
+
+
+        // the cols [j, j + nr) (nr <= 16) of _R rows of C from row i, the lanes beyond nr are masked
+        template <int _R>
+        static void _sgemm_small_generic_block(const decx::_sgemm_small_info* info, const int i, const int j, const int nr)
+        {
+            const __m256 _alpha = _mm256_set1_ps(info->alpha), _beta = _mm256_set1_ps(info->beta);
+            const __m256i _lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+            const __m256i _mask0 = _mm256_cmpgt_epi32(_mm256_set1_epi32(nr), _lane);
+            const __m256i _mask1 = _mm256_cmpgt_epi32(_mm256_set1_epi32(nr - 8), _lane);
+            const float* A = info->A + (size_t)i * info->lda;
+            __m256 acc[_R][2];
+
+            for (int r = 0; r < _R; ++r) {
+                acc[r][0] = _mm256_setzero_ps();    acc[r][1] = _mm256_setzero_ps();
+            }
+            for (int k = 0; k < info->K; ++k) {
+                const float* B = info->B + (size_t)k * info->ldb + j;
+                const __m256 b0 = _mm256_maskload_ps(B, _mask0), b1 = _mm256_maskload_ps(B + 8, _mask1);
+                for (int r = 0; r < _R; ++r) {
+                    const __m256 a = _mm256_broadcast_ss(A + r * info->lda + k);
+                    acc[r][0] = _mm256_fmadd_ps(a, b0, acc[r][0]);
+                    acc[r][1] = _mm256_fmadd_ps(a, b1, acc[r][1]);
+                }
+            }
+            for (int r = 0; r < _R; ++r) {
+                float* C = info->C + (size_t)(i + r) * info->ldc + j;
+                __m256 _res0 = _mm256_mul_ps(acc[r][0], _alpha), _res1 = _mm256_mul_ps(acc[r][1], _alpha);
+                if (info->S != NULL) {
+                    const float* S = info->S + (size_t)(i + r) * info->lds + j;
+                    _res0 = _mm256_fmadd_ps(_mm256_maskload_ps(S, _mask0), _beta, _res0);
+                    _res1 = _mm256_fmadd_ps(_mm256_maskload_ps(S + 8, _mask1), _beta, _res1);
+                }
+                _mm256_maskstore_ps(C, _mask0, _res0);
+                _mm256_maskstore_ps(C + 8, _mask1, _res1);
+            }
+        }
+
+
+        static void _sgemm_small_generic(const decx::_sgemm_small_info* info)
+        {
+            for (int j = 0; j < info->N; j += 16) {
+                const int nr = decx::utils::clamp_max<int>(info->N - j, 16);
+                int i = 0;
+                for (; i + 6 <= info->M; i += 6) {
+                    decx::avx2::_sgemm_small_generic_block<6>(info, i, j, nr);
+                }
+                for (; i < info->M; ++i) {
+                    decx::avx2::_sgemm_small_generic_block<1>(info, i, j, nr);
+                }
+            }
+        }
+    }
+}
+_DECX_ISA_END_
+
+
+
+namespace decx
+{
+    static void _select_sgemm_small_kernels(const int isa)
+    {
+        decx::_sgemm_small_kernel_table* t = &decx::_sgemm_small_kernels;
+        switch (isa)
+        {
+        case de::CPU_ISA::ISA_AVX512:
+        case de::CPU_ISA::ISA_AVX2:
+            t->fixed[0] = &decx::avx2::_sgemm_small_fixed_4;
+            t->fixed[1] = &decx::avx2::_sgemm_small_fixed<8>;
+            t->fixed[2] = &decx::avx2::_sgemm_small_fixed<16>;
+            t->fixed[3] = &decx::avx2::_sgemm_small_fixed<32>;
+            t->generic = &decx::avx2::_sgemm_small_generic;
+            break;
+        default:
+            t->fixed[0] = &decx::sse42::_sgemm_small_fixed<4>;
+            t->fixed[1] = &decx::sse42::_sgemm_small_fixed<8>;
+            t->fixed[2] = &decx::sse42::_sgemm_small_fixed<16>;
+            t->fixed[3] = &decx::sse42::_sgemm_small_fixed<32>;
+            t->generic = &decx::sse42::_sgemm_small_generic;
+            break;
+        }
+    }
+
+
+    static decx::_ISA_dispatch_reg _sgemm_small_kernels_reg(&decx::_select_sgemm_small_kernels);
+}
+
+
+
+static bool decx::sgemm_small_eligible(const decx::_sgemm_small_info* info)
+{
+    return !info->transA && !info->transB && info->pB == NULL &&
+        (size_t)info->M * (size_t)info->N * (size_t)info->K <= _SGEMM_SMALL_MAX_MNK_;
+}
+
+
+
+static void decx::sgemm_small(const decx::_sgemm_small_info* info)
+{
+    const decx::_sgemm_small_kernel_table* t = &decx::_sgemm_small_kernels;
+    switch (info->N)
+    {
+    case 4:
+        t->fixed[0](info);      break;
+    case 8:
+        t->fixed[1](info);      break;
+    case 16:
+        t->fixed[2](info);      break;
+    case 32:
+        t->fixed[3](info);      break;
+    default:
+        t->generic(info);       break;
+    }
+}
+
+
+#endif
@@ -0,0 +1,277 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+
+#ifndef _SGEMM_STRASSEN_H_
+#define _SGEMM_STRASSEN_H_
+
+#include "sgemm_blocked.h"
+#include "../../core/allocators.h"
+#include "../../core/thread_management/parallel_for.h"
+
+
+/**
+* The Strassen-Winograd recursion over the blocked SGEMM, for the large products, opted in by
+* de::cpu::SetStrassenLevels(). One level splits A, B and C into 2 x 2 blocks and computes C by 7 products
+* of the halves (instead of 8) and 15 additions of blocks (the Winograd form) :
+*
+*   S1 = A21 + A22    S2 = S1 - A11    S3 = A11 - A21    S4 = A12 - S2
+*   T1 = B12 - B11    T2 = B22 - T1    T3 = B22 - B12    T4 = T2 - B21
+*   P1 = A11 B11   P2 = A12 B21   P3 = S4 B22   P4 = A22 T4   P5 = S1 T1   P6 = S2 T2   P7 = S3 T3
+*   C11 = P1 + P2    C12 = P1 + P6 + P5 + P3    C21 = P1 + P6 + P7 - P4    C22 = P1 + P6 + P7 + P5
+*
+* The products are the next level, or decx::sgemm_blocked() (multithreaded) at the last one. The additions
+* are streamed over the blocks by decx::parallel_for(). C12, C21 and C22 hold the partial sums, so one level
+* takes X (m x k), Y (k x n) and Z (m x n) of workspace, allocated once from the memory pool for all the levels.
+* The odd row, col or k of a level is peeled and done by the blocked SGEMM.
+*
+* Error : the classic product is bounded element by element, |C - C'| <= K u |A| |B| (u = 2^-24). The
+* Winograd form is bounded by the norms only (Higham, Accuracy and Stability of Numerical Algorithms, 23.2),
+*   max |C - C'| <= [(n0^2 + 5 n0) 18^l - 5n] u max|A| max|B|,   n0 = n / 2^l the size of the products
+* of the last level. So each level costs about a decimal digit in the worst case, and the elements of C much
+* smaller than max|A| max|B| (the rows or cols of A and B of very different scales) lose their relative
+* accuracy. On the matrices of one scale the error measured is a few times that of the classic product.
+*/
+
+
+// the least M, N and K a level is applied to, below it the additions cost more than the product saved
+#define _SGEMM_STRASSEN_CROSSOVER_ 2048
+#define _SGEMM_STRASSEN_MAX_LEVELS_ 2
+
+
+namespace de
+{
+    namespace cpu
+    {
+        /**
+        * @brief Let de::cpu::sgemm(A, B, dst) apply up to max_levels (0 to 2) levels of the Strassen-Winograd
+        * recursion, on the products whose M, N and K are at least _SGEMM_STRASSEN_CROSSOVER_ at the level.
+        * 0 (the default) keeps the classic product. Trades accuracy for time, see sgemm_strassen.h.
+        */
+        _DECX_API_ de::DH SetStrassenLevels(const int max_levels);
+
+
+        _DECX_API_ int GetStrassenLevels();
+    }
+}
+
+
+
+namespace decx
+{
+    // the levels de::cpu::SetStrassenLevels() allows, 0 by default
+    int _sgemm_strassen_levels = 0;
+
+
+    /**
+    * @return The levels of the recursion applied to M x N x K, at most max_levels
+    */
+    static int sgemm_strassen_depth(const int M, const int N, const int K, const int max_levels);
+
+
+    /**
+    * @return The length (in floats) of the workspace of the levels
+    */
+    static size_t sgemm_strassen_workspace_len(const int M, const int N, const int K, const int levels);
+
+
+    /**
+    * @brief C = A * B of info by the levels of the recursion, info->alpha, beta, S and the transposes are not
+    * supported (1, 0, NULL and none)
+    * @return false if the workspace can not be allocated
+    */
+    static bool sgemm_strassen(const decx::_sgemm_blocked_info* info, const int levels);
+
+
+    // D = X + sign * Y, m x n, multithreaded by rows. D can be X or Y
+    static void _strassen_add(float* D, const size_t ldd, const float* X, const size_t ldx, const float* Y,
+        const size_t ldy, const int m, const int n, const float sign);
+
+
+    /**
+    * @brief C = A * B (or beta * S + A * B), M x N x K, by the blocked SGEMM of the micro-kernel and the block sizes
+    * of proto
+    */
+    static bool _strassen_gemm(const decx::_sgemm_blocked_info* proto, const float* A, const size_t lda,
+        const float* B, const size_t ldb, float* C, const size_t ldc, const int M, const int N, const int K,
+        const float* S, const size_t lds, const float beta);
+
+
+    static bool _sgemm_strassen_level(const decx::_sgemm_blocked_info* proto, const float* A, const size_t lda,
+        const float* B, const size_t ldb, float* C, const size_t ldc, const int M, const int N, const int K,
+        const int levels, float* workspace);
+}
+
+
+
+static int decx::sgemm_strassen_depth(const int M, const int N, const int K, const int max_levels)
+{
+    int levels = 0, _min = decx::utils::clamp_max<int>(decx::utils::clamp_max<int>(M, N), K);
+    while (levels < max_levels && _min >= _SGEMM_STRASSEN_CROSSOVER_) {
+        ++levels;
+        _min /= 2;
+    }
+    return levels;
+}
+
+
+
+static size_t decx::sgemm_strassen_workspace_len(const int M, const int N, const int K, const int levels)
+{
+    if (levels == 0) {
+        return 0;
+    }
+    const size_t m = M / 2, n = N / 2, k = K / 2;
+    // each of X, Y and Z starts at 64 bytes
+    return decx::utils::ceil<size_t>(m * k, 16) * 16 + decx::utils::ceil<size_t>(k * n, 16) * 16 +
+        decx::utils::ceil<size_t>(m * n, 16) * 16 + decx::sgemm_strassen_workspace_len(m, n, k, levels - 1);
+}
+
+
+
+static void decx::_strassen_add(float* D, const size_t ldd, const float* X, const size_t ldx, const float* Y,
+    const size_t ldy, const int m, const int n, const float sign)
+{
+    const size_t _grain = decx::utils::clamp_min<size_t>((1 << 16) / decx::utils::clamp_min<int>(n, 1), 1);
+    decx::parallel_for(0, m, [&](const size_t _beg, const size_t _end) {
+        for (size_t i = _beg; i < _end; ++i) {
+            float* _D = D + i * ldd;
+            const float* _X = X + i * ldx, * _Y = Y + i * ldy;
+            for (int j = 0; j < n; ++j) {
+                _D[j] = _X[j] + sign * _Y[j];
+            }
+        }
+    }, _grain);
+}
+
+
+
+static bool decx::_strassen_gemm(const decx::_sgemm_blocked_info* proto, const float* A, const size_t lda,
+    const float* B, const size_t ldb, float* C, const size_t ldc, const int M, const int N, const int K,
+    const float* S, const size_t lds, const float beta)
+{
+    decx::_sgemm_blocked_info info = *proto;
+    info.A = A;         info.lda = lda;
+    info.B = B;         info.ldb = ldb;
+    info.C = C;         info.ldc = ldc;
+    info.M = M;         info.N = N;         info.K = K;
+    info.S = S;         info.lds = lds;
+    info.alpha = 1.f;   info.beta = beta;
+    return decx::sgemm_blocked(&info, NULL);
+}
+
+
+
+static bool decx::_sgemm_strassen_level(const decx::_sgemm_blocked_info* proto, const float* A, const size_t lda,
+    const float* B, const size_t ldb, float* C, const size_t ldc, const int M, const int N, const int K,
+    const int levels, float* workspace)
+{
+    if (levels == 0) {
+        return decx::_strassen_gemm(proto, A, lda, B, ldb, C, ldc, M, N, K, NULL, 0, 0.f);
+    }
+
+    const int m = M / 2, n = N / 2, k = K / 2;
+    const float* A11 = A, * A12 = A + k, * A21 = A + (size_t)m * lda, * A22 = A21 + k;
+    const float* B11 = B, * B12 = B + n, * B21 = B + (size_t)k * ldb, * B22 = B21 + n;
+    float* C11 = C, * C12 = C + n, * C21 = C + (size_t)m * ldc, * C22 = C21 + n;
+
+    float* X = workspace;
+    float* Y = X + decx::utils::ceil<size_t>((size_t)m * k, 16) * 16;
+    float* Z = Y + decx::utils::ceil<size_t>((size_t)k * n, 16) * 16;
+    float* _next = Z + decx::utils::ceil<size_t>((size_t)m * n, 16) * 16;
+
+    bool _ok = true;
+    // C21 = P7 = S3 * T3
+    decx::_strassen_add(X, k, A11, lda, A21, lda, m, k, -1.f);
+    decx::_strassen_add(Y, n, B22, ldb, B12, ldb, k, n, -1.f);
+    _ok = _ok && decx::_sgemm_strassen_level(proto, X, k, Y, n, C21, ldc, m, n, k, levels - 1, _next);
+    // C22 = P5 = S1 * T1
+    decx::_strassen_add(X, k, A21, lda, A22, lda, m, k, 1.f);
+    decx::_strassen_add(Y, n, B12, ldb, B11, ldb, k, n, -1.f);
+    _ok = _ok && decx::_sgemm_strassen_level(proto, X, k, Y, n, C22, ldc, m, n, k, levels - 1, _next);
+    // C12 = P6 = S2 * T2
+    decx::_strassen_add(X, k, X, k, A11, lda, m, k, -1.f);
+    decx::_strassen_add(Y, n, B22, ldb, Y, n, k, n, -1.f);
+    _ok = _ok && decx::_sgemm_strassen_level(proto, X, k, Y, n, C12, ldc, m, n, k, levels - 1, _next);
+    // C11 = P3 = S4 * B22
+    decx::_strassen_add(X, k, A12, lda, X, k, m, k, -1.f);
+    _ok = _ok && decx::_sgemm_strassen_level(proto, X, k, B22, ldb, C11, ldc, m, n, k, levels - 1, _next);
+    // Z = P1
+    _ok = _ok && decx::_sgemm_strassen_level(proto, A11, lda, B11, ldb, Z, n, m, n, k, levels - 1, _next);
+
+    // C12 = P1 + P6 (U2), C21 = U2 + P7 (U3), C12 = U2 + P5 + P3, C22 = U3 + P5
+    decx::_strassen_add(C12, ldc, C12, ldc, Z, n, m, n, 1.f);
+    decx::_strassen_add(C21, ldc, C21, ldc, C12, ldc, m, n, 1.f);
+    decx::_strassen_add(C12, ldc, C12, ldc, C22, ldc, m, n, 1.f);
+    decx::_strassen_add(C12, ldc, C12, ldc, C11, ldc, m, n, 1.f);
+    decx::_strassen_add(C22, ldc, C22, ldc, C21, ldc, m, n, 1.f);
+
+    // C11 = P2 + P1
+    _ok = _ok && decx::_sgemm_strassen_level(proto, A12, lda, B21, ldb, C11, ldc, m, n, k, levels - 1, _next);
+    decx::_strassen_add(C11, ldc, C11, ldc, Z, n, m, n, 1.f);
+    // C21 = U3 - P4, P4 = A22 * T4
+    decx::_strassen_add(Y, n, Y, n, B21, ldb, k, n, -1.f);
+    _ok = _ok && decx::_sgemm_strassen_level(proto, A22, lda, Y, n, Z, n, m, n, k, levels - 1, _next);
+    decx::_strassen_add(C21, ldc, C21, ldc, Z, n, m, n, -1.f);
+
+    // the odd k, col and row
+    if (K % 2) {
+        _ok = _ok && decx::_strassen_gemm(proto, A + K - 1, lda, B + (size_t)(K - 1) * ldb, ldb, C, ldc,
+            2 * m, 2 * n, 1, C, ldc, 1.f);
+    }
+    if (N % 2) {
+        _ok = _ok && decx::_strassen_gemm(proto, A, lda, B + N - 1, ldb, C + N - 1, ldc, M, 1, K, NULL, 0, 0.f);
+    }
+    if (M % 2) {
+        _ok = _ok && decx::_strassen_gemm(proto, A + (size_t)(M - 1) * lda, lda, B, ldb, C + (size_t)(M - 1) * ldc,
+            ldc, 1, 2 * n, K, NULL, 0, 0.f);
+    }
+    return _ok;
+}
+
+
+
+static bool decx::sgemm_strassen(const decx::_sgemm_blocked_info* info, const int levels)
+{
+    decx::PtrInfo<float> _workspace;
+    const size_t _len = decx::sgemm_strassen_workspace_len(info->M, info->N, info->K, levels);
+    if (decx::alloc::_host_virtual_page_malloc<float>(&_workspace, _len * sizeof(float))) {
+        return false;
+    }
+
+    const bool _ok = decx::_sgemm_strassen_level(info, info->A, info->lda, info->B, info->ldb, info->C, info->ldc,
+        info->M, info->N, info->K, levels, _workspace.ptr);
+
+    decx::alloc::_host_virtual_page_dealloc(&_workspace);
+    return _ok;
+}
+
+
+
+de::DH de::cpu::SetStrassenLevels(const int max_levels)
+{
+    de::DH handle;
+    if (max_levels < 0 || max_levels > _SGEMM_STRASSEN_MAX_LEVELS_) {
+        decx::MeaninglessFlag(&handle);
+        return handle;
+    }
+    decx::_sgemm_strassen_levels = max_levels;
+    decx::Success(&handle);
+    return handle;
+}
+
+
+
+int de::cpu::GetStrassenLevels()
+{
+    return decx::_sgemm_strassen_levels;
+}
+
+
+#endif
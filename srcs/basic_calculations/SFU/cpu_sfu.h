@@ -0,0 +1,550 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+#ifndef _CPU_SFU_H_
+#define _CPU_SFU_H_
+
+#include "../../classes/Matrix.h"
+#include "../../classes/Vector.h"
+#include "../operators/Tensor/cpu_tensor_ew.h"
+#include "sfu_exec.h"
+
+
+// pow, next to the unary functions of decx::_sfu_kernel_table
+#define _SFU_POW_ _SFU_FUNC_NUM_
+
+
+namespace de
+{
+    namespace cpu
+    {
+        // the variant of the transcendental functions
+        enum SFU_Precision
+        {
+            SFU_Fast = 0x00,
+            SFU_Accurate = 0x01,
+        };
+
+
+        /**
+        * @brief dst = e^src, of float and double. dst is reshaped to src if it differs, and can be src
+        * @param precision : de::cpu::SFU_Fast or de::cpu::SFU_Accurate (see sfu_isa_kernels.h for the errors)
+        * @return decx::MeaninglessFlag if precision is neither
+        */
+        template <typename T>
+        _DECX_API_ de::DH Exp(de::Matrix<T>& src, de::Matrix<T>& dst, const int precision = de::cpu::SFU_Fast);
+
+
+        template <typename T>
+        _DECX_API_ de::DH Exp(de::Vector<T>& src, de::Vector<T>& dst, const int precision = de::cpu::SFU_Fast);
+
+
+        template <typename T>
+        _DECX_API_ de::DH Exp(de::Tensor<T>& src, de::Tensor<T>& dst, const int precision = de::cpu::SFU_Fast);
+
+
+        /**
+        * @brief dst = log(src), the natural logarithm
+        */
+        template <typename T>
+        _DECX_API_ de::DH Log(de::Matrix<T>& src, de::Matrix<T>& dst, const int precision = de::cpu::SFU_Fast);
+
+
+        template <typename T>
+        _DECX_API_ de::DH Log(de::Vector<T>& src, de::Vector<T>& dst, const int precision = de::cpu::SFU_Fast);
+
+
+        template <typename T>
+        _DECX_API_ de::DH Log(de::Tensor<T>& src, de::Tensor<T>& dst, const int precision = de::cpu::SFU_Fast);
+
+
+        /**
+        * @brief dst = sin(src)
+        */
+        template <typename T>
+        _DECX_API_ de::DH Sin(de::Matrix<T>& src, de::Matrix<T>& dst, const int precision = de::cpu::SFU_Fast);
+
+
+        template <typename T>
+        _DECX_API_ de::DH Sin(de::Vector<T>& src, de::Vector<T>& dst, const int precision = de::cpu::SFU_Fast);
+
+
+        template <typename T>
+        _DECX_API_ de::DH Sin(de::Tensor<T>& src, de::Tensor<T>& dst, const int precision = de::cpu::SFU_Fast);
+
+
+        /**
+        * @brief dst = cos(src)
+        */
+        template <typename T>
+        _DECX_API_ de::DH Cos(de::Matrix<T>& src, de::Matrix<T>& dst, const int precision = de::cpu::SFU_Fast);
+
+
+        template <typename T>
+        _DECX_API_ de::DH Cos(de::Vector<T>& src, de::Vector<T>& dst, const int precision = de::cpu::SFU_Fast);
+
+
+        template <typename T>
+        _DECX_API_ de::DH Cos(de::Tensor<T>& src, de::Tensor<T>& dst, const int precision = de::cpu::SFU_Fast);
+
+
+        /**
+        * @brief dst = tan(src)
+        */
+        template <typename T>
+        _DECX_API_ de::DH Tan(de::Matrix<T>& src, de::Matrix<T>& dst, const int precision = de::cpu::SFU_Fast);
+
+
+        template <typename T>
+        _DECX_API_ de::DH Tan(de::Vector<T>& src, de::Vector<T>& dst, const int precision = de::cpu::SFU_Fast);
+
+
+        template <typename T>
+        _DECX_API_ de::DH Tan(de::Tensor<T>& src, de::Tensor<T>& dst, const int precision = de::cpu::SFU_Fast);
+
+
+        /**
+        * @brief dst = tanh(src)
+        */
+        template <typename T>
+        _DECX_API_ de::DH Tanh(de::Matrix<T>& src, de::Matrix<T>& dst, const int precision = de::cpu::SFU_Fast);
+
+
+        template <typename T>
+        _DECX_API_ de::DH Tanh(de::Vector<T>& src, de::Vector<T>& dst, const int precision = de::cpu::SFU_Fast);
+
+
+        template <typename T>
+        _DECX_API_ de::DH Tanh(de::Tensor<T>& src, de::Tensor<T>& dst, const int precision = de::cpu::SFU_Fast);
+
+
+        /**
+        * @brief dst = 1 / (1 + e^-src)
+        */
+        template <typename T>
+        _DECX_API_ de::DH Sigmoid(de::Matrix<T>& src, de::Matrix<T>& dst, const int precision = de::cpu::SFU_Fast);
+
+
+        template <typename T>
+        _DECX_API_ de::DH Sigmoid(de::Vector<T>& src, de::Vector<T>& dst, const int precision = de::cpu::SFU_Fast);
+
+
+        template <typename T>
+        _DECX_API_ de::DH Sigmoid(de::Tensor<T>& src, de::Tensor<T>& dst, const int precision = de::cpu::SFU_Fast);
+
+
+        /**
+        * @brief dst = src ^ p. The negative elements are raised to the integral p only, NaN otherwise
+        */
+        template <typename T>
+        _DECX_API_ de::DH Pow(de::Matrix<T>& src, const T p, de::Matrix<T>& dst, const int precision = de::cpu::SFU_Fast);
+
+
+        template <typename T>
+        _DECX_API_ de::DH Pow(de::Vector<T>& src, const T p, de::Vector<T>& dst, const int precision = de::cpu::SFU_Fast);
+
+
+        template <typename T>
+        _DECX_API_ de::DH Pow(de::Tensor<T>& src, const T p, de::Tensor<T>& dst, const int precision = de::cpu::SFU_Fast);
+
+    }
+}
+
+
+
+namespace decx
+{
+    template <typename T>
+    static void _sfu_shape_as(decx::_Matrix<T>* dst, const decx::_Matrix<T>* src);
+
+
+    template <typename T>
+    static void _sfu_shape_as(decx::_Vector<T>* dst, const decx::_Vector<T>* src);
+
+
+    template <typename T>
+    static void _sfu_shape_as(decx::_Tensor<T>* dst, const decx::_Tensor<T>* src) { decx::_ew_shape_as(dst, src); }
+
+
+    // dst = f(src) of op, or src ^ p if op is _SFU_POW_
+    template <typename T>
+    static void _sfu_run(decx::_Matrix<T>* src, decx::_Matrix<T>* dst, const int op, const T p, const bool acc);
+
+
+    template <typename T>
+    static void _sfu_run(decx::_Vector<T>* src, decx::_Vector<T>* dst, const int op, const T p, const bool acc);
+
+
+    // the padding of the widths is skipped whenever there is any, a polynomial costs more than its traffic
+    template <typename T>
+    static void _sfu_run(decx::_Tensor<T>* src, decx::_Tensor<T>* dst, const int op, const T p, const bool acc);
+
+
+    /**
+    * @brief The checks of the initialization and of precision, shared by the functions of de::cpu::Exp() ...
+    * of all the classes (_Tc is decx::_Matrix<T>, decx::_Vector<T> or decx::_Tensor<T>)
+    */
+    template <typename T, class _Tc>
+    static de::DH _sfu_caller(_Tc* src, _Tc* dst, const int op, const T p, const int precision);
+}
+
+
+
+template <typename T>
+static void decx::_sfu_shape_as(decx::_Matrix<T>* dst, const decx::_Matrix<T>* src)
+{
+    if (dst->width != src->width || dst->height != src->height) {
+        dst->re_construct(src->width, src->height, decx::DATA_STORE_TYPE::Page_Default);
+    }
+}
+
+
+
+template <typename T>
+static void decx::_sfu_shape_as(decx::_Vector<T>* dst, const decx::_Vector<T>* src)
+{
+    if (dst->length != src->length) {
+        dst->re_construct(src->length, decx::DATA_STORE_TYPE::Page_Default);
+    }
+}
+
+
+
+template <typename T>
+static void decx::_sfu_run(decx::_Matrix<T>* src, decx::_Matrix<T>* dst, const int op, const T p, const bool acc)
+{
+    if (op == _SFU_POW_) {
+        decx::sfu_pow<T>(src->Mat.ptr, p, dst->Mat.ptr, src->_element_num, acc);
+    }
+    else {
+        decx::sfu_eval<T>(op, src->Mat.ptr, dst->Mat.ptr, src->_element_num, acc);
+    }
+}
+
+
+
+template <typename T>
+static void decx::_sfu_run(decx::_Vector<T>* src, decx::_Vector<T>* dst, const int op, const T p, const bool acc)
+{
+    if (op == _SFU_POW_) {
+        decx::sfu_pow<T>(src->Vec.ptr, p, dst->Vec.ptr, src->length, acc);
+    }
+    else {
+        decx::sfu_eval<T>(op, src->Vec.ptr, dst->Vec.ptr, src->length, acc);
+    }
+}
+
+
+
+template <typename T>
+static void decx::_sfu_run(decx::_Tensor<T>* src, decx::_Tensor<T>* dst, const int op, const T p, const bool acc)
+{
+    const decx::_ew_tensor_layout layout = decx::_ew_layout_of(src);
+    const T* _src = src->Tens.ptr;
+    T* _dst = dst->Tens.ptr;
+
+    if (op == _SFU_POW_) {
+        const auto _kernel = decx::_sfu_typed_kernels<T>::pow(acc);
+        decx::_ew_tensor_for(&layout, 1, layout.row_len < layout.pitch, [&](const size_t offset, const size_t len) {
+            _kernel(_src + offset, p, _dst + offset, len);
+        });
+    }
+    else {
+        const auto _kernel = decx::_sfu_typed_kernels<T>::f(op, acc);
+        decx::_ew_tensor_for(&layout, 1, layout.row_len < layout.pitch, [&](const size_t offset, const size_t len) {
+            _kernel(_src + offset, _dst + offset, len);
+        });
+    }
+}
+
+
+
+template <typename T, class _Tc>
+static de::DH decx::_sfu_caller(_Tc* src, _Tc* dst, const int op, const T p, const int precision)
+{
+    de::DH handle;
+    decx::_ew_check_init(&handle);
+    if (precision != de::cpu::SFU_Fast && precision != de::cpu::SFU_Accurate) {
+        decx::MeaninglessFlag(&handle);
+        return handle;
+    }
+    decx::_sfu_shape_as(dst, src);
+
+    decx::_sfu_run(src, dst, op, p, precision == de::cpu::SFU_Accurate);
+    decx::Success(&handle);
+    return handle;
+}
+
+
+
+template <typename T>
+de::DH de::cpu::Exp(de::Matrix<T>& src, de::Matrix<T>& dst, const int precision)
+{
+    return decx::_sfu_caller<T>(dynamic_cast<decx::_Matrix<T>*>(&src), dynamic_cast<decx::_Matrix<T>*>(&dst), _SFU_EXP_, 0, precision);
+}
+
+template _DECX_API_ de::DH de::cpu::Exp(de::Matrix<float>& src, de::Matrix<float>& dst, const int precision);
+
+template _DECX_API_ de::DH de::cpu::Exp(de::Matrix<double>& src, de::Matrix<double>& dst, const int precision);
+
+
+template <typename T>
+de::DH de::cpu::Exp(de::Vector<T>& src, de::Vector<T>& dst, const int precision)
+{
+    return decx::_sfu_caller<T>(dynamic_cast<decx::_Vector<T>*>(&src), dynamic_cast<decx::_Vector<T>*>(&dst), _SFU_EXP_, 0, precision);
+}
+
+template _DECX_API_ de::DH de::cpu::Exp(de::Vector<float>& src, de::Vector<float>& dst, const int precision);
+
+template _DECX_API_ de::DH de::cpu::Exp(de::Vector<double>& src, de::Vector<double>& dst, const int precision);
+
+
+template <typename T>
+de::DH de::cpu::Exp(de::Tensor<T>& src, de::Tensor<T>& dst, const int precision)
+{
+    return decx::_sfu_caller<T>(dynamic_cast<decx::_Tensor<T>*>(&src), dynamic_cast<decx::_Tensor<T>*>(&dst), _SFU_EXP_, 0, precision);
+}
+
+template _DECX_API_ de::DH de::cpu::Exp(de::Tensor<float>& src, de::Tensor<float>& dst, const int precision);
+
+template _DECX_API_ de::DH de::cpu::Exp(de::Tensor<double>& src, de::Tensor<double>& dst, const int precision);
+
+
+template <typename T>
+de::DH de::cpu::Log(de::Matrix<T>& src, de::Matrix<T>& dst, const int precision)
+{
+    return decx::_sfu_caller<T>(dynamic_cast<decx::_Matrix<T>*>(&src), dynamic_cast<decx::_Matrix<T>*>(&dst), _SFU_LOG_, 0, precision);
+}
+
+template _DECX_API_ de::DH de::cpu::Log(de::Matrix<float>& src, de::Matrix<float>& dst, const int precision);
+
+template _DECX_API_ de::DH de::cpu::Log(de::Matrix<double>& src, de::Matrix<double>& dst, const int precision);
+
+
+template <typename T>
+de::DH de::cpu::Log(de::Vector<T>& src, de::Vector<T>& dst, const int precision)
+{
+    return decx::_sfu_caller<T>(dynamic_cast<decx::_Vector<T>*>(&src), dynamic_cast<decx::_Vector<T>*>(&dst), _SFU_LOG_, 0, precision);
+}
+
+template _DECX_API_ de::DH de::cpu::Log(de::Vector<float>& src, de::Vector<float>& dst, const int precision);
+
+template _DECX_API_ de::DH de::cpu::Log(de::Vector<double>& src, de::Vector<double>& dst, const int precision);
+
+
+template <typename T>
+de::DH de::cpu::Log(de::Tensor<T>& src, de::Tensor<T>& dst, const int precision)
+{
+    return decx::_sfu_caller<T>(dynamic_cast<decx::_Tensor<T>*>(&src), dynamic_cast<decx::_Tensor<T>*>(&dst), _SFU_LOG_, 0, precision);
+}
+
+template _DECX_API_ de::DH de::cpu::Log(de::Tensor<float>& src, de::Tensor<float>& dst, const int precision);
+
+template _DECX_API_ de::DH de::cpu::Log(de::Tensor<double>& src, de::Tensor<double>& dst, const int precision);
+
+
+template <typename T>
+de::DH de::cpu::Sin(de::Matrix<T>& src, de::Matrix<T>& dst, const int precision)
+{
+    return decx::_sfu_caller<T>(dynamic_cast<decx::_Matrix<T>*>(&src), dynamic_cast<decx::_Matrix<T>*>(&dst), _SFU_SIN_, 0, precision);
+}
+
+template _DECX_API_ de::DH de::cpu::Sin(de::Matrix<float>& src, de::Matrix<float>& dst, const int precision);
+
+template _DECX_API_ de::DH de::cpu::Sin(de::Matrix<double>& src, de::Matrix<double>& dst, const int precision);
+
+
+template <typename T>
+de::DH de::cpu::Sin(de::Vector<T>& src, de::Vector<T>& dst, const int precision)
+{
+    return decx::_sfu_caller<T>(dynamic_cast<decx::_Vector<T>*>(&src), dynamic_cast<decx::_Vector<T>*>(&dst), _SFU_SIN_, 0, precision);
+}
+
+template _DECX_API_ de::DH de::cpu::Sin(de::Vector<float>& src, de::Vector<float>& dst, const int precision);
+
+template _DECX_API_ de::DH de::cpu::Sin(de::Vector<double>& src, de::Vector<double>& dst, const int precision);
+
+
+template <typename T>
+de::DH de::cpu::Sin(de::Tensor<T>& src, de::Tensor<T>& dst, const int precision)
+{
+    return decx::_sfu_caller<T>(dynamic_cast<decx::_Tensor<T>*>(&src), dynamic_cast<decx::_Tensor<T>*>(&dst), _SFU_SIN_, 0, precision);
+}
+
+template _DECX_API_ de::DH de::cpu::Sin(de::Tensor<float>& src, de::Tensor<float>& dst, const int precision);
+
+template _DECX_API_ de::DH de::cpu::Sin(de::Tensor<double>& src, de::Tensor<double>& dst, const int precision);
+
+
+template <typename T>
+de::DH de::cpu::Cos(de::Matrix<T>& src, de::Matrix<T>& dst, const int precision)
+{
+    return decx::_sfu_caller<T>(dynamic_cast<decx::_Matrix<T>*>(&src), dynamic_cast<decx::_Matrix<T>*>(&dst), _SFU_COS_, 0, precision);
+}
+
+template _DECX_API_ de::DH de::cpu::Cos(de::Matrix<float>& src, de::Matrix<float>& dst, const int precision);
+
+template _DECX_API_ de::DH de::cpu::Cos(de::Matrix<double>& src, de::Matrix<double>& dst, const int precision);
+
+
+template <typename T>
+de::DH de::cpu::Cos(de::Vector<T>& src, de::Vector<T>& dst, const int precision)
+{
+    return decx::_sfu_caller<T>(dynamic_cast<decx::_Vector<T>*>(&src), dynamic_cast<decx::_Vector<T>*>(&dst), _SFU_COS_, 0, precision);
+}
+
+template _DECX_API_ de::DH de::cpu::Cos(de::Vector<float>& src, de::Vector<float>& dst, const int precision);
+
+template _DECX_API_ de::DH de::cpu::Cos(de::Vector<double>& src, de::Vector<double>& dst, const int precision);
+
+
+template <typename T>
+de::DH de::cpu::Cos(de::Tensor<T>& src, de::Tensor<T>& dst, const int precision)
+{
+    return decx::_sfu_caller<T>(dynamic_cast<decx::_Tensor<T>*>(&src), dynamic_cast<decx::_Tensor<T>*>(&dst), _SFU_COS_, 0, precision);
+}
+
+template _DECX_API_ de::DH de::cpu::Cos(de::Tensor<float>& src, de::Tensor<float>& dst, const int precision);
+
+template _DECX_API_ de::DH de::cpu::Cos(de::Tensor<double>& src, de::Tensor<double>& dst, const int precision);
+
+
+template <typename T>
+de::DH de::cpu::Tan(de::Matrix<T>& src, de::Matrix<T>& dst, const int precision)
+{
+    return decx::_sfu_caller<T>(dynamic_cast<decx::_Matrix<T>*>(&src), dynamic_cast<decx::_Matrix<T>*>(&dst), _SFU_TAN_, 0, precision);
+}
+
+template _DECX_API_ de::DH de::cpu::Tan(de::Matrix<float>& src, de::Matrix<float>& dst, const int precision);
+
+template _DECX_API_ de::DH de::cpu::Tan(de::Matrix<double>& src, de::Matrix<double>& dst, const int precision);
+
+
+template <typename T>
+de::DH de::cpu::Tan(de::Vector<T>& src, de::Vector<T>& dst, const int precision)
+{
+    return decx::_sfu_caller<T>(dynamic_cast<decx::_Vector<T>*>(&src), dynamic_cast<decx::_Vector<T>*>(&dst), _SFU_TAN_, 0, precision);
+}
+
+template _DECX_API_ de::DH de::cpu::Tan(de::Vector<float>& src, de::Vector<float>& dst, const int precision);
+
+template _DECX_API_ de::DH de::cpu::Tan(de::Vector<double>& src, de::Vector<double>& dst, const int precision);
+
+
+template <typename T>
+de::DH de::cpu::Tan(de::Tensor<T>& src, de::Tensor<T>& dst, const int precision)
+{
+    return decx::_sfu_caller<T>(dynamic_cast<decx::_Tensor<T>*>(&src), dynamic_cast<decx::_Tensor<T>*>(&dst), _SFU_TAN_, 0, precision);
+}
+
+template _DECX_API_ de::DH de::cpu::Tan(de::Tensor<float>& src, de::Tensor<float>& dst, const int precision);
+
+template _DECX_API_ de::DH de::cpu::Tan(de::Tensor<double>& src, de::Tensor<double>& dst, const int precision);
+
+
+template <typename T>
+de::DH de::cpu::Tanh(de::Matrix<T>& src, de::Matrix<T>& dst, const int precision)
+{
+    return decx::_sfu_caller<T>(dynamic_cast<decx::_Matrix<T>*>(&src), dynamic_cast<decx::_Matrix<T>*>(&dst), _SFU_TANH_, 0, precision);
+}
+
+template _DECX_API_ de::DH de::cpu::Tanh(de::Matrix<float>& src, de::Matrix<float>& dst, const int precision);
+
+template _DECX_API_ de::DH de::cpu::Tanh(de::Matrix<double>& src, de::Matrix<double>& dst, const int precision);
+
+
+template <typename T>
+de::DH de::cpu::Tanh(de::Vector<T>& src, de::Vector<T>& dst, const int precision)
+{
+    return decx::_sfu_caller<T>(dynamic_cast<decx::_Vector<T>*>(&src), dynamic_cast<decx::_Vector<T>*>(&dst), _SFU_TANH_, 0, precision);
+}
+
+template _DECX_API_ de::DH de::cpu::Tanh(de::Vector<float>& src, de::Vector<float>& dst, const int precision);
+
+template _DECX_API_ de::DH de::cpu::Tanh(de::Vector<double>& src, de::Vector<double>& dst, const int precision);
+
+
+template <typename T>
+de::DH de::cpu::Tanh(de::Tensor<T>& src, de::Tensor<T>& dst, const int precision)
+{
+    return decx::_sfu_caller<T>(dynamic_cast<decx::_Tensor<T>*>(&src), dynamic_cast<decx::_Tensor<T>*>(&dst), _SFU_TANH_, 0, precision);
+}
+
+template _DECX_API_ de::DH de::cpu::Tanh(de::Tensor<float>& src, de::Tensor<float>& dst, const int precision);
+
+template _DECX_API_ de::DH de::cpu::Tanh(de::Tensor<double>& src, de::Tensor<double>& dst, const int precision);
+
+
+template <typename T>
+de::DH de::cpu::Sigmoid(de::Matrix<T>& src, de::Matrix<T>& dst, const int precision)
+{
+    return decx::_sfu_caller<T>(dynamic_cast<decx::_Matrix<T>*>(&src), dynamic_cast<decx::_Matrix<T>*>(&dst), _SFU_SIGMOID_, 0, precision);
+}
+
+template _DECX_API_ de::DH de::cpu::Sigmoid(de::Matrix<float>& src, de::Matrix<float>& dst, const int precision);
+
+template _DECX_API_ de::DH de::cpu::Sigmoid(de::Matrix<double>& src, de::Matrix<double>& dst, const int precision);
+
+
+template <typename T>
+de::DH de::cpu::Sigmoid(de::Vector<T>& src, de::Vector<T>& dst, const int precision)
+{
+    return decx::_sfu_caller<T>(dynamic_cast<decx::_Vector<T>*>(&src), dynamic_cast<decx::_Vector<T>*>(&dst), _SFU_SIGMOID_, 0, precision);
+}
+
+template _DECX_API_ de::DH de::cpu::Sigmoid(de::Vector<float>& src, de::Vector<float>& dst, const int precision);
+
+template _DECX_API_ de::DH de::cpu::Sigmoid(de::Vector<double>& src, de::Vector<double>& dst, const int precision);
+
+
+template <typename T>
+de::DH de::cpu::Sigmoid(de::Tensor<T>& src, de::Tensor<T>& dst, const int precision)
+{
+    return decx::_sfu_caller<T>(dynamic_cast<decx::_Tensor<T>*>(&src), dynamic_cast<decx::_Tensor<T>*>(&dst), _SFU_SIGMOID_, 0, precision);
+}
+
+template _DECX_API_ de::DH de::cpu::Sigmoid(de::Tensor<float>& src, de::Tensor<float>& dst, const int precision);
+
+template _DECX_API_ de::DH de::cpu::Sigmoid(de::Tensor<double>& src, de::Tensor<double>& dst, const int precision);
+
+
+template <typename T>
+de::DH de::cpu::Pow(de::Matrix<T>& src, const T p, de::Matrix<T>& dst, const int precision)
+{
+    return decx::_sfu_caller<T>(dynamic_cast<decx::_Matrix<T>*>(&src), dynamic_cast<decx::_Matrix<T>*>(&dst), _SFU_POW_, p, precision);
+}
+
+template _DECX_API_ de::DH de::cpu::Pow(de::Matrix<float>& src, const float p, de::Matrix<float>& dst, const int precision);
+
+template _DECX_API_ de::DH de::cpu::Pow(de::Matrix<double>& src, const double p, de::Matrix<double>& dst, const int precision);
+
+
+template <typename T>
+de::DH de::cpu::Pow(de::Vector<T>& src, const T p, de::Vector<T>& dst, const int precision)
+{
+    return decx::_sfu_caller<T>(dynamic_cast<decx::_Vector<T>*>(&src), dynamic_cast<decx::_Vector<T>*>(&dst), _SFU_POW_, p, precision);
+}
+
+template _DECX_API_ de::DH de::cpu::Pow(de::Vector<float>& src, const float p, de::Vector<float>& dst, const int precision);
+
+template _DECX_API_ de::DH de::cpu::Pow(de::Vector<double>& src, const double p, de::Vector<double>& dst, const int precision);
+
+
+template <typename T>
+de::DH de::cpu::Pow(de::Tensor<T>& src, const T p, de::Tensor<T>& dst, const int precision)
+{
+    return decx::_sfu_caller<T>(dynamic_cast<decx::_Tensor<T>*>(&src), dynamic_cast<decx::_Tensor<T>*>(&dst), _SFU_POW_, p, precision);
+}
+
+template _DECX_API_ de::DH de::cpu::Pow(de::Tensor<float>& src, const float p, de::Tensor<float>& dst, const int precision);
+
+template _DECX_API_ de::DH de::cpu::Pow(de::Tensor<double>& src, const double p, de::Tensor<double>& dst, const int precision);
+
+
+#endif
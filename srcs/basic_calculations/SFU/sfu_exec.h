@@ -0,0 +1,70 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+#ifndef _SFU_EXEC_H_
+#define _SFU_EXEC_H_
+
+#include "../../core/basic.h"
+#include "../../core/thread_management/parallel_for.h"
+#include "sfu_isa_kernels.h"
+
+
+// the elements of a unit of decx::parallel_for(), the chunks begin on the vectors of AVX-512
+#define _SFU_UNIT_ 16
+
+// a polynomial costs tens of times an addition, so the chunks are smaller than _EW_MIN_GRAIN_VEC_
+#define _SFU_MIN_GRAIN_ 128
+
+
+namespace decx
+{
+    /**
+    * @brief dst = f(src) over the thread pool, f is one of _SFU_EXP_ ... _SFU_SIGMOID_
+    * @param len : the length of the arrays in elements, arbitrary
+    * @param acc : the accurate variant if true, the fast one otherwise
+    */
+    template <typename T>
+    static void sfu_eval(const int op, const T* src, T* dst, const size_t len, const bool acc);
+
+
+    /**
+    * @brief dst = src ^ p over the thread pool
+    */
+    template <typename T>
+    static void sfu_pow(const T* src, const T p, T* dst, const size_t len, const bool acc);
+}
+
+
+
+template <typename T>
+static void decx::sfu_eval(const int op, const T* src, T* dst, const size_t len, const bool acc)
+{
+    const auto _kernel = decx::_sfu_typed_kernels<T>::f(op, acc);
+
+    decx::parallel_for(0, decx::utils::ceil<size_t>(len, _SFU_UNIT_), [&](const size_t _beg, const size_t _end) {
+        const size_t _end_elem = decx::utils::clamp_max<size_t>(_end * _SFU_UNIT_, len);
+        _kernel(src + _beg * _SFU_UNIT_, dst + _beg * _SFU_UNIT_, _end_elem - _beg * _SFU_UNIT_);
+    }, _SFU_MIN_GRAIN_, decx::Partition_NUMA);
+}
+
+
+
+template <typename T>
+static void decx::sfu_pow(const T* src, const T p, T* dst, const size_t len, const bool acc)
+{
+    const auto _kernel = decx::_sfu_typed_kernels<T>::pow(acc);
+
+    decx::parallel_for(0, decx::utils::ceil<size_t>(len, _SFU_UNIT_), [&](const size_t _beg, const size_t _end) {
+        const size_t _end_elem = decx::utils::clamp_max<size_t>(_end * _SFU_UNIT_, len);
+        _kernel(src + _beg * _SFU_UNIT_, p, dst + _beg * _SFU_UNIT_, _end_elem - _beg * _SFU_UNIT_);
+    }, _SFU_MIN_GRAIN_, decx::Partition_NUMA);
+}
+
+
+#endif
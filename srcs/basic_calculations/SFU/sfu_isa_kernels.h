@@ -0,0 +1,1280 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+#ifndef _SFU_ISA_KERNELS_H_
+#define _SFU_ISA_KERNELS_H_
+
+#include "../../core/basic.h"
+#include "../../core/configs/cpu_isa.h"
+#include <cmath>
+#include <limits>
+
+
+/**
+* The transcendental functions (exp, log, sin, cos, tan, tanh, sigmoid and pow) on the CPU, for SSE4.2, AVX2
+* and AVX-512, of float and double. No table is looked up, each is a range reduction and a minimax polynomial :
+*   exp     : x = n * ln2 + r, 2^n * (1 + r + r^2 * P(r)), 2^n is applied in two steps, so the subnormal results
+*             and the overflow are exact. The accurate variant keeps the tail of r and adds 1 + r last
+*   log     : x = 2^k * (1 + f), k * ln2 + 2s + s * R(s^2), s = f / (2 + f) (as fdlibm). The accurate variant
+*             carries s, 2s^3 / 3 and the sums in two parts, log(x) as hi + lo to about 2^-65
+*   sin, cos: x = q * pi / 2 + r (Cody-Waite, pi / 2 in 3 parts, in 4 parts in the accurate variant, the sums
+*             two-summed so r is carried in two parts), the polynomials of sin(r) and cos(r) picked and signed
+*             by q % 4. tan = sin(r) / cos(r) or -cos(r) / sin(r), the quotient corrected once by the tails
+*   tanh    : x + x^3 * P(x^2) of |x| < 0.625, e / (e + 2) above, e = e^(2|x|) - 1. The accurate variant
+*             takes 1 - 2 / (e^(2|x|) + 1) above, of e^(2|x|) in two parts
+*   sigmoid : 1 / (1 + t) or t / (1 + t) of t = e^-|x| (never overflows), the rounding of 1 + t taken off.
+*             The accurate variant carries t in two parts and corrects the quotient once
+*   pow     : src ^ p of a scalar p, e^(p * log(|x|)), negative x kept by the odd integer p and NaN of the
+*             others. log(|x|) is carried in two parts (about 2^-65) and so is p * log(|x|) into exp, so
+*             the error does not grow with |p * log(x)|
+*
+* Each function has two variants, the index of decx::_sfu_kernel_table::f[op][] :
+*   0 fast     : the polynomials of the element type. log does not handle the subnormals, inf and NaN, pow
+*                keeps 0 and the subnormals but not inf and NaN. The reduction of sin, cos and tan holds for
+*                |x| < 2^12 of float, 2^20 of double
+*   1 accurate : all the special values and the subnormals, the reduction holds for |x| < 2^27. Of double,
+*                the exact products are taken by FMA (the Dekker split on SSE4.2). Of float, the accurate
+*                variant of double is calculated and rounded to float
+* The errors, the most of SSE4.2, AVX2 and AVX-512 against long double, on 2^20 random inputs of each range :
+*                      exp    log    sin    cos    tan    tanh   sigmoid   pow
+*   float fast   (ulp) 1.1    0.9    0.9    0.8    1.6    1.5    1.9       0.5
+*   float acc.   (ulp) 0.5    0.5    0.5    0.5    0.5    0.5    0.5       0.5
+*   double fast  (ulp) 1.1    0.9    0.8    0.8    1.7    1.5    1.9       1.2
+*   double acc.  (ulp) 0.8    0.5    0.8    0.8    1.0    0.9    0.8       0.8
+* pow of float is calculated in double in both variants. test/test/sfu_bench measures the same of both types.
+*
+* The lengths of the kernels are in elements and arbitrary, the last elements not filling a vector are
+* calculated through a vector on the stack. The kernels are the ones of de::cpu::Exp() ..., and are to be
+* taken through decx::_sfu_typed_kernels<T> (or called by decx::sfu_eval()) by the activations of de::nn.
+*/
+
+
+#define _SFU_EXP_ 0
+#define _SFU_LOG_ 1
+#define _SFU_SIN_ 2
+#define _SFU_COS_ 3
+#define _SFU_TAN_ 4
+#define _SFU_TANH_ 5
+#define _SFU_SIGMOID_ 6
+
+#define _SFU_FUNC_NUM_ 7
+
+
+namespace decx
+{
+    struct _sfu_kernel_table
+    {
+        // [_SFU_EXP_ ... _SFU_SIGMOID_][fast, accurate], dst = f(src)
+        void (*f[_SFU_FUNC_NUM_][2])(const float*, float*, const size_t);
+        void (*d[_SFU_FUNC_NUM_][2])(const double*, double*, const size_t);
+
+        // [fast, accurate], dst = src ^ p
+        void (*fpow[2])(const float*, const float, float*, const size_t);
+        void (*dpow[2])(const double*, const double, double*, const size_t);
+    };
+
+
+    decx::_sfu_kernel_table _sfu_kernels;
+
+
+    /**
+    * @brief The kernels of decx::_sfu_kernels of T
+    */
+    template <typename T>
+    struct _sfu_typed_kernels;
+
+
+    /**
+    * @brief The constants of the functions of T, the bit patterns, the reductions and the coefficients
+    * (in ascending order) of the polynomials
+    */
+    template <typename T>
+    struct _sfu_consts;
+
+
+    /**
+    * @brief Whether the scalar exponent p of pow is an integer and odd
+    * @return true if p is 0, the result is 1 whatever the base is
+    */
+    static bool _sfu_pow_flags(const double p, bool* _int, bool* _odd);
+}
+
+
+
+template <>
+struct decx::_sfu_typed_kernels<float>
+{
+    static void (*f(const int op, const bool acc))(const float*, float*, const size_t)                  { return decx::_sfu_kernels.f[op][acc]; }
+    static void (*pow(const bool acc))(const float*, const float, float*, const size_t)                 { return decx::_sfu_kernels.fpow[acc]; }
+};
+
+
+template <>
+struct decx::_sfu_typed_kernels<double>
+{
+    static void (*f(const int op, const bool acc))(const double*, double*, const size_t)                { return decx::_sfu_kernels.d[op][acc]; }
+    static void (*pow(const bool acc))(const double*, const double, double*, const size_t)              { return decx::_sfu_kernels.dpow[acc]; }
+};
+
+
+
+namespace decx
+{
+    static const float _sfu_exp_f32[] = { 4.999999345e-01f, 1.666652069e-01f, 4.166838736e-02f, 8.368709825e-03f,
+        1.381461332e-03f };
+
+    static const float _sfu_log_f32[] = { 6.666677638e-01f, 3.997754158e-01f, 2.987172769e-01f };
+
+    static const float _sfu_sin_f32[] = { -1.666665461e-01f, 8.332160762e-03f, -1.951528320e-04f };
+
+    static const float _sfu_cos_f32[] = { 4.166664568e-02f, -1.388731625e-03f, 2.443315706e-05f };
+
+    static const float _sfu_tanh_f32[] = { -3.333333433e-01f, 1.333330423e-01f, -5.395925790e-02f, 2.176891826e-02f,
+        -8.343945257e-03f, 2.292744815e-03f };
+
+    // pi / 2 in 12, 12 and 24 bits
+    static const float _sfu_pio2_f32[] = { 1.57080078125f, -4.45358455181121826171875e-06f, -8.70551575271605315720e-10f };
+
+
+    static const double _sfu_exp_f64[] = { 5.000000000000010617e-01, 1.666666666666641277e-01, 4.166666666653026557e-02,
+        8.333333333494336424e-03, 1.388888894359782094e-03, 1.984126950677187048e-04, 2.480149313605284194e-05,
+        2.755758627370282988e-06, 2.763023396723674279e-07, 2.500006988517879083e-08 };
+
+    static const double _sfu_log_f64[] = { 6.666666666666734412e-01, 3.999999999941468042e-01, 2.857142874238726667e-01,
+        2.222219857321431303e-01, 1.818356432482046383e-01, 1.531405058048649573e-01, 1.479594945596713325e-01 };
+
+    // Q(z) of log(1 + f) = 2s + 2s^3 / 3 + s^5 * Q(s^2), s = f / (2 + f), of the log in two parts
+    static const double _sfu_log_dd_f64[] = { 4.000000000000000222e-01, 2.857142857142936448e-01, 2.222222222165588469e-01,
+        1.818181833539280162e-01, 1.538459496251843138e-01, 1.333480469384731030e-01, 1.170623633949120655e-01,
+        1.172317862387651728e-01 };
+
+    static const double _sfu_sin_f64[] = { -1.666666666666663073e-01, 8.333333333322118588e-03, -1.984126982958954010e-04,
+        2.755731362138650966e-06, -2.505074776298982275e-08, 1.589623016495866310e-10 };
+
+    static const double _sfu_cos_f64[] = { 4.166666666666659292e-02, -1.388888888887305641e-03, 2.480158728885170407e-05,
+        -2.755731417929677506e-07, 2.087570084198979056e-09, -1.135853652233133281e-11 };
+
+    static const double _sfu_tanh_f64[] = { -3.333333333333285527e-01, 1.333333333326209137e-01, -5.396825393126767878e-02,
+        2.186948757609372745e-02, -8.863221002617257357e-03, 3.591989173699582533e-03, -1.454958877366635508e-03,
+        5.863165382301097784e-04, -2.285642067135984016e-04, 7.714436147423475524e-05, -1.607256706774441926e-05 };
+
+    // pi / 2 in 33, 33 and 53 bits
+    static const double _sfu_pio2_f64[] = { 1.570796326734125614166259765625, 6.0771005063039659765955491366185015e-11,
+        2.0222662487959506315411442613699270e-21 };
+
+    // pi / 2 in 26, 26, 26 and 53 bits
+    static const double _sfu_pio2_acc_f64[] = { 1.5707963407039642333984375, -1.3909067675399455765727907419204711914e-08,
+        6.1232339320535942510208282651973377142e-17, 6.3683171635109499079619942528805958898e-25 };
+}
+
+
+
+template <>
+struct decx::_sfu_consts<float>
+{
+    static const int bias = 127;
+    static const int one_bits = 0x3f800000;             // 1
+    static const int sqrt_half_bits = 0x3f3504f3;       // sqrt(1/2)
+    static const int mant_mask = 0x007fffff;
+    static const int m0_bits = 0x4b000000;              // 2^23
+
+    static const int exp_n = 5, log_n = 3, sin_n = 3, cos_n = 3, tanh_n = 6;
+
+    static float magic()            { return 12582912.f; }             // 1.5 * 2^23
+    static float m0()               { return 8388608.f; }
+    static float log2e()            { return 1.44269504f; }
+    static float ln2_hi()           { return 0.693359375f; }
+    static float ln2_lo()           { return -2.12194440e-4f; }
+    static float exp_min()          { return -104.f; }                  // e^x rounds to 0 below
+    static float exp_max()          { return 89.f; }                    // and to inf above
+    static float two_over_pi()      { return 0.636619772f; }
+    static float tanh_max()         { return 10.f; }                    // tanh(x) rounds to 1 above
+    static float tanh_small()       { return 0.625f; }
+
+    static const float* exp_c()     { return decx::_sfu_exp_f32; }
+    static const float* log_c()     { return decx::_sfu_log_f32; }
+    static const float* sin_c()     { return decx::_sfu_sin_f32; }
+    static const float* cos_c()     { return decx::_sfu_cos_f32; }
+    static const float* tanh_c()    { return decx::_sfu_tanh_f32; }
+    static const float* pio2_c()    { return decx::_sfu_pio2_f32; }
+};
+
+
+template <>
+struct decx::_sfu_consts<double>
+{
+    static const long long bias = 1023;
+    static const long long one_bits = 0x3ff0000000000000LL;
+    static const long long sqrt_half_bits = 0x3fe6a09e667f3bcdLL;
+    static const long long mant_mask = 0x000fffffffffffffLL;
+    static const long long m0_bits = 0x4330000000000000LL;      // 2^52
+
+    static const int exp_n = 10, log_n = 7, log_dd_n = 8, sin_n = 6, cos_n = 6, tanh_n = 11;
+
+    static double magic()           { return 6755399441055744.0; }      // 1.5 * 2^52
+    static double m0()              { return 4503599627370496.0; }
+    static double log2e()           { return 1.4426950408889634074; }
+    static double ln2_hi()          { return 6.93147180369123816490e-01; }
+    static double ln2_lo()          { return 1.90821492927058770002e-10; }
+    static double two_thirds_hi()   { return 6.66666666666666629659e-01; }
+    static double two_thirds_lo()   { return 3.70074341541718826e-17; }
+    static double exp_min()         { return -746.0; }
+    static double exp_max()         { return 710.0; }
+    static double two_over_pi()     { return 0.63661977236758134308; }
+    static double tanh_max()        { return 20.0; }
+    static double tanh_small()      { return 0.625; }
+    static double min_normal()      { return 2.2250738585072014e-308; }
+    static double subnormal_scale() { return 18014398509481984.0; }     // 2^54
+    static double subnormal_log2()  { return 54.0; }
+
+    static const double* exp_c()    { return decx::_sfu_exp_f64; }
+    static const double* log_c()    { return decx::_sfu_log_f64; }
+    static const double* log_dd_c() { return decx::_sfu_log_dd_f64; }
+    static const double* sin_c()    { return decx::_sfu_sin_f64; }
+    static const double* cos_c()    { return decx::_sfu_cos_f64; }
+    static const double* tanh_c()   { return decx::_sfu_tanh_f64; }
+    static const double* pio2_c()   { return decx::_sfu_pio2_f64; }
+    static const double* pio2_acc_c() { return decx::_sfu_pio2_acc_f64; }
+};
+
+
+
+static bool decx::_sfu_pow_flags(const double p, bool* _int, bool* _odd)
+{
+    *_int = std::floor(p) == p;
+    *_odd = *_int && std::fmod(p, 2.0) != 0;
+    return p == 0;
+}
+
+
+/**
+* The kernels of one instruction set, expanded in the namespace of the set where _sfu_vec<float> and
+* _sfu_vec<double> wrap the vectors of the set. float of the accurate variant (and pow of float) is calculated
+* in double, through _sfu_vec<float>::widen() and narrow().
+*/
+#define _DECX_SFU_KERNELS_                                                                              \
+template <typename T> using _sfu_V = typename _sfu_vec<T>::V;                                           \
+template <typename T> using _sfu_I = typename _sfu_vec<T>::I;                                           \
+                                                                                                        \
+                                                                                                        \
+/* c[0] + x * (c[1] + x * (... + x * c[_n - 1])) */                                                     \
+template <typename T, int _n>                                                                           \
+static inline _sfu_V<T> _sfu_poly(const _sfu_V<T> x, const T* c)                                        \
+{                                                                                                       \
+    typedef _sfu_vec<T> _V;                                                                             \
+    _sfu_V<T> s = _V::set1(c[_n - 1]);                                                                  \
+    for (int i = _n - 2; i >= 0; --i) {                                                                 \
+        s = _V::fma(s, x, _V::set1(c[i]));                                                              \
+    }                                                                                                   \
+    return s;                                                                                           \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+/* x rounded to the nearest integer, bits gets the bits of x + magic, the low ones of which are the integer */ \
+template <typename T>                                                                                   \
+static inline _sfu_V<T> _sfu_rint(const _sfu_V<T> x, _sfu_I<T>* bits)                                   \
+{                                                                                                       \
+    typedef _sfu_vec<T> _V;                                                                             \
+    const _sfu_V<T> t = _V::add(x, _V::set1(decx::_sfu_consts<T>::magic()));                            \
+    *bits = _V::casti(t);                                                                               \
+    return _V::sub(t, _V::set1(decx::_sfu_consts<T>::magic()));                                         \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+/* 2^n, n is in the low bits of bits (as _sfu_rint() leaves them) and in [1 - bias, bias] */            \
+template <typename T>                                                                                   \
+static inline _sfu_V<T> _sfu_pow2i(const _sfu_I<T> bits)                                                \
+{                                                                                                       \
+    typedef _sfu_vec<T> _V;                                                                             \
+    return _V::castf(_V::shl_mant(_V::iadd(bits, _V::iset1(decx::_sfu_consts<T>::bias))));              \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+/* a + b rounded, *err gets the rounding (two-sum, whatever the magnitudes are) */                      \
+template <typename T>                                                                                   \
+static inline _sfu_V<T> _sfu_two_sum(const _sfu_V<T> a, const _sfu_V<T> b, _sfu_V<T>* err)              \
+{                                                                                                       \
+    typedef _sfu_vec<T> _V;                                                                             \
+    const _sfu_V<T> s = _V::add(a, b);                                                                  \
+    const _sfu_V<T> bb = _V::sub(s, a);                                                                 \
+    *err = _V::add(_V::sub(a, _V::sub(s, bb)), _V::sub(b, bb));                                         \
+    return s;                                                                                           \
+}                                                                                                       \
+                                                                                                        \
+/* r = x - n * ln2 in [-ln2 / 2, ln2 / 2], n = x / ln2 rounded */                                       \
+template <typename T>                                                                                   \
+static inline _sfu_V<T> _sfu_exp_reduce(const _sfu_V<T> x, _sfu_V<T>* n, _sfu_I<T>* nb)                 \
+{                                                                                                       \
+    typedef _sfu_vec<T> _V;                                                                             \
+    typedef decx::_sfu_consts<T> _C;                                                                    \
+    *n = _sfu_rint<T>(_V::mul(x, _V::set1(_C::log2e())), nb);                                           \
+    const _sfu_V<T> r = _V::fma(*n, _V::set1(-_C::ln2_hi()), x);                                        \
+    return _V::fma(*n, _V::set1(-_C::ln2_lo()), r);                                                     \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+/* e^r - 1 of the reduced r */                                                                          \
+template <typename T>                                                                                   \
+static inline _sfu_V<T> _sfu_expm1_reduced(const _sfu_V<T> r)                                           \
+{                                                                                                       \
+    typedef _sfu_vec<T> _V;                                                                             \
+    typedef decx::_sfu_consts<T> _C;                                                                    \
+    return _V::fma(_V::mul(r, r), _sfu_poly<T, _C::exp_n>(r, _C::exp_c()), r);                          \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+/* 2^n as 2^n1 * 2^n2, n spans the subnormals and the overflow, beyond one exponent */                  \
+template <typename T>                                                                                   \
+static inline void _sfu_pow2i_split(const _sfu_V<T> n, const _sfu_I<T> nb, _sfu_V<T>* s1, _sfu_V<T>* s2) \
+{                                                                                                       \
+    typedef _sfu_vec<T> _V;                                                                             \
+    _sfu_I<T> n1b;                                                                                      \
+    _sfu_rint<T>(_V::mul(n, _V::set1((T)0.5)), &n1b);                                                   \
+    *s1 = _sfu_pow2i<T>(n1b);                                                                           \
+    *s2 = _sfu_pow2i<T>(_V::isub(nb, n1b));                                                             \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+/* e^(x + x_lo) as the result + *lo (the accurate variant), x_lo is the low part of the argument, 0 if none. The \
+   tail of r is kept and 1 + r is split off the polynomial, so e^r is rounded once. NaN passes max() and min() */ \
+template <typename T>                                                                                   \
+static inline _sfu_V<T> _sfu_exp_dd(const _sfu_V<T> x, const _sfu_V<T> x_lo, _sfu_V<T>* lo)             \
+{                                                                                                       \
+    typedef _sfu_vec<T> _V;                                                                             \
+    typedef decx::_sfu_consts<T> _C;                                                                    \
+    const _sfu_V<T> xc = _V::min(_V::set1(_C::exp_max()), _V::max(_V::set1(_C::exp_min()), x));         \
+    const _sfu_V<T> one = _V::set1((T)1);                                                               \
+    _sfu_I<T> nb;                                                                                       \
+    const _sfu_V<T> n = _sfu_rint<T>(_V::mul(xc, _V::set1(_C::log2e())), &nb);                          \
+    const _sfu_V<T> r_hi = _V::fma(n, _V::set1(-_C::ln2_hi()), xc);                                     \
+    const _sfu_V<T> r0 = _V::fma(n, _V::set1(-_C::ln2_lo()), r_hi);                                     \
+    /* the tail of the reduction and x_lo, added to r0 so r_lo is below the ulp of r */                 \
+    const _sfu_V<T> t = _V::add(_V::fma(n, _V::set1(-_C::ln2_lo()), _V::sub(r_hi, r0)), x_lo);          \
+    const _sfu_V<T> r = _V::add(r0, t);                                                                 \
+    const _sfu_V<T> r_lo = _V::add(_V::sub(r0, r), t);                                                  \
+    const _sfu_V<T> hi = _V::add(one, r);                                                               \
+    const _sfu_V<T> p = _V::fma(_V::mul(r, r), _sfu_poly<T, _C::exp_n>(r, _C::exp_c()), _V::add(_V::add(_V::sub(one, hi), r), r_lo)); \
+    const _sfu_V<T> m = _V::add(hi, p);                                                                 \
+    _sfu_V<T> s1, s2;                                                                                   \
+    _sfu_pow2i_split<T>(n, nb, &s1, &s2);                                                               \
+    *lo = _V::mul(_V::mul(_V::sub(p, _V::sub(m, hi)), s1), s2);                                         \
+    return _V::mul(_V::mul(m, s1), s2);                                                                 \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+/* e^(x + x_lo), x_lo is the low part of the argument (pow), 0 otherwise. NaN passes max() and min() */ \
+template <typename T, bool _acc>                                                                        \
+static inline _sfu_V<T> _sfu_exp(const _sfu_V<T> x, const _sfu_V<T> x_lo)                               \
+{                                                                                                       \
+    typedef _sfu_vec<T> _V;                                                                             \
+    typedef decx::_sfu_consts<T> _C;                                                                    \
+    if (_acc) {                                                                                         \
+        _sfu_V<T> lo;                                                                                   \
+        return _sfu_exp_dd<T>(x, x_lo, &lo);                                                            \
+    }                                                                                                   \
+    _sfu_V<T> n, s1, s2;                                                                                \
+    _sfu_I<T> nb;                                                                                       \
+    const _sfu_V<T> xc = _V::min(_V::set1(_C::exp_max()), _V::max(_V::set1(_C::exp_min()), x));         \
+    const _sfu_V<T> q = _sfu_expm1_reduced<T>(_V::add(_sfu_exp_reduce<T>(xc, &n, &nb), x_lo));          \
+    _sfu_pow2i_split<T>(n, nb, &s1, &s2);                                                               \
+    return _V::mul(_V::fma(q, s1, s1), s2);                                                             \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+/* e^x - 1 of x in [0, 2 * tanh_max], 2^n in one step */                                                \
+template <typename T>                                                                                   \
+static inline _sfu_V<T> _sfu_expm1_pos(const _sfu_V<T> x)                                               \
+{                                                                                                       \
+    typedef _sfu_vec<T> _V;                                                                             \
+    _sfu_V<T> n;                                                                                        \
+    _sfu_I<T> nb;                                                                                       \
+    const _sfu_V<T> q = _sfu_expm1_reduced<T>(_sfu_exp_reduce<T>(x, &n, &nb));                          \
+    const _sfu_V<T> s = _sfu_pow2i<T>(nb);                                                              \
+    return _V::fma(s, q, _V::sub(s, _V::set1((T)1)));                                                   \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+/* x = m * 2^k of the positive normal x, m in [sqrt(1/2), sqrt(2)), returns f = m - 1 */                \
+template <typename T>                                                                                   \
+static inline _sfu_V<T> _sfu_log_split(const _sfu_V<T> x, _sfu_V<T>* k)                                 \
+{                                                                                                       \
+    typedef _sfu_vec<T> _V;                                                                             \
+    typedef decx::_sfu_consts<T> _C;                                                                    \
+    const _sfu_I<T> bits = _V::iadd(_V::casti(x), _V::iset1(_C::one_bits - _C::sqrt_half_bits));        \
+    *k = _V::sub(_V::castf(_V::ior(_V::shr_mant(bits), _V::iset1(_C::m0_bits))), _V::set1(_C::m0() + _C::bias)); \
+    const _sfu_V<T> m = _V::castf(_V::iadd(_V::iand(bits, _V::iset1(_C::mant_mask)), _V::iset1(_C::sqrt_half_bits))); \
+    return _V::sub(m, _V::set1((T)1));                                                                  \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+/* k * ln2 + log(1 + f) = k * ln2 + 2s + s * R(s^2), s = f / (2 + f) (as fdlibm) */                     \
+template <typename T>                                                                                   \
+static inline _sfu_V<T> _sfu_log_core(const _sfu_V<T> f, const _sfu_V<T> k)                             \
+{                                                                                                       \
+    typedef _sfu_vec<T> _V;                                                                             \
+    typedef decx::_sfu_consts<T> _C;                                                                    \
+    const _sfu_V<T> s = _V::div(f, _V::add(f, _V::set1((T)2)));                                         \
+    const _sfu_V<T> z = _V::mul(s, s);                                                                  \
+    const _sfu_V<T> R = _V::mul(z, _sfu_poly<T, _C::log_n>(z, _C::log_c()));                            \
+    const _sfu_V<T> hfsq = _V::mul(_V::mul(f, f), _V::set1((T)0.5));                                    \
+    const _sfu_V<T> t = _V::fma(s, _V::add(hfsq, R), _V::mul(k, _V::set1(_C::ln2_lo())));               \
+    return _V::fma(k, _V::set1(_C::ln2_hi()), _V::sub(f, _V::sub(hfsq, t)));                            \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+/* the subnormal x scaled to the normals, k_sub gets the power of 2 to take off k */                    \
+template <typename T>                                                                                   \
+static inline _sfu_V<T> _sfu_log_prescale(const _sfu_V<T> x, _sfu_V<T>* k_sub)                          \
+{                                                                                                       \
+    typedef _sfu_vec<T> _V;                                                                             \
+    typedef decx::_sfu_consts<T> _C;                                                                    \
+    const typename _sfu_vec<T>::M sub = _V::lt(x, _V::set1(_C::min_normal()));                          \
+    *k_sub = _V::select(sub, _V::set1(_C::subnormal_log2()), _V::set1((T)0));                           \
+    return _V::select(sub, _V::mul(x, _V::set1(_C::subnormal_scale())), x);                             \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+/* log(x) as hi + lo, to about 2^-65 relatively, of the positive finite x (the accurate log and pow).   \
+   log(1 + f) = 2s + 2s^3 / 3 + s^5 * Q(s^2), the first two terms and their sum with k * ln2 in two parts */ \
+template <typename T>                                                                                   \
+static inline _sfu_V<T> _sfu_log_dd(const _sfu_V<T> x, _sfu_V<T>* lo)                                   \
+{                                                                                                       \
+    typedef _sfu_vec<T> _V;                                                                             \
+    typedef decx::_sfu_consts<T> _C;                                                                    \
+    _sfu_V<T> k, k_sub;                                                                                 \
+    const _sfu_V<T> f = _sfu_log_split<T>(_sfu_log_prescale<T>(x, &k_sub), &k);                         \
+    k = _V::sub(k, k_sub);                                                                              \
+    /* d = 2 + f and s = f / d, both in two parts */                                                    \
+    const _sfu_V<T> d = _V::add(f, _V::set1((T)2));                                                     \
+    const _sfu_V<T> dl = _V::add(_V::sub(_V::set1((T)2), d), f);                                        \
+    const _sfu_V<T> sh = _V::div(f, d);                                                                 \
+    const _sfu_V<T> p = _V::mul(sh, d);                                                                 \
+    const _sfu_V<T> sl = _V::div(_V::sub(_V::sub(_V::sub(f, p), _V::mul_err(sh, d, p)), _V::mul(sh, dl)), d); \
+    /* 2s^3 / 3 = c + c_lo */                                                                           \
+    const _sfu_V<T> z = _V::mul(sh, sh);                                                                \
+    const _sfu_V<T> s3 = _V::mul(sh, z);                                                                \
+    const _sfu_V<T> s3_lo = _V::fma(sh, _V::mul_err(sh, sh, z), _V::mul_err(sh, z, s3));                \
+    const _sfu_V<T> c = _V::mul(_V::set1(_C::two_thirds_hi()), s3);                                     \
+    const _sfu_V<T> c_lo = _V::fma(_V::set1(_C::two_thirds_lo()), s3,                                   \
+        _V::fma(_V::set1(_C::two_thirds_hi()), s3_lo, _V::mul_err(_V::set1(_C::two_thirds_hi()), s3, c))); \
+    /* s^5 * Q(s^2), and what sl adds to 2s + 2s^3 / 3 */                                               \
+    const _sfu_V<T> tail = _V::fma(_V::mul(s3, z), _sfu_poly<T, _C::log_dd_n>(z, _C::log_dd_c()),       \
+        _V::mul(_V::fma(z, _V::set1((T)2), _V::set1((T)2)), sl));                                       \
+    /* k * ln2_hi + 2 * sh + c, the errors of the sums are kept */                                      \
+    _sfu_V<T> e1, e2;                                                                                   \
+    const _sfu_V<T> s1 = _sfu_two_sum<T>(_V::mul(k, _V::set1(_C::ln2_hi())), _V::add(sh, sh), &e1);     \
+    const _sfu_V<T> s2 = _sfu_two_sum<T>(s1, c, &e2);                                                   \
+    const _sfu_V<T> t = _V::add(_V::add(e1, e2), _V::add(_V::add(tail, c_lo), _V::mul(k, _V::set1(_C::ln2_lo())))); \
+    /* renormalized, hi is log(x) rounded, so p * hi is where e^(p * log(x)) overflows */               \
+    const _sfu_V<T> hi = _V::add(s2, t);                                                                \
+    *lo = _V::sub(t, _V::sub(hi, s2));                                                                  \
+    return hi;                                                                                          \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+/* r = x - q * pi / 2 as r + *r_lo, with pi / 2 in _n parts. The products of q and the parts but the last one \
+   are exact, the roundings of the sums are kept (two-sum), so *r_lo is below the ulp of r */           \
+template <typename T, int _n>                                                                           \
+static inline _sfu_V<T> _sfu_reduce_pio2(const _sfu_V<T> x, const T* pio2, _sfu_I<T>* qb, _sfu_V<T>* r_lo) \
+{                                                                                                       \
+    typedef _sfu_vec<T> _V;                                                                             \
+    const _sfu_V<T> q = _sfu_rint<T>(_V::mul(x, _V::set1(decx::_sfu_consts<T>::two_over_pi())), qb);    \
+    _sfu_V<T> r = _V::fma(q, _V::set1(-pio2[0]), x);                                                    \
+    _sfu_V<T> lo = _V::set1((T)0);                                                                      \
+    for (int i = 1; i < _n; ++i) {                                                                      \
+        _sfu_V<T> err;                                                                                  \
+        r = _sfu_two_sum<T>(r, _V::mul(q, _V::set1(-pio2[i])), &err);                                   \
+        lo = _V::add(lo, err);                                                                          \
+    }                                                                                                   \
+    *r_lo = lo;                                                                                         \
+    return r;                                                                                           \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+/* sin(r + y) = r + *s_lo and cos(r + y) = *c_hi + *c_lo of r in [-pi / 4, pi / 4] and its tail y, the sums are \
+   left to the caller. 1 - r^2 / 2 of cos is compensated (as fdlibm) */                                 \
+template <typename T>                                                                                   \
+static inline void _sfu_sincos_poly(const _sfu_V<T> r, const _sfu_V<T> y, _sfu_V<T>* s_lo, _sfu_V<T>* c_hi, _sfu_V<T>* c_lo) \
+{                                                                                                       \
+    typedef _sfu_vec<T> _V;                                                                             \
+    typedef decx::_sfu_consts<T> _C;                                                                    \
+    const _sfu_V<T> z = _V::mul(r, r);                                                                  \
+    const _sfu_V<T> hz = _V::mul(z, _V::set1((T)0.5));                                                  \
+    /* y * cos(r) = y * (1 - r^2 / 2) */                                                                \
+    *s_lo = _V::fma(_V::mul(z, r), _sfu_poly<T, _C::sin_n>(z, _C::sin_c()), _V::sub(y, _V::mul(y, hz))); \
+    const _sfu_V<T> w = _V::sub(_V::set1((T)1), hz);                                                    \
+    /* - y * sin(r) = - y * r */                                                                        \
+    const _sfu_V<T> tail = _V::sub(_V::mul(_V::mul(z, z), _sfu_poly<T, _C::cos_n>(z, _C::cos_c())), _V::mul(r, y)); \
+    *c_hi = w;                                                                                          \
+    *c_lo = _V::add(_V::sub(_V::sub(_V::set1((T)1), w), hz), tail);                                     \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+/* sin(x) (cos(x) if _cos) of r + y and the quadrant q, sin(x) = sin(r), cos(r), -sin(r), -cos(r) of q % 4 */ \
+template <typename T, bool _cos>                                                                        \
+static inline _sfu_V<T> _sfu_sin_of(const _sfu_V<T> r, const _sfu_V<T> y, _sfu_I<T> qb)                 \
+{                                                                                                       \
+    typedef _sfu_vec<T> _V;                                                                             \
+    _sfu_V<T> s_lo, c_hi, c_lo;                                                                         \
+    _sfu_sincos_poly<T>(r, y, &s_lo, &c_hi, &c_lo);                                                     \
+    if (_cos) {                                                                                         \
+        qb = _V::iadd(qb, _V::iset1(1));                                                                \
+    }                                                                                                   \
+    const _sfu_V<T> res = _V::select(_V::ieqz(_V::iand(qb, _V::iset1(1))), _V::add(r, s_lo), _V::add(c_hi, c_lo)); \
+    return _V::select(_V::ieqz(_V::iand(qb, _V::iset1(2))), res, _V::bxor(res, _V::set1((T)-0.0)));     \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+/* tan(x) = sin(r) / cos(r) of the even q, -cos(r) / sin(r) of the odd, as (num + num_t) / (den + den_t) */ \
+template <typename T>                                                                                   \
+static inline void _sfu_tan_parts(const _sfu_V<T> r, const _sfu_V<T> y, const _sfu_I<T> qb, _sfu_V<T>* num, \
+    _sfu_V<T>* num_t, _sfu_V<T>* den, _sfu_V<T>* den_t)                                                 \
+{                                                                                                       \
+    typedef _sfu_vec<T> _V;                                                                             \
+    _sfu_V<T> s_lo, c_hi, c_lo;                                                                         \
+    _sfu_sincos_poly<T>(r, y, &s_lo, &c_hi, &c_lo);                                                     \
+    const _sfu_V<T> s = _V::add(r, s_lo), c = _V::add(c_hi, c_lo);                                      \
+    const _sfu_V<T> s_t = _V::add(_V::sub(r, s), s_lo), c_t = _V::add(_V::sub(c_hi, c), c_lo);          \
+    const typename _sfu_vec<T>::M even = _V::ieqz(_V::iand(qb, _V::iset1(1)));                          \
+    const _sfu_V<T> neg = _V::set1((T)-0.0);                                                            \
+    *num = _V::select(even, s, _V::bxor(c, neg));                                                       \
+    *num_t = _V::select(even, s_t, _V::bxor(c_t, neg));                                                 \
+    *den = _V::select(even, c, s);                                                                      \
+    *den_t = _V::select(even, c_t, s_t);                                                                \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+template <typename T>                                                                                   \
+static inline _sfu_V<T> _sfu_abs(const _sfu_V<T> x)                                                     \
+{                                                                                                       \
+    typedef _sfu_vec<T> _V;                                                                             \
+    return _V::bxor(x, _V::band(x, _V::set1((T)-0.0)));                                                 \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+/* tanh(|x|) = e / (e + 2), e = e^(2|x|) - 1, |x| clamped where tanh is 1 */                            \
+template <typename T>                                                                                   \
+static inline _sfu_V<T> _sfu_tanh_pos(const _sfu_V<T> ax)                                               \
+{                                                                                                       \
+    typedef _sfu_vec<T> _V;                                                                             \
+    const _sfu_V<T> e = _sfu_expm1_pos<T>(_V::add(ax, ax));                                             \
+    return _V::div(e, _V::add(e, _V::set1((T)2)));                                                      \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+/* tanh(|x|) = |x| + |x|^3 * P(x^2) of |x| < tanh_small, where e / (e + 2) loses to the roundings */    \
+template <typename T>                                                                                   \
+static inline _sfu_V<T> _sfu_tanh_small(const _sfu_V<T> ax)                                             \
+{                                                                                                       \
+    typedef _sfu_vec<T> _V;                                                                             \
+    typedef decx::_sfu_consts<T> _C;                                                                    \
+    const _sfu_V<T> z = _V::mul(ax, ax);                                                                \
+    return _V::fma(_V::mul(ax, z), _sfu_poly<T, _C::tanh_n>(z, _C::tanh_c()), ax);                      \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+                                                                                                        \
+/* e^(p * log(ax)) of the positive finite ax, log(ax) in two parts, so the error does not grow with     \
+   |p * log(ax)|. Of double only (pow of float is calculated in double) */                              \
+template <typename T, bool _acc>                                                                        \
+static inline _sfu_V<T> _sfu_pow_pos(const _sfu_V<T> ax, const T p)                                     \
+{                                                                                                       \
+    typedef _sfu_vec<T> _V;                                                                             \
+    const _sfu_V<T> vp = _V::set1(p);                                                                   \
+    _sfu_V<T> lo;                                                                                       \
+    const _sfu_V<T> hi = _sfu_log_dd<T>(ax, &lo);                                                       \
+    const _sfu_V<T> yh = _V::mul(vp, hi);                                                               \
+    const _sfu_V<T> yl = _V::fma(vp, lo, _V::mul_err(vp, hi, yh));                                      \
+    /* past -exp_min, e^yh is 0 or inf and yl is dropped (NaN of the infinite yh) */                    \
+    return _sfu_exp<T, _acc>(yh, _V::select(_V::lt(_sfu_abs<T>(yh), _V::set1(-decx::_sfu_consts<T>::exp_min())), yl, \
+        _V::set1((T)0)));                                                                               \
+}                                                                                                       \
+                                                                                                        \
+/* The functions of the fast (_acc = false) and the accurate variants, only what a variant uses of      \
+   decx::_sfu_consts<T> is instantiated */                                                              \
+template <typename T, bool _acc> struct _sfu_funcs;                                                     \
+                                                                                                        \
+                                                                                                        \
+template <typename T>                                                                                   \
+struct _sfu_funcs<T, false>                                                                             \
+{                                                                                                       \
+    typedef _sfu_vec<T> _V;                                                                             \
+    typedef typename _V::V V;                                                                           \
+    typedef decx::_sfu_consts<T> _C;                                                                    \
+                                                                                                        \
+    static inline V log(const V x)                                                                      \
+    {                                                                                                   \
+        V k;                                                                                            \
+        const V f = _sfu_log_split<T>(x, &k);                                                           \
+        return _sfu_log_core<T>(f, k);                                                                  \
+    }                                                                                                   \
+                                                                                                        \
+    static inline V sin(const V x, const bool _cos)                                                     \
+    {                                                                                                   \
+        typename _V::I qb;                                                                              \
+        V y;                                                                                            \
+        const V r = _sfu_reduce_pio2<T, 3>(x, _C::pio2_c(), &qb, &y);                                   \
+        return _cos ? _sfu_sin_of<T, true>(r, y, qb) : _sfu_sin_of<T, false>(r, y, qb);                 \
+    }                                                                                                   \
+                                                                                                        \
+    /* the quotient of the parts corrected once, against the tails of sin(r) and cos(r) */              \
+    static inline V tan(const V x)                                                                      \
+    {                                                                                                   \
+        typename _V::I qb;                                                                              \
+        V y, num, num_t, den, den_t;                                                                    \
+        const V r = _sfu_reduce_pio2<T, 3>(x, _C::pio2_c(), &qb, &y);                                   \
+        _sfu_tan_parts<T>(r, y, qb, &num, &num_t, &den, &den_t);                                        \
+        const V rcp = _V::div(_V::set1((T)1), den);                                                     \
+        const V t = _V::mul(num, rcp);                                                                  \
+        const V e = _V::sub(_V::add(_V::fma(_V::bxor(t, _V::set1((T)-0.0)), den, num), num_t), _V::mul(t, den_t)); \
+        return _V::fma(e, rcp, t);                                                                      \
+    }                                                                                                   \
+                                                                                                        \
+    static inline V tanh(const V x)                                                                     \
+    {                                                                                                   \
+        const V sign = _V::band(x, _V::set1((T)-0.0));                                                  \
+        const V ax = _V::min(_V::set1(_C::tanh_max()), _V::bxor(x, sign));                              \
+        return _V::bor(_V::select(_V::lt(ax, _V::set1(_C::tanh_small())), _sfu_tanh_small<T>(ax), _sfu_tanh_pos<T>(ax)), sign); \
+    }                                                                                                   \
+                                                                                                        \
+    /* 1 / (1 + t) of x >= 0, t / (1 + t) of x < 0, t = e^-|x| does not overflow. The rounding dl of 1 + t is \
+       taken off the quotient to the first order, q * dl / d, which needs no exact residual (SSE4.2 has no FMA) */ \
+    static inline V sigmoid(const V x)                                                                  \
+    {                                                                                                   \
+        const V t = _sfu_exp<T, false>(_V::bor(x, _V::set1((T)-0.0)), _V::set1((T)0));                  \
+        const V one = _V::set1((T)1);                                                                   \
+        const V d = _V::add(one, t);                                                                    \
+        const V dl = _V::add(_V::sub(one, d), t);                                                       \
+        const V q = _V::div(_V::select(_V::lt(x, _V::set1((T)0)), t, one), d);                          \
+        return _V::sub(q, _V::mul(q, _V::div(dl, d)));                                                  \
+    }                                                                                                   \
+                                                                                                        \
+    /* 0 is kept (the activations), log(0) is not */                                                    \
+    static inline V pow(const V ax, const T p)                                                          \
+    {                                                                                                   \
+        const V zero = _V::set1((T)0);                                                                  \
+        return _V::select(_V::eq(ax, zero), p > 0 ? zero : _V::set1(std::numeric_limits<T>::infinity()), \
+            _sfu_pow_pos<T, false>(ax, p));                                                             \
+    }                                                                                                   \
+                                                                                                        \
+    static inline V calc(const int op, const V x)                                                       \
+    {                                                                                                   \
+        switch (op)                                                                                     \
+        {                                                                                               \
+        case _SFU_EXP_:     return _sfu_exp<T, false>(x, _V::set1((T)0));                               \
+        case _SFU_LOG_:     return _sfu_funcs<T, false>::log(x);                                        \
+        case _SFU_SIN_:     return _sfu_funcs<T, false>::sin(x, false);                                 \
+        case _SFU_COS_:     return _sfu_funcs<T, false>::sin(x, true);                                  \
+        case _SFU_TAN_:     return _sfu_funcs<T, false>::tan(x);                                        \
+        case _SFU_TANH_:    return _sfu_funcs<T, false>::tanh(x);                                       \
+        default:            return _sfu_funcs<T, false>::sigmoid(x);                                    \
+        }                                                                                               \
+    }                                                                                                   \
+};                                                                                                      \
+                                                                                                        \
+                                                                                                        \
+template <typename T>                                                                                   \
+struct _sfu_funcs<T, true>                                                                              \
+{                                                                                                       \
+    typedef _sfu_vec<T> _V;                                                                             \
+    typedef typename _V::V V;                                                                           \
+    typedef decx::_sfu_consts<T> _C;                                                                    \
+                                                                                                        \
+    /* hi of the log in two parts, rounded once */                                                      \
+    static inline V log(const V x)                                                                      \
+    {                                                                                                   \
+        V lo;                                                                                           \
+        V res = _sfu_log_dd<T>(x, &lo);                                                                 \
+        const V inf = _V::set1(std::numeric_limits<T>::infinity());                                     \
+        res = _V::select(_V::eq(x, inf), inf, res);                                                     \
+        res = _V::select(_V::eq(x, _V::set1((T)0)), _V::bxor(inf, _V::set1((T)-0.0)), res);             \
+        return _V::select(_V::nge(x, _V::set1((T)0)), _V::set1(std::numeric_limits<T>::quiet_NaN()), res); \
+    }                                                                                                   \
+                                                                                                        \
+    static inline V sin(const V x, const bool _cos)                                                     \
+    {                                                                                                   \
+        typename _V::I qb;                                                                              \
+        V y;                                                                                            \
+        const V r = _sfu_reduce_pio2<T, 4>(x, _C::pio2_acc_c(), &qb, &y);                               \
+        return _cos ? _sfu_sin_of<T, true>(r, y, qb) : _sfu_sin_of<T, false>(r, y, qb);                 \
+    }                                                                                                   \
+                                                                                                        \
+    /* the quotient of sin(r) and cos(r) with their tails, corrected once */                            \
+    static inline V tan(const V x)                                                                      \
+    {                                                                                                   \
+        typename _V::I qb;                                                                              \
+        V y, num, num_t, den, den_t;                                                                    \
+        const V r = _sfu_reduce_pio2<T, 4>(x, _C::pio2_acc_c(), &qb, &y);                               \
+        _sfu_tan_parts<T>(r, y, qb, &num, &num_t, &den, &den_t);                                        \
+        const V t = _V::div(num, den);                                                                  \
+        const V p = _V::mul(t, den);                                                                    \
+        const V e = _V::sub(_V::add(_V::sub(_V::sub(num, p), _V::mul_err(t, den, p)), num_t), _V::mul(t, den_t)); \
+        return _V::add(t, _V::div(e, den));                                                             \
+    }                                                                                                   \
+                                                                                                        \
+    /* 1 - 2 / (e^(2|x|) + 1) of |x| >= tanh_small, e^(2|x|) in two parts and the quotient corrected once */ \
+    static inline V tanh(const V x)                                                                     \
+    {                                                                                                   \
+        const V sign = _V::band(x, _V::set1((T)-0.0));                                                  \
+        const V ax = _V::min(_V::set1(_C::tanh_max()), _V::bxor(x, sign));                              \
+        const V one = _V::set1((T)1), two = _V::set1((T)2);                                             \
+        V e_lo;                                                                                         \
+        const V e = _sfu_exp_dd<T>(_V::add(ax, ax), _V::set1((T)0), &e_lo);                             \
+        const V d = _V::add(e, one);                                                                    \
+        const V d_lo = _V::add(_V::add(_V::sub(e, d), one), e_lo);                                      \
+        const V g = _V::div(two, d);                                                                    \
+        const V p = _V::mul(g, d);                                                                      \
+        const V g_lo = _V::div(_V::sub(_V::sub(_V::sub(two, p), _V::mul_err(g, d, p)), _V::mul(g, d_lo)), d); \
+        const V h = _V::sub(one, g);                                                                    \
+        const V big = _V::add(h, _V::sub(_V::sub(_V::sub(one, h), g), g_lo));                           \
+        return _V::bor(_V::select(_V::lt(ax, _V::set1(_C::tanh_small())), _sfu_tanh_small<T>(ax), big), sign); \
+    }                                                                                                   \
+                                                                                                        \
+    /* 1 / (1 + t) of x >= 0, t / (1 + t) of x < 0, t = e^-|x| in two parts, the quotient corrected once */ \
+    static inline V sigmoid(const V x)                                                                  \
+    {                                                                                                   \
+        const V one = _V::set1((T)1), zero = _V::set1((T)0);                                            \
+        V t_lo;                                                                                         \
+        const V t = _sfu_exp_dd<T>(_V::bor(x, _V::set1((T)-0.0)), zero, &t_lo);                         \
+        const V d = _V::add(one, t);                                                                    \
+        const V d_lo = _V::add(_V::add(_V::sub(one, d), t), t_lo);                                      \
+        const typename _V::M neg = _V::lt(x, zero);                                                     \
+        const V num = _V::select(neg, t, one), num_lo = _V::select(neg, t_lo, zero);                    \
+        const V q = _V::div(num, d);                                                                    \
+        const V p = _V::mul(q, d);                                                                      \
+        const V e = _V::sub(_V::add(_V::sub(_V::sub(num, p), _V::mul_err(q, d, p)), num_lo), _V::mul(q, d_lo)); \
+        return _V::add(q, _V::div(e, d));                                                               \
+    }                                                                                                   \
+                                                                                                        \
+    static inline V pow(const V ax, const T p)                                                          \
+    {                                                                                                   \
+        const V zero = _V::set1((T)0), inf = _V::set1(std::numeric_limits<T>::infinity());              \
+        V res = _sfu_pow_pos<T, true>(ax, p);                                                           \
+        /* 0, inf and NaN, where log(x) is not finite */                                                \
+        res = _V::select(_V::eq(ax, zero), p > 0 ? zero : inf, res);                                    \
+        res = _V::select(_V::eq(ax, inf), p > 0 ? inf : zero, res);                                     \
+        return _V::select(_V::unord(ax, ax), ax, res);                                                  \
+    }                                                                                                   \
+                                                                                                        \
+    static inline V calc(const int op, const V x)                                                       \
+    {                                                                                                   \
+        switch (op)                                                                                     \
+        {                                                                                               \
+        case _SFU_EXP_:     return _sfu_exp<T, true>(x, _V::set1((T)0));                                \
+        case _SFU_LOG_:     return _sfu_funcs<T, true>::log(x);                                         \
+        case _SFU_SIN_:     return _sfu_funcs<T, true>::sin(x, false);                                  \
+        case _SFU_COS_:     return _sfu_funcs<T, true>::sin(x, true);                                   \
+        case _SFU_TAN_:     return _sfu_funcs<T, true>::tan(x);                                         \
+        case _SFU_TANH_:    return _sfu_funcs<T, true>::tanh(x);                                        \
+        default:            return _sfu_funcs<T, true>::sigmoid(x);                                     \
+        }                                                                                               \
+    }                                                                                                   \
+};                                                                                                      \
+                                                                                                        \
+                                                                                                        \
+/* pow of the sign of x : odd p keeps it, not integral p gives NaN of the negative x */                 \
+template <typename T, bool _acc>                                                                        \
+static inline _sfu_V<T> _sfu_pow(const _sfu_V<T> x, const T p, const bool _int, const bool _odd)        \
+{                                                                                                       \
+    typedef _sfu_vec<T> _V;                                                                             \
+    const _sfu_V<T> sign = _V::band(x, _V::set1((T)-0.0));                                              \
+    _sfu_V<T> res = _sfu_funcs<T, _acc>::pow(_V::bxor(x, sign), p);                                     \
+    if (_odd) {                                                                                         \
+        res = _V::bor(res, sign);                                                                       \
+    }                                                                                                   \
+    if (!_int) {                                                                                        \
+        res = _V::select(_V::lt(x, _V::set1((T)0)), _V::set1(std::numeric_limits<T>::quiet_NaN()), res); \
+    }                                                                                                   \
+    return res;                                                                                         \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+                                                                                                        \
+template <typename T, int _op, bool _acc>                                                               \
+static void _THREAD_FUNCTION_ _sfu_k(const T* src, T* dst, const size_t len)                            \
+{                                                                                                       \
+    typedef _sfu_vec<T> _V;                                                                             \
+    size_t i = 0;                                                                                       \
+    for (; i + _V::W <= len; i += _V::W) {                                                              \
+        _V::store(dst + i, _sfu_funcs<T, _acc>::calc(_op, _V::load(src + i)));                          \
+    }                                                                                                   \
+    if (i < len) {                                                                                      \
+        T _tail[_V::W] = { 0 };                                                                         \
+        for (size_t j = i; j < len; ++j) { _tail[j - i] = src[j]; }                                     \
+        _V::store(_tail, _sfu_funcs<T, _acc>::calc(_op, _V::load(_tail)));                              \
+        for (size_t j = i; j < len; ++j) { dst[j] = _tail[j - i]; }                                     \
+    }                                                                                                   \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+/* float, calculated in double */                                                                       \
+template <int _op, bool _acc>                                                                           \
+static void _THREAD_FUNCTION_ _sfu_k_widen(const float* src, float* dst, const size_t len)              \
+{                                                                                                       \
+    typedef _sfu_vec<float> _V;                                                                         \
+    typedef _sfu_vec<double>::V _Vd;                                                                    \
+    size_t i = 0;                                                                                       \
+    _Vd lo, hi;                                                                                         \
+    for (; i + _V::W <= len; i += _V::W) {                                                              \
+        _V::widen(_V::load(src + i), &lo, &hi);                                                         \
+        _V::store(dst + i, _V::narrow(_sfu_funcs<double, _acc>::calc(_op, lo), _sfu_funcs<double, _acc>::calc(_op, hi))); \
+    }                                                                                                   \
+    if (i < len) {                                                                                      \
+        float _tail[_V::W] = { 0 };                                                                     \
+        for (size_t j = i; j < len; ++j) { _tail[j - i] = src[j]; }                                     \
+        _V::widen(_V::load(_tail), &lo, &hi);                                                           \
+        _V::store(_tail, _V::narrow(_sfu_funcs<double, _acc>::calc(_op, lo), _sfu_funcs<double, _acc>::calc(_op, hi))); \
+        for (size_t j = i; j < len; ++j) { dst[j] = _tail[j - i]; }                                     \
+    }                                                                                                   \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+template <bool _acc>                                                                                    \
+static void _THREAD_FUNCTION_ _sfu_pow_k64(const double* src, const double p, double* dst, const size_t len) \
+{                                                                                                       \
+    typedef _sfu_vec<double> _V;                                                                        \
+    bool _int, _odd;                                                                                    \
+    if (decx::_sfu_pow_flags(p, &_int, &_odd)) {                                                        \
+        for (size_t i = 0; i < len; ++i) { dst[i] = 1; }                                                \
+        return;                                                                                         \
+    }                                                                                                   \
+    size_t i = 0;                                                                                       \
+    for (; i + _V::W <= len; i += _V::W) {                                                              \
+        _V::store(dst + i, _sfu_pow<double, _acc>(_V::load(src + i), p, _int, _odd));                   \
+    }                                                                                                   \
+    if (i < len) {                                                                                      \
+        double _tail[_V::W] = { 0 };                                                                    \
+        for (size_t j = i; j < len; ++j) { _tail[j - i] = src[j]; }                                     \
+        _V::store(_tail, _sfu_pow<double, _acc>(_V::load(_tail), p, _int, _odd));                       \
+        for (size_t j = i; j < len; ++j) { dst[j] = _tail[j - i]; }                                     \
+    }                                                                                                   \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+/* float, calculated in double */                                                                       \
+template <bool _acc>                                                                                    \
+static void _THREAD_FUNCTION_ _sfu_pow_k32(const float* src, const float p, float* dst, const size_t len) \
+{                                                                                                       \
+    typedef _sfu_vec<float> _V;                                                                         \
+    typedef _sfu_vec<double>::V _Vd;                                                                    \
+    bool _int, _odd;                                                                                    \
+    if (decx::_sfu_pow_flags((double)p, &_int, &_odd)) {                                                \
+        for (size_t i = 0; i < len; ++i) { dst[i] = 1; }                                                \
+        return;                                                                                         \
+    }                                                                                                   \
+    size_t i = 0;                                                                                       \
+    _Vd lo, hi;                                                                                         \
+    for (; i + _V::W <= len; i += _V::W) {                                                              \
+        _V::widen(_V::load(src + i), &lo, &hi);                                                         \
+        _V::store(dst + i, _V::narrow(_sfu_pow<double, _acc>(lo, p, _int, _odd), _sfu_pow<double, _acc>(hi, p, _int, _odd))); \
+    }                                                                                                   \
+    if (i < len) {                                                                                      \
+        float _tail[_V::W] = { 0 };                                                                     \
+        for (size_t j = i; j < len; ++j) { _tail[j - i] = src[j]; }                                     \
+        _V::widen(_V::load(_tail), &lo, &hi);                                                           \
+        _V::store(_tail, _V::narrow(_sfu_pow<double, _acc>(lo, p, _int, _odd), _sfu_pow<double, _acc>(hi, p, _int, _odd))); \
+        for (size_t j = i; j < len; ++j) { dst[j] = _tail[j - i]; }                                     \
+    }                                                                                                   \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+template <int _op>                                                                                      \
+static void _fill_sfu_op(decx::_sfu_kernel_table* table)                                                \
+{                                                                                                       \
+    table->f[_op][0] = &_sfu_k<float, _op, false>;                                                      \
+    table->f[_op][1] = &_sfu_k_widen<_op, true>;                                                        \
+    table->d[_op][0] = &_sfu_k<double, _op, false>;                                                     \
+    table->d[_op][1] = &_sfu_k<double, _op, true>;                                                      \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+static void _fill_sfu_table(decx::_sfu_kernel_table* table)                                             \
+{                                                                                                       \
+    _fill_sfu_op<_SFU_EXP_>(table);                                                                     \
+    _fill_sfu_op<_SFU_LOG_>(table);                                                                     \
+    _fill_sfu_op<_SFU_SIN_>(table);                                                                     \
+    _fill_sfu_op<_SFU_COS_>(table);                                                                     \
+    _fill_sfu_op<_SFU_TAN_>(table);                                                                     \
+    _fill_sfu_op<_SFU_TANH_>(table);                                                                    \
+    _fill_sfu_op<_SFU_SIGMOID_>(table);                                                                 \
+    table->fpow[0] = &_sfu_pow_k32<false>;                                                              \
+    table->fpow[1] = &_sfu_pow_k32<true>;                                                               \
+    table->dpow[0] = &_sfu_pow_k64<false>;                                                              \
+    table->dpow[1] = &_sfu_pow_k64<true>;                                                               \
+}
+
+
+
+// ------------------------------------------ SSE4.2 ------------------------------------------------
+
+
+_DECX_ISA_BEGIN_SSE42_
+namespace decx
+{
+    namespace sse42
+    {
+        template <typename T> struct _sfu_vec;
+
+
+        template <> struct _sfu_vec<double>
+        {
+            typedef __m128d V;
+            typedef __m128i I;
+            typedef __m128d M;
+            static const int W = 2;
+
+            static inline V load(const double* p)                   { return _mm_loadu_pd(p); }
+            static inline void store(double* p, const V v)          { _mm_storeu_pd(p, v); }
+            static inline V set1(const double a)                    { return _mm_set1_pd(a); }
+            static inline I iset1(const long long a)                { return _mm_set1_epi64x(a); }
+
+            static inline V add(const V a, const V b)               { return _mm_add_pd(a, b); }
+            static inline V sub(const V a, const V b)               { return _mm_sub_pd(a, b); }
+            static inline V mul(const V a, const V b)               { return _mm_mul_pd(a, b); }
+            static inline V div(const V a, const V b)               { return _mm_div_pd(a, b); }
+            static inline V min(const V a, const V b)               { return _mm_min_pd(a, b); }
+            static inline V max(const V a, const V b)               { return _mm_max_pd(a, b); }
+            static inline V fma(const V a, const V b, const V c)    { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+
+            // a * b - p exactly, p is a * b rounded (Dekker, no FMA, not to be contracted by the compiler)
+            static inline V mul_err(const V a, const V b, const V p)
+            {
+                const __m128d _split = _mm_set1_pd(134217729.0);        // 2^27 + 1
+                __m128d t = _mm_mul_pd(a, _split);
+                const __m128d ah = _mm_sub_pd(t, _mm_sub_pd(t, a)), al = _mm_sub_pd(a, ah);
+                t = _mm_mul_pd(b, _split);
+                const __m128d bh = _mm_sub_pd(t, _mm_sub_pd(t, b)), bl = _mm_sub_pd(b, bh);
+                t = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(ah, bh), p), _mm_mul_pd(ah, bl));
+                return _mm_add_pd(_mm_add_pd(t, _mm_mul_pd(al, bh)), _mm_mul_pd(al, bl));
+            }
+
+            static inline V band(const V a, const V b)              { return _mm_and_pd(a, b); }
+            static inline V bor(const V a, const V b)               { return _mm_or_pd(a, b); }
+            static inline V bxor(const V a, const V b)              { return _mm_xor_pd(a, b); }
+
+            static inline M lt(const V a, const V b)                { return _mm_cmplt_pd(a, b); }
+            static inline M eq(const V a, const V b)                { return _mm_cmpeq_pd(a, b); }
+            static inline M nge(const V a, const V b)               { return _mm_cmpnge_pd(a, b); }
+            static inline M unord(const V a, const V b)             { return _mm_cmpunord_pd(a, b); }
+            // m ? a : b
+            static inline V select(const M m, const V a, const V b) { return _mm_blendv_pd(b, a, m); }
+
+            static inline I casti(const V a)                        { return _mm_castpd_si128(a); }
+            static inline V castf(const I a)                        { return _mm_castsi128_pd(a); }
+            static inline I iadd(const I a, const I b)              { return _mm_add_epi64(a, b); }
+            static inline I isub(const I a, const I b)              { return _mm_sub_epi64(a, b); }
+            static inline I iand(const I a, const I b)              { return _mm_and_si128(a, b); }
+            static inline I ior(const I a, const I b)               { return _mm_or_si128(a, b); }
+            static inline I shl_mant(const I a)                     { return _mm_slli_epi64(a, 52); }
+            static inline I shr_mant(const I a)                     { return _mm_srli_epi64(a, 52); }
+            static inline M ieqz(const I a)                         { return _mm_castsi128_pd(_mm_cmpeq_epi64(a, _mm_setzero_si128())); }
+        };
+
+
+        template <> struct _sfu_vec<float>
+        {
+            typedef __m128 V;
+            typedef __m128i I;
+            typedef __m128 M;
+            static const int W = 4;
+
+            static inline V load(const float* p)                    { return _mm_loadu_ps(p); }
+            static inline void store(float* p, const V v)           { _mm_storeu_ps(p, v); }
+            static inline V set1(const float a)                     { return _mm_set1_ps(a); }
+            static inline I iset1(const int a)                      { return _mm_set1_epi32(a); }
+
+            static inline V add(const V a, const V b)               { return _mm_add_ps(a, b); }
+            static inline V sub(const V a, const V b)               { return _mm_sub_ps(a, b); }
+            static inline V mul(const V a, const V b)               { return _mm_mul_ps(a, b); }
+            static inline V div(const V a, const V b)               { return _mm_div_ps(a, b); }
+            static inline V min(const V a, const V b)               { return _mm_min_ps(a, b); }
+            static inline V max(const V a, const V b)               { return _mm_max_ps(a, b); }
+            static inline V fma(const V a, const V b, const V c)    { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+
+            static inline V band(const V a, const V b)              { return _mm_and_ps(a, b); }
+            static inline V bor(const V a, const V b)               { return _mm_or_ps(a, b); }
+            static inline V bxor(const V a, const V b)              { return _mm_xor_ps(a, b); }
+
+            static inline M lt(const V a, const V b)                { return _mm_cmplt_ps(a, b); }
+            static inline V select(const M m, const V a, const V b) { return _mm_blendv_ps(b, a, m); }
+
+            static inline I casti(const V a)                        { return _mm_castps_si128(a); }
+            static inline V castf(const I a)                        { return _mm_castsi128_ps(a); }
+            static inline I iadd(const I a, const I b)              { return _mm_add_epi32(a, b); }
+            static inline I isub(const I a, const I b)              { return _mm_sub_epi32(a, b); }
+            static inline I iand(const I a, const I b)              { return _mm_and_si128(a, b); }
+            static inline I ior(const I a, const I b)               { return _mm_or_si128(a, b); }
+            static inline I shl_mant(const I a)                     { return _mm_slli_epi32(a, 23); }
+            static inline I shr_mant(const I a)                     { return _mm_srli_epi32(a, 23); }
+            static inline M ieqz(const I a)                         { return _mm_castsi128_ps(_mm_cmpeq_epi32(a, _mm_setzero_si128())); }
+
+            // the halves of x to double, and back
+            static inline void widen(const V x, __m128d* lo, __m128d* hi)
+            {
+                *lo = _mm_cvtps_pd(x);
+                *hi = _mm_cvtps_pd(_mm_movehl_ps(x, x));
+            }
+            static inline V narrow(const __m128d lo, const __m128d hi)  { return _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi)); }
+        };
+
+
+        _DECX_SFU_KERNELS_
+    }
+}
+_DECX_ISA_END_
+
+
+
+// ------------------------------------------- AVX2 -------------------------------------------------
+
+
+_DECX_ISA_BEGIN_AVX2_
+namespace decx
+{
+    namespace avx2
+    {
+        template <typename T> struct _sfu_vec;
+
+
+        template <> struct _sfu_vec<double>
+        {
+            typedef __m256d V;
+            typedef __m256i I;
+            typedef __m256d M;
+            static const int W = 4;
+
+            static inline V load(const double* p)                   { return _mm256_loadu_pd(p); }
+            static inline void store(double* p, const V v)          { _mm256_storeu_pd(p, v); }
+            static inline V set1(const double a)                    { return _mm256_set1_pd(a); }
+            static inline I iset1(const long long a)                { return _mm256_set1_epi64x(a); }
+
+            static inline V add(const V a, const V b)               { return _mm256_add_pd(a, b); }
+            static inline V sub(const V a, const V b)               { return _mm256_sub_pd(a, b); }
+            static inline V mul(const V a, const V b)               { return _mm256_mul_pd(a, b); }
+            static inline V div(const V a, const V b)               { return _mm256_div_pd(a, b); }
+            static inline V min(const V a, const V b)               { return _mm256_min_pd(a, b); }
+            static inline V max(const V a, const V b)               { return _mm256_max_pd(a, b); }
+            static inline V fma(const V a, const V b, const V c)    { return _mm256_fmadd_pd(a, b, c); }
+            static inline V mul_err(const V a, const V b, const V p){ return _mm256_fmsub_pd(a, b, p); }
+
+            static inline V band(const V a, const V b)              { return _mm256_and_pd(a, b); }
+            static inline V bor(const V a, const V b)               { return _mm256_or_pd(a, b); }
+            static inline V bxor(const V a, const V b)              { return _mm256_xor_pd(a, b); }
+
+            static inline M lt(const V a, const V b)                { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+            static inline M eq(const V a, const V b)                { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+            static inline M nge(const V a, const V b)               { return _mm256_cmp_pd(a, b, _CMP_NGE_UQ); }
+            static inline M unord(const V a, const V b)             { return _mm256_cmp_pd(a, b, _CMP_UNORD_Q); }
+            static inline V select(const M m, const V a, const V b) { return _mm256_blendv_pd(b, a, m); }
+
+            static inline I casti(const V a)                        { return _mm256_castpd_si256(a); }
+            static inline V castf(const I a)                        { return _mm256_castsi256_pd(a); }
+            static inline I iadd(const I a, const I b)              { return _mm256_add_epi64(a, b); }
+            static inline I isub(const I a, const I b)              { return _mm256_sub_epi64(a, b); }
+            static inline I iand(const I a, const I b)              { return _mm256_and_si256(a, b); }
+            static inline I ior(const I a, const I b)               { return _mm256_or_si256(a, b); }
+            static inline I shl_mant(const I a)                     { return _mm256_slli_epi64(a, 52); }
+            static inline I shr_mant(const I a)                     { return _mm256_srli_epi64(a, 52); }
+            static inline M ieqz(const I a)                         { return _mm256_castsi256_pd(_mm256_cmpeq_epi64(a, _mm256_setzero_si256())); }
+        };
+
+
+        template <> struct _sfu_vec<float>
+        {
+            typedef __m256 V;
+            typedef __m256i I;
+            typedef __m256 M;
+            static const int W = 8;
+
+            static inline V load(const float* p)                    { return _mm256_loadu_ps(p); }
+            static inline void store(float* p, const V v)           { _mm256_storeu_ps(p, v); }
+            static inline V set1(const float a)                     { return _mm256_set1_ps(a); }
+            static inline I iset1(const int a)                      { return _mm256_set1_epi32(a); }
+
+            static inline V add(const V a, const V b)               { return _mm256_add_ps(a, b); }
+            static inline V sub(const V a, const V b)               { return _mm256_sub_ps(a, b); }
+            static inline V mul(const V a, const V b)               { return _mm256_mul_ps(a, b); }
+            static inline V div(const V a, const V b)               { return _mm256_div_ps(a, b); }
+            static inline V min(const V a, const V b)               { return _mm256_min_ps(a, b); }
+            static inline V max(const V a, const V b)               { return _mm256_max_ps(a, b); }
+            static inline V fma(const V a, const V b, const V c)    { return _mm256_fmadd_ps(a, b, c); }
+
+            static inline V band(const V a, const V b)              { return _mm256_and_ps(a, b); }
+            static inline V bor(const V a, const V b)               { return _mm256_or_ps(a, b); }
+            static inline V bxor(const V a, const V b)              { return _mm256_xor_ps(a, b); }
+
+            static inline M lt(const V a, const V b)                { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+            static inline V select(const M m, const V a, const V b) { return _mm256_blendv_ps(b, a, m); }
+
+            static inline I casti(const V a)                        { return _mm256_castps_si256(a); }
+            static inline V castf(const I a)                        { return _mm256_castsi256_ps(a); }
+            static inline I iadd(const I a, const I b)              { return _mm256_add_epi32(a, b); }
+            static inline I isub(const I a, const I b)              { return _mm256_sub_epi32(a, b); }
+            static inline I iand(const I a, const I b)              { return _mm256_and_si256(a, b); }
+            static inline I ior(const I a, const I b)               { return _mm256_or_si256(a, b); }
+            static inline I shl_mant(const I a)                     { return _mm256_slli_epi32(a, 23); }
+            static inline I shr_mant(const I a)                     { return _mm256_srli_epi32(a, 23); }
+            static inline M ieqz(const I a)                         { return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, _mm256_setzero_si256())); }
+
+            static inline void widen(const V x, __m256d* lo, __m256d* hi)
+            {
+                *lo = _mm256_cvtps_pd(_mm256_castps256_ps128(x));
+                *hi = _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1));
+            }
+            static inline V narrow(const __m256d lo, const __m256d hi)
+            {
+                return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(lo)), _mm256_cvtpd_ps(hi), 1);
+            }
+        };
+
+
+        _DECX_SFU_KERNELS_
+    }
+}
+_DECX_ISA_END_
+
+
+
+// ------------------------------------------ AVX-512 -----------------------------------------------
+
+
+_DECX_ISA_BEGIN_AVX512_
+namespace decx
+{
+    namespace avx512
+    {
+        // the bitwise operations of the floating point vectors are AVX512-DQ, they go through the integers
+
+        template <typename T> struct _sfu_vec;
+
+
+        template <> struct _sfu_vec<double>
+        {
+            typedef __m512d V;
+            typedef __m512i I;
+            typedef __mmask8 M;
+            static const int W = 8;
+
+            static inline V load(const double* p)                   { return _mm512_loadu_pd(p); }
+            static inline void store(double* p, const V v)          { _mm512_storeu_pd(p, v); }
+            static inline V set1(const double a)                    { return _mm512_set1_pd(a); }
+            static inline I iset1(const long long a)                { return _mm512_set1_epi64(a); }
+
+            static inline V add(const V a, const V b)               { return _mm512_add_pd(a, b); }
+            static inline V sub(const V a, const V b)               { return _mm512_sub_pd(a, b); }
+            static inline V mul(const V a, const V b)               { return _mm512_mul_pd(a, b); }
+            static inline V div(const V a, const V b)               { return _mm512_div_pd(a, b); }
+            static inline V min(const V a, const V b)               { return _mm512_min_pd(a, b); }
+            static inline V max(const V a, const V b)               { return _mm512_max_pd(a, b); }
+            static inline V fma(const V a, const V b, const V c)    { return _mm512_fmadd_pd(a, b, c); }
+            static inline V mul_err(const V a, const V b, const V p){ return _mm512_fmsub_pd(a, b, p); }
+
+            static inline V band(const V a, const V b)              { return castf(_mm512_and_si512(casti(a), casti(b))); }
+            static inline V bor(const V a, const V b)               { return castf(_mm512_or_si512(casti(a), casti(b))); }
+            static inline V bxor(const V a, const V b)              { return castf(_mm512_xor_si512(casti(a), casti(b))); }
+
+            static inline M lt(const V a, const V b)                { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+            static inline M eq(const V a, const V b)                { return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ); }
+            static inline M nge(const V a, const V b)               { return _mm512_cmp_pd_mask(a, b, _CMP_NGE_UQ); }
+            static inline M unord(const V a, const V b)             { return _mm512_cmp_pd_mask(a, b, _CMP_UNORD_Q); }
+            static inline V select(const M m, const V a, const V b) { return _mm512_mask_blend_pd(m, b, a); }
+
+            static inline I casti(const V a)                        { return _mm512_castpd_si512(a); }
+            static inline V castf(const I a)                        { return _mm512_castsi512_pd(a); }
+            static inline I iadd(const I a, const I b)              { return _mm512_add_epi64(a, b); }
+            static inline I isub(const I a, const I b)              { return _mm512_sub_epi64(a, b); }
+            static inline I iand(const I a, const I b)              { return _mm512_and_si512(a, b); }
+            static inline I ior(const I a, const I b)               { return _mm512_or_si512(a, b); }
+            static inline I shl_mant(const I a)                     { return _mm512_slli_epi64(a, 52); }
+            static inline I shr_mant(const I a)                     { return _mm512_srli_epi64(a, 52); }
+            static inline M ieqz(const I a)                         { return _mm512_testn_epi64_mask(a, a); }
+        };
+
+
+        template <> struct _sfu_vec<float>
+        {
+            typedef __m512 V;
+            typedef __m512i I;
+            typedef __mmask16 M;
+            static const int W = 16;
+
+            static inline V load(const float* p)                    { return _mm512_loadu_ps(p); }
+            static inline void store(float* p, const V v)           { _mm512_storeu_ps(p, v); }
+            static inline V set1(const float a)                     { return _mm512_set1_ps(a); }
+            static inline I iset1(const int a)                      { return _mm512_set1_epi32(a); }
+
+            static inline V add(const V a, const V b)               { return _mm512_add_ps(a, b); }
+            static inline V sub(const V a, const V b)               { return _mm512_sub_ps(a, b); }
+            static inline V mul(const V a, const V b)               { return _mm512_mul_ps(a, b); }
+            static inline V div(const V a, const V b)               { return _mm512_div_ps(a, b); }
+            static inline V min(const V a, const V b)               { return _mm512_min_ps(a, b); }
+            static inline V max(const V a, const V b)               { return _mm512_max_ps(a, b); }
+            static inline V fma(const V a, const V b, const V c)    { return _mm512_fmadd_ps(a, b, c); }
+
+            static inline V band(const V a, const V b)              { return castf(_mm512_and_si512(casti(a), casti(b))); }
+            static inline V bor(const V a, const V b)               { return castf(_mm512_or_si512(casti(a), casti(b))); }
+            static inline V bxor(const V a, const V b)              { return castf(_mm512_xor_si512(casti(a), casti(b))); }
+
+            static inline M lt(const V a, const V b)                { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+            static inline V select(const M m, const V a, const V b) { return _mm512_mask_blend_ps(m, b, a); }
+
+            static inline I casti(const V a)                        { return _mm512_castps_si512(a); }
+            static inline V castf(const I a)                        { return _mm512_castsi512_ps(a); }
+            static inline I iadd(const I a, const I b)              { return _mm512_add_epi32(a, b); }
+            static inline I isub(const I a, const I b)              { return _mm512_sub_epi32(a, b); }
+            static inline I iand(const I a, const I b)              { return _mm512_and_si512(a, b); }
+            static inline I ior(const I a, const I b)               { return _mm512_or_si512(a, b); }
+            static inline I shl_mant(const I a)                     { return _mm512_slli_epi32(a, 23); }
+            static inline I shr_mant(const I a)                     { return _mm512_srli_epi32(a, 23); }
+            static inline M ieqz(const I a)                         { return _mm512_testn_epi32_mask(a, a); }
+
+            static inline void widen(const V x, __m512d* lo, __m512d* hi)
+            {
+                *lo = _mm512_cvtps_pd(_mm512_castps512_ps256(x));
+                *hi = _mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(x), 1)));
+            }
+            static inline V narrow(const __m512d lo, const __m512d hi)
+            {
+                return _mm512_castpd_ps(_mm512_insertf64x4(_mm512_castpd256_pd512(_mm256_castps_pd(_mm512_cvtpd_ps(lo))),
+                    _mm256_castps_pd(_mm512_cvtpd_ps(hi)), 1));
+            }
+        };
+
+
+        _DECX_SFU_KERNELS_
+    }
+}
+_DECX_ISA_END_
+
+
+
+namespace decx
+{
+    static void _select_sfu_kernels(const int isa)
+    {
+        switch (isa)
+        {
+        case de::CPU_ISA::ISA_AVX512:
+            decx::avx512::_fill_sfu_table(&decx::_sfu_kernels);
+            break;
+        case de::CPU_ISA::ISA_AVX2:
+            decx::avx2::_fill_sfu_table(&decx::_sfu_kernels);
+            break;
+        default:
+            decx::sse42::_fill_sfu_table(&decx::_sfu_kernels);
+            break;
+        }
+    }
+
+
+    static decx::_ISA_dispatch_reg _sfu_kernels_reg(&decx::_select_sfu_kernels);
+}
+
+
+#endif
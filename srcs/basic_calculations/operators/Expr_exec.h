@@ -0,0 +1,394 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+#ifndef _EXPR_EXEC_H_
+#define _EXPR_EXEC_H_
+
+#include "../../core/basic.h"
+#include "../../core/thread_management/parallel_for.h"
+#include "../../core/allocators/scratch_arena.h"
+#include "ew_isa_kernels.h"
+#include <memory>
+#include <vector>
+#include <cmath>
+#include <atomic>
+
+
+/**
+* The lazy element-wise expressions of the CPU (de::cpu::Expr). An expression is a tree of Add, Sub, Mul
+* and Div over the arrays (leaves) and the scalars, built by the operators of de::cpu::Expr without any
+* calculation. decx::_expr_compile() turns the tree into a list of the kernels of decx::_ew_kernels, whose
+* intermediates are the blocks of _EXPR_BLOCK_BYTES_ (slots). decx::expr_eval() runs the whole list block
+* by block on each chunk of decx::parallel_for(), so the intermediates stay in L1, the leaves are read once
+* and dst is written once, by one dispatch of the thread pool. e.g. (A * B + C) / D streams 5 arrays
+* instead of the 9 of de::cpu::Mul(), Add() and Div().
+*
+* The scalars of a node are folded, the slot of the left (or right) operand is reused by the result, so
+* the slots taken are at most the height of the tree.
+*/
+
+
+// the bytes of one slot, the slots of the longest expressions of a thread stay in L1
+#define _EXPR_BLOCK_BYTES_ 4096
+
+
+#define _EXPR_LEAF_ -1
+#define _EXPR_SCALAR_ -2
+
+
+namespace decx
+{
+    template <typename T>
+    struct _expr_node
+    {
+        // _EW_ADD_ ... _EW_DIV_, _EXPR_LEAF_ or _EXPR_SCALAR_
+        int op;
+
+        // leaf : the data of the array, the length (including the pitches) and the shape
+        // { class (0 matrix, 1 vector, 2 tensor), width, height, depth }
+        const T* src;
+        size_t len;
+        uint dims[4];
+
+        T val;
+
+        std::shared_ptr<const decx::_expr_node<T>> l, r;
+    };
+
+
+    /**
+    * @brief A leaf of the expressions, dims is { class, width, height, depth } (see decx::_expr_node)
+    */
+    template <typename T>
+    static std::shared_ptr<const decx::_expr_node<T>> _expr_leaf(const T* src, const size_t len, const uint dims[4]);
+}
+
+
+
+namespace de
+{
+    template <typename T> class _DECX_API_ Matrix;
+    template <typename T> class _DECX_API_ Vector;
+    template <typename T> class _DECX_API_ Tensor;
+
+
+    namespace cpu
+    {
+        /**
+        * An element-wise expression over the matrices, vectors or tensors (of the same shape) and the scalars,
+        * calculated only by de::cpu::Eval(). The first array of an expression is to be wrapped :
+        *   de::cpu::Eval((de::cpu::Expr<float>(A) * B + C) / D, dst);
+        * the other operands are converted. The arrays are referred, not copied, they must live until Eval().
+        */
+        template <typename T>
+        class Expr
+        {
+        public:
+            std::shared_ptr<const decx::_expr_node<T>> _node;
+
+
+            Expr(de::Matrix<T>& src);
+
+
+            Expr(de::Vector<T>& src);
+
+
+            Expr(de::Tensor<T>& src);
+
+
+            Expr(const T val);
+
+
+            explicit Expr(const std::shared_ptr<const decx::_expr_node<T>>& node) : _node(node) {}
+
+
+            static Expr _binary(const int op, const Expr& A, const Expr& B);
+
+
+            friend Expr operator+(const Expr& A, const Expr& B) { return Expr::_binary(_EW_ADD_, A, B); }
+            friend Expr operator-(const Expr& A, const Expr& B) { return Expr::_binary(_EW_SUB_, A, B); }
+            friend Expr operator*(const Expr& A, const Expr& B) { return Expr::_binary(_EW_MUL_, A, B); }
+            friend Expr operator/(const Expr& A, const Expr& B) { return Expr::_binary(_EW_DIV_, A, B); }
+        };
+    }
+}
+
+
+
+namespace decx
+{
+    // _EXPR_LEAF_ : index of decx::_expr_program::leaves, _EW_ADD_ ... (>= 0) : slot, _EXPR_SCALAR_ : val
+    template <typename T>
+    struct _expr_operand
+    {
+        int type;
+        int index;
+        T val;
+    };
+
+
+    template <typename T>
+    struct _expr_inst
+    {
+        int op;
+        decx::_expr_operand<T> A, B;
+        // the slot of the result, -1 for dst
+        int dst;
+    };
+
+
+    template <typename T>
+    struct _expr_program
+    {
+        std::vector<decx::_expr_inst<T>> inst;
+        std::vector<const T*> leaves;
+
+        // of the leaves, all the same
+        size_t len;
+        uint dims[4];
+
+        int slot_num;
+        std::vector<int> _free_slots;
+
+        _expr_program() : len(0), slot_num(0) {}
+    };
+
+
+    /**
+    * @brief Compile the expression tree of root to prog
+    * @return false if the leaves differ in shape, or there is no leaf
+    */
+    template <typename T>
+    static bool _expr_compile(const decx::_expr_node<T>* root, decx::_expr_program<T>* prog);
+
+
+    template <typename T>
+    static decx::_expr_operand<T> _expr_compile_node(const decx::_expr_node<T>* node, decx::_expr_program<T>* prog,
+        bool* shape_matched);
+
+
+    // the scalar of two scalars, int divides as the kernels (in float, rounded to the nearest)
+    template <typename T>
+    static T _expr_fold(const int op, const T a, const T b);
+
+
+    /**
+    * @brief dst = the expression of prog, dst has prog->len elements, and can be one of the leaves
+    * @return false if the slots can not be allocated
+    */
+    template <typename T>
+    static bool expr_eval(const decx::_expr_program<T>* prog, T* dst);
+}
+
+
+
+template <typename T>
+static std::shared_ptr<const decx::_expr_node<T>> decx::_expr_leaf(const T* src, const size_t len, const uint dims[4])
+{
+    std::shared_ptr<decx::_expr_node<T>> node = std::make_shared<decx::_expr_node<T>>();
+    node->op = _EXPR_LEAF_;
+    node->src = src;
+    node->len = len;
+    for (int i = 0; i < 4; ++i) {
+        node->dims[i] = dims[i];
+    }
+    return node;
+}
+
+
+
+template <typename T>
+de::cpu::Expr<T>::Expr(const T val)
+{
+    std::shared_ptr<decx::_expr_node<T>> node = std::make_shared<decx::_expr_node<T>>();
+    node->op = _EXPR_SCALAR_;
+    node->val = val;
+    this->_node = node;
+}
+
+
+
+template <typename T>
+de::cpu::Expr<T> de::cpu::Expr<T>::_binary(const int op, const de::cpu::Expr<T>& A, const de::cpu::Expr<T>& B)
+{
+    std::shared_ptr<decx::_expr_node<T>> node = std::make_shared<decx::_expr_node<T>>();
+    node->op = op;
+    node->l = A._node;
+    node->r = B._node;
+    return de::cpu::Expr<T>(std::shared_ptr<const decx::_expr_node<T>>(node));
+}
+
+
+
+template <typename T>
+static T decx::_expr_fold(const int op, const T a, const T b)
+{
+    switch (op)
+    {
+    case _EW_ADD_:  return a + b;
+    case _EW_SUB_:  return a - b;
+    case _EW_MUL_:  return a * b;
+    default:        return a / b;
+    }
+}
+
+
+template <>
+int decx::_expr_fold<int>(const int op, const int a, const int b)
+{
+    switch (op)
+    {
+    case _EW_ADD_:  return a + b;
+    case _EW_SUB_:  return a - b;
+    case _EW_MUL_:  return a * b;
+    default:        return (int)std::nearbyint((float)a / (float)b);
+    }
+}
+
+
+
+template <typename T>
+static decx::_expr_operand<T> decx::_expr_compile_node(const decx::_expr_node<T>* node, decx::_expr_program<T>* prog,
+    bool* shape_matched)
+{
+    decx::_expr_operand<T> res;
+
+    if (node->op == _EXPR_SCALAR_) {
+        res.type = _EXPR_SCALAR_;
+        res.val = node->val;
+        return res;
+    }
+    if (node->op == _EXPR_LEAF_) {
+        if (prog->leaves.empty()) {
+            prog->len = node->len;
+            for (int i = 0; i < 4; ++i) {
+                prog->dims[i] = node->dims[i];
+            }
+        }
+        else {
+            for (int i = 0; i < 4; ++i) {
+                *shape_matched = *shape_matched && (prog->dims[i] == node->dims[i]);
+            }
+            *shape_matched = *shape_matched && (prog->len == node->len);
+        }
+        res.type = _EXPR_LEAF_;
+        res.index = (int)prog->leaves.size();
+        prog->leaves.push_back(node->src);
+        return res;
+    }
+
+    const decx::_expr_operand<T> A = decx::_expr_compile_node(node->l.get(), prog, shape_matched);
+    const decx::_expr_operand<T> B = decx::_expr_compile_node(node->r.get(), prog, shape_matched);
+
+    if (A.type == _EXPR_SCALAR_ && B.type == _EXPR_SCALAR_) {
+        res.type = _EXPR_SCALAR_;
+        res.val = decx::_expr_fold<T>(node->op, A.val, B.val);
+        return res;
+    }
+
+    decx::_expr_inst<T> inst;
+    inst.op = node->op;
+    inst.A = A;
+    inst.B = B;
+
+    // the result takes the slot of an operand, the slot of the other is released
+    if (A.type >= 0) {
+        inst.dst = A.index;
+        if (B.type >= 0) {
+            prog->_free_slots.push_back(B.index);
+        }
+    }
+    else if (B.type >= 0) {
+        inst.dst = B.index;
+    }
+    else if (!prog->_free_slots.empty()) {
+        inst.dst = prog->_free_slots.back();
+        prog->_free_slots.pop_back();
+    }
+    else {
+        inst.dst = prog->slot_num++;
+    }
+    prog->inst.push_back(inst);
+
+    res.type = 0;
+    res.index = inst.dst;
+    return res;
+}
+
+
+
+template <typename T>
+static bool decx::_expr_compile(const decx::_expr_node<T>* root, decx::_expr_program<T>* prog)
+{
+    bool shape_matched = true;
+    const decx::_expr_operand<T> res = decx::_expr_compile_node(root, prog, &shape_matched);
+
+    if (!shape_matched || prog->leaves.empty()) {
+        return false;
+    }
+    if (res.type == _EXPR_LEAF_) {
+        // a single array is copied, as dst = src * 1
+        decx::_expr_inst<T> inst;
+        inst.op = _EW_MUL_;
+        inst.A = res;
+        inst.B.type = _EXPR_SCALAR_;
+        inst.B.val = 1;
+        prog->inst.push_back(inst);
+    }
+    // the last instruction is the root
+    prog->inst.back().dst = -1;
+    return true;
+}
+
+
+
+template <typename T>
+static bool decx::expr_eval(const decx::_expr_program<T>* prog, T* dst)
+{
+    typedef decx::_ew_typed_kernels<T> _K;
+    const size_t _block = _EXPR_BLOCK_BYTES_ / sizeof(T);
+
+    std::atomic<bool> _failed(false);
+
+    decx::parallel_for(0, prog->len / _K::vec_len, [&](const size_t _beg, const size_t _end) {
+        decx::ScratchMarker marker(&decx::_tl_scratch_arena);
+        T* _slots = decx::_tl_scratch_arena.allocate<T>(decx::utils::clamp_min<size_t>(prog->slot_num, 1) * _block);
+        if (_slots == NULL) {
+            _failed.store(true, std::memory_order_relaxed);
+            return;
+        }
+
+        const size_t _end_elem = _end * _K::vec_len;
+        for (size_t i = _beg * _K::vec_len; i < _end_elem; i += _block) {
+            const size_t _len = decx::utils::clamp_max<size_t>(_end_elem - i, _block);
+
+            for (size_t k = 0; k < prog->inst.size(); ++k) {
+                const decx::_expr_inst<T>& inst = prog->inst[k];
+                const T* _A = inst.A.type == _EXPR_LEAF_ ? prog->leaves[inst.A.index] + i : _slots + inst.A.index * _block;
+                const T* _B = inst.B.type == _EXPR_LEAF_ ? prog->leaves[inst.B.index] + i : _slots + inst.B.index * _block;
+                T* _dst = inst.dst < 0 ? dst + i : _slots + inst.dst * _block;
+
+                if (inst.B.type == _EXPR_SCALAR_) {
+                    _K::c(inst.op)(_A, inst.B.val, _dst, _len);
+                }
+                else if (inst.A.type == _EXPR_SCALAR_) {
+                    _K::cinv(inst.op)(_B, inst.A.val, _dst, _len);
+                }
+                else {
+                    _K::m(inst.op)(_A, _B, _dst, _len);
+                }
+            }
+        }
+    }, _EW_MIN_GRAIN_VEC_, decx::Partition_NUMA);
+
+    return !_failed.load(std::memory_order_relaxed);
+}
+
+
+#endif
@@ -12,6 +12,7 @@
 
 #include "../../../classes/Matrix.h"
 #include "../Div_exec.h"
+#include "cpu_matrix_bcast.h"
 
 using decx::_Matrix;
 
@@ -20,21 +21,21 @@ namespace de
     namespace cpu
     {
         template <typename T>
-        _DECX_API_ de::DH Div(de::Matrix<T>& A, de::Matrix<T>& B, de::Matrix<T>& dst);
+        _DECX_API_ de::DH Div(de::Matrix<T>& A, de::Matrix<T>& B, de::Matrix<T>& dst, const int store = de::cpu::Store_Auto);
 
 
         template <typename T>
-        _DECX_API_ de::DH Div(de::Matrix<T>& src, const T B, de::Matrix<T>& dst);
+        _DECX_API_ de::DH Div(de::Matrix<T>& src, const T B, de::Matrix<T>& dst, const int store = de::cpu::Store_Auto);
 
 
         template <typename T>
-        _DECX_API_ de::DH Div(const T B, de::Matrix<T>& src, de::Matrix<T>& dst);
+        _DECX_API_ de::DH Div(const T B, de::Matrix<T>& src, de::Matrix<T>& dst, const int store = de::cpu::Store_Auto);
     }
 }
 
 
 template <typename T>
-de::DH de::cpu::Div(de::Matrix<T>& A, de::Matrix<T>& B, de::Matrix<T>& dst)
+de::DH de::cpu::Div(de::Matrix<T>& A, de::Matrix<T>& B, de::Matrix<T>& dst, const int store)
 {
     _Matrix<T>* _A = dynamic_cast<_Matrix<T>*>(&A);
     _Matrix<T>* _B = dynamic_cast<_Matrix<T>*>(&B);
@@ -48,22 +49,32 @@ de::DH de::cpu::Div(de::Matrix<T>& A, de::Matrix<T>& B, de::Matrix<T>& dst)
         Print_Error_Message(4, NOT_INIT);
         exit(-1);
     }
+    if (!decx::_check_store_mode(store, &handle)) {
+        return handle;
+    }
     
-    decx::Kdiv_m(_A->Mat.ptr, _B->Mat.ptr, _dst->Mat.ptr, _A->_element_num);
+    // of different shapes, broadcast
+    if (_A->width != _B->width || _A->height != _B->height) {
+        decx::_Matrix_ew_bcast_caller(_A, _B, _dst, _EW_DIV_, store, &handle);
+        return handle;
+    }
+    decx::_ew_shape_as(_dst, _A);
+
+    decx::Kdiv_m(_A->Mat.ptr, _B->Mat.ptr, _dst->Mat.ptr, _A->_element_num, store);
 
     return handle;
 }
 
-template _DECX_API_ de::DH de::cpu::Div(de::Matrix<float>& A, de::Matrix<float>& B, de::Matrix<float>& dst);
+template _DECX_API_ de::DH de::cpu::Div(de::Matrix<float>& A, de::Matrix<float>& B, de::Matrix<float>& dst, const int store);
 
-template _DECX_API_ de::DH de::cpu::Div(de::Matrix<int>& A, de::Matrix<int>& B, de::Matrix<int>& dst);
+template _DECX_API_ de::DH de::cpu::Div(de::Matrix<int>& A, de::Matrix<int>& B, de::Matrix<int>& dst, const int store);
 
-template _DECX_API_ de::DH de::cpu::Div(de::Matrix<double>& A, de::Matrix<double>& B, de::Matrix<double>& dst);
+template _DECX_API_ de::DH de::cpu::Div(de::Matrix<double>& A, de::Matrix<double>& B, de::Matrix<double>& dst, const int store);
 
 
 
 template <typename T>
-de::DH de::cpu::Div(de::Matrix<T>& src, const T __x, de::Matrix<T>& dst)
+de::DH de::cpu::Div(de::Matrix<T>& src, const T __x, de::Matrix<T>& dst, const int store)
 {
     _Matrix<T>* _src = dynamic_cast<_Matrix<T>*>(&src);
     _Matrix<T>* _dst = dynamic_cast<_Matrix<T>*>(&dst);
@@ -76,22 +87,26 @@ de::DH de::cpu::Div(de::Matrix<T>& src, const T __x, de::Matrix<T>& dst)
         Print_Error_Message(4, NOT_INIT);
         exit(-1);
     }
+    if (!decx::_check_store_mode(store, &handle)) {
+        return handle;
+    }
 
-    decx::Kdiv_c(_src->Mat.ptr, __x, _dst->Mat.ptr, _src->_element_num);
+    decx::_ew_shape_as(_dst, _src);
+    decx::Kdiv_c(_src->Mat.ptr, __x, _dst->Mat.ptr, _src->_element_num, store);
 
     return handle;
 }
 
-template _DECX_API_ de::DH de::cpu::Div(de::Matrix<float>& src, const float __x, de::Matrix<float>& dst);
+template _DECX_API_ de::DH de::cpu::Div(de::Matrix<float>& src, const float __x, de::Matrix<float>& dst, const int store);
 
-template _DECX_API_ de::DH de::cpu::Div(de::Matrix<int>& src, const int __x, de::Matrix<int>& dst);
+template _DECX_API_ de::DH de::cpu::Div(de::Matrix<int>& src, const int __x, de::Matrix<int>& dst, const int store);
 
-template _DECX_API_ de::DH de::cpu::Div(de::Matrix<double>& src, const double __x, de::Matrix<double>& dst);
+template _DECX_API_ de::DH de::cpu::Div(de::Matrix<double>& src, const double __x, de::Matrix<double>& dst, const int store);
 
 
 
 template <typename T>
-de::DH de::cpu::Div(const T __x, de::Matrix<T>& src, de::Matrix<T>& dst)
+de::DH de::cpu::Div(const T __x, de::Matrix<T>& src, de::Matrix<T>& dst, const int store)
 {
     _Matrix<T>* _src = dynamic_cast<_Matrix<T>*>(&src);
     _Matrix<T>* _dst = dynamic_cast<_Matrix<T>*>(&dst);
@@ -104,16 +119,20 @@ de::DH de::cpu::Div(const T __x, de::Matrix<T>& src, de::Matrix<T>& dst)
         Print_Error_Message(4, NOT_INIT);
         exit(-1);
     }
+    if (!decx::_check_store_mode(store, &handle)) {
+        return handle;
+    }
 
-    decx::Kdiv_cinv(_src->Mat.ptr, __x, _dst->Mat.ptr, _src->_element_num);
+    decx::_ew_shape_as(_dst, _src);
+    decx::Kdiv_cinv(_src->Mat.ptr, __x, _dst->Mat.ptr, _src->_element_num, store);
 
     return handle;
 }
 
-template _DECX_API_ de::DH de::cpu::Div(const float __x, de::Matrix<float>& src, de::Matrix<float>& dst);
+template _DECX_API_ de::DH de::cpu::Div(const float __x, de::Matrix<float>& src, de::Matrix<float>& dst, const int store);
 
-template _DECX_API_ de::DH de::cpu::Div(const int __x, de::Matrix<int>& src, de::Matrix<int>& dst);
+template _DECX_API_ de::DH de::cpu::Div(const int __x, de::Matrix<int>& src, de::Matrix<int>& dst, const int store);
 
-template _DECX_API_ de::DH de::cpu::Div(const double __x, de::Matrix<double>& src, de::Matrix<double>& dst);
+template _DECX_API_ de::DH de::cpu::Div(const double __x, de::Matrix<double>& src, de::Matrix<double>& dst, const int store);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,101 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+#ifndef _CPU_MATRIX_BCAST_H_
+#define _CPU_MATRIX_BCAST_H_
+
+#include "../../../classes/Matrix.h"
+#include "../ew_bcast_exec.h"
+
+
+namespace decx
+{
+    /**
+    * @brief dst = A op B of the matrices of different shapes, broadcast as NumPy does (see ew_bcast_exec.h) :
+    * a row vector (1 x width), a column vector (height x 1) or a 1 x 1 scalar against a matrix. dst is reshaped
+    * to the broadcast shape, unless it is one of the operands
+    */
+    template <typename T>
+    static void _Matrix_ew_bcast_caller(decx::_Matrix<T>* A, decx::_Matrix<T>* B, decx::_Matrix<T>* dst, const int op,
+        const int store, de::DH* handle);
+
+
+    template <typename T>
+    static decx::_ew_bcast_operand<T> _ew_bcast_operand_of(const decx::_Matrix<T>* src, const uint dst_width);
+
+
+    // reshape dst to the shape of src, if it is not already, as decx::_ew_shape_as() of the tensors
+    template <typename T>
+    static void _ew_shape_as(decx::_Matrix<T>* dst, const decx::_Matrix<T>* src);
+}
+
+
+
+template <typename T>
+static void decx::_ew_shape_as(decx::_Matrix<T>* dst, const decx::_Matrix<T>* src)
+{
+    if (dst->width != src->width || dst->height != src->height) {
+        dst->re_construct(src->width, src->height, decx::DATA_STORE_TYPE::Page_Default);
+    }
+}
+
+
+
+template <typename T>
+static decx::_ew_bcast_operand<T> decx::_ew_bcast_operand_of(const decx::_Matrix<T>* src, const uint dst_width)
+{
+    decx::_ew_bcast_operand<T> res;
+    res.ptr = src->Mat.ptr;
+    res.row_pitch = src->height == 1 ? 0 : src->pitch;
+    res.pixel_pitch = 1;
+    res.kind = decx::_ew_bcast_kind(src->width, 1, dst_width, 1);
+    return res;
+}
+
+
+
+template <typename T>
+static void decx::_Matrix_ew_bcast_caller(decx::_Matrix<T>* A, decx::_Matrix<T>* B, decx::_Matrix<T>* dst, const int op,
+    const int store, de::DH* handle)
+{
+    const uint _width = decx::utils::clamp_min<uint>(A->width, B->width);
+    const uint _height = decx::utils::clamp_min<uint>(A->height, B->height);
+
+    if ((A->width != _width && A->width != 1) || (B->width != _width && B->width != 1) ||
+        (A->height != _height && A->height != 1) || (B->height != _height && B->height != 1)) {
+        decx::MDim_Not_Matching(handle);
+        return;
+    }
+    if (dst->width != _width || dst->height != _height) {
+        // an operand can not be reshaped under the calculation
+        if (dst == A || dst == B) {
+            decx::MDim_Not_Matching(handle);
+            return;
+        }
+        dst->re_construct(_width, _height, decx::DATA_STORE_TYPE::Page_Default);
+    }
+
+    const decx::_ew_bcast_operand<T> _opA = decx::_ew_bcast_operand_of(A, _width);
+    const decx::_ew_bcast_operand<T> _opB = decx::_ew_bcast_operand_of(B, _width);
+    decx::_ew_bcast_layout layout;
+    layout.rows = _height;
+    layout.width = _width;
+    layout.dpitch = 1;
+    layout.pitch = dst->pitch;
+
+    if (!decx::ew_bcast_m<T>(op, &_opA, &_opB, dst->Mat.ptr, &layout, store)) {
+        decx::err::AllocateFailure(handle);
+        Print_Error_Message(4, ALLOC_FAIL);
+        return;
+    }
+    decx::Success(handle);
+}
+
+
+#endif
@@ -0,0 +1,157 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+#ifndef _CPU_DIV_TENSOR_H_
+#define _CPU_DIV_TENSOR_H_
+
+#include "cpu_tensor_ew.h"
+
+
+namespace de
+{
+    namespace cpu
+    {
+        /**
+        * @brief dst = A / B, int is divided in float and rounded to the nearest
+        */
+        template <typename T>
+        _DECX_API_ de::DH Div(de::Tensor<T>& A, de::Tensor<T>& B, de::Tensor<T>& dst, const int store = de::cpu::Store_Auto);
+
+
+        /**
+        * @brief dst = src / __x
+        */
+        template <typename T>
+        _DECX_API_ de::DH Div(de::Tensor<T>& src, const T __x, de::Tensor<T>& dst, const int store = de::cpu::Store_Auto);
+
+
+        /**
+        * @brief dst = __x / src
+        */
+        template <typename T>
+        _DECX_API_ de::DH Div(const T __x, de::Tensor<T>& src, de::Tensor<T>& dst, const int store = de::cpu::Store_Auto);
+
+
+        template <typename T>
+        _DECX_API_ de::DH Div(de::TensorArray<T>& A, de::TensorArray<T>& B, de::TensorArray<T>& dst, const int store = de::cpu::Store_Auto);
+
+
+        template <typename T>
+        _DECX_API_ de::DH Div(de::TensorArray<T>& src, const T __x, de::TensorArray<T>& dst, const int store = de::cpu::Store_Auto);
+
+
+        template <typename T>
+        _DECX_API_ de::DH Div(const T __x, de::TensorArray<T>& src, de::TensorArray<T>& dst, const int store = de::cpu::Store_Auto);
+    }
+}
+
+
+
+template <typename T>
+de::DH de::cpu::Div(de::Tensor<T>& A, de::Tensor<T>& B, de::Tensor<T>& dst, const int store)
+{
+    de::DH handle;
+    decx::_Tensor_ew_m_caller<T>(dynamic_cast<decx::_Tensor<T>*>(&A), dynamic_cast<decx::_Tensor<T>*>(&B),
+        dynamic_cast<decx::_Tensor<T>*>(&dst), _EW_DIV_, store, &handle);
+    return handle;
+}
+
+template _DECX_API_ de::DH de::cpu::Div(de::Tensor<float>& A, de::Tensor<float>& B, de::Tensor<float>& dst, const int store);
+
+template _DECX_API_ de::DH de::cpu::Div(de::Tensor<int>& A, de::Tensor<int>& B, de::Tensor<int>& dst, const int store);
+
+template _DECX_API_ de::DH de::cpu::Div(de::Tensor<double>& A, de::Tensor<double>& B, de::Tensor<double>& dst, const int store);
+
+
+
+template <typename T>
+de::DH de::cpu::Div(de::Tensor<T>& src, const T __x, de::Tensor<T>& dst, const int store)
+{
+    de::DH handle;
+    decx::_Tensor_ew_c_caller<T>(dynamic_cast<decx::_Tensor<T>*>(&src), __x,
+        dynamic_cast<decx::_Tensor<T>*>(&dst), _EW_DIV_, false, store, &handle);
+    return handle;
+}
+
+template _DECX_API_ de::DH de::cpu::Div(de::Tensor<float>& src, const float __x, de::Tensor<float>& dst, const int store);
+
+template _DECX_API_ de::DH de::cpu::Div(de::Tensor<int>& src, const int __x, de::Tensor<int>& dst, const int store);
+
+template _DECX_API_ de::DH de::cpu::Div(de::Tensor<double>& src, const double __x, de::Tensor<double>& dst, const int store);
+
+
+
+template <typename T>
+de::DH de::cpu::Div(const T __x, de::Tensor<T>& src, de::Tensor<T>& dst, const int store)
+{
+    de::DH handle;
+    decx::_Tensor_ew_c_caller<T>(dynamic_cast<decx::_Tensor<T>*>(&src), __x,
+        dynamic_cast<decx::_Tensor<T>*>(&dst), _EW_DIV_, true, store, &handle);
+    return handle;
+}
+
+template _DECX_API_ de::DH de::cpu::Div(const float __x, de::Tensor<float>& src, de::Tensor<float>& dst, const int store);
+
+template _DECX_API_ de::DH de::cpu::Div(const int __x, de::Tensor<int>& src, de::Tensor<int>& dst, const int store);
+
+template _DECX_API_ de::DH de::cpu::Div(const double __x, de::Tensor<double>& src, de::Tensor<double>& dst, const int store);
+
+
+
+template <typename T>
+de::DH de::cpu::Div(de::TensorArray<T>& A, de::TensorArray<T>& B, de::TensorArray<T>& dst, const int store)
+{
+    de::DH handle;
+    decx::_Tensor_ew_m_caller<T>(dynamic_cast<decx::_TensorArray<T>*>(&A), dynamic_cast<decx::_TensorArray<T>*>(&B),
+        dynamic_cast<decx::_TensorArray<T>*>(&dst), _EW_DIV_, store, &handle);
+    return handle;
+}
+
+template _DECX_API_ de::DH de::cpu::Div(de::TensorArray<float>& A, de::TensorArray<float>& B, de::TensorArray<float>& dst, const int store);
+
+template _DECX_API_ de::DH de::cpu::Div(de::TensorArray<int>& A, de::TensorArray<int>& B, de::TensorArray<int>& dst, const int store);
+
+template _DECX_API_ de::DH de::cpu::Div(de::TensorArray<double>& A, de::TensorArray<double>& B, de::TensorArray<double>& dst, const int store);
+
+
+
+template <typename T>
+de::DH de::cpu::Div(de::TensorArray<T>& src, const T __x, de::TensorArray<T>& dst, const int store)
+{
+    de::DH handle;
+    decx::_Tensor_ew_c_caller<T>(dynamic_cast<decx::_TensorArray<T>*>(&src), __x,
+        dynamic_cast<decx::_TensorArray<T>*>(&dst), _EW_DIV_, false, store, &handle);
+    return handle;
+}
+
+template _DECX_API_ de::DH de::cpu::Div(de::TensorArray<float>& src, const float __x, de::TensorArray<float>& dst, const int store);
+
+template _DECX_API_ de::DH de::cpu::Div(de::TensorArray<int>& src, const int __x, de::TensorArray<int>& dst, const int store);
+
+template _DECX_API_ de::DH de::cpu::Div(de::TensorArray<double>& src, const double __x, de::TensorArray<double>& dst, const int store);
+
+
+
+template <typename T>
+de::DH de::cpu::Div(const T __x, de::TensorArray<T>& src, de::TensorArray<T>& dst, const int store)
+{
+    de::DH handle;
+    decx::_Tensor_ew_c_caller<T>(dynamic_cast<decx::_TensorArray<T>*>(&src), __x,
+        dynamic_cast<decx::_TensorArray<T>*>(&dst), _EW_DIV_, true, store, &handle);
+    return handle;
+}
+
+template _DECX_API_ de::DH de::cpu::Div(const float __x, de::TensorArray<float>& src, de::TensorArray<float>& dst, const int store);
+
+template _DECX_API_ de::DH de::cpu::Div(const int __x, de::TensorArray<int>& src, de::TensorArray<int>& dst, const int store);
+
+template _DECX_API_ de::DH de::cpu::Div(const double __x, de::TensorArray<double>& src, de::TensorArray<double>& dst, const int store);
+
+
+#endif
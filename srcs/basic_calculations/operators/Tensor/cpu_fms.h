@@ -0,0 +1,112 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+#ifndef _CPU_FMS_TENSOR_H_
+#define _CPU_FMS_TENSOR_H_
+
+#include "cpu_tensor_ew.h"
+
+
+namespace de
+{
+    namespace cpu
+    {
+        /**
+        * @brief dst = A * B - C, fused (one rounding) with AVX2 and AVX-512
+        */
+        template <typename T>
+        _DECX_API_ de::DH Fms(de::Tensor<T>& A, de::Tensor<T>& B, de::Tensor<T>& C, de::Tensor<T>& dst, const int store = de::cpu::Store_Auto);
+
+
+        /**
+        * @brief dst = src * __x - B
+        */
+        template <typename T>
+        _DECX_API_ de::DH Fms(de::Tensor<T>& src, const T __x, de::Tensor<T>& B, de::Tensor<T>& dst, const int store = de::cpu::Store_Auto);
+
+
+        template <typename T>
+        _DECX_API_ de::DH Fms(de::TensorArray<T>& A, de::TensorArray<T>& B, de::TensorArray<T>& C, de::TensorArray<T>& dst, const int store = de::cpu::Store_Auto);
+
+
+        template <typename T>
+        _DECX_API_ de::DH Fms(de::TensorArray<T>& src, const T __x, de::TensorArray<T>& B, de::TensorArray<T>& dst, const int store = de::cpu::Store_Auto);
+    }
+}
+
+
+
+template <typename T>
+de::DH de::cpu::Fms(de::Tensor<T>& A, de::Tensor<T>& B, de::Tensor<T>& C, de::Tensor<T>& dst, const int store)
+{
+    de::DH handle;
+    decx::_Tensor_ew_m3_caller<T>(dynamic_cast<decx::_Tensor<T>*>(&A), dynamic_cast<decx::_Tensor<T>*>(&B),
+        dynamic_cast<decx::_Tensor<T>*>(&C), dynamic_cast<decx::_Tensor<T>*>(&dst), _EW_FMS_, store, &handle);
+    return handle;
+}
+
+template _DECX_API_ de::DH de::cpu::Fms(de::Tensor<float>& A, de::Tensor<float>& B, de::Tensor<float>& C, de::Tensor<float>& dst, const int store);
+
+template _DECX_API_ de::DH de::cpu::Fms(de::Tensor<int>& A, de::Tensor<int>& B, de::Tensor<int>& C, de::Tensor<int>& dst, const int store);
+
+template _DECX_API_ de::DH de::cpu::Fms(de::Tensor<double>& A, de::Tensor<double>& B, de::Tensor<double>& C, de::Tensor<double>& dst, const int store);
+
+
+
+template <typename T>
+de::DH de::cpu::Fms(de::Tensor<T>& src, const T __x, de::Tensor<T>& B, de::Tensor<T>& dst, const int store)
+{
+    de::DH handle;
+    decx::_Tensor_ew_c3_caller<T>(dynamic_cast<decx::_Tensor<T>*>(&src), __x,
+        dynamic_cast<decx::_Tensor<T>*>(&B), dynamic_cast<decx::_Tensor<T>*>(&dst), _EW_FMS_, store, &handle);
+    return handle;
+}
+
+template _DECX_API_ de::DH de::cpu::Fms(de::Tensor<float>& src, const float __x, de::Tensor<float>& B, de::Tensor<float>& dst, const int store);
+
+template _DECX_API_ de::DH de::cpu::Fms(de::Tensor<int>& src, const int __x, de::Tensor<int>& B, de::Tensor<int>& dst, const int store);
+
+template _DECX_API_ de::DH de::cpu::Fms(de::Tensor<double>& src, const double __x, de::Tensor<double>& B, de::Tensor<double>& dst, const int store);
+
+
+
+template <typename T>
+de::DH de::cpu::Fms(de::TensorArray<T>& A, de::TensorArray<T>& B, de::TensorArray<T>& C, de::TensorArray<T>& dst, const int store)
+{
+    de::DH handle;
+    decx::_Tensor_ew_m3_caller<T>(dynamic_cast<decx::_TensorArray<T>*>(&A), dynamic_cast<decx::_TensorArray<T>*>(&B),
+        dynamic_cast<decx::_TensorArray<T>*>(&C), dynamic_cast<decx::_TensorArray<T>*>(&dst), _EW_FMS_, store, &handle);
+    return handle;
+}
+
+template _DECX_API_ de::DH de::cpu::Fms(de::TensorArray<float>& A, de::TensorArray<float>& B, de::TensorArray<float>& C, de::TensorArray<float>& dst, const int store);
+
+template _DECX_API_ de::DH de::cpu::Fms(de::TensorArray<int>& A, de::TensorArray<int>& B, de::TensorArray<int>& C, de::TensorArray<int>& dst, const int store);
+
+template _DECX_API_ de::DH de::cpu::Fms(de::TensorArray<double>& A, de::TensorArray<double>& B, de::TensorArray<double>& C, de::TensorArray<double>& dst, const int store);
+
+
+
+template <typename T>
+de::DH de::cpu::Fms(de::TensorArray<T>& src, const T __x, de::TensorArray<T>& B, de::TensorArray<T>& dst, const int store)
+{
+    de::DH handle;
+    decx::_Tensor_ew_c3_caller<T>(dynamic_cast<decx::_TensorArray<T>*>(&src), __x,
+        dynamic_cast<decx::_TensorArray<T>*>(&B), dynamic_cast<decx::_TensorArray<T>*>(&dst), _EW_FMS_, store, &handle);
+    return handle;
+}
+
+template _DECX_API_ de::DH de::cpu::Fms(de::TensorArray<float>& src, const float __x, de::TensorArray<float>& B, de::TensorArray<float>& dst, const int store);
+
+template _DECX_API_ de::DH de::cpu::Fms(de::TensorArray<int>& src, const int __x, de::TensorArray<int>& B, de::TensorArray<int>& dst, const int store);
+
+template _DECX_API_ de::DH de::cpu::Fms(de::TensorArray<double>& src, const double __x, de::TensorArray<double>& B, de::TensorArray<double>& dst, const int store);
+
+
+#endif
@@ -0,0 +1,310 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+#ifndef _CPU_TENSOR_EW_H_
+#define _CPU_TENSOR_EW_H_
+
+#include "../../../classes/Tensor.h"
+#include "../../../classes/TensorArray.h"
+#include "../ew_tensor_exec.h"
+#include "../ew_bcast_exec.h"
+
+
+/**
+* The callers shared by the element-wise operators of de::Tensor and de::TensorArray on the CPU, templated
+* on the class (_Tc is decx::_Tensor<T> or decx::_TensorArray<T>). The operands must be of one shape, dst
+* is reshaped to it if it differs (and not touched otherwise, so it can be one of the operands). The two
+* tensors of dst = A op B are broadcast if they differ (see ew_bcast_exec.h), e.g. a bias of 1 x 1 x depth.
+*/
+
+
+namespace decx
+{
+    template <typename T>
+    static decx::_ew_tensor_layout _ew_layout_of(const decx::_Tensor<T>* src);
+
+
+    // the tensors of an array are contiguous (_gap = dp_x_wp * height), as one tensor of height * tensor_num
+    template <typename T>
+    static decx::_ew_tensor_layout _ew_layout_of(const decx::_TensorArray<T>* src);
+
+
+    template <typename T>
+    static T* _ew_data_of(decx::_Tensor<T>* src) { return src->Tens.ptr; }
+
+
+    template <typename T>
+    static T* _ew_data_of(decx::_TensorArray<T>* src) { return src->TensArr.ptr; }
+
+
+    template <typename T>
+    static bool _ew_same_shape(const decx::_Tensor<T>* A, const decx::_Tensor<T>* B);
+
+
+    template <typename T>
+    static bool _ew_same_shape(const decx::_TensorArray<T>* A, const decx::_TensorArray<T>* B);
+
+
+    template <typename T>
+    static void _ew_shape_as(decx::_Tensor<T>* dst, const decx::_Tensor<T>* src);
+
+
+    template <typename T>
+    static void _ew_shape_as(decx::_TensorArray<T>* dst, const decx::_TensorArray<T>* src);
+
+
+    // the check of the initialization, abort as the operators of de::Matrix
+    static void _ew_check_init(de::DH* handle);
+
+
+    template <typename T>
+    static decx::_ew_bcast_operand<T> _ew_bcast_operand_of(const decx::_Tensor<T>* src, const uint dst_width, const uint dst_depth);
+
+
+    // dst = A op B of the tensors of different shapes, each dimension is the one of dst or 1
+    template <typename T>
+    static void _Tensor_ew_bcast_caller(decx::_Tensor<T>* A, decx::_Tensor<T>* B, decx::_Tensor<T>* dst, const int op,
+        const int store, de::DH* handle);
+
+
+    // the tensor arrays are not broadcast
+    template <typename T>
+    static void _Tensor_ew_bcast_caller(decx::_TensorArray<T>* A, decx::_TensorArray<T>* B, decx::_TensorArray<T>* dst,
+        const int op, const int store, de::DH* handle) { decx::MDim_Not_Matching(handle); }
+
+
+    // dst = A op B
+    template <typename T, class _Tc>
+    static void _Tensor_ew_m_caller(_Tc* A, _Tc* B, _Tc* dst, const int op, const int store, de::DH* handle);
+
+
+    // dst = src op __x, or __x op src if inv
+    template <typename T, class _Tc>
+    static void _Tensor_ew_c_caller(_Tc* src, const T __x, _Tc* dst, const int op, const bool inv, const int store, de::DH* handle);
+
+
+    // dst = A * B +- C
+    template <typename T, class _Tc>
+    static void _Tensor_ew_m3_caller(_Tc* A, _Tc* B, _Tc* C, _Tc* dst, const int op, const int store, de::DH* handle);
+
+
+    // dst = src * __x +- B
+    template <typename T, class _Tc>
+    static void _Tensor_ew_c3_caller(_Tc* src, const T __x, _Tc* B, _Tc* dst, const int op, const int store, de::DH* handle);
+}
+
+
+
+template <typename T>
+static decx::_ew_tensor_layout decx::_ew_layout_of(const decx::_Tensor<T>* src)
+{
+    decx::_ew_tensor_layout layout;
+    layout.rows = src->height;
+    layout.row_len = (size_t)src->width * (size_t)src->dpitch;
+    layout.pitch = src->dp_x_wp;
+    layout.total = src->_element_num;
+    return layout;
+}
+
+
+
+template <typename T>
+static decx::_ew_tensor_layout decx::_ew_layout_of(const decx::_TensorArray<T>* src)
+{
+    decx::_ew_tensor_layout layout;
+    layout.rows = (size_t)src->height * (size_t)src->tensor_num;
+    layout.row_len = (size_t)src->width * (size_t)src->dpitch;
+    layout.pitch = src->dp_x_wp;
+    layout.total = src->_element_num;
+    return layout;
+}
+
+
+
+template <typename T>
+static bool decx::_ew_same_shape(const decx::_Tensor<T>* A, const decx::_Tensor<T>* B)
+{
+    return A->width == B->width && A->height == B->height && A->depth == B->depth;
+}
+
+
+
+template <typename T>
+static bool decx::_ew_same_shape(const decx::_TensorArray<T>* A, const decx::_TensorArray<T>* B)
+{
+    return A->width == B->width && A->height == B->height && A->depth == B->depth && A->tensor_num == B->tensor_num;
+}
+
+
+
+template <typename T>
+static void decx::_ew_shape_as(decx::_Tensor<T>* dst, const decx::_Tensor<T>* src)
+{
+    if (!decx::_ew_same_shape(dst, src)) {
+        dst->re_construct(src->width, src->height, src->depth, decx::DATA_STORE_TYPE::Page_Default);
+    }
+}
+
+
+
+template <typename T>
+static void decx::_ew_shape_as(decx::_TensorArray<T>* dst, const decx::_TensorArray<T>* src)
+{
+    if (!decx::_ew_same_shape(dst, src)) {
+        dst->re_construct(src->width, src->height, src->depth, src->tensor_num, decx::DATA_STORE_TYPE::Page_Default);
+    }
+}
+
+
+
+static void decx::_ew_check_init(de::DH* handle)
+{
+    if (!decx::cpI.is_init) {
+        decx::Not_init(handle);
+        Print_Error_Message(4, NOT_INIT);
+        exit(-1);
+    }
+}
+
+
+
+template <typename T>
+static decx::_ew_bcast_operand<T> decx::_ew_bcast_operand_of(const decx::_Tensor<T>* src, const uint dst_width, const uint dst_depth)
+{
+    decx::_ew_bcast_operand<T> res;
+    res.ptr = src->Tens.ptr;
+    res.row_pitch = src->height == 1 ? 0 : src->dp_x_wp;
+    res.pixel_pitch = src->dpitch;
+    res.kind = decx::_ew_bcast_kind(src->width, src->depth, dst_width, dst_depth);
+    return res;
+}
+
+
+
+template <typename T>
+static void decx::_Tensor_ew_bcast_caller(decx::_Tensor<T>* A, decx::_Tensor<T>* B, decx::_Tensor<T>* dst, const int op,
+    const int store, de::DH* handle)
+{
+    const uint _width = decx::utils::clamp_min<uint>(A->width, B->width);
+    const uint _height = decx::utils::clamp_min<uint>(A->height, B->height);
+    const uint _depth = decx::utils::clamp_min<uint>(A->depth, B->depth);
+
+    if ((A->width != _width && A->width != 1) || (B->width != _width && B->width != 1) ||
+        (A->height != _height && A->height != 1) || (B->height != _height && B->height != 1) ||
+        (A->depth != _depth && A->depth != 1) || (B->depth != _depth && B->depth != 1)) {
+        decx::MDim_Not_Matching(handle);
+        return;
+    }
+    if (dst->width != _width || dst->height != _height || dst->depth != _depth) {
+        // an operand can not be reshaped under the calculation
+        if (dst == A || dst == B) {
+            decx::MDim_Not_Matching(handle);
+            return;
+        }
+        dst->re_construct(_width, _height, _depth, decx::DATA_STORE_TYPE::Page_Default);
+    }
+
+    const decx::_ew_bcast_operand<T> _opA = decx::_ew_bcast_operand_of(A, _width, _depth);
+    const decx::_ew_bcast_operand<T> _opB = decx::_ew_bcast_operand_of(B, _width, _depth);
+    decx::_ew_bcast_layout layout;
+    layout.rows = _height;
+    layout.width = _width;
+    layout.dpitch = dst->dpitch;
+    layout.pitch = dst->dp_x_wp;
+
+    if (!decx::ew_bcast_m<T>(op, &_opA, &_opB, dst->Tens.ptr, &layout, store)) {
+        decx::err::AllocateFailure(handle);
+        Print_Error_Message(4, ALLOC_FAIL);
+        return;
+    }
+    decx::Success(handle);
+}
+
+
+
+template <typename T, class _Tc>
+static void decx::_Tensor_ew_m_caller(_Tc* A, _Tc* B, _Tc* dst, const int op, const int store, de::DH* handle)
+{
+    decx::_ew_check_init(handle);
+    if (!decx::_check_store_mode(store, handle)) {
+        return;
+    }
+    if (!decx::_ew_same_shape(A, B)) {
+        decx::_Tensor_ew_bcast_caller(A, B, dst, op, store, handle);
+        return;
+    }
+    decx::_ew_shape_as(dst, A);
+
+    const decx::_ew_tensor_layout layout = decx::_ew_layout_of(A);
+    decx::ew_tensor_m<T>(op, decx::_ew_data_of(A), decx::_ew_data_of(B), decx::_ew_data_of(dst), &layout,
+        decx::_ew_skip_padding<T>(&layout), store);
+    decx::Success(handle);
+}
+
+
+
+template <typename T, class _Tc>
+static void decx::_Tensor_ew_c_caller(_Tc* src, const T __x, _Tc* dst, const int op, const bool inv, const int store, de::DH* handle)
+{
+    decx::_ew_check_init(handle);
+    if (!decx::_check_store_mode(store, handle)) {
+        return;
+    }
+    decx::_ew_shape_as(dst, src);
+
+    const decx::_ew_tensor_layout layout = decx::_ew_layout_of(src);
+    decx::ew_tensor_c<T>(op, decx::_ew_data_of(src), __x, decx::_ew_data_of(dst), &layout,
+        decx::_ew_skip_padding<T>(&layout), inv, store);
+    decx::Success(handle);
+}
+
+
+
+template <typename T, class _Tc>
+static void decx::_Tensor_ew_m3_caller(_Tc* A, _Tc* B, _Tc* C, _Tc* dst, const int op, const int store, de::DH* handle)
+{
+    decx::_ew_check_init(handle);
+    if (!decx::_check_store_mode(store, handle)) {
+        return;
+    }
+    if (!decx::_ew_same_shape(A, B) || !decx::_ew_same_shape(A, C)) {
+        decx::MDim_Not_Matching(handle);
+        return;
+    }
+    decx::_ew_shape_as(dst, A);
+
+    const decx::_ew_tensor_layout layout = decx::_ew_layout_of(A);
+    decx::ew_tensor_m3<T>(op, decx::_ew_data_of(A), decx::_ew_data_of(B), decx::_ew_data_of(C), decx::_ew_data_of(dst),
+        &layout, decx::_ew_skip_padding<T>(&layout), store);
+    decx::Success(handle);
+}
+
+
+
+template <typename T, class _Tc>
+static void decx::_Tensor_ew_c3_caller(_Tc* src, const T __x, _Tc* B, _Tc* dst, const int op, const int store, de::DH* handle)
+{
+    decx::_ew_check_init(handle);
+    if (!decx::_check_store_mode(store, handle)) {
+        return;
+    }
+    if (!decx::_ew_same_shape(src, B)) {
+        decx::MDim_Not_Matching(handle);
+        return;
+    }
+    decx::_ew_shape_as(dst, src);
+
+    const decx::_ew_tensor_layout layout = decx::_ew_layout_of(src);
+    decx::ew_tensor_c3<T>(op, decx::_ew_data_of(src), __x, decx::_ew_data_of(B), decx::_ew_data_of(dst), &layout,
+        decx::_ew_skip_padding<T>(&layout), store);
+    decx::Success(handle);
+}
+
+
+#endif
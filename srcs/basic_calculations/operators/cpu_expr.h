@@ -0,0 +1,218 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+#ifndef _CPU_EXPR_H_
+#define _CPU_EXPR_H_
+
+#include "../../classes/Matrix.h"
+#include "../../classes/Vector.h"
+#include "../../classes/Tensor.h"
+#include "Expr_exec.h"
+
+
+namespace de
+{
+    namespace cpu
+    {
+        /**
+        * @brief dst = expr, by one fused pass over the arrays of expr (see Expr_exec.h). The arrays of expr
+        * must be of the shape of dst, dst is reshaped if it differs, and can be one of the arrays.
+        * @return decx::MDim_Not_Matching if the arrays differ in shape, decx::MeaninglessFlag if expr has no array
+        */
+        template <typename T>
+        _DECX_API_ de::DH Eval(const de::cpu::Expr<T>& expr, de::Matrix<T>& dst);
+
+
+        template <typename T>
+        _DECX_API_ de::DH Eval(const de::cpu::Expr<T>& expr, de::Vector<T>& dst);
+
+
+        template <typename T>
+        _DECX_API_ de::DH Eval(const de::cpu::Expr<T>& expr, de::Tensor<T>& dst);
+    }
+}
+
+
+
+namespace decx
+{
+    /**
+    * @brief Compile expr, check the initialization and the shapes, shared by de::cpu::Eval()
+    * @return false if the evaluation is not to be done, with the error in handle
+    */
+    template <typename T>
+    static bool _Eval_compile(const de::cpu::Expr<T>* expr, decx::_expr_program<T>* prog, de::DH* handle);
+}
+
+
+
+template <typename T>
+de::cpu::Expr<T>::Expr(de::Matrix<T>& src)
+{
+    const decx::_Matrix<T>* _src = dynamic_cast<decx::_Matrix<T>*>(&src);
+    const uint dims[4] = { 0, _src->width, _src->height, 1 };
+    this->_node = decx::_expr_leaf<T>(_src->Mat.ptr, _src->_element_num, dims);
+}
+
+
+
+template <typename T>
+de::cpu::Expr<T>::Expr(de::Vector<T>& src)
+{
+    const decx::_Vector<T>* _src = dynamic_cast<decx::_Vector<T>*>(&src);
+    const uint dims[4] = { 1, (uint)_src->length, 1, 1 };
+    this->_node = decx::_expr_leaf<T>(_src->Vec.ptr, _src->_length, dims);
+}
+
+
+
+template <typename T>
+de::cpu::Expr<T>::Expr(de::Tensor<T>& src)
+{
+    const decx::_Tensor<T>* _src = dynamic_cast<decx::_Tensor<T>*>(&src);
+    const uint dims[4] = { 2, _src->width, _src->height, _src->depth };
+    this->_node = decx::_expr_leaf<T>(_src->Tens.ptr, _src->_element_num, dims);
+}
+
+
+template class de::cpu::Expr<float>;
+template class de::cpu::Expr<int>;
+template class de::cpu::Expr<double>;
+
+
+
+template <typename T>
+static bool decx::_Eval_compile(const de::cpu::Expr<T>* expr, decx::_expr_program<T>* prog, de::DH* handle)
+{
+    if (!decx::cpI.is_init) {
+        decx::Not_init(handle);
+        Print_Error_Message(4, NOT_INIT);
+        exit(-1);
+    }
+
+    if (!decx::_expr_compile(expr->_node.get(), prog)) {
+        if (prog->leaves.empty()) {
+            decx::MeaninglessFlag(handle);
+        }
+        else {
+            decx::MDim_Not_Matching(handle);
+        }
+        return false;
+    }
+    return true;
+}
+
+
+
+template <typename T>
+de::DH de::cpu::Eval(const de::cpu::Expr<T>& expr, de::Matrix<T>& dst)
+{
+    decx::_Matrix<T>* _dst = dynamic_cast<decx::_Matrix<T>*>(&dst);
+
+    de::DH handle;
+    decx::_expr_program<T> prog;
+    if (!decx::_Eval_compile(&expr, &prog, &handle)) {
+        return handle;
+    }
+    if (prog.dims[0] != 0) {
+        decx::MDim_Not_Matching(&handle);
+        return handle;
+    }
+    // dst is one of the leaves if it has their shape, it is not reshaped then
+    if (_dst->width != prog.dims[1] || _dst->height != prog.dims[2]) {
+        _dst->re_construct(prog.dims[1], prog.dims[2], decx::DATA_STORE_TYPE::Page_Default);
+    }
+
+    if (!decx::expr_eval(&prog, _dst->Mat.ptr)) {
+        decx::err::AllocateFailure(&handle);
+        Print_Error_Message(4, ALLOC_FAIL);
+        return handle;
+    }
+    decx::Success(&handle);
+    return handle;
+}
+
+template _DECX_API_ de::DH de::cpu::Eval(const de::cpu::Expr<float>& expr, de::Matrix<float>& dst);
+
+template _DECX_API_ de::DH de::cpu::Eval(const de::cpu::Expr<int>& expr, de::Matrix<int>& dst);
+
+template _DECX_API_ de::DH de::cpu::Eval(const de::cpu::Expr<double>& expr, de::Matrix<double>& dst);
+
+
+
+template <typename T>
+de::DH de::cpu::Eval(const de::cpu::Expr<T>& expr, de::Vector<T>& dst)
+{
+    decx::_Vector<T>* _dst = dynamic_cast<decx::_Vector<T>*>(&dst);
+
+    de::DH handle;
+    decx::_expr_program<T> prog;
+    if (!decx::_Eval_compile(&expr, &prog, &handle)) {
+        return handle;
+    }
+    if (prog.dims[0] != 1) {
+        decx::MDim_Not_Matching(&handle);
+        return handle;
+    }
+    if (_dst->length != prog.dims[1]) {
+        _dst->re_construct(prog.dims[1], decx::DATA_STORE_TYPE::Page_Default);
+    }
+
+    if (!decx::expr_eval(&prog, _dst->Vec.ptr)) {
+        decx::err::AllocateFailure(&handle);
+        Print_Error_Message(4, ALLOC_FAIL);
+        return handle;
+    }
+    decx::Success(&handle);
+    return handle;
+}
+
+template _DECX_API_ de::DH de::cpu::Eval(const de::cpu::Expr<float>& expr, de::Vector<float>& dst);
+
+template _DECX_API_ de::DH de::cpu::Eval(const de::cpu::Expr<int>& expr, de::Vector<int>& dst);
+
+template _DECX_API_ de::DH de::cpu::Eval(const de::cpu::Expr<double>& expr, de::Vector<double>& dst);
+
+
+
+template <typename T>
+de::DH de::cpu::Eval(const de::cpu::Expr<T>& expr, de::Tensor<T>& dst)
+{
+    decx::_Tensor<T>* _dst = dynamic_cast<decx::_Tensor<T>*>(&dst);
+
+    de::DH handle;
+    decx::_expr_program<T> prog;
+    if (!decx::_Eval_compile(&expr, &prog, &handle)) {
+        return handle;
+    }
+    if (prog.dims[0] != 2) {
+        decx::MDim_Not_Matching(&handle);
+        return handle;
+    }
+    if (_dst->width != prog.dims[1] || _dst->height != prog.dims[2] || _dst->depth != prog.dims[3]) {
+        _dst->re_construct(prog.dims[1], prog.dims[2], prog.dims[3], decx::DATA_STORE_TYPE::Page_Default);
+    }
+
+    if (!decx::expr_eval(&prog, _dst->Tens.ptr)) {
+        decx::err::AllocateFailure(&handle);
+        Print_Error_Message(4, ALLOC_FAIL);
+        return handle;
+    }
+    decx::Success(&handle);
+    return handle;
+}
+
+template _DECX_API_ de::DH de::cpu::Eval(const de::cpu::Expr<float>& expr, de::Tensor<float>& dst);
+
+template _DECX_API_ de::DH de::cpu::Eval(const de::cpu::Expr<int>& expr, de::Tensor<int>& dst);
+
+template _DECX_API_ de::DH de::cpu::Eval(const de::cpu::Expr<double>& expr, de::Tensor<double>& dst);
+
+
+#endif
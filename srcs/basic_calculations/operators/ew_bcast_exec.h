@@ -0,0 +1,207 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+#ifndef _EW_BCAST_EXEC_H_
+#define _EW_BCAST_EXEC_H_
+
+#include "../../core/basic.h"
+#include "../../core/thread_management/parallel_for.h"
+#include "../../core/allocators/scratch_arena.h"
+#include "ew_isa_kernels.h"
+#include <atomic>
+
+
+/**
+* dst = A op B of the operands of different shapes, broadcast as NumPy does : each dimension of an operand
+* is either the one of dst or 1. dst is seen as rows (the height) of pixels (the width) of dpitch elements
+* (the depth, 1 of a matrix). Along a row, an operand is read as one of :
+*   _EW_BC_FULL_        the row of dst's shape, in place
+*   _EW_BC_CHANNELS_    one pixel of all the channels, repeated over the width (a bias of a tensor)
+*   _EW_BC_PIXELS_      one channel of each pixel, repeated over the depth
+*   _EW_BC_SCALAR_      one element (a column vector of a matrix)
+* and the rows of an operand of height 1 are all its first. The rows of dst are processed in blocks of
+* about _EW_BCAST_BLOCK_BYTES_, by the kernels of decx::_ew_kernels : the full rows are read in place,
+* the scalars go to the kernels of a constant, and the repeated pixels and channels are expanded to a
+* block on the stack of the thread (decx::_tl_scratch_arena), that stays in L1 over the whole row. No
+* operand is expanded to the shape of dst.
+*/
+
+
+#define _EW_BC_FULL_ 0
+#define _EW_BC_CHANNELS_ 1
+#define _EW_BC_PIXELS_ 2
+#define _EW_BC_SCALAR_ 3
+
+
+// the elements of a block of a row, about
+#define _EW_BCAST_BLOCK_BYTES_ 4096
+
+
+namespace decx
+{
+    template <typename T>
+    struct _ew_bcast_operand
+    {
+        const T* ptr;
+        size_t row_pitch;       // the elements between the rows, 0 if the height is 1
+        size_t pixel_pitch;     // the elements between the pixels (dpitch), read by _EW_BC_PIXELS_
+        int kind;               // _EW_BC_FULL_ ... _EW_BC_SCALAR_
+    };
+
+
+    struct _ew_bcast_layout
+    {
+        size_t rows;            // the height of dst
+        size_t width;           // the pixels of a row
+        size_t dpitch;          // the elements of a pixel, 1 of a matrix
+        size_t pitch;           // the elements between the rows of dst
+    };
+
+
+    /**
+    * @brief The kind of an operand of width x depth against dst of dst_width x dst_depth, the dimensions
+    * are assumed to match or to be 1
+    */
+    static int _ew_bcast_kind(const size_t width, const size_t depth, const size_t dst_width, const size_t dst_depth);
+
+
+    /**
+    * @brief dst = A op B, op is _EW_ADD_ ... _EW_DIV_
+    * @param store : one of de::cpu::StoreMode, the stores of dst
+    * @return false if the blocks of the expanded operands can not be allocated
+    */
+    template <typename T>
+    static bool ew_bcast_m(const int op, const decx::_ew_bcast_operand<T>* A, const decx::_ew_bcast_operand<T>* B,
+        T* dst, const decx::_ew_bcast_layout* layout, const int store);
+}
+
+
+
+static int decx::_ew_bcast_kind(const size_t width, const size_t depth, const size_t dst_width, const size_t dst_depth)
+{
+    if (width == dst_width) {
+        return depth == dst_depth ? _EW_BC_FULL_ : _EW_BC_PIXELS_;
+    }
+    // one pixel of one channel (or of a depth of 1) is a scalar
+    return (depth == dst_depth && dst_depth > 1) ? _EW_BC_CHANNELS_ : _EW_BC_SCALAR_;
+}
+
+
+
+namespace decx
+{
+    /**
+    * @brief The block of an operand from the pixel w0 of its row, expanded to buf if it is not in place
+    * @return NULL if the operand is a scalar (written to val)
+    */
+    template <typename T>
+    static const T* _ew_bcast_block(const decx::_ew_bcast_operand<T>* X, const T* row, const size_t w0,
+        const size_t blk_pix, const decx::_ew_bcast_layout* layout, T* buf, const T** expanded, T* val)
+    {
+        const size_t _dp = layout->dpitch;
+        switch (X->kind)
+        {
+        case _EW_BC_FULL_:
+            return row + w0 * _dp;
+
+        case _EW_BC_CHANNELS_:
+            // the same for all the blocks of the row
+            if (*expanded != row) {
+                for (size_t p = 0; p < blk_pix; ++p) {
+                    memcpy(buf + p * _dp, row, _dp * sizeof(T));
+                }
+                *expanded = row;
+            }
+            return buf;
+
+        case _EW_BC_PIXELS_:
+            for (size_t p = 0; p < blk_pix; ++p) {
+                const T _v = row[decx::utils::clamp_max<size_t>(w0 + p, layout->width - 1) * X->pixel_pitch];
+                for (size_t c = 0; c < _dp; ++c) {
+                    buf[p * _dp + c] = _v;
+                }
+            }
+            return buf;
+
+        default:
+            *val = row[0];
+            return NULL;
+        }
+    }
+}
+
+
+
+template <typename T>
+static bool decx::ew_bcast_m(const int op, const decx::_ew_bcast_operand<T>* A, const decx::_ew_bcast_operand<T>* B,
+    T* dst, const decx::_ew_bcast_layout* layout, const int store)
+{
+    typedef decx::_ew_typed_kernels<T> _K;
+    const size_t _dp = layout->dpitch;
+    const size_t _row_len = decx::utils::ceil<size_t>(layout->width * _dp, _K::vec_len) * _K::vec_len;
+
+    // the least pixels of a multiple of vec_len, then the pixels of a block
+    size_t _unit = _K::vec_len;
+    while (_unit > 1 && ((_unit / 2) * _dp) % _K::vec_len == 0) {
+        _unit /= 2;
+    }
+    const size_t _blk_pix = decx::utils::clamp_min<size_t>(_EW_BCAST_BLOCK_BYTES_ / sizeof(T) / (_unit * _dp), 1) * _unit;
+    const size_t _grain = decx::utils::clamp_min<size_t>(_EW_MIN_GRAIN_VEC_ * _K::vec_len / _row_len, 1);
+
+    const bool _nt = decx::_use_streaming_store(store, layout->rows * layout->pitch * sizeof(T));
+    const auto _m = _K::m(op, _nt), _c = _K::c(op, _nt), _cinv = _K::cinv(op, _nt);
+
+    std::atomic<bool> _failed(false);
+
+    decx::parallel_for(0, layout->rows, [&](const size_t _beg, const size_t _end) {
+        decx::ScratchMarker marker(&decx::_tl_scratch_arena);
+        T* _bufA = decx::_tl_scratch_arena.allocate<T>(_blk_pix * _dp);
+        T* _bufB = decx::_tl_scratch_arena.allocate<T>(_blk_pix * _dp);
+        if (_bufA == NULL || _bufB == NULL) {
+            _failed.store(true, std::memory_order_relaxed);
+            return;
+        }
+        const T* _expandedA = NULL, * _expandedB = NULL;
+
+        for (size_t i = _beg; i < _end; ++i) {
+            const T* _rowA = A->ptr + i * A->row_pitch;
+            const T* _rowB = B->ptr + i * B->row_pitch;
+            T* _rowD = dst + i * layout->pitch;
+
+            for (size_t w0 = 0; w0 < layout->width; w0 += _blk_pix) {
+                const size_t _len = decx::utils::clamp_max<size_t>(_blk_pix * _dp, _row_len - w0 * _dp);
+                T _va, _vb;
+                const T* _pA = decx::_ew_bcast_block(A, _rowA, w0, _blk_pix, layout, _bufA, &_expandedA, &_va);
+                const T* _pB = decx::_ew_bcast_block(B, _rowB, w0, _blk_pix, layout, _bufB, &_expandedB, &_vb);
+
+                if (_pA != NULL && _pB != NULL) {
+                    _m(_pA, _pB, _rowD + w0 * _dp, _len);
+                }
+                else if (_pA != NULL) {
+                    _c(_pA, _vb, _rowD + w0 * _dp, _len);
+                }
+                else if (_pB != NULL) {
+                    _cinv(_pB, _va, _rowD + w0 * _dp, _len);
+                }
+                else {
+                    // both scalars, A is spread over the block
+                    for (size_t k = 0; k < _len; ++k) {
+                        _bufA[k] = _va;
+                    }
+                    _c(_bufA, _vb, _rowD + w0 * _dp, _len);
+                }
+            }
+        }
+    }, _grain, decx::Partition_NUMA);
+
+    return !_failed.load(std::memory_order_relaxed);
+}
+
+
+#endif
@@ -0,0 +1,636 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+#ifndef _EW_ISA_KERNELS_H_
+#define _EW_ISA_KERNELS_H_
+
+#include "../../core/basic.h"
+#include "../../core/configs/cpu_isa.h"
+#include "../../core/configs/store_mode.h"
+
+
+/**
+* The element-wise kernels of Add, Sub, Mul, Div, Fma and Fms on the CPU, for SSE4.2, AVX2 and AVX-512. The
+* callers (decx::Kadd_m() ...) take the kernel from decx::_ew_kernels, which is filled for the
+* de::CPU_ISA in use.
+*
+* The lengths of the kernels are in elements, and multiples of 8 (float, int) or 4 (double), which
+* is what the pitches of the classes guarantee. With AVX-512, the last 8 (4) elements not filling
+* a __m512 are calculated with AVX2.
+*
+* int : Mul is exact (mullo), Div is done in float and rounded to the nearest.
+* float, double : Fma and Fms are fused (one rounding) with AVX2 and AVX-512, and not with SSE4.2.
+*
+* Each kernel has a twin in decx::_ew_kernels_nt, storing dst with the non-temporal stores and fencing them
+* at the end. The stores of AVX-512 need 64 bytes, the head of a chunk starting on 32 bytes is stored with
+* AVX2 first.
+*/
+
+
+#define _EW_ADD_ 0
+#define _EW_SUB_ 1
+#define _EW_MUL_ 2
+#define _EW_DIV_ 3
+
+// the index of the kernels of 3 operands
+#define _EW_FMA_ 0
+#define _EW_FMS_ 1
+
+
+namespace decx
+{
+    struct _ew_kernel_table
+    {
+        // [_EW_ADD_ ... _EW_DIV_], dst = A op B
+        void (*fm[4])(const float*, const float*, float*, const size_t);
+        void (*im[4])(const int*, const int*, int*, const size_t);
+        void (*dm[4])(const double*, const double*, double*, const size_t);
+
+        // dst = src op __x
+        void (*fc[4])(const float*, const float, float*, const size_t);
+        void (*ic[4])(const int*, const int, int*, const size_t);
+        void (*dc[4])(const double*, const double, double*, const size_t);
+
+        // dst = __x op src
+        void (*fcinv[4])(const float*, const float, float*, const size_t);
+        void (*icinv[4])(const int*, const int, int*, const size_t);
+        void (*dcinv[4])(const double*, const double, double*, const size_t);
+
+        // [_EW_FMA_, _EW_FMS_], dst = A * B +- C
+        void (*fm3[2])(const float*, const float*, const float*, float*, const size_t);
+        void (*im3[2])(const int*, const int*, const int*, int*, const size_t);
+        void (*dm3[2])(const double*, const double*, const double*, double*, const size_t);
+
+        // dst = src * __x +- B
+        void (*fc3[2])(const float*, const float, const float*, float*, const size_t);
+        void (*ic3[2])(const int*, const int, const int*, int*, const size_t);
+        void (*dc3[2])(const double*, const double, const double*, double*, const size_t);
+    };
+
+
+    // _ew_kernels_nt : the same kernels with the non-temporal stores (see core/configs/store_mode.h)
+    decx::_ew_kernel_table _ew_kernels, _ew_kernels_nt;
+
+
+    static decx::_ew_kernel_table& _ew_table(const bool nt) { return nt ? decx::_ew_kernels_nt : decx::_ew_kernels; }
+
+
+    /**
+    * @brief The kernels of decx::_ew_kernels (decx::_ew_kernels_nt if nt) of T, and the multiple (in elements)
+    * their lengths are of
+    */
+    template <typename T>
+    struct _ew_typed_kernels;
+}
+
+
+
+template <>
+struct decx::_ew_typed_kernels<float>
+{
+    static const int vec_len = 8;
+    static void (*m(const int op, const bool nt = false))(const float*, const float*, float*, const size_t)                    { return decx::_ew_table(nt).fm[op]; }
+    static void (*c(const int op, const bool nt = false))(const float*, const float, float*, const size_t)                     { return decx::_ew_table(nt).fc[op]; }
+    static void (*cinv(const int op, const bool nt = false))(const float*, const float, float*, const size_t)                  { return decx::_ew_table(nt).fcinv[op]; }
+    static void (*m3(const int op, const bool nt = false))(const float*, const float*, const float*, float*, const size_t)     { return decx::_ew_table(nt).fm3[op]; }
+    static void (*c3(const int op, const bool nt = false))(const float*, const float, const float*, float*, const size_t)      { return decx::_ew_table(nt).fc3[op]; }
+};
+
+
+template <>
+struct decx::_ew_typed_kernels<int>
+{
+    static const int vec_len = 8;
+    static void (*m(const int op, const bool nt = false))(const int*, const int*, int*, const size_t)                          { return decx::_ew_table(nt).im[op]; }
+    static void (*c(const int op, const bool nt = false))(const int*, const int, int*, const size_t)                           { return decx::_ew_table(nt).ic[op]; }
+    static void (*cinv(const int op, const bool nt = false))(const int*, const int, int*, const size_t)                        { return decx::_ew_table(nt).icinv[op]; }
+    static void (*m3(const int op, const bool nt = false))(const int*, const int*, const int*, int*, const size_t)             { return decx::_ew_table(nt).im3[op]; }
+    static void (*c3(const int op, const bool nt = false))(const int*, const int, const int*, int*, const size_t)              { return decx::_ew_table(nt).ic3[op]; }
+};
+
+
+template <>
+struct decx::_ew_typed_kernels<double>
+{
+    static const int vec_len = 4;
+    static void (*m(const int op, const bool nt = false))(const double*, const double*, double*, const size_t)                 { return decx::_ew_table(nt).dm[op]; }
+    static void (*c(const int op, const bool nt = false))(const double*, const double, double*, const size_t)                  { return decx::_ew_table(nt).dc[op]; }
+    static void (*cinv(const int op, const bool nt = false))(const double*, const double, double*, const size_t)               { return decx::_ew_table(nt).dcinv[op]; }
+    static void (*m3(const int op, const bool nt = false))(const double*, const double*, const double*, double*, const size_t) { return decx::_ew_table(nt).dm3[op]; }
+    static void (*c3(const int op, const bool nt = false))(const double*, const double, const double*, double*, const size_t)  { return decx::_ew_table(nt).dc3[op]; }
+};
+
+
+
+/**
+* The kernels of one instruction set, expanded in the namespace of the set, where vec_f32, vec_i32,
+* vec_f64 are the vector types of the set and tail_f32, tail_i32, tail_f64 are the ones calculating
+* the elements left by them.
+*/
+#define _EW_ISA_KERNELS_                                                                                \
+template <class _Vt, bool _nt>                                                                          \
+static void _ew_put(typename _Vt::type* p, const typename _Vt::vec v)                                   \
+{                                                                                                       \
+    if (_nt) { _Vt::stream(p, v); }                                                                     \
+    else { _Vt::store(p, v); }                                                                          \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+/* the elements left to _Vtail before dst is aligned to _Vt, for the non-temporal stores */             \
+template <class _Vt, bool _nt>                                                                          \
+static size_t _ew_head(const typename _Vt::type* dst, const size_t len)                                 \
+{                                                                                                       \
+    const size_t _vec_bytes = _Vt::width * sizeof(typename _Vt::type);                                  \
+    const size_t _misalign = ((size_t)dst) % _vec_bytes;                                                \
+    if (!_nt || _misalign == 0) {                                                                       \
+        return 0;                                                                                       \
+    }                                                                                                   \
+    return decx::utils::clamp_max<size_t>((_vec_bytes - _misalign) / sizeof(typename _Vt::type), len);  \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+template <class _Vt, class _Vtail, int _op, bool _nt>                                                   \
+static void _THREAD_FUNCTION_ _ew_m(const typename _Vt::type* A, const typename _Vt::type* B,           \
+    typename _Vt::type* dst, const size_t len)                                                          \
+{                                                                                                       \
+    const size_t _head = _ew_head<_Vt, _nt>(dst, len);                                                  \
+    size_t i = 0;                                                                                       \
+    for (; i < _head; i += _Vtail::width) {                                                             \
+        _ew_put<_Vtail, _nt>(dst + i, _Vtail::calc(_op, _Vtail::load(A + i), _Vtail::load(B + i)));     \
+    }                                                                                                   \
+    for (; i + _Vt::width <= len; i += _Vt::width) {                                                    \
+        _ew_put<_Vt, _nt>(dst + i, _Vt::calc(_op, _Vt::load(A + i), _Vt::load(B + i)));                 \
+    }                                                                                                   \
+    for (; i < len; i += _Vtail::width) {                                                               \
+        _ew_put<_Vtail, _nt>(dst + i, _Vtail::calc(_op, _Vtail::load(A + i), _Vtail::load(B + i)));     \
+    }                                                                                                   \
+    if (_nt) { _mm_sfence(); }                                                                          \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+template <class _Vt, class _Vtail, int _op, bool _inv, bool _nt>                                        \
+static void _THREAD_FUNCTION_ _ew_c(const typename _Vt::type* src, const typename _Vt::type __x,        \
+    typename _Vt::type* dst, const size_t len)                                                          \
+{                                                                                                       \
+    const typename _Vt::vec _x = _Vt::set1(__x);                                                        \
+    const typename _Vtail::vec _x_tail = _Vtail::set1(__x);                                             \
+    const size_t _head = _ew_head<_Vt, _nt>(dst, len);                                                  \
+    size_t i = 0;                                                                                       \
+    for (; i < _head; i += _Vtail::width) {                                                             \
+        const typename _Vtail::vec _src = _Vtail::load(src + i);                                        \
+        _ew_put<_Vtail, _nt>(dst + i, _inv ? _Vtail::calc(_op, _x_tail, _src) : _Vtail::calc(_op, _src, _x_tail)); \
+    }                                                                                                   \
+    for (; i + _Vt::width <= len; i += _Vt::width) {                                                    \
+        const typename _Vt::vec _src = _Vt::load(src + i);                                              \
+        _ew_put<_Vt, _nt>(dst + i, _inv ? _Vt::calc(_op, _x, _src) : _Vt::calc(_op, _src, _x));         \
+    }                                                                                                   \
+    for (; i < len; i += _Vtail::width) {                                                               \
+        const typename _Vtail::vec _src = _Vtail::load(src + i);                                        \
+        _ew_put<_Vtail, _nt>(dst + i, _inv ? _Vtail::calc(_op, _x_tail, _src) : _Vtail::calc(_op, _src, _x_tail)); \
+    }                                                                                                   \
+    if (_nt) { _mm_sfence(); }                                                                          \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+template <class _Vt, class _Vtail, int _op, bool _nt>                                                   \
+static void _THREAD_FUNCTION_ _ew_m3(const typename _Vt::type* A, const typename _Vt::type* B,          \
+    const typename _Vt::type* C, typename _Vt::type* dst, const size_t len)                             \
+{                                                                                                       \
+    const size_t _head = _ew_head<_Vt, _nt>(dst, len);                                                  \
+    size_t i = 0;                                                                                       \
+    for (; i < _head; i += _Vtail::width) {                                                             \
+        _ew_put<_Vtail, _nt>(dst + i, _Vtail::fma(_op, _Vtail::load(A + i), _Vtail::load(B + i), _Vtail::load(C + i))); \
+    }                                                                                                   \
+    for (; i + _Vt::width <= len; i += _Vt::width) {                                                    \
+        _ew_put<_Vt, _nt>(dst + i, _Vt::fma(_op, _Vt::load(A + i), _Vt::load(B + i), _Vt::load(C + i))); \
+    }                                                                                                   \
+    for (; i < len; i += _Vtail::width) {                                                               \
+        _ew_put<_Vtail, _nt>(dst + i, _Vtail::fma(_op, _Vtail::load(A + i), _Vtail::load(B + i), _Vtail::load(C + i))); \
+    }                                                                                                   \
+    if (_nt) { _mm_sfence(); }                                                                          \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+template <class _Vt, class _Vtail, int _op, bool _nt>                                                   \
+static void _THREAD_FUNCTION_ _ew_c3(const typename _Vt::type* src, const typename _Vt::type __x,       \
+    const typename _Vt::type* B, typename _Vt::type* dst, const size_t len)                             \
+{                                                                                                       \
+    const typename _Vt::vec _x = _Vt::set1(__x);                                                        \
+    const typename _Vtail::vec _x_tail = _Vtail::set1(__x);                                             \
+    const size_t _head = _ew_head<_Vt, _nt>(dst, len);                                                  \
+    size_t i = 0;                                                                                       \
+    for (; i < _head; i += _Vtail::width) {                                                             \
+        _ew_put<_Vtail, _nt>(dst + i, _Vtail::fma(_op, _Vtail::load(src + i), _x_tail, _Vtail::load(B + i))); \
+    }                                                                                                   \
+    for (; i + _Vt::width <= len; i += _Vt::width) {                                                    \
+        _ew_put<_Vt, _nt>(dst + i, _Vt::fma(_op, _Vt::load(src + i), _x, _Vt::load(B + i)));            \
+    }                                                                                                   \
+    for (; i < len; i += _Vtail::width) {                                                               \
+        _ew_put<_Vtail, _nt>(dst + i, _Vtail::fma(_op, _Vtail::load(src + i), _x_tail, _Vtail::load(B + i))); \
+    }                                                                                                   \
+    if (_nt) { _mm_sfence(); }                                                                          \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+template <int _op, bool _nt>                                                                            \
+static void _fill_ew_op(decx::_ew_kernel_table* table)                                                  \
+{                                                                                                       \
+    table->fm[_op] = &_ew_m<vec_f32, tail_f32, _op, _nt>;                                               \
+    table->im[_op] = &_ew_m<vec_i32, tail_i32, _op, _nt>;                                               \
+    table->dm[_op] = &_ew_m<vec_f64, tail_f64, _op, _nt>;                                               \
+    table->fc[_op] = &_ew_c<vec_f32, tail_f32, _op, false, _nt>;                                        \
+    table->ic[_op] = &_ew_c<vec_i32, tail_i32, _op, false, _nt>;                                        \
+    table->dc[_op] = &_ew_c<vec_f64, tail_f64, _op, false, _nt>;                                        \
+    table->fcinv[_op] = &_ew_c<vec_f32, tail_f32, _op, true, _nt>;                                      \
+    table->icinv[_op] = &_ew_c<vec_i32, tail_i32, _op, true, _nt>;                                      \
+    table->dcinv[_op] = &_ew_c<vec_f64, tail_f64, _op, true, _nt>;                                      \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+template <int _op, bool _nt>                                                                            \
+static void _fill_ew_op3(decx::_ew_kernel_table* table)                                                 \
+{                                                                                                       \
+    table->fm3[_op] = &_ew_m3<vec_f32, tail_f32, _op, _nt>;                                             \
+    table->im3[_op] = &_ew_m3<vec_i32, tail_i32, _op, _nt>;                                             \
+    table->dm3[_op] = &_ew_m3<vec_f64, tail_f64, _op, _nt>;                                             \
+    table->fc3[_op] = &_ew_c3<vec_f32, tail_f32, _op, _nt>;                                             \
+    table->ic3[_op] = &_ew_c3<vec_i32, tail_i32, _op, _nt>;                                             \
+    table->dc3[_op] = &_ew_c3<vec_f64, tail_f64, _op, _nt>;                                             \
+}                                                                                                       \
+                                                                                                        \
+                                                                                                        \
+template <bool _nt>                                                                                     \
+static void _fill_ew_table(decx::_ew_kernel_table* table)                                               \
+{                                                                                                       \
+    _fill_ew_op<_EW_ADD_, _nt>(table);                                                                  \
+    _fill_ew_op<_EW_SUB_, _nt>(table);                                                                  \
+    _fill_ew_op<_EW_MUL_, _nt>(table);                                                                  \
+    _fill_ew_op<_EW_DIV_, _nt>(table);                                                                  \
+    _fill_ew_op3<_EW_FMA_, _nt>(table);                                                                 \
+    _fill_ew_op3<_EW_FMS_, _nt>(table);                                                                 \
+}                                                                                                       \
+
+
+
+// ------------------------------------------ SSE4.2 ------------------------------------------------
+
+
+_DECX_ISA_BEGIN_SSE42_
+namespace decx
+{
+    namespace sse42
+    {
+        struct vec_f32
+        {
+            typedef float type;
+            typedef __m128 vec;
+            static const int width = 4;
+
+            static vec load(const float* p)             { return _mm_load_ps(p); }
+            static void store(float* p, const vec v)    { _mm_store_ps(p, v); }
+            static void stream(float* p, const vec v)   { _mm_stream_ps(p, v); }
+            static vec set1(const float x)              { return _mm_set1_ps(x); }
+
+            static vec calc(const int op, const vec a, const vec b)
+            {
+                switch (op)
+                {
+                case _EW_ADD_:  return _mm_add_ps(a, b);
+                case _EW_SUB_:  return _mm_sub_ps(a, b);
+                case _EW_MUL_:  return _mm_mul_ps(a, b);
+                default:        return _mm_div_ps(a, b);
+                }
+            }
+
+            // _EW_FMA_ : a * b + c, _EW_FMS_ : a * b - c
+            static vec fma(const int op, const vec a, const vec b, const vec c)
+            {
+                return op == _EW_FMA_ ? _mm_add_ps(_mm_mul_ps(a, b), c) : _mm_sub_ps(_mm_mul_ps(a, b), c);
+            }
+        };
+
+
+        struct vec_i32
+        {
+            typedef int type;
+            typedef __m128i vec;
+            static const int width = 4;
+
+            static vec load(const int* p)               { return _mm_load_si128((const __m128i*)p); }
+            static void store(int* p, const vec v)      { _mm_store_si128((__m128i*)p, v); }
+            static void stream(int* p, const vec v)     { _mm_stream_si128((__m128i*)p, v); }
+            static vec set1(const int x)                { return _mm_set1_epi32(x); }
+
+            static vec calc(const int op, const vec a, const vec b)
+            {
+                switch (op)
+                {
+                case _EW_ADD_:  return _mm_add_epi32(a, b);
+                case _EW_SUB_:  return _mm_sub_epi32(a, b);
+                case _EW_MUL_:  return _mm_mullo_epi32(a, b);
+                default:        return _mm_cvtps_epi32(_mm_div_ps(_mm_cvtepi32_ps(a), _mm_cvtepi32_ps(b)));
+                }
+            }
+
+            // _EW_FMA_ : a * b + c, _EW_FMS_ : a * b - c
+            static vec fma(const int op, const vec a, const vec b, const vec c)
+            {
+                return op == _EW_FMA_ ? _mm_add_epi32(_mm_mullo_epi32(a, b), c) : _mm_sub_epi32(_mm_mullo_epi32(a, b), c);
+            }
+        };
+
+
+        struct vec_f64
+        {
+            typedef double type;
+            typedef __m128d vec;
+            static const int width = 2;
+
+            static vec load(const double* p)            { return _mm_load_pd(p); }
+            static void store(double* p, const vec v)   { _mm_store_pd(p, v); }
+            static void stream(double* p, const vec v)  { _mm_stream_pd(p, v); }
+            static vec set1(const double x)             { return _mm_set1_pd(x); }
+
+            static vec calc(const int op, const vec a, const vec b)
+            {
+                switch (op)
+                {
+                case _EW_ADD_:  return _mm_add_pd(a, b);
+                case _EW_SUB_:  return _mm_sub_pd(a, b);
+                case _EW_MUL_:  return _mm_mul_pd(a, b);
+                default:        return _mm_div_pd(a, b);
+                }
+            }
+
+            // _EW_FMA_ : a * b + c, _EW_FMS_ : a * b - c
+            static vec fma(const int op, const vec a, const vec b, const vec c)
+            {
+                return op == _EW_FMA_ ? _mm_add_pd(_mm_mul_pd(a, b), c) : _mm_sub_pd(_mm_mul_pd(a, b), c);
+            }
+        };
+
+
+        typedef vec_f32 tail_f32;
+        typedef vec_i32 tail_i32;
+        typedef vec_f64 tail_f64;
+
+        _EW_ISA_KERNELS_
+    }
+}
+_DECX_ISA_END_
+
+
+
+// ------------------------------------------- AVX2 -------------------------------------------------
+
+
+_DECX_ISA_BEGIN_AVX2_
+namespace decx
+{
+    namespace avx2
+    {
+        struct vec_f32
+        {
+            typedef float type;
+            typedef __m256 vec;
+            static const int width = 8;
+
+            static vec load(const float* p)             { return _mm256_load_ps(p); }
+            static void store(float* p, const vec v)    { _mm256_store_ps(p, v); }
+            static void stream(float* p, const vec v)   { _mm256_stream_ps(p, v); }
+            static vec set1(const float x)              { return _mm256_set1_ps(x); }
+
+            static vec calc(const int op, const vec a, const vec b)
+            {
+                switch (op)
+                {
+                case _EW_ADD_:  return _mm256_add_ps(a, b);
+                case _EW_SUB_:  return _mm256_sub_ps(a, b);
+                case _EW_MUL_:  return _mm256_mul_ps(a, b);
+                default:        return _mm256_div_ps(a, b);
+                }
+            }
+
+            // _EW_FMA_ : a * b + c, _EW_FMS_ : a * b - c
+            static vec fma(const int op, const vec a, const vec b, const vec c)
+            {
+                return op == _EW_FMA_ ? _mm256_fmadd_ps(a, b, c) : _mm256_fmsub_ps(a, b, c);
+            }
+        };
+
+
+        struct vec_i32
+        {
+            typedef int type;
+            typedef __m256i vec;
+            static const int width = 8;
+
+            static vec load(const int* p)               { return _mm256_load_si256((const __m256i*)p); }
+            static void store(int* p, const vec v)      { _mm256_store_si256((__m256i*)p, v); }
+            static void stream(int* p, const vec v)     { _mm256_stream_si256((__m256i*)p, v); }
+            static vec set1(const int x)                { return _mm256_set1_epi32(x); }
+
+            static vec calc(const int op, const vec a, const vec b)
+            {
+                switch (op)
+                {
+                case _EW_ADD_:  return _mm256_add_epi32(a, b);
+                case _EW_SUB_:  return _mm256_sub_epi32(a, b);
+                case _EW_MUL_:  return _mm256_mullo_epi32(a, b);
+                default:        return _mm256_cvtps_epi32(_mm256_div_ps(_mm256_cvtepi32_ps(a), _mm256_cvtepi32_ps(b)));
+                }
+            }
+
+            // _EW_FMA_ : a * b + c, _EW_FMS_ : a * b - c
+            static vec fma(const int op, const vec a, const vec b, const vec c)
+            {
+                return op == _EW_FMA_ ? _mm256_add_epi32(_mm256_mullo_epi32(a, b), c) : _mm256_sub_epi32(_mm256_mullo_epi32(a, b), c);
+            }
+        };
+
+
+        struct vec_f64
+        {
+            typedef double type;
+            typedef __m256d vec;
+            static const int width = 4;
+
+            static vec load(const double* p)            { return _mm256_load_pd(p); }
+            static void store(double* p, const vec v)   { _mm256_store_pd(p, v); }
+            static void stream(double* p, const vec v)  { _mm256_stream_pd(p, v); }
+            static vec set1(const double x)             { return _mm256_set1_pd(x); }
+
+            static vec calc(const int op, const vec a, const vec b)
+            {
+                switch (op)
+                {
+                case _EW_ADD_:  return _mm256_add_pd(a, b);
+                case _EW_SUB_:  return _mm256_sub_pd(a, b);
+                case _EW_MUL_:  return _mm256_mul_pd(a, b);
+                default:        return _mm256_div_pd(a, b);
+                }
+            }
+
+            // _EW_FMA_ : a * b + c, _EW_FMS_ : a * b - c
+            static vec fma(const int op, const vec a, const vec b, const vec c)
+            {
+                return op == _EW_FMA_ ? _mm256_fmadd_pd(a, b, c) : _mm256_fmsub_pd(a, b, c);
+            }
+        };
+
+
+        typedef vec_f32 tail_f32;
+        typedef vec_i32 tail_i32;
+        typedef vec_f64 tail_f64;
+
+        _EW_ISA_KERNELS_
+    }
+}
+_DECX_ISA_END_
+
+
+
+// ------------------------------------------ AVX-512 -----------------------------------------------
+
+
+_DECX_ISA_BEGIN_AVX512_
+namespace decx
+{
+    namespace avx512
+    {
+        // the chunks of decx::parallel_for() start at 32 bytes only, the loads are unaligned
+
+        struct vec_f32
+        {
+            typedef float type;
+            typedef __m512 vec;
+            static const int width = 16;
+
+            static vec load(const float* p)             { return _mm512_loadu_ps(p); }
+            static void store(float* p, const vec v)    { _mm512_storeu_ps(p, v); }
+            static void stream(float* p, const vec v)   { _mm512_stream_ps(p, v); }
+            static vec set1(const float x)              { return _mm512_set1_ps(x); }
+
+            static vec calc(const int op, const vec a, const vec b)
+            {
+                switch (op)
+                {
+                case _EW_ADD_:  return _mm512_add_ps(a, b);
+                case _EW_SUB_:  return _mm512_sub_ps(a, b);
+                case _EW_MUL_:  return _mm512_mul_ps(a, b);
+                default:        return _mm512_div_ps(a, b);
+                }
+            }
+
+            // _EW_FMA_ : a * b + c, _EW_FMS_ : a * b - c
+            static vec fma(const int op, const vec a, const vec b, const vec c)
+            {
+                return op == _EW_FMA_ ? _mm512_fmadd_ps(a, b, c) : _mm512_fmsub_ps(a, b, c);
+            }
+        };
+
+
+        struct vec_i32
+        {
+            typedef int type;
+            typedef __m512i vec;
+            static const int width = 16;
+
+            static vec load(const int* p)               { return _mm512_loadu_si512(p); }
+            static void store(int* p, const vec v)      { _mm512_storeu_si512(p, v); }
+            static void stream(int* p, const vec v)     { _mm512_stream_si512((__m512i*)p, v); }
+            static vec set1(const int x)                { return _mm512_set1_epi32(x); }
+
+            static vec calc(const int op, const vec a, const vec b)
+            {
+                switch (op)
+                {
+                case _EW_ADD_:  return _mm512_add_epi32(a, b);
+                case _EW_SUB_:  return _mm512_sub_epi32(a, b);
+                case _EW_MUL_:  return _mm512_mullo_epi32(a, b);
+                default:        return _mm512_cvtps_epi32(_mm512_div_ps(_mm512_cvtepi32_ps(a), _mm512_cvtepi32_ps(b)));
+                }
+            }
+
+            // _EW_FMA_ : a * b + c, _EW_FMS_ : a * b - c
+            static vec fma(const int op, const vec a, const vec b, const vec c)
+            {
+                return op == _EW_FMA_ ? _mm512_add_epi32(_mm512_mullo_epi32(a, b), c) : _mm512_sub_epi32(_mm512_mullo_epi32(a, b), c);
+            }
+        };
+
+
+        struct vec_f64
+        {
+            typedef double type;
+            typedef __m512d vec;
+            static const int width = 8;
+
+            static vec load(const double* p)            { return _mm512_loadu_pd(p); }
+            static void store(double* p, const vec v)   { _mm512_storeu_pd(p, v); }
+            static void stream(double* p, const vec v)  { _mm512_stream_pd(p, v); }
+            static vec set1(const double x)             { return _mm512_set1_pd(x); }
+
+            static vec calc(const int op, const vec a, const vec b)
+            {
+                switch (op)
+                {
+                case _EW_ADD_:  return _mm512_add_pd(a, b);
+                case _EW_SUB_:  return _mm512_sub_pd(a, b);
+                case _EW_MUL_:  return _mm512_mul_pd(a, b);
+                default:        return _mm512_div_pd(a, b);
+                }
+            }
+
+            // _EW_FMA_ : a * b + c, _EW_FMS_ : a * b - c
+            static vec fma(const int op, const vec a, const vec b, const vec c)
+            {
+                return op == _EW_FMA_ ? _mm512_fmadd_pd(a, b, c) : _mm512_fmsub_pd(a, b, c);
+            }
+        };
+
+
+        typedef decx::avx2::vec_f32 tail_f32;
+        typedef decx::avx2::vec_i32 tail_i32;
+        typedef decx::avx2::vec_f64 tail_f64;
+
+        _EW_ISA_KERNELS_
+    }
+}
+_DECX_ISA_END_
+
+
+
+namespace decx
+{
+    static void _select_ew_kernels(const int isa)
+    {
+        switch (isa)
+        {
+        case de::CPU_ISA::ISA_AVX512:
+            decx::avx512::_fill_ew_table<false>(&decx::_ew_kernels);
+            decx::avx512::_fill_ew_table<true>(&decx::_ew_kernels_nt);
+            break;
+        case de::CPU_ISA::ISA_AVX2:
+            decx::avx2::_fill_ew_table<false>(&decx::_ew_kernels);
+            decx::avx2::_fill_ew_table<true>(&decx::_ew_kernels_nt);
+            break;
+        default:
+            decx::sse42::_fill_ew_table<false>(&decx::_ew_kernels);
+            decx::sse42::_fill_ew_table<true>(&decx::_ew_kernels_nt);
+            break;
+        }
+    }
+
+
+    static decx::_ISA_dispatch_reg _ew_kernels_reg(&decx::_select_ew_kernels);
+}
+
+
+#endif
@@ -0,0 +1,173 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+#ifndef _EW_TENSOR_EXEC_H_
+#define _EW_TENSOR_EXEC_H_
+
+#include "../../core/basic.h"
+#include "../../core/thread_management/parallel_for.h"
+#include "ew_isa_kernels.h"
+
+
+/**
+* The element-wise callers of the tensors (and the tensor arrays) on the CPU. A tensor is stored as
+* height rows of dp_x_wp elements, of which only width * dpitch are active, the rest pads the width to
+* wpitch. The callers either go flat over all the _element_num elements as the ones of the matrices do,
+* one range of decx::parallel_for() in long kernels, or skip the padding of the rows, one kernel per row.
+* The padding of the depth (dpitch - depth of each element) is among the active ones, it is not skippable.
+*
+* Skipping saves traffic only by the cache lines lying wholly in the padding. The padding of a row is
+* (wpitch - width) * dpitch elements, at most 3 * dpitch, so the shallow tensors (dpitch <= 8 of float)
+* fetch the same lines either way and go flat, while the tensors of width 1 or 2 and depth 1024 are 2x - 6x
+* faster skipping (see tensor_ew_bench).
+*
+* store is one of de::cpu::StoreMode, the dst of Store_Auto is streamed by the size of all its elements.
+*/
+
+
+// skip the padding if it is at least _EW_SKIP_PADDING_MIN_GAP_ bytes a row,
+#define _EW_SKIP_PADDING_MIN_GAP_ 128
+
+// and at least 1 / _EW_SKIP_PADDING_MIN_RATIO_ of the rows
+#define _EW_SKIP_PADDING_MIN_RATIO_ 32
+
+
+namespace decx
+{
+    struct _ew_tensor_layout
+    {
+        size_t rows;            // height (of all the tensors of an array)
+        size_t row_len;         // the active elements of a row, width * dpitch
+        size_t pitch;           // dp_x_wp
+        size_t total;           // _element_num
+    };
+
+
+    /**
+    * @return true if the rows of layout (of T) are to be processed one by one, skipping the padding
+    */
+    template <typename T>
+    static bool _ew_skip_padding(const decx::_ew_tensor_layout* layout);
+
+
+    /**
+    * @brief Call f(offset, len) over the elements of layout, flat or row by row, len is a multiple of vec_len
+    */
+    template <typename _Func>
+    static void _ew_tensor_for(const decx::_ew_tensor_layout* layout, const int vec_len, const bool skip, const _Func& f);
+
+
+    // dst = A op B, op is _EW_ADD_ ... _EW_DIV_
+    template <typename T>
+    static void ew_tensor_m(const int op, const T* A, const T* B, T* dst, const decx::_ew_tensor_layout* layout,
+        const bool skip, const int store);
+
+
+    // dst = src op __x, or __x op src if inv
+    template <typename T>
+    static void ew_tensor_c(const int op, const T* src, const T __x, T* dst, const decx::_ew_tensor_layout* layout,
+        const bool skip, const bool inv, const int store);
+
+
+    // dst = A * B +- C, op is _EW_FMA_ or _EW_FMS_
+    template <typename T>
+    static void ew_tensor_m3(const int op, const T* A, const T* B, const T* C, T* dst,
+        const decx::_ew_tensor_layout* layout, const bool skip, const int store);
+
+
+    // dst = src * __x +- B
+    template <typename T>
+    static void ew_tensor_c3(const int op, const T* src, const T __x, const T* B, T* dst,
+        const decx::_ew_tensor_layout* layout, const bool skip, const int store);
+}
+
+
+
+template <typename T>
+static bool decx::_ew_skip_padding(const decx::_ew_tensor_layout* layout)
+{
+    const int vec_len = decx::_ew_typed_kernels<T>::vec_len;
+    const size_t _gap = layout->pitch - decx::utils::ceil<size_t>(layout->row_len, vec_len) * vec_len;
+    return _gap * sizeof(T) >= _EW_SKIP_PADDING_MIN_GAP_ && _gap * _EW_SKIP_PADDING_MIN_RATIO_ >= layout->pitch;
+}
+
+
+
+template <typename _Func>
+static void decx::_ew_tensor_for(const decx::_ew_tensor_layout* layout, const int vec_len, const bool skip, const _Func& f)
+{
+    if (skip) {
+        // the pitches are multiples of 8 (4 for double), the rounded rows stay in them
+        const size_t _row_len = decx::utils::ceil<size_t>(layout->row_len, vec_len) * vec_len;
+        const size_t _grain = decx::utils::clamp_min<size_t>(_EW_MIN_GRAIN_VEC_ * vec_len / decx::utils::clamp_min<size_t>(_row_len, 1), 1);
+
+        decx::parallel_for(0, layout->rows, [&](const size_t _beg, const size_t _end) {
+            for (size_t i = _beg; i < _end; ++i) {
+                f(i * layout->pitch, _row_len);
+            }
+        }, _grain, decx::Partition_NUMA);
+    }
+    else {
+        decx::parallel_for(0, layout->total / vec_len, [&](const size_t _beg, const size_t _end) {
+            f(_beg * vec_len, (_end - _beg) * vec_len);
+        }, _EW_MIN_GRAIN_VEC_, decx::Partition_NUMA);
+    }
+}
+
+
+
+template <typename T>
+static void decx::ew_tensor_m(const int op, const T* A, const T* B, T* dst, const decx::_ew_tensor_layout* layout,
+    const bool skip, const int store)
+{
+    const auto _kernel = decx::_ew_typed_kernels<T>::m(op, decx::_use_streaming_store(store, layout->total * sizeof(T)));
+    decx::_ew_tensor_for(layout, decx::_ew_typed_kernels<T>::vec_len, skip, [&](const size_t offset, const size_t len) {
+        _kernel(A + offset, B + offset, dst + offset, len);
+    });
+}
+
+
+
+template <typename T>
+static void decx::ew_tensor_c(const int op, const T* src, const T __x, T* dst, const decx::_ew_tensor_layout* layout,
+    const bool skip, const bool inv, const int store)
+{
+    const bool _nt = decx::_use_streaming_store(store, layout->total * sizeof(T));
+    const auto _kernel = inv ? decx::_ew_typed_kernels<T>::cinv(op, _nt) : decx::_ew_typed_kernels<T>::c(op, _nt);
+    decx::_ew_tensor_for(layout, decx::_ew_typed_kernels<T>::vec_len, skip, [&](const size_t offset, const size_t len) {
+        _kernel(src + offset, __x, dst + offset, len);
+    });
+}
+
+
+
+template <typename T>
+static void decx::ew_tensor_m3(const int op, const T* A, const T* B, const T* C, T* dst,
+    const decx::_ew_tensor_layout* layout, const bool skip, const int store)
+{
+    const auto _kernel = decx::_ew_typed_kernels<T>::m3(op, decx::_use_streaming_store(store, layout->total * sizeof(T)));
+    decx::_ew_tensor_for(layout, decx::_ew_typed_kernels<T>::vec_len, skip, [&](const size_t offset, const size_t len) {
+        _kernel(A + offset, B + offset, C + offset, dst + offset, len);
+    });
+}
+
+
+
+template <typename T>
+static void decx::ew_tensor_c3(const int op, const T* src, const T __x, const T* B, T* dst,
+    const decx::_ew_tensor_layout* layout, const bool skip, const int store)
+{
+    const auto _kernel = decx::_ew_typed_kernels<T>::c3(op, decx::_use_streaming_store(store, layout->total * sizeof(T)));
+    decx::_ew_tensor_for(layout, decx::_ew_typed_kernels<T>::vec_len, skip, [&](const size_t offset, const size_t len) {
+        _kernel(src + offset, __x, B + offset, dst + offset, len);
+    });
+}
+
+
+#endif
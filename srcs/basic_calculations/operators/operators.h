@@ -47,17 +47,33 @@
 #ifdef _DECX_CPU_CODES_
 // addition
 #include "Matrix/cpu_add.h"
+#include "Tensor/cpu_add.h"
 
 // subtract
 #include "Matrix/cpu_subtract.h"
+#include "Tensor/cpu_subtract.h"
 
 
 // multiply
 #include "Matrix/cpu_multiply.h"
+#include "Tensor/cpu_multiply.h"
 
 
 // divide
 #include "Matrix/cpu_divide.h"
+#include "Tensor/cpu_divide.h"
+
+
+// fma
+#include "Tensor/cpu_fma.h"
+
+
+// fms
+#include "Tensor/cpu_fms.h"
+
+
+// fused expressions
+#include "cpu_expr.h"
 
 #endif
 
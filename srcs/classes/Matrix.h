@@ -183,6 +183,15 @@ void decx::_Matrix<T>::alloc_data_space()
         }
         break;
 
+    case decx::DATA_STORE_TYPE::Page_Huge:
+        if (decx::alloc::_host_huge_page_malloc<T>(&this->Mat, this->_total_bytes)) {
+            SetConsoleColor(4);
+            printf("Matrix malloc failed! Please check if there is enough space in your device.");
+            ResetConsoleColor;
+            return;
+        }
+        break;
+
 #ifdef _DECX_CUDA_CODES_
     case decx::DATA_STORE_TYPE::Page_Locked:
         if (decx::alloc::_host_fixed_page_malloc<T>(&this->Mat, this->_total_bytes)) {
@@ -211,6 +220,15 @@ void decx::_Matrix<T>::re_alloc_data_space()
         }
         break;
 
+    case decx::DATA_STORE_TYPE::Page_Huge:
+        if (decx::alloc::_host_huge_page_realloc<T>(&this->Mat, this->_total_bytes)) {
+            SetConsoleColor(4);
+            printf("Matrix malloc failed! Please check if there is enough space in your device.");
+            ResetConsoleColor;
+            return;
+        }
+        break;
+
 #ifdef _DECX_CUDA_CODES_
     case decx::DATA_STORE_TYPE::Page_Locked:
         if (decx::alloc::_host_fixed_page_realloc<T>(&this->Mat, this->_total_bytes)) {
@@ -341,6 +359,25 @@ void decx::_Matrix<uchar>::_attribute_assign(const uint _width, const uint _heig
 
 
 
+// signed char is used as int8, plain char may be unsigned
+void decx::_Matrix<signed char>::_attribute_assign(const uint _width, const uint _height, const int store_type)
+{
+    this->width = _width;
+    this->height = _height;
+
+    this->Store_Type = store_type;
+
+    this->pitch = decx::utils::ceil<int>(_width, _MATRIX_ALIGN_1B_) * _MATRIX_ALIGN_1B_;
+
+    this->element_num = static_cast<size_t>(_width) * static_cast<size_t>(_height);
+    this->total_bytes = (this->element_num) * sizeof(signed char);
+
+    this->_element_num = static_cast<size_t>(this->pitch) * static_cast<size_t>(_height);
+    this->_total_bytes = (this->_element_num) * sizeof(signed char);
+}
+
+
+
 void decx::_Matrix<de::CPf>::_attribute_assign(const uint _width, const uint _height, const int store_type)
 {
     this->width = _width;
@@ -368,6 +405,10 @@ void decx::_Matrix<T>::release()
         decx::alloc::_host_virtual_page_dealloc(&this->Mat);
         break;
 
+    case decx::DATA_STORE_TYPE::Page_Huge:
+        decx::alloc::_host_huge_page_dealloc(&this->Mat);
+        break;
+
 #ifdef _DECX_CUDA_CODES_
     case decx::DATA_STORE_TYPE::Page_Locked:
         decx::alloc::_host_fixed_page_dealloc(&this->Mat);
@@ -438,6 +479,8 @@ template _DECX_API_ _DOUBLE_& de::CreateMatrixRef();
 
 template _DECX_API_ _UCHAR_& de::CreateMatrixRef();
 
+template _DECX_API_ _CHAR_& de::CreateMatrixRef();
+
 template _DECX_API_ _CPF_& de::CreateMatrixRef();
 
 #ifdef _DECX_CUDA_CODES_
@@ -453,6 +496,8 @@ template _DECX_API_ _DOUBLE_* de::CreateMatrixPtr();
 
 template _DECX_API_ _UCHAR_* de::CreateMatrixPtr();
 
+template _DECX_API_ _CHAR_* de::CreateMatrixPtr();
+
 template _DECX_API_ _CPF_* de::CreateMatrixPtr();
 
 #ifdef _DECX_CUDA_CODES_
@@ -483,6 +528,8 @@ template _DECX_API_ _DOUBLE_& de::CreateMatrixRef(const uint _width, const uint
 
 template _DECX_API_ _UCHAR_& de::CreateMatrixRef(const uint _width, const uint _height, const int store_type);
 
+template _DECX_API_ _CHAR_& de::CreateMatrixRef(const uint _width, const uint _height, const int store_type);
+
 template _DECX_API_ _CPF_& de::CreateMatrixRef(const uint _width, const uint _height, const int store_type);
 
 #ifdef _DECX_CUDA_CODES_
@@ -498,6 +545,8 @@ template _DECX_API_ _DOUBLE_* de::CreateMatrixPtr(const uint _width, const uint
 
 template _DECX_API_ _UCHAR_* de::CreateMatrixPtr(const uint _width, const uint _height, const int store_type);
 
+template _DECX_API_ _CHAR_* de::CreateMatrixPtr(const uint _width, const uint _height, const int store_type);
+
 template _DECX_API_ _CPF_* de::CreateMatrixPtr(const uint _width, const uint _height, const int store_type);
 
 #ifdef _DECX_CUDA_CODES_
@@ -524,6 +573,10 @@ de::Matrix<T>& decx::_Matrix<T>::operator=(de::Matrix<T>& src)
     case decx::DATA_STORE_TYPE::Page_Default:
         decx::alloc::_host_virtual_page_malloc_same_place(&this->Mat);
         break;
+
+    case decx::DATA_STORE_TYPE::Page_Huge:
+        decx::alloc::_host_huge_page_malloc_same_place(&this->Mat);
+        break;
     }
 
     return *this;
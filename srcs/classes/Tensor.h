@@ -305,6 +305,10 @@ void decx::_Tensor<T>::alloc_data_space()
         decx::alloc::_host_virtual_page_malloc<T>(&this->Tens, this->total_bytes);
         break;
 
+    case decx::DATA_STORE_TYPE::Page_Huge:
+        decx::alloc::_host_huge_page_malloc<T>(&this->Tens, this->total_bytes);
+        break;
+
     default:
         break;
     }
@@ -327,6 +331,10 @@ void decx::_Tensor<T>::re_alloc_data_space()
         decx::alloc::_host_virtual_page_realloc<T>(&this->Tens, this->total_bytes);
         break;
 
+    case decx::DATA_STORE_TYPE::Page_Huge:
+        decx::alloc::_host_huge_page_realloc<T>(&this->Tens, this->total_bytes);
+        break;
+
     default:
         break;
     }
@@ -379,6 +387,10 @@ void decx::_Tensor<T>::release()
         decx::alloc::_host_virtual_page_dealloc(&this->Tens);
         break;
 
+    case decx::DATA_STORE_TYPE::Page_Huge:
+        decx::alloc::_host_huge_page_dealloc(&this->Tens);
+        break;
+
     default:
         break;
     }
@@ -518,6 +530,10 @@ de::Tensor<T>& decx::_Tensor<T>::operator=(de::Tensor<T>& src)
         decx::alloc::_host_virtual_page_malloc_same_place(&this->Tens);
         break;
 
+    case decx::DATA_STORE_TYPE::Page_Huge:
+        decx::alloc::_host_huge_page_malloc_same_place(&this->Tens);
+        break;
+
     default:
         break;
     }
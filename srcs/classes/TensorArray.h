@@ -336,6 +336,13 @@ void decx::_TensorArray<T>::alloc_data_space()
         }
         break;
 
+    case decx::DATA_STORE_TYPE::Page_Huge:
+        if (decx::alloc::_host_huge_page_malloc<T>(&this->TensArr, this->total_bytes)) {
+            Print_Error_Message(4, "Fail to allocate memory for TensorArray on host\n");
+            exit(-1);
+        }
+        break;
+
     default:
         break;
     }
@@ -373,6 +380,13 @@ void decx::_TensorArray<T>::re_alloc_data_space()
         }
         break;
 
+    case decx::DATA_STORE_TYPE::Page_Huge:
+        if (decx::alloc::_host_huge_page_realloc<T>(&this->TensArr, this->total_bytes)) {
+            Print_Error_Message(4, "Fail to allocate memory for TensorArray on host\n");
+            exit(-1);
+        }
+        break;
+
     default:
         break;
     }
@@ -546,6 +560,10 @@ de::TensorArray<T>& decx::_TensorArray<T>::operator=(de::TensorArray<T>& src)
         decx::alloc::_host_virtual_page_malloc_same_place(&this->TensArr);
         break;
 
+    case decx::DATA_STORE_TYPE::Page_Huge:
+        decx::alloc::_host_huge_page_malloc_same_place(&this->TensArr);
+        break;
+
     default:
         break;
     }
@@ -563,6 +581,10 @@ void decx::_TensorArray<T>::release()
         decx::alloc::_host_virtual_page_dealloc(&this->TensArr);
         break;
 
+    case decx::DATA_STORE_TYPE::Page_Huge:
+        decx::alloc::_host_huge_page_dealloc(&this->TensArr);
+        break;
+
 #ifdef _DECX_CUDA_CODES_
     case decx::DATA_STORE_TYPE::Page_Locked:
         decx::alloc::_host_fixed_page_dealloc(&this->TensArr);
@@ -20,11 +20,16 @@ namespace decx {
 * So make sure the users won't use this flag to create any memory block if they just load DECX_cpu.dll(.so)
 * But if users are using DECX_CUDA.dll(.so), both flags work. But Page_Locked flag will accelerate DMA
 * process (transfering data between host and device)
+* 'Page_Huge' backs the large buffers with 2MB pages (fewer TLB misses), through MAP_HUGETLB (or
+* MEM_LARGE_PAGES on Windows) if there are huge pages reserved, otherwise through the transparent huge
+* pages (madvise), or the normal pages if neither is available. It works for decx::_Matrix,
+* decx::_Tensor and decx::_TensorArray.
 */
 enum decx::DATA_STORE_TYPE
 {
     Page_Locked = 0x00,        // call cudaHostAlloc(..., cudaHostAllocDefault)
-    Page_Default = 0x01        // call decx::alloc::aligned_malloc_Hv() -> std::malloc()
+    Page_Default = 0x01,       // call decx::alloc::aligned_malloc_Hv() -> std::malloc()
+    Page_Huge = 0x02           // call decx::alloc::malloc_Hh() -> 2MB pages, normal pages if not available
 };
 
 
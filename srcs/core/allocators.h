@@ -35,6 +35,12 @@ namespace decx
         template <typename _Ty>
         static int _host_virtual_page_malloc(decx::PtrInfo<_Ty>* ptr_info, size_t size);
 
+        _DECX_API_ int _alloc_Hh(decx::MemBlock** _ptr, size_t req_size);
+
+
+        template <typename _Ty>
+        static int _host_huge_page_malloc(decx::PtrInfo<_Ty>* ptr_info, size_t size);
+
         _DECX_API_ int _alloc_Hf(decx::MemBlock** _ptr, size_t req_size);
 
 
@@ -59,6 +65,14 @@ namespace decx
         static void _host_virtual_page_malloc_same_place(decx::PtrInfo<_Ty>* ptr_info);
 
 
+        /** @return If successed, 0; If failed -1 */
+        _DECX_API_ void _alloc_Hh_same_place(decx::MemBlock** _ptr);
+
+
+        template <typename _Ty>
+        static void _host_huge_page_malloc_same_place(decx::PtrInfo<_Ty>* ptr_info);
+
+
         /** @return If successed, 0; If failed -1 */
         _DECX_API_ void _alloc_Hf_same_place(decx::MemBlock** _ptr);
 
@@ -83,6 +97,10 @@ namespace decx
         int _host_virtual_page_realloc(decx::PtrInfo<T>* ptr_info, size_t size);
 
 
+        template <typename T>
+        int _host_huge_page_realloc(decx::PtrInfo<T>* ptr_info, size_t size);
+
+
         template <typename T>
         int _device_realloc(decx::PtrInfo<T>* ptr_info, size_t size);
     }
@@ -99,6 +117,11 @@ namespace decx
         template <typename _Ty>
         static void _host_virtual_page_dealloc(decx::PtrInfo<_Ty>* ptr_info);
 
+        _DECX_API_ void _dealloc_Hh(decx::MemBlock* _ptr);
+
+        template <typename _Ty>
+        static void _host_huge_page_dealloc(decx::PtrInfo<_Ty>* ptr_info);
+
         _DECX_API_ void _dealloc_Hf(decx::MemBlock* _ptr);
 
 
@@ -125,6 +148,15 @@ static void decx::alloc::_host_virtual_page_dealloc(decx::PtrInfo<_Ty>* ptr_info
 
 
 
+template <typename _Ty>
+static void decx::alloc::_host_huge_page_dealloc(decx::PtrInfo<_Ty>* ptr_info) {
+    decx::alloc::_dealloc_Hh(ptr_info->block);
+    ptr_info->ptr = NULL;
+}
+
+
+
+
 template <typename _Ty>
 static void decx::alloc::_host_fixed_page_dealloc(decx::PtrInfo<_Ty>* ptr_info) {
     decx::alloc::_dealloc_Hf(ptr_info->block);
@@ -161,6 +193,25 @@ static void decx::alloc::_host_virtual_page_malloc_same_place(decx::PtrInfo<T>*
 
 
 
+template <typename T>
+static int decx::alloc::_host_huge_page_malloc(decx::PtrInfo<T>* ptr_info, size_t size)
+{
+    int ans = decx::alloc::_alloc_Hh(&ptr_info->block, size);
+    ptr_info->_sync_type();
+    return ans;
+}
+
+
+
+template <typename T>
+static void decx::alloc::_host_huge_page_malloc_same_place(decx::PtrInfo<T>* ptr_info)
+{
+    decx::alloc::_alloc_Hh_same_place(&ptr_info->block);
+    ptr_info->_sync_type();
+}
+
+
+
 template <typename T>
 static int decx::alloc::_host_fixed_page_malloc(decx::PtrInfo<T>* ptr_info, size_t size)
 {
@@ -231,6 +282,23 @@ int decx::alloc::_host_virtual_page_realloc(decx::PtrInfo<T>* ptr_info, size_t s
 
 
 
+template <typename T>
+int decx::alloc::_host_huge_page_realloc(decx::PtrInfo<T>* ptr_info, size_t size)
+{
+    if (ptr_info->block != NULL) {
+        if (ptr_info->block->_ptr != NULL) {            // if it is previously allocated
+            decx::alloc::_dealloc_Hh(ptr_info->block);
+        }
+    }
+    // reallocate new memory of new size
+    int ans = decx::alloc::_alloc_Hh(&ptr_info->block, size);
+    ptr_info->_sync_type();
+
+    return ans;
+}
+
+
+
 template <typename T>
 int decx::alloc::_device_realloc(decx::PtrInfo<T>* ptr_info, size_t size)
 {
@@ -12,6 +12,14 @@
 
 #include "../basic.h"
 
+#ifndef Windows
+#include <sys/mman.h>
+#endif
+
+
+// size (and alignment) of the huge pages requested by decx::alloc::malloc_Hh()
+#define _HUGE_PAGE_SIZE_ (2 << 20)
+
 
 
 namespace decx
@@ -23,6 +31,23 @@ namespace decx
 
         void aligned_free_Hv(void* _ptr);
 
+        /**
+        * @brief Allocate the memory backed by huge pages (_HUGE_PAGE_SIZE_). Tries the explicit huge
+        * pages first (MAP_HUGETLB / MEM_LARGE_PAGES), and falls back to the normal pages aligned to
+        * _HUGE_PAGE_SIZE_ (advised with MADV_HUGEPAGE, so that the kernel backs them with transparent
+        * huge pages where it is enabled).
+        *
+        * @param size Multiple of _HUGE_PAGE_SIZE_
+        * @param is_huge Set true if the explicit huge pages are got
+        * @return NULL if failed
+        */
+        void* malloc_Hh(size_t size, bool* is_huge);
+
+        /**
+        * @param size The size passed to decx::alloc::malloc_Hh()
+        */
+        void free_Hh(void* _ptr, size_t size);
+
         void* aligned_malloc_Hf(size_t size, size_t alignment);
 
         void aligned_free_Hf(void* _ptr);
@@ -66,6 +91,67 @@ void decx::alloc::aligned_free_Hv(void* _ptr)
 }
 
 
+#ifdef Windows
+void* decx::alloc::malloc_Hh(size_t size, bool* is_huge)
+{
+    // MEM_LARGE_PAGES needs SeLockMemoryPrivilege, it fails without it
+    const size_t _large_page = GetLargePageMinimum();
+    if (_large_page != 0 && size % _large_page == 0) {
+        void* ptr = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+        if (ptr != NULL) {
+            *is_huge = true;
+            return ptr;
+        }
+    }
+    *is_huge = false;
+    return VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+}
+
+
+
+void decx::alloc::free_Hh(void* _ptr, size_t size)
+{
+    VirtualFree(_ptr, 0, MEM_RELEASE);
+}
+#else
+void* decx::alloc::malloc_Hh(size_t size, bool* is_huge)
+{
+#ifdef MAP_HUGETLB
+    // succeeds only if there are huge pages reserved (vm.nr_hugepages)
+    void* ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (ptr != MAP_FAILED) {
+        *is_huge = true;
+        return ptr;
+    }
+#endif
+    *is_huge = false;
+
+    // over-map by one huge page, and unmap the unaligned head and tail
+    uchar* raw_ptr = (uchar*)mmap(NULL, size + _HUGE_PAGE_SIZE_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if ((void*)raw_ptr == MAP_FAILED) {
+        return NULL;
+    }
+    uchar* real_ptr = (uchar*)(((size_t)raw_ptr + _HUGE_PAGE_SIZE_ - 1) & ~((size_t)_HUGE_PAGE_SIZE_ - 1));
+    if (real_ptr != raw_ptr) {
+        munmap(raw_ptr, real_ptr - raw_ptr);
+    }
+    munmap(real_ptr + size, raw_ptr + _HUGE_PAGE_SIZE_ - real_ptr);
+#ifdef MADV_HUGEPAGE
+    madvise(real_ptr, size, MADV_HUGEPAGE);
+#endif
+    return real_ptr;
+}
+
+
+
+void decx::alloc::free_Hh(void* _ptr, size_t size)
+{
+    munmap(_ptr, size);
+}
+#endif
+
+
+
 void* decx::alloc::aligned_malloc_Hf(size_t size, size_t alignment)
 {
     if (alignment & (alignment - 1)) {
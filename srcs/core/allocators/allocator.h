@@ -27,6 +27,9 @@ namespace decx
         /** @return If successed, 0; If failed -1 */
         _DECX_API_ int _alloc_Hv(decx::MemBlock** _ptr, size_t req_size);
 
+        /** @return If successed, 0; If failed -1 */
+        _DECX_API_ int _alloc_Hh(decx::MemBlock** _ptr, size_t req_size);
+
         /** @return If successed, 0; If failed -1 */
         _DECX_API_ int _alloc_Hf(decx::MemBlock** _ptr, size_t req_size);
 
@@ -36,6 +39,9 @@ namespace decx
         /** @return If successed, 0; If failed -1 */
         _DECX_API_ void _alloc_Hv_same_place(decx::MemBlock** _ptr);
 
+        /** @return If successed, 0; If failed -1 */
+        _DECX_API_ void _alloc_Hh_same_place(decx::MemBlock** _ptr);
+
         /** @return If successed, 0; If failed -1 */
         _DECX_API_ void _alloc_Hf_same_place(decx::MemBlock** _ptr);
 
@@ -63,6 +69,23 @@ void decx::alloc::_alloc_Hv_same_place(decx::MemBlock** _ptr)
 }
 
 
+int decx::alloc::_alloc_Hh(decx::MemBlock** _ptr, size_t req_size)
+{
+    decx::mem_pool_Hh.allocate(req_size, _ptr);
+
+    if ((*_ptr)->_ptr == NULL) {
+        return -1;
+    }
+    return 0;
+}
+
+
+void decx::alloc::_alloc_Hh_same_place(decx::MemBlock** _ptr)
+{
+    decx::mem_pool_Hh.register_reference(*_ptr);
+}
+
+
 int decx::alloc::_alloc_Hf(decx::MemBlock** _ptr, size_t req_size)
 {
     decx::mem_pool_Hf.allocate(req_size, _ptr);
@@ -28,6 +28,8 @@ namespace decx
         template <typename _Ty>
         static void _host_virtual_page_dealloc(decx::PtrInfo<_Ty>* ptr_info);
 
+        _DECX_API_ void _dealloc_Hh(decx::MemBlock* _ptr);
+
         _DECX_API_ void _dealloc_Hf(decx::MemBlock* _ptr);
 
 
@@ -50,6 +52,11 @@ void decx::alloc::_dealloc_Hv(decx::MemBlock* _ptr) {
 }
 
 
+void decx::alloc::_dealloc_Hh(decx::MemBlock* _ptr) {
+    decx::mem_pool_Hh.deallocate(_ptr);
+}
+
+
 void decx::alloc::_dealloc_Hf(decx::MemBlock* _ptr) {
     decx::mem_pool_Hf.deallocate(_ptr);
 }
@@ -0,0 +1,271 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+
+#ifndef _SCRATCH_ARENA_H_
+#define _SCRATCH_ARENA_H_
+
+#include "../basic.h"
+#include "../allocators.h"
+
+
+// the alignment (in bytes) of the pointers returned by decx::ScratchArena::allocate()
+#define _SCRATCH_ALIGN_ 64
+
+// the least size of a block requested by the arena
+#define _SCRATCH_BLOCK_MIN_ (1 << 20)
+
+// the arena returns all its blocks to the pool at the outermost rewind if it holds more than this
+#define _SCRATCH_RETAIN_MAX_ (64 << 20)
+
+#define _SCRATCH_BLOCK_MAX_NUM_ 16
+
+
+namespace decx
+{
+    class ScratchArena;
+
+
+    class ScratchMarker;
+}
+
+
+
+/**
+* Per-thread bump-pointer arena for the temporary workspaces of the operators. The memory is
+* requested from decx::mem_pool_Hv in blocks and handed out by bumping an offset, nothing is freed
+* individually, a decx::ScratchMarker rewinds the arena to where it was when the marker was created.
+*   - When a block is used up, the next block is taken, a new block is at least twice the
+*     capacity so far.
+*   - At the outermost rewind, an arena holding several blocks gives them back, and takes one
+*     block covering the most bytes used at once instead. So the same sequence of calls
+*     runs in one block with no allocation from the pool after the first time.
+*   - An arena holding more than _SCRATCH_RETAIN_MAX_ gives all its blocks back at the outermost
+*     rewind, the operators accept a workspace from the user for such sizes.
+*/
+class decx::ScratchArena
+{
+private:
+    friend class decx::ScratchMarker;
+
+    decx::PtrInfo<uchar> _blocks[_SCRATCH_BLOCK_MAX_NUM_];
+    int _block_num, _current;
+
+    // _base : the total size of the blocks before this->_current
+    size_t _offset, _base, _capacity;
+
+    // the most bytes used at once since the last outermost rewind
+    size_t _high_water;
+
+    // number of the living markers
+    int _depth;
+
+
+    bool _add_block(const size_t req_size);
+
+
+    void _rewind(const int block, const size_t offset, const size_t base);
+
+
+    // called when the outermost marker is destroyed
+    void _on_reset();
+
+public:
+    ScratchArena();
+
+    /**
+    * @brief Take size bytes from the arena, aligned to _SCRATCH_ALIGN_. The memory is valid until
+    * the arena is rewound past it.
+    * @return NULL if the pool fails to provide a new block
+    */
+    void* allocate(size_t size);
+
+
+    template <typename _Ty>
+    _Ty* allocate(const size_t num) {
+        return reinterpret_cast<_Ty*>(this->allocate(num * sizeof(_Ty)));
+    }
+
+
+    size_t capacity() const { return this->_capacity; }
+
+    /**
+    * @brief Give all the blocks back to the pool, should not be called while any marker is living
+    */
+    void release();
+
+
+    ~ScratchArena();
+};
+
+
+
+/**
+* RAII marker of a decx::ScratchArena, rewinds the arena to where it was at the construction of
+* the marker when it goes out of scope. The markers of an arena should be destroyed in the reverse
+* order of their construction, which is the case when they are local variables.
+*/
+class decx::ScratchMarker
+{
+private:
+    decx::ScratchArena* _arena;
+    int _block;
+    size_t _offset, _base;
+
+public:
+    ScratchMarker(decx::ScratchArena* arena);
+
+
+    ~ScratchMarker();
+};
+
+
+
+namespace decx
+{
+    thread_local decx::ScratchArena _tl_scratch_arena;
+}
+
+
+
+decx::ScratchArena::ScratchArena()
+{
+    this->_block_num = 0;
+    this->_current = 0;
+    this->_offset = 0;
+    this->_base = 0;
+    this->_capacity = 0;
+    this->_high_water = 0;
+    this->_depth = 0;
+}
+
+
+
+bool decx::ScratchArena::_add_block(const size_t req_size)
+{
+    if (this->_block_num == _SCRATCH_BLOCK_MAX_NUM_) {
+        return false;
+    }
+    size_t _size = decx::utils::clamp_min<size_t>(req_size, _SCRATCH_BLOCK_MIN_);
+    _size = decx::utils::clamp_min<size_t>(_size, this->_capacity * 2);
+
+    decx::PtrInfo<uchar>* _new = &this->_blocks[this->_block_num];
+    if (decx::alloc::_host_virtual_page_malloc<uchar>(_new, _size)) {
+        _new->block = NULL;
+        _new->ptr = NULL;
+        return false;
+    }
+    ++this->_block_num;
+    this->_capacity += _new->block->block_size;
+    return true;
+}
+
+
+
+void* decx::ScratchArena::allocate(size_t size)
+{
+    size = decx::utils::ceil<size_t>(size, _SCRATCH_ALIGN_) * _SCRATCH_ALIGN_;
+
+    // find the first block (from the current one) with enough room
+    while (this->_current < this->_block_num) {
+        decx::MemBlock* _block = this->_blocks[this->_current].block;
+        // the pool aligns to host_mem_alignment only
+        const size_t _head = decx::utils::ceil<size_t>((size_t)_block->_ptr, _SCRATCH_ALIGN_) * _SCRATCH_ALIGN_
+            - (size_t)_block->_ptr;
+        if (_head + this->_offset + size <= _block->block_size) {
+            void* _ptr = _block->_ptr + _head + this->_offset;
+            this->_offset += size;
+            this->_high_water = decx::utils::clamp_min<size_t>(this->_high_water, this->_base + this->_offset + _head);
+            return _ptr;
+        }
+        if (this->_current == this->_block_num - 1) {
+            break;
+        }
+        this->_base += _block->block_size;
+        this->_offset = 0;
+        ++this->_current;
+    }
+
+    if (!this->_add_block(size + _SCRATCH_ALIGN_)) {
+        return NULL;
+    }
+    if (this->_block_num > 1) {
+        this->_base += this->_blocks[this->_current].block->block_size;
+        this->_current = this->_block_num - 1;
+    }
+    this->_offset = 0;
+    return this->allocate(size);
+}
+
+
+
+void decx::ScratchArena::_rewind(const int block, const size_t offset, const size_t base)
+{
+    this->_current = block;
+    this->_offset = offset;
+    this->_base = base;
+}
+
+
+
+void decx::ScratchArena::_on_reset()
+{
+    if (this->_capacity > _SCRATCH_RETAIN_MAX_) {
+        this->release();
+    }
+    else if (this->_block_num > 1) {
+        const size_t _need = this->_high_water;
+        this->release();
+        this->_add_block(_need + _SCRATCH_ALIGN_);
+    }
+    this->_high_water = 0;
+}
+
+
+
+void decx::ScratchArena::release()
+{
+    for (int i = 0; i < this->_block_num; ++i) {
+        decx::alloc::_host_virtual_page_dealloc<uchar>(&this->_blocks[i]);
+    }
+    this->_block_num = 0;
+    this->_capacity = 0;
+    this->_rewind(0, 0, 0);
+}
+
+
+
+decx::ScratchArena::~ScratchArena()
+{
+    this->release();
+}
+
+
+
+decx::ScratchMarker::ScratchMarker(decx::ScratchArena* arena)
+{
+    this->_arena = arena;
+    this->_block = arena->_current;
+    this->_offset = arena->_offset;
+    this->_base = arena->_base;
+    ++arena->_depth;
+}
+
+
+
+decx::ScratchMarker::~ScratchMarker()
+{
+    this->_arena->_rewind(this->_block, this->_offset, this->_base);
+    if (--this->_arena->_depth == 0) {
+        this->_arena->_on_reset();
+    }
+}
+
+
+#endif
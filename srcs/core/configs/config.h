@@ -12,6 +12,8 @@
 #define _CONFIG_H_
 
 #include "../../core/basic.h"
+#include "cpu_topology.h"
+#include "cpu_isa.h"
 
 
 #ifdef _DECX_CUDA_CODES_
@@ -33,11 +35,22 @@ namespace decx
 {
     typedef struct cpuInfo
     {
+        // number of logical processors
         size_t cpu_concurrency;
+
+        uint socket_num, physical_core_num, numa_node_num;
+
+        // in bytes. L1d and L2 are of one core, L3 is of one socket (shared)
+        size_t L1d_size, L2_size, L3_size, cache_line_size;
+
+        // de::CPU_ISA, the highest supported and the one the kernel tables are filled with
+        int ISA_detected, ISA_level;
+
         bool is_init;
 
         cpuInfo() {
             is_init = false;
+            ISA_detected = ISA_level = 0;
         }
     };
 }
@@ -64,6 +77,20 @@ namespace de
 
 #ifdef _DECX_CPU_CODES_
     _DECX_API_ void InitCPUInfo();
+
+
+    /**
+    * @brief Select the kernels of the instruction set for all the CPU operators, for comparing the levels.
+    * Should not be called while any operator is running.
+    * @param isa : one of de::CPU_ISA, ISA_Auto for the highest level supported
+    */
+    _DECX_API_ de::DH SetCPUISA(const int isa);
+
+
+    /**
+    * @return The de::CPU_ISA the CPU operators are running with
+    */
+    _DECX_API_ int GetCPUISA();
 #endif
 }
 
@@ -81,8 +108,57 @@ _DECX_API_ void de::InitCuda()
 #ifdef _DECX_CPU_CODES_
 _DECX_API_ void de::InitCPUInfo()
 {
+    const decx::CPU_Topology& _topo = decx::utils::get_cpu_topology();
+
+    decx::cpI.cpu_concurrency = _topo.logical_cpu_num();
+    decx::cpI.socket_num = _topo.socket_num;
+    decx::cpI.physical_core_num = _topo.physical_core_num;
+    decx::cpI.numa_node_num = _topo.numa_node_num;
+
+    decx::cpI.L1d_size = _topo.L1d_size;
+    decx::cpI.L2_size = _topo.L2_size;
+    decx::cpI.L3_size = _topo.L3_size;
+    decx::cpI.cache_line_size = _topo.cache_line_size;
+
+    decx::cpI.ISA_detected = decx::utils::detect_CPU_ISA();
+    decx::cpI.ISA_level = decx::cpI.ISA_detected;
+    decx::utils::_apply_ISA(decx::cpI.ISA_level);
+
     decx::cpI.is_init = true;
-    decx::cpI.cpu_concurrency = std::thread::hardware_concurrency();
+}
+
+
+
+_DECX_API_ de::DH de::SetCPUISA(const int isa)
+{
+    de::DH handle;
+    const int _detected = decx::utils::detect_CPU_ISA();
+
+    if (isa < de::CPU_ISA::ISA_Auto || isa > de::CPU_ISA::ISA_AVX512) {
+        decx::MeaninglessFlag(&handle);
+        Print_Error_Message(4, MEANINGLESS_FLAG);
+        return handle;
+    }
+    if (isa > _detected) {
+        decx::err::ISA_NotSupported(&handle);
+        Print_Error_Message(4, ISA_NOT_SUPPORTED);
+        return handle;
+    }
+
+    decx::cpI.ISA_detected = _detected;
+    decx::cpI.ISA_level = isa == de::CPU_ISA::ISA_Auto ? _detected : isa;
+    decx::utils::_apply_ISA(decx::cpI.ISA_level);
+
+    decx::Success(&handle);
+    return handle;
+}
+
+
+
+_DECX_API_ int de::GetCPUISA()
+{
+    // the tables are filled with the detected level until de::InitCPUInfo() or de::SetCPUISA()
+    return decx::cpI.ISA_level != de::CPU_ISA::ISA_Auto ? decx::cpI.ISA_level : decx::utils::detect_CPU_ISA();
 }
 #endif
 
@@ -0,0 +1,236 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+
+#ifndef _CPU_ISA_H_
+#define _CPU_ISA_H_
+
+
+// not basic.h, config.h includes this file to describe the CPU
+#include "../defines.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+
+/**
+* The kernels of each instruction set are put between _DECX_ISA_BEGIN_XXX_ and _DECX_ISA_END_.
+* GCC and Clang refuse the intrinsics which are not enabled for the function using them, and only
+* the base x86-64 set is enabled for the whole library, so that it loads on any host. MSVC emits
+* the intrinsics of any instruction set whatever /arch is, the macros are empty.
+*/
+#if defined(__GNUC__) && !defined(_MSC_VER)
+#define _DECX_ISA_BEGIN_SSE42_      _Pragma("GCC push_options") _Pragma("GCC target(\"sse4.2\")")
+#define _DECX_ISA_BEGIN_AVX2_       _Pragma("GCC push_options") _Pragma("GCC target(\"avx2,fma\")")
+#define _DECX_ISA_BEGIN_AVX512_     _Pragma("GCC push_options") _Pragma("GCC target(\"avx512f,avx2,fma\")")
+#define _DECX_ISA_BEGIN_AVX512_VNNI_    _Pragma("GCC push_options") _Pragma("GCC target(\"avx512f,avx512bw,avx512vnni,avx2,fma\")")
+#define _DECX_ISA_END_              _Pragma("GCC pop_options")
+#else
+#define _DECX_ISA_BEGIN_SSE42_
+#define _DECX_ISA_BEGIN_AVX2_
+#define _DECX_ISA_BEGIN_AVX512_
+#define _DECX_ISA_BEGIN_AVX512_VNNI_
+#define _DECX_ISA_END_
+#endif
+
+
+// the most kernel tables which can be registered by decx::_ISA_dispatch_reg
+#define _MAX_ISA_DISPATCH_NUM_ 32
+
+
+namespace de
+{
+    enum CPU_ISA
+    {
+        ISA_Auto = 0x00,            // the highest level supported by the host
+        ISA_SSE42 = 0x01,           // SSE4.2, the lowest level the kernels are written for
+        ISA_AVX2 = 0x02,            // AVX2 and FMA3
+        ISA_AVX512 = 0x03           // AVX-512F
+    };
+}
+
+
+namespace decx
+{
+    // called with one of de::CPU_ISA (never ISA_Auto) to fill the function pointers of a kernel table
+    typedef void (*_ISA_selector)(const int);
+
+
+    struct _ISA_dispatch_reg;
+
+
+    namespace utils
+    {
+        /**
+        * @brief The highest de::CPU_ISA the CPU and the OS support, the CPU is queried once, at the first call.
+        * SSE4.2 is returned for the hosts below it, the library is not meant to run on them.
+        */
+        static int detect_CPU_ISA();
+
+
+        /**
+        * @brief If the host has AVX512-VNNI (and AVX512-BW), an extension the kernels of the integers
+        * may use on top of de::CPU_ISA::ISA_AVX512, it is not a level of its own
+        */
+        static bool detect_CPU_VNNI();
+
+
+        /**
+        * @brief Call all the registered selectors with the ISA level
+        */
+        static void _apply_ISA(const int isa);
+
+
+        static const char* ISA_name(const int isa);
+    }
+}
+
+
+
+/**
+* Each module with ISA-dependent kernels keeps a table of function pointers and defines one
+* decx::_ISA_dispatch_reg (at namespace scope) with the function filling its table. The table is
+* filled with the detected level at the registration, de::InitCPUInfo() and de::SetCPUISA() fill
+* all the tables again. So the calls go through one indirect call of a table entry, and no kernel of
+* an unsupported ISA is ever reached.
+*/
+struct decx::_ISA_dispatch_reg
+{
+    static decx::_ISA_selector _selectors[_MAX_ISA_DISPATCH_NUM_];
+    static int _selector_num;
+
+    _ISA_dispatch_reg(const decx::_ISA_selector selector)
+    {
+        if (decx::_ISA_dispatch_reg::_selector_num < _MAX_ISA_DISPATCH_NUM_) {
+            decx::_ISA_dispatch_reg::_selectors[decx::_ISA_dispatch_reg::_selector_num++] = selector;
+        }
+        selector(decx::utils::detect_CPU_ISA());
+    }
+};
+
+
+decx::_ISA_selector decx::_ISA_dispatch_reg::_selectors[_MAX_ISA_DISPATCH_NUM_];
+int decx::_ISA_dispatch_reg::_selector_num = 0;
+
+
+
+namespace decx
+{
+    namespace utils
+    {
+        static void _cpuid(int res[4], const int leaf, const int subleaf)
+        {
+        #ifdef _MSC_VER
+            __cpuidex(res, leaf, subleaf);
+        #else
+            unsigned int a = 0, b = 0, c = 0, d = 0;
+            __cpuid_count(leaf, subleaf, a, b, c, d);
+            res[0] = (int)a;    res[1] = (int)b;    res[2] = (int)c;    res[3] = (int)d;
+        #endif
+        }
+
+
+        // the register states enabled by the OS (XCR0)
+        static unsigned long long _xgetbv0()
+        {
+        #ifdef _MSC_VER
+            return _xgetbv(0);
+        #else
+            unsigned int lo = 0, hi = 0;
+            __asm__ volatile ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+            return ((unsigned long long)hi << 32) | lo;
+        #endif
+        }
+    }
+}
+
+
+
+static int decx::utils::detect_CPU_ISA()
+{
+    static int _isa = -1;
+    if (_isa != -1) {
+        return _isa;
+    }
+
+    int regs[4];
+    decx::utils::_cpuid(regs, 0, 0);
+    const int _max_leaf = regs[0];
+
+    decx::utils::_cpuid(regs, 1, 0);
+    const bool _osxsave = (regs[2] >> 27) & 1;
+    const bool _avx = (regs[2] >> 28) & 1;
+    const bool _fma = (regs[2] >> 12) & 1;
+
+    bool _avx2 = false, _avx512f = false;
+    if (_max_leaf >= 7) {
+        decx::utils::_cpuid(regs, 7, 0);
+        _avx2 = (regs[1] >> 5) & 1;
+        _avx512f = (regs[1] >> 16) & 1;
+    }
+
+    // XMM, YMM (bits 1, 2) and opmask, ZMM0-15 upper, ZMM16-31 (bits 5, 6, 7) saved by the OS
+    const unsigned long long _xcr0 = _osxsave ? decx::utils::_xgetbv0() : 0;
+    const bool _os_ymm = (_xcr0 & 0x06) == 0x06;
+    const bool _os_zmm = (_xcr0 & 0xe6) == 0xe6;
+
+    int _res = de::CPU_ISA::ISA_SSE42;
+    if (_avx && _avx2 && _fma && _os_ymm) {
+        _res = de::CPU_ISA::ISA_AVX2;
+        if (_avx512f && _os_zmm) {
+            _res = de::CPU_ISA::ISA_AVX512;
+        }
+    }
+    _isa = _res;
+    return _isa;
+}
+
+
+
+static bool decx::utils::detect_CPU_VNNI()
+{
+    if (decx::utils::detect_CPU_ISA() != de::CPU_ISA::ISA_AVX512) {
+        return false;
+    }
+    int regs[4];
+    decx::utils::_cpuid(regs, 7, 0);
+    return ((regs[1] >> 30) & 1) && ((regs[2] >> 11) & 1);
+}
+
+
+
+static void decx::utils::_apply_ISA(const int isa)
+{
+    for (int i = 0; i < decx::_ISA_dispatch_reg::_selector_num; ++i) {
+        decx::_ISA_dispatch_reg::_selectors[i](isa);
+    }
+}
+
+
+
+static const char* decx::utils::ISA_name(const int isa)
+{
+    switch (isa)
+    {
+    case de::CPU_ISA::ISA_SSE42:
+        return "SSE4.2";
+    case de::CPU_ISA::ISA_AVX2:
+        return "AVX2";
+    case de::CPU_ISA::ISA_AVX512:
+        return "AVX-512";
+    default:
+        return "Auto";
+    }
+}
+
+
+#endif
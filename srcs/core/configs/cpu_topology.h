@@ -0,0 +1,460 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+
+#ifndef _CPU_TOPOLOGY_H_
+#define _CPU_TOPOLOGY_H_
+
+
+// not basic.h, config.h includes this file to describe the CPU
+#include "../defines.h"
+#include <algorithm>
+
+#ifndef Windows
+#include <cstdio>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+
+// the largest number of NUMA nodes that decx::parallel_for() distributes the work over
+#define _MAX_NUMA_NODE_NUM_ 16
+
+
+namespace decx
+{
+    struct logical_cpu
+    {
+        int os_id;          // the id used by the OS for affinity
+        int socket_id;      // 0, 1, ... (compacted)
+        int core_id;        // the physical core, unique within the whole machine (compacted)
+        int node_id;        // the NUMA node, 0, 1, ... (compacted)
+        int smt_id;         // 0 for the first hardware thread of the physical core, 1 for its sibling ...
+    };
+
+
+    class CPU_Topology;
+
+
+    namespace utils
+    {
+        /**
+        * @brief The topology is queried once, at the first call.
+        */
+        const decx::CPU_Topology& get_cpu_topology();
+    }
+}
+
+
+/**
+* The CPU topology (sockets, physical cores, SMT siblings, NUMA nodes) and the sizes of the caches.
+* Linux : read from /sys/devices/system/cpu and /sys/devices/system/node.
+* Windows : read from GetLogicalProcessorInformationEx().
+* If nothing can be read, every logical processor is treated as one core in socket 0, node 0, and
+* the cache sizes are set to common values (32K L1d, 256K L2, 8M L3, 64B line).
+*/
+class decx::CPU_Topology
+{
+private:
+    void _query_OS();
+
+    void _fallback();
+
+    // compact the ids, find the SMT siblings and build this->_placement
+    void _arrange();
+
+public:
+    std::vector<decx::logical_cpu> _cpus;
+
+    /**
+    * The order in which the workers of a pool are placed, worker i -> this->_cpus[this->_placement[i]].
+    * All the physical cores first (round-robin over the NUMA nodes), then the second hardware
+    * threads of the cores, and so on.
+    */
+    std::vector<int> _placement;
+
+    uint socket_num, physical_core_num, numa_node_num;
+
+    // in bytes. L1d and L2 are of one core, L3 is of one socket (shared)
+    size_t L1d_size, L2_size, L3_size, cache_line_size;
+
+
+    CPU_Topology();
+
+
+    size_t logical_cpu_num() const { return this->_cpus.size(); }
+
+    /**
+    * @brief The NUMA node which the worker is placed on
+    */
+    int node_of_worker(const size_t worker_id) const;
+
+    /**
+    * @brief Pin the calling thread to the logical processor of the worker. The workers beyond the
+    * number of the logical processors are not pinned.
+    * @return true if the thread is pinned
+    */
+    bool bind_current_thread(const size_t worker_id) const;
+};
+
+
+
+#ifndef Windows
+namespace decx
+{
+    namespace utils
+    {
+        static bool _read_sys_string(const char* path, char* buf, const int buf_len)
+        {
+            FILE* fp = fopen(path, "r");
+            if (fp == NULL) {
+                return false;
+            }
+            const bool res = (fgets(buf, buf_len, fp) != NULL);
+            fclose(fp);
+            return res;
+        }
+
+
+        static bool _read_sys_int(const char* path, int* res)
+        {
+            char buf[64];
+            if (!decx::utils::_read_sys_string(path, buf, 64)) {
+                return false;
+            }
+            return sscanf(buf, "%d", res) == 1;
+        }
+
+
+        // "32K" -> 32768, "8M" -> 8388608
+        static size_t _parse_sys_size(const char* str)
+        {
+            size_t val = 0;
+            char unit = 0;
+            if (sscanf(str, "%zu%c", &val, &unit) < 1) {
+                return 0;
+            }
+            if (unit == 'K' || unit == 'k') { val <<= 10; }
+            else if (unit == 'M' || unit == 'm') { val <<= 20; }
+            else if (unit == 'G' || unit == 'g') { val <<= 30; }
+            return val;
+        }
+
+
+        // "0-3,8,10-11" -> {0, 1, 2, 3, 8, 10, 11}
+        static void _parse_cpu_list(const char* str, std::vector<int>* res)
+        {
+            const char* p = str;
+            while (*p != 0 && *p != '\n') {
+                int a = 0, b = 0, n = 0;
+                if (sscanf(p, "%d-%d%n", &a, &b, &n) == 2) {}
+                else if (sscanf(p, "%d%n", &a, &n) == 1) { b = a; }
+                else { break; }
+
+                for (int i = a; i <= b; ++i) {
+                    res->push_back(i);
+                }
+                p += n;
+                if (*p == ',') {
+                    ++p;
+                }
+            }
+        }
+    }
+}
+#endif
+
+
+
+decx::CPU_Topology::CPU_Topology()
+{
+    this->socket_num = this->physical_core_num = this->numa_node_num = 0;
+    this->L1d_size = this->L2_size = this->L3_size = this->cache_line_size = 0;
+
+    this->_query_OS();
+    if (this->_cpus.empty()) {
+        this->_fallback();
+    }
+    this->_arrange();
+
+    if (this->L1d_size == 0)        { this->L1d_size = 32 * 1024; }
+    if (this->L2_size == 0)         { this->L2_size = 256 * 1024; }
+    if (this->L3_size == 0)         { this->L3_size = 8 * 1024 * 1024; }
+    if (this->cache_line_size == 0) { this->cache_line_size = 64; }
+}
+
+
+
+void decx::CPU_Topology::_fallback()
+{
+    const int _num = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+    for (int i = 0; i < _num; ++i) {
+        decx::logical_cpu _cpu = { i, 0, i, 0, 0 };
+        this->_cpus.push_back(_cpu);
+    }
+}
+
+
+
+#ifdef Windows
+void decx::CPU_Topology::_query_OS()
+{
+    DWORD _len = 0;
+    GetLogicalProcessorInformationEx(RelationAll, NULL, &_len);
+    if (_len == 0) {
+        return;
+    }
+    std::vector<char> _buf(_len);
+    if (!GetLogicalProcessorInformationEx(RelationAll, (PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX)_buf.data(), &_len)) {
+        return;
+    }
+
+    // the logical processors are identified by (group << 6) | bit
+    std::vector<decx::logical_cpu> _found;
+    int _core = 0, _socket = 0;
+
+    // first pass : the cores, which enumerate all the logical processors
+    for (DWORD ofs = 0; ofs < _len;) {
+        PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX _info = (PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX)(_buf.data() + ofs);
+        if (_info->Relationship == RelationProcessorCore) {
+            for (WORD g = 0; g < _info->Processor.GroupCount; ++g) {
+                const GROUP_AFFINITY& _ga = _info->Processor.GroupMask[g];
+                for (int bit = 0; bit < 64; ++bit) {
+                    if (_ga.Mask & ((KAFFINITY)1 << bit)) {
+                        decx::logical_cpu _cpu = { ((int)_ga.Group << 6) | bit, 0, _core, 0, 0 };
+                        _found.push_back(_cpu);
+                    }
+                }
+            }
+            ++_core;
+        }
+        ofs += _info->Size;
+    }
+
+    // second pass : the packages, the NUMA nodes and the caches
+    for (DWORD ofs = 0; ofs < _len;) {
+        PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX _info = (PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX)(_buf.data() + ofs);
+
+        if (_info->Relationship == RelationProcessorPackage) {
+            for (WORD g = 0; g < _info->Processor.GroupCount; ++g) {
+                const GROUP_AFFINITY& _ga = _info->Processor.GroupMask[g];
+                for (int i = 0; i < _found.size(); ++i) {
+                    if ((_found[i].os_id >> 6) == _ga.Group && (_ga.Mask & ((KAFFINITY)1 << (_found[i].os_id & 63)))) {
+                        _found[i].socket_id = _socket;
+                    }
+                }
+            }
+            ++_socket;
+        }
+        else if (_info->Relationship == RelationNumaNode) {
+            const GROUP_AFFINITY& _ga = _info->NumaNode.GroupMask;
+            for (int i = 0; i < _found.size(); ++i) {
+                if ((_found[i].os_id >> 6) == _ga.Group && (_ga.Mask & ((KAFFINITY)1 << (_found[i].os_id & 63)))) {
+                    _found[i].node_id = (int)_info->NumaNode.NodeNumber;
+                }
+            }
+        }
+        else if (_info->Relationship == RelationCache) {
+            const CACHE_RELATIONSHIP& _cache = _info->Cache;
+            if (_cache.Type == CacheData || _cache.Type == CacheUnified) {
+                if (_cache.Level == 1 && this->L1d_size == 0) { this->L1d_size = _cache.CacheSize; }
+                if (_cache.Level == 2 && this->L2_size == 0) { this->L2_size = _cache.CacheSize; }
+                if (_cache.Level == 3 && this->L3_size == 0) { this->L3_size = _cache.CacheSize; }
+                if (this->cache_line_size == 0) { this->cache_line_size = _cache.LineSize; }
+            }
+        }
+        ofs += _info->Size;
+    }
+
+    this->_cpus = _found;
+}
+
+#else
+
+void decx::CPU_Topology::_query_OS()
+{
+    char _buf[4096], _path[256];
+
+    std::vector<int> _online;
+    if (!decx::utils::_read_sys_string("/sys/devices/system/cpu/online", _buf, 4096)) {
+        return;
+    }
+    decx::utils::_parse_cpu_list(_buf, &_online);
+
+    // the processors outside the affinity mask of the process (taskset, cgroups) are not usable
+    cpu_set_t _allowed;
+    CPU_ZERO(&_allowed);
+    const bool _has_mask = (sched_getaffinity(0, sizeof(cpu_set_t), &_allowed) == 0);
+
+    for (int i = 0; i < _online.size(); ++i) {
+        if (_has_mask && _online[i] < CPU_SETSIZE && !CPU_ISSET(_online[i], &_allowed)) {
+            continue;
+        }
+        decx::logical_cpu _cpu = { _online[i], 0, 0, 0, 0 };
+        int _package = 0, _core = _online[i];
+
+        sprintf(_path, "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", _online[i]);
+        decx::utils::_read_sys_int(_path, &_package);
+        sprintf(_path, "/sys/devices/system/cpu/cpu%d/topology/core_id", _online[i]);
+        decx::utils::_read_sys_int(_path, &_core);
+
+        // the core ids restart in each package, make them unique for now, compacted in _arrange()
+        _cpu.socket_id = _package;
+        _cpu.core_id = (_package << 16) | _core;
+        this->_cpus.push_back(_cpu);
+    }
+
+    // NUMA nodes, the directory does not exist when the kernel is built without NUMA
+    for (int node = 0; node < 1024; ++node) {
+        std::vector<int> _node_cpus;
+        sprintf(_path, "/sys/devices/system/node/node%d/cpulist", node);
+        if (!decx::utils::_read_sys_string(_path, _buf, 4096)) {
+            continue;
+        }
+        decx::utils::_parse_cpu_list(_buf, &_node_cpus);
+        for (int i = 0; i < this->_cpus.size(); ++i) {
+            if (std::find(_node_cpus.begin(), _node_cpus.end(), this->_cpus[i].os_id) != _node_cpus.end()) {
+                this->_cpus[i].node_id = node;
+            }
+        }
+    }
+
+    // caches of the first online processor
+    if (!this->_cpus.empty()) {
+        for (int index = 0; index < 8; ++index) {
+            int _level = 0;
+            sprintf(_path, "/sys/devices/system/cpu/cpu%d/cache/index%d/level", this->_cpus[0].os_id, index);
+            if (!decx::utils::_read_sys_int(_path, &_level)) {
+                break;
+            }
+            sprintf(_path, "/sys/devices/system/cpu/cpu%d/cache/index%d/type", this->_cpus[0].os_id, index);
+            if (!decx::utils::_read_sys_string(_path, _buf, 4096) || strncmp(_buf, "Instruction", 11) == 0) {
+                continue;
+            }
+            sprintf(_path, "/sys/devices/system/cpu/cpu%d/cache/index%d/size", this->_cpus[0].os_id, index);
+            if (!decx::utils::_read_sys_string(_path, _buf, 4096)) {
+                continue;
+            }
+            const size_t _size = decx::utils::_parse_sys_size(_buf);
+
+            if (_level == 1) { this->L1d_size = _size; }
+            if (_level == 2) { this->L2_size = _size; }
+            if (_level == 3) { this->L3_size = _size; }
+
+            int _line = 0;
+            sprintf(_path, "/sys/devices/system/cpu/cpu%d/cache/index%d/coherency_line_size", this->_cpus[0].os_id, index);
+            if (this->cache_line_size == 0 && decx::utils::_read_sys_int(_path, &_line)) {
+                this->cache_line_size = _line;
+            }
+        }
+    }
+}
+#endif
+
+
+
+void decx::CPU_Topology::_arrange()
+{
+    // compact the ids of sockets, cores and nodes to 0, 1, ...
+    std::vector<int> _sockets, _cores, _nodes;
+    for (int i = 0; i < this->_cpus.size(); ++i) {
+        _sockets.push_back(this->_cpus[i].socket_id);
+        _cores.push_back(this->_cpus[i].core_id);
+        _nodes.push_back(this->_cpus[i].node_id);
+    }
+    std::sort(_sockets.begin(), _sockets.end());
+    _sockets.erase(std::unique(_sockets.begin(), _sockets.end()), _sockets.end());
+    std::sort(_cores.begin(), _cores.end());
+    _cores.erase(std::unique(_cores.begin(), _cores.end()), _cores.end());
+    std::sort(_nodes.begin(), _nodes.end());
+    _nodes.erase(std::unique(_nodes.begin(), _nodes.end()), _nodes.end());
+
+    for (int i = 0; i < this->_cpus.size(); ++i) {
+        decx::logical_cpu* _cpu = &this->_cpus[i];
+        _cpu->socket_id = std::lower_bound(_sockets.begin(), _sockets.end(), _cpu->socket_id) - _sockets.begin();
+        _cpu->core_id = std::lower_bound(_cores.begin(), _cores.end(), _cpu->core_id) - _cores.begin();
+        _cpu->node_id = std::lower_bound(_nodes.begin(), _nodes.end(), _cpu->node_id) - _nodes.begin();
+    }
+    this->socket_num = _sockets.size();
+    this->physical_core_num = _cores.size();
+    this->numa_node_num = _nodes.size();
+
+    // SMT siblings, in the order of the OS ids
+    std::vector<int> _core_count(this->physical_core_num, 0);
+    for (int i = 0; i < this->_cpus.size(); ++i) {
+        this->_cpus[i].smt_id = _core_count[this->_cpus[i].core_id]++;
+    }
+
+    // the placement, by SMT level, then round-robin over the nodes
+    const int _max_smt = *std::max_element(_core_count.begin(), _core_count.end());
+    this->_placement.clear();
+    for (int smt = 0; smt < _max_smt; ++smt) {
+        std::vector<std::vector<int>> _per_node(this->numa_node_num);
+        for (int i = 0; i < this->_cpus.size(); ++i) {
+            if (this->_cpus[i].smt_id == smt) {
+                _per_node[this->_cpus[i].node_id].push_back(i);
+            }
+        }
+        bool _left = true;
+        for (int k = 0; _left; ++k) {
+            _left = false;
+            for (int node = 0; node < this->numa_node_num; ++node) {
+                if (k < _per_node[node].size()) {
+                    this->_placement.push_back(_per_node[node][k]);
+                    _left = true;
+                }
+            }
+        }
+    }
+}
+
+
+
+int decx::CPU_Topology::node_of_worker(const size_t worker_id) const
+{
+    if (worker_id < this->_placement.size()) {
+        return this->_cpus[this->_placement[worker_id]].node_id;
+    }
+    // the workers beyond the logical processors are spread over the nodes
+    return (int)(worker_id % this->numa_node_num);
+}
+
+
+
+bool decx::CPU_Topology::bind_current_thread(const size_t worker_id) const
+{
+    if (worker_id >= this->_placement.size()) {
+        return false;
+    }
+    const int os_id = this->_cpus[this->_placement[worker_id]].os_id;
+
+#ifdef Windows
+    GROUP_AFFINITY _ga;
+    memset(&_ga, 0, sizeof(GROUP_AFFINITY));
+    _ga.Group = (WORD)(os_id >> 6);
+    _ga.Mask = (KAFFINITY)1 << (os_id & 63);
+    return SetThreadGroupAffinity(GetCurrentThread(), &_ga, NULL) != 0;
+#else
+    cpu_set_t _set;
+    CPU_ZERO(&_set);
+    CPU_SET(os_id, &_set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &_set) == 0;
+#endif
+}
+
+
+
+const decx::CPU_Topology& decx::utils::get_cpu_topology()
+{
+    static decx::CPU_Topology _topology;
+    return _topology;
+}
+
+
+#endif
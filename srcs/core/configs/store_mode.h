@@ -0,0 +1,88 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+
+#ifndef _STORE_MODE_H_
+#define _STORE_MODE_H_
+
+#include "../basic.h"
+
+
+/**
+* The stores of the outputs of the streaming operators on the CPU (the element-wise ones and the conversions
+* of the pixels). The stores through the caches read every line of dst before writing it (read for ownership)
+* and evict the lines of the inputs, which costs about a third of the bandwidth when dst is far larger than L3.
+* The non-temporal (streaming) stores write the lines to the memory directly, and are fenced (sfence) at
+* the end of each chunk, before the thread pool reports it done. The caches are bypassed automatically when
+* dst exceeds _STREAMING_STORE_L3_SHARE_ of L3, the outputs smaller than that are likely read again while
+* cached.
+*/
+
+
+// dst is streamed from L3_size / _STREAMING_STORE_L3_SHARE_ bytes, the inputs take the rest of L3
+#define _STREAMING_STORE_L3_SHARE_ 2
+
+
+namespace de
+{
+    namespace cpu
+    {
+        enum StoreMode
+        {
+            Store_Auto = 0x00,          // streamed if dst is larger than half of L3, cached otherwise
+            Store_Cached = 0x01,        // always through the caches
+            Store_Streaming = 0x02,     // always non-temporal
+        };
+    }
+}
+
+
+namespace decx
+{
+    /**
+    * @brief Whether the stores of dst of dst_bytes are to be non-temporal, mode is one of de::cpu::StoreMode
+    */
+    static bool _use_streaming_store(const int mode, const size_t dst_bytes);
+
+
+    /**
+    * @return false and MeaninglessFlag in handle if mode is not one of de::cpu::StoreMode
+    */
+    static bool _check_store_mode(const int mode, de::DH* handle);
+}
+
+
+
+static bool decx::_use_streaming_store(const int mode, const size_t dst_bytes)
+{
+    switch (mode)
+    {
+    case de::cpu::StoreMode::Store_Cached:
+        return false;
+    case de::cpu::StoreMode::Store_Streaming:
+        return true;
+    default:
+        return dst_bytes > decx::cpI.L3_size / _STREAMING_STORE_L3_SHARE_;
+    }
+}
+
+
+
+static bool decx::_check_store_mode(const int mode, de::DH* handle)
+{
+    if (mode < de::cpu::StoreMode::Store_Auto || mode > de::cpu::StoreMode::Store_Streaming) {
+        decx::MeaninglessFlag(handle);
+        Print_Error_Message(4, MEANINGLESS_FLAG);
+        return false;
+    }
+    return true;
+}
+
+
+#endif
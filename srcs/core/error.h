@@ -65,6 +65,11 @@ if (__handle _operator error_type != decx::DECX_SUCCESS) {    \
 #define ALLOC_FAIL                                "Fail to allocate memory\n"
 #define DIM_NOT_EQUAL                            "Dim(s) is(are) not equal to each other\n"
 #define MEANINGLESS_FLAG                        "This flag is meaningless in current context\n"
+#define ISA_NOT_SUPPORTED                       "The instruction set is not supported by this CPU\n"
+#define FILE_NOT_EXIST                          "Fail to open the file\n"
+#define PACKED_LAYOUT_ERROR                     "The packed matrix is broken or does not match the kernels in use\n"
+#define OPERAND_ALIASING                        "The output is required to be an object other than the inputs\n"
+#define FILE_IO_ERROR                           "Fail to read or write the file\n"
 
 
 
@@ -156,5 +161,41 @@ namespace decx
             handle->error_string = (char*)ALLOC_FAIL;
             handle->error_type = decx::DECX_FAIL_ALLOCATION;
         }
+
+
+        static void ISA_NotSupported(de::DH* handle)    noexcept
+        {
+            handle->error_string = (char*)ISA_NOT_SUPPORTED;
+            handle->error_type = decx::DECX_FAIL_ISA_NotSupported;
+        }
+
+
+
+        static void FileNotExist(de::DH* handle)    noexcept
+        {
+            handle->error_string = (char*)FILE_NOT_EXIST;
+            handle->error_type = decx::DECX_FAIL_FileNotExist;
+        }
+
+
+        static void PackedLayoutError(de::DH* handle)    noexcept
+        {
+            handle->error_string = (char*)PACKED_LAYOUT_ERROR;
+            handle->error_type = decx::DECX_FAIL_PackedLayout;
+        }
+
+
+        static void OperandAliasing(de::DH* handle)    noexcept
+        {
+            handle->error_string = (char*)OPERAND_ALIASING;
+            handle->error_type = decx::DECX_FAIL_OperandAliasing;
+        }
+
+
+        static void FileIOError(de::DH* handle)    noexcept
+        {
+            handle->error_string = (char*)FILE_IO_ERROR;
+            handle->error_type = decx::DECX_FAIL_FileIO;
+        }
     }
 }
\ No newline at end of file
@@ -54,6 +54,10 @@ struct decx::MemBlock
     decx::MemBlock* _prev;
     decx::MemBlock* _next;
 
+    // links of the free list which the (idle) block is in, used by decx::MemPool_Hv only
+    decx::MemBlock* _free_prev;
+    decx::MemBlock* _free_next;
+
     /**
      * @brief Construct a new Mem Block object by indicating each param
      *
@@ -87,6 +91,9 @@ decx::MemBlock::MemBlock(size_t size, bool idle, decx::MemLoc* mem_loc, uchar* p
     this->_loc.z = mem_loc->z;
 
     this->_ref_times = 0;
+
+    this->_free_prev = NULL;
+    this->_free_next = NULL;
 }
 
 
@@ -101,6 +108,9 @@ void decx::MemBlock::CopyTo(decx::MemBlock* dst)
     dst->_prev = this->_prev;
     dst->_next = this->_next;
 
+    dst->_free_prev = this->_free_prev;
+    dst->_free_next = this->_free_next;
+
     dst->_ref_times = this->_ref_times;
     dst->_idle = this->_idle;
 
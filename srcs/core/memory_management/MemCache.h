@@ -0,0 +1,297 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*   Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+#ifndef _MEM_CACHE_H_
+#define _MEM_CACHE_H_
+
+#include "MemBlock.h"
+#include "internal_types.h"
+#include "MemPool_status.h"
+#include <atomic>
+
+
+// the most bytes each thread keeps in the cache of one memory pool
+#define _MEM_CACHE_BUDGET_ (32 << 20)
+
+// the blocks larger than this are never cached
+#define _MEM_CACHE_MAX_BLOCK_ (8 << 20)
+
+// the size classes of the cache, 2^_MEM_CACHE_SL_LOG2_ classes in each power of 2,
+// from Min_Alloc_Bytes to _MEM_CACHE_MAX_BLOCK_
+#define _MEM_CACHE_SL_LOG2_ 3
+#define _MEM_CACHE_SL_NUM_ (1 << _MEM_CACHE_SL_LOG2_)
+#define _MEM_CACHE_FL_MIN_ 10
+#define _MEM_CACHE_FL_MAX_ 23
+#define _MEM_CACHE_CLASS_NUM_ ((_MEM_CACHE_FL_MAX_ - _MEM_CACHE_FL_MIN_ + 1) << _MEM_CACHE_SL_LOG2_)
+
+// the most blocks a magazine holds, the magazines of the large classes hold fewer
+#define _MEM_CACHE_MAG_CAPACITY_ 32
+
+// the hits and the deallocations counted by a cache are added to the pool every so many operations
+#define _MEM_CACHE_STAT_FLUSH_ 256
+
+
+/**
+* Per-thread cache in front of a memory pool (_PoolType is decx::MemPool_Hv or decx::MemPool_Hf).
+* The blocks freed by a thread are kept in one magazine (a LIFO list linked by
+* decx::MemBlock::_free_next) per size class, and the next allocation of that class on the same
+* thread takes one without locking the pool. To the pool, the cached blocks are still occupied.
+*   - A magazine holds at most _MEM_CACHE_BUDGET_ / (4 * class size) blocks (1 to
+*     _MEM_CACHE_MAG_CAPACITY_). When it is full, half of it is given back to the pool under one lock.
+*   - When the cached bytes exceed _MEM_CACHE_BUDGET_, the whole cache is given back.
+*   - When the pool is under pressure (an allocation from the OS failed, or the pool is being
+*     released) it raises its epoch, and each cache drains itself at its next use. The caches
+*     are also drained when their threads exit.
+* The hits and the deallocations served by a cache are counted locally, and added to the
+* decx::MemPoolStatus of the pool in batches.
+*/
+template <class _PoolType>
+class decx::MemCache
+{
+private:
+    struct _magazine
+    {
+        decx::MemBlock* _head;
+        int _num, _capacity;
+    };
+
+    _magazine _mags[_MEM_CACHE_CLASS_NUM_];
+    size_t _cached_bytes;
+
+    // the pool this cache is in front of, set at the first push
+    _PoolType* _pool;
+    uint64_t _epoch;
+
+    uint _hit_num, _dealloc_num;
+
+    /**
+    * @param round_up true to map the size to the smallest class whose blocks are all at least
+    * the size, false to map it to the class it is in
+    * @return -1 if the size is out of the range of the cache
+    */
+    static int _class_of(size_t size, const bool round_up);
+
+
+    // give (at most) _num blocks of the magazine back to the pool under one lock
+    void _give_back(_magazine* mag, const int _num);
+
+
+    void _check_epoch(_PoolType* pool);
+
+public:
+    MemCache();
+
+    /**
+    * @brief Take a cached block which is at least the size (already rounded by the pool)
+    * @return NULL if missed
+    */
+    decx::MemBlock* pop(_PoolType* pool, const size_t size);
+
+    /**
+    * @brief Keep the block (whose last reference is just released) in the cache
+    * @return false if the block is not cacheable, then the caller should deallocate it in the pool
+    */
+    bool push(_PoolType* pool, decx::MemBlock* _block);
+
+    /**
+    * @brief Give all the cached blocks back to the pool
+    */
+    void drain();
+
+    /**
+    * @brief Add the hits and the deallocations counted so far to the pool
+    */
+    void flush_stats();
+
+
+    ~MemCache();
+};
+
+
+
+template <class _PoolType>
+decx::MemCache<_PoolType>::MemCache()
+{
+    for (int i = 0; i < _MEM_CACHE_CLASS_NUM_; ++i) {
+        const size_t _class_size = ((size_t)(_MEM_CACHE_SL_NUM_ + (i & (_MEM_CACHE_SL_NUM_ - 1))))
+            << ((i >> _MEM_CACHE_SL_LOG2_) + _MEM_CACHE_FL_MIN_ - _MEM_CACHE_SL_LOG2_);
+
+        this->_mags[i]._head = NULL;
+        this->_mags[i]._num = 0;
+        this->_mags[i]._capacity = (int)decx::utils::clamp_max<size_t>(
+            decx::utils::clamp_min<size_t>(_MEM_CACHE_BUDGET_ / (4 * _class_size), 1), _MEM_CACHE_MAG_CAPACITY_);
+    }
+    this->_cached_bytes = 0;
+    this->_pool = NULL;
+    this->_epoch = 0;
+    this->_hit_num = 0;
+    this->_dealloc_num = 0;
+}
+
+
+
+template <class _PoolType>
+int decx::MemCache<_PoolType>::_class_of(size_t size, const bool round_up)
+{
+    if (size < Min_Alloc_Bytes || size > _MEM_CACHE_MAX_BLOCK_) {
+        return -1;
+    }
+    int fl = decx::utils::_highest_bit64(size);
+    if (round_up) {
+        size += ((size_t)1 << (fl - _MEM_CACHE_SL_LOG2_)) - 1;
+        fl = decx::utils::_highest_bit64(size);
+    }
+    const int sl = (int)(size >> (fl - _MEM_CACHE_SL_LOG2_)) ^ _MEM_CACHE_SL_NUM_;
+
+    if (fl > _MEM_CACHE_FL_MAX_) {
+        return -1;
+    }
+    return ((fl - _MEM_CACHE_FL_MIN_) << _MEM_CACHE_SL_LOG2_) + sl;
+}
+
+
+
+template <class _PoolType>
+void decx::MemCache<_PoolType>::_give_back(_magazine* mag, const int _num)
+{
+    if (mag->_head == NULL) {
+        return;
+    }
+    std::lock_guard<std::mutex> lck(this->_pool->_mtx);
+    for (int i = 0; i < _num && mag->_head != NULL; ++i) {
+        decx::MemBlock* _block = mag->_head;
+        mag->_head = _block->_free_next;
+        _block->_free_next = NULL;
+        --mag->_num;
+        this->_cached_bytes -= _block->block_size;
+
+        this->_pool->_deallocate(_block);
+    }
+}
+
+
+
+template <class _PoolType>
+void decx::MemCache<_PoolType>::_check_epoch(_PoolType* pool)
+{
+    const uint64_t _pool_epoch = pool->_pressure_epoch.load(std::memory_order_relaxed);
+    if (this->_epoch != _pool_epoch) {
+        this->drain();
+        this->_epoch = _pool_epoch;
+    }
+}
+
+
+
+template <class _PoolType>
+void decx::MemCache<_PoolType>::flush_stats()
+{
+    if (this->_pool == NULL) {
+        return;
+    }
+    this->_pool->_status.cache_hit_num.fetch_add(this->_hit_num, std::memory_order_relaxed);
+    this->_pool->_status.cache_dealloc_num.fetch_add(this->_dealloc_num, std::memory_order_relaxed);
+    this->_hit_num = 0;
+    this->_dealloc_num = 0;
+}
+
+
+
+template <class _PoolType>
+decx::MemBlock* decx::MemCache<_PoolType>::pop(_PoolType* pool, const size_t size)
+{
+    this->_check_epoch(pool);
+
+    const int _class = decx::MemCache<_PoolType>::_class_of(size, true);
+    if (_class < 0) {
+        return NULL;
+    }
+    _magazine* mag = &this->_mags[_class];
+    decx::MemBlock* _block = mag->_head;
+    if (_block != NULL) {
+        mag->_head = _block->_free_next;
+        _block->_free_next = NULL;
+        --mag->_num;
+        this->_cached_bytes -= _block->block_size;
+
+        if (++this->_hit_num == _MEM_CACHE_STAT_FLUSH_) {
+            this->flush_stats();
+        }
+    }
+    return _block;
+}
+
+
+
+template <class _PoolType>
+bool decx::MemCache<_PoolType>::push(_PoolType* pool, decx::MemBlock* _block)
+{
+    const int _class = decx::MemCache<_PoolType>::_class_of(_block->block_size, false);
+    if (_class < 0) {
+        return false;
+    }
+    if (this->_pool == NULL) {
+        this->_pool = pool;
+        this->_epoch = pool->_pressure_epoch.load(std::memory_order_relaxed);
+    }
+    this->_check_epoch(pool);
+
+    _magazine* mag = &this->_mags[_class];
+    if (mag->_num == mag->_capacity) {
+        this->_give_back(mag, (mag->_capacity + 1) / 2);
+    }
+    _block->_ref_times = 0;
+    _block->_free_next = mag->_head;
+    mag->_head = _block;
+    ++mag->_num;
+    this->_cached_bytes += _block->block_size;
+
+    if (++this->_dealloc_num == _MEM_CACHE_STAT_FLUSH_) {
+        this->flush_stats();
+    }
+
+    if (this->_cached_bytes > _MEM_CACHE_BUDGET_) {
+        this->drain();
+    }
+    return true;
+}
+
+
+
+template <class _PoolType>
+void decx::MemCache<_PoolType>::drain()
+{
+    this->flush_stats();
+    if (this->_cached_bytes == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lck(this->_pool->_mtx);
+    for (int i = 0; i < _MEM_CACHE_CLASS_NUM_; ++i) {
+        _magazine* mag = &this->_mags[i];
+        while (mag->_head != NULL) {
+            decx::MemBlock* _block = mag->_head;
+            mag->_head = _block->_free_next;
+            _block->_free_next = NULL;
+            this->_pool->_deallocate(_block);
+        }
+        mag->_num = 0;
+    }
+    this->_cached_bytes = 0;
+}
+
+
+
+template <class _PoolType>
+decx::MemCache<_PoolType>::~MemCache()
+{
+    this->drain();
+}
+
+
+#endif
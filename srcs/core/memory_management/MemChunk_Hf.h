@@ -11,6 +11,7 @@
 
 #include"MemBlock.h"
 #include "internal_types.h"
+#include <chrono>
 
 
 class decx::MemChunk_Hf
@@ -21,6 +22,9 @@ public:
     std::vector<decx::MemBlock*> mem_block_list;
     int list_length;
 
+    // when the chunk became fully idle, valid only while this->is_idle()
+    std::chrono::steady_clock::time_point _idle_since;
+
     /**
      * @brief Construct a new Mem Chunk object formally, it will not allocate the memory
      * physically, but it will turn the size into zero, and insert an ilde decx::MemBlock.(All params initialized)
@@ -83,6 +87,16 @@ public:
      * @param dex The index of the searching block
      */
     void check_to_merge(int dex);
+
+
+    bool is_idle() const {
+        return this->header_ptr != NULL && this->mem_block_list.size() == 1 && this->mem_block_list[0]->_idle;
+    }
+
+    /**
+     * @brief Turn the chunk back into the formal (empty) one, after its memory is freed by the pool
+     */
+    void reset();
 };
 
 
@@ -97,6 +111,7 @@ decx::MemChunk_Hf::MemChunk_Hf(int pool_dex, int chunk_set_dex)
     this->mem_block_list.emplace_back(new_node);
 
     this->list_length = this->mem_block_list.size();
+    this->_idle_since = std::chrono::steady_clock::now();
 }
 
 
@@ -123,6 +138,7 @@ decx::MemChunk_Hf::MemChunk_Hf(size_t size, size_t req_size, int pool_dex, int c
         this->mem_block_list.emplace_back(new_node_1);
     }
     this->list_length = this->mem_block_list.size();
+    this->_idle_since = std::chrono::steady_clock::now();
 }
 
 
@@ -145,6 +161,7 @@ decx::MemBlock* decx::MemChunk_Hf::split(int dex, size_t req_size)
     if (block_split->_next != NULL)
     {                                    // not the last block
         block_insert->_next = block_split->_next;
+        block_split->_next->_prev = block_insert;
         for (int i = dex + 1; i < this->list_length; ++i) {
             this->mem_block_list[i]->_loc.z++;
         }
@@ -155,6 +172,7 @@ decx::MemBlock* decx::MemChunk_Hf::split(int dex, size_t req_size)
     }
 
     block_split->_next = block_insert;
+    this->list_length = this->mem_block_list.size();
     return block_insert;
 }
 
@@ -184,6 +202,7 @@ decx::MemBlock* decx::MemChunk_Hf::forward_merge2(int dex)
         delete current_bl;
     }
 
+    this->list_length = this->mem_block_list.size();
     return prev_bl;
 }
 
@@ -223,6 +242,7 @@ decx::MemBlock* decx::MemChunk_Hf::merge3(int dex)
         delete this_bl;
         delete next_bl;
     }
+    this->list_length = this->mem_block_list.size();
     return prev_bl;
 }
 
@@ -260,6 +280,25 @@ void decx::MemChunk_Hf::check_to_merge(int dex)
 }
 
 
+void decx::MemChunk_Hf::reset()
+{
+    const decx::MemBlock* _first = this->mem_block_list[0];
+    int3 _loc;
+    _loc.x = _first->_loc.x;        _loc.y = _first->_loc.y;        _loc.z = 0;
+
+    for (int i = 0; i < this->mem_block_list.size(); ++i) {
+        delete this->mem_block_list[i];
+    }
+    this->mem_block_list.clear();
+
+    this->chunk_size = 0;
+    this->header_ptr = NULL;
+    this->mem_block_list.emplace_back(new decx::MemBlock(0, true, &_loc, NULL, NULL, NULL));
+    this->list_length = this->mem_block_list.size();
+}
+
+
+
 class decx::MemChunkSet_Hf
 {
 public:
@@ -0,0 +1,229 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*   Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+#ifndef _MEMPOOL_STATUS_H_
+#define _MEMPOOL_STATUS_H_
+
+#include "../basic.h"
+#include "MemBlock.h"
+#include <atomic>
+#include <chrono>
+
+
+// number of the size classes reported by de::GetMemoryStats(), class i holds the blocks in
+// [2^(i + dex_to_pow_bias), 2^(i + dex_to_pow_bias + 1)), the smaller blocks are counted in class 0
+#define _MEM_STATS_CLASS_NUM_ 32
+
+// the least interval (in milliseconds) between two scans for the idle chunks
+#define _MEM_TRIM_SCAN_INTERVAL_MIN_ 10
+
+
+namespace de
+{
+    enum DECX_MEM_POOL
+    {
+        Pool_Host_Virtual = 0,          // decx::mem_pool_Hv, pageable host memory
+        Pool_Host_Fixed = 1,            // decx::mem_pool_Hf, page-locked host memory
+        Pool_Device = 2,                // decx::mem_pool_D, device memory
+        Pool_Host_Huge = 3              // decx::mem_pool_Hh, host memory backed by huge pages
+    };
+
+
+    struct MemPoolStats
+    {
+        size_t reserved_bytes;          // requested from the OS (or the device) and not returned yet
+        size_t peak_reserved_bytes;
+        size_t in_use_bytes;            // occupied, including the blocks kept in the thread caches
+        size_t idle_bytes;
+        size_t largest_idle_block;
+        size_t chunk_num;
+
+        // 1 - largest_idle_block / idle_bytes, 0 when all the idle bytes are in one block
+        float fragmentation;
+
+        size_t in_use_bytes_per_class[_MEM_STATS_CLASS_NUM_];
+        size_t idle_bytes_per_class[_MEM_STATS_CLASS_NUM_];
+
+        uint64_t alloc_num;
+        uint64_t dealloc_num;
+        uint64_t cache_hit_num;         // allocations served by the thread caches without locking
+        uint64_t os_alloc_num;          // chunks requested from the OS
+        uint64_t os_free_num;           // chunks returned to the OS
+
+        // cache_hit_num / alloc_num
+        float hit_rate;
+    };
+
+
+    struct MemoryStats
+    {
+        de::MemPoolStats Host_Virtual;
+        de::MemPoolStats Host_Fixed;
+        de::MemPoolStats Device;
+        de::MemPoolStats Host_Huge;
+    };
+}
+
+
+
+namespace decx
+{
+    struct MemPoolStatus;
+}
+
+
+/**
+* The counters and the trimming policy of a memory pool. The plain fields are modified with the
+* lock of the pool held, the atomic ones are added by the thread caches.
+*/
+struct decx::MemPoolStatus
+{
+    size_t reserved_bytes, peak_reserved_bytes;
+    uint64_t alloc_num, dealloc_num, os_alloc_num, os_free_num;
+
+    std::atomic<uint64_t> cache_hit_num, cache_dealloc_num;
+
+    // the most bytes kept reserved, the fully idle chunks beyond it are returned at once
+    size_t reserved_limit;
+
+    // the chunks fully idle longer than this are returned, 0 to disable
+    uint idle_trim_ms;
+    std::chrono::steady_clock::time_point last_scan;
+
+
+    MemPoolStatus();
+
+
+    void on_os_alloc(const size_t size);
+
+
+    void on_os_free(const size_t size);
+
+    /**
+    * @brief Whether it is time to scan for the chunks idle longer than idle_trim_ms. Returns false
+    * if the policy is disabled, otherwise scans at most once every max(idle_trim_ms / 4,
+    * _MEM_TRIM_SCAN_INTERVAL_MIN_) milliseconds.
+    */
+    bool should_scan();
+
+    /**
+    * @brief Copy the counters to the statistics, the other fields of _stats are left untouched
+    */
+    void report(de::MemPoolStats* _stats) const;
+
+    /**
+    * @brief Count the block in the per-class statistics
+    */
+    static void count_block(de::MemPoolStats* _stats, const decx::MemBlock* _block);
+
+    /**
+    * @brief Compute the derived fields (fragmentation, hit rate) of the statistics
+    */
+    static void finalize(de::MemPoolStats* _stats);
+};
+
+
+
+decx::MemPoolStatus::MemPoolStatus()
+{
+    this->reserved_bytes = 0;
+    this->peak_reserved_bytes = 0;
+    this->alloc_num = 0;
+    this->dealloc_num = 0;
+    this->os_alloc_num = 0;
+    this->os_free_num = 0;
+    this->cache_hit_num.store(0, std::memory_order_relaxed);
+    this->cache_dealloc_num.store(0, std::memory_order_relaxed);
+
+    this->reserved_limit = (size_t)-1;
+    this->idle_trim_ms = 0;
+    this->last_scan = std::chrono::steady_clock::now();
+}
+
+
+
+void decx::MemPoolStatus::on_os_alloc(const size_t size)
+{
+    this->reserved_bytes += size;
+    this->peak_reserved_bytes = decx::utils::clamp_min<size_t>(this->peak_reserved_bytes, this->reserved_bytes);
+    ++this->os_alloc_num;
+}
+
+
+
+void decx::MemPoolStatus::on_os_free(const size_t size)
+{
+    this->reserved_bytes -= size;
+    ++this->os_free_num;
+}
+
+
+
+bool decx::MemPoolStatus::should_scan()
+{
+    if (this->idle_trim_ms == 0) {
+        return false;
+    }
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    const uint _interval = decx::utils::clamp_min<uint>(this->idle_trim_ms / 4, _MEM_TRIM_SCAN_INTERVAL_MIN_);
+    if (now - this->last_scan < std::chrono::milliseconds(_interval)) {
+        return false;
+    }
+    this->last_scan = now;
+    return true;
+}
+
+
+
+void decx::MemPoolStatus::report(de::MemPoolStats* _stats) const
+{
+    const uint64_t _hits = this->cache_hit_num.load(std::memory_order_relaxed);
+
+    _stats->reserved_bytes = this->reserved_bytes;
+    _stats->peak_reserved_bytes = this->peak_reserved_bytes;
+    _stats->alloc_num = this->alloc_num + _hits;
+    _stats->dealloc_num = this->dealloc_num + this->cache_dealloc_num.load(std::memory_order_relaxed);
+    _stats->cache_hit_num = _hits;
+    _stats->os_alloc_num = this->os_alloc_num;
+    _stats->os_free_num = this->os_free_num;
+}
+
+
+
+void decx::MemPoolStatus::count_block(de::MemPoolStats* _stats, const decx::MemBlock* _block)
+{
+    if (_block->block_size == 0) {
+        return;
+    }
+    const int _class = decx::utils::clamp_max<int>(decx::utils::clamp_min<int>(
+        decx::utils::_highest_bit64(_block->block_size) - dex_to_pow_bias, 0), _MEM_STATS_CLASS_NUM_ - 1);
+
+    if (_block->_idle) {
+        _stats->idle_bytes += _block->block_size;
+        _stats->idle_bytes_per_class[_class] += _block->block_size;
+        _stats->largest_idle_block = decx::utils::clamp_min<size_t>(_stats->largest_idle_block, _block->block_size);
+    }
+    else {
+        _stats->in_use_bytes += _block->block_size;
+        _stats->in_use_bytes_per_class[_class] += _block->block_size;
+    }
+}
+
+
+
+void decx::MemPoolStatus::finalize(de::MemPoolStats* _stats)
+{
+    _stats->fragmentation = _stats->idle_bytes == 0 ? 0 :
+        1.f - (float)((double)_stats->largest_idle_block / (double)_stats->idle_bytes);
+    _stats->hit_rate = _stats->alloc_num == 0 ? 0 :
+        (float)((double)_stats->cache_hit_num / (double)_stats->alloc_num);
+}
+
+
+#endif
@@ -12,9 +12,17 @@
 
 #include "../basic.h"
 #include "MemChunk_D.h"
+#include "MemPool_status.h"
 
 
 
+/**
+* Device memory pool.
+* A chunk is freed when it is fully idle and the reserved bytes exceed this->_status.reserved_limit,
+* or it stays idle longer than this->_status.idle_trim_ms, or release() or trim() is called. The
+* freed chunk stays in its decx::MemChunkSet_D as an empty one (so the indices in
+* decx::MemBlock::_loc stay valid), and its slot is reused by the next new chunk of the set.
+*/
 class decx::MemPool_D
 {
 public:
@@ -23,6 +31,8 @@ public:
 
     std::mutex _mtx;
 
+    decx::MemPoolStatus _status;
+
     /**
      * @brief Construct a new MemPool_Hf object
      *
@@ -52,8 +62,31 @@ public:
     void register_reference(decx::MemBlock* _ptr);
 
 
+    /**
+    * @brief Free the fully idle chunks and reset their bookkeeping. The chunks which still have
+    * blocks in use are kept.
+    */
     void release();
 
+    /**
+    * @brief Free the chunks fully idle for at least idle_ms (0 for all of them)
+    */
+    void trim(const uint idle_ms);
+
+    /**
+    * @brief Set the most bytes kept reserved, the fully idle chunks beyond it are freed at once
+    */
+    void set_limit(const size_t max_reserved_bytes);
+
+    /**
+    * @brief Free the chunks which stay fully idle longer than idle_ms, 0 to disable
+    */
+    void set_trim_policy(const uint idle_ms);
+
+
+    void get_stats(de::MemPoolStats* _stats);
+
+
     ~MemPool_D();
 
 private:
@@ -68,6 +101,27 @@ private:
      */
     bool search_for_idle(size_t req_size, int begin_dex, decx::MemBlock** _ptr);
 
+    /**
+    * @brief Take a block from the chunks, should be called with this->_mtx locked
+    */
+    decx::MemBlock* _allocate(size_t req_size);
+
+    /**
+    * @brief Label the block (no reference left) idle and check if it can be merged, should
+    * be called with this->_mtx locked
+    */
+    void _deallocate(decx::MemBlock* _ptr);
+
+    /**
+    * @brief Free the (fully idle) chunk and reset it, should be called with this->_mtx locked
+    */
+    void _release_chunk(decx::MemChunk_D* _chunk);
+
+    /**
+    * @brief Free the chunks fully idle for at least idle_ms (0 for all of them), should be
+    * called with this->_mtx locked
+    */
+    void _trim(const uint idle_ms);
 };
 
 
@@ -115,47 +169,120 @@ bool decx::MemPool_D::search_for_idle(size_t req_size, int begin_dex, decx::MemB
 }
 
 
-void decx::MemPool_D::allocate(size_t req_size, decx::MemBlock** _ptr)
+decx::MemBlock* decx::MemPool_D::_allocate(size_t req_size)
 {
     int begin_dex = decx::utils::_GetHighest_abd(
         decx::utils::clamp_min<size_t>(req_size, Min_Alloc_Bytes)) - dex_to_pow_bias;
+
     decx::MemBlock* _MBPtr = NULL;
 
     bool _found = this->search_for_idle(req_size, begin_dex, &_MBPtr);
-    *_ptr = _MBPtr;        // assign the value to the pointer
-    
-    if (!_found)        // physically allocate one
+
+    if (!_found)
     {
-        size_t alloc_size = 1 << (begin_dex + dex_to_pow_bias);
+        size_t alloc_size = (size_t)1 << (begin_dex + dex_to_pow_bias);
+        if (this->_status.reserved_bytes + alloc_size > this->_status.reserved_limit) {
+            this->_trim(0);
+        }
+
         auto chunk_set = this->mem_chunk_set_list.begin() + begin_dex;
-        chunk_set->mem_chunk_list.emplace_back(
-            decx::MemChunk_D(alloc_size, req_size, begin_dex, chunk_set->list_length));
-        
-        _MBPtr = chunk_set->mem_chunk_list[chunk_set->list_length].mem_block_list[0];
-        *_ptr = _MBPtr;                // assign the value to the pointer
-        chunk_set->list_length++;    // increase the length of chunk_set
-        _MBPtr->_ref_times = 1;        // set the reference time to one
+        // reuse the slot of an empty chunk if there is any
+        int dex = 0;
+        while (dex < chunk_set->list_length && chunk_set->mem_chunk_list[dex].header_ptr != NULL) {
+            ++dex;
+        }
+        if (dex < chunk_set->list_length) {
+            delete chunk_set->mem_chunk_list[dex].mem_block_list[0];
+            chunk_set->mem_chunk_list[dex] = decx::MemChunk_D(alloc_size, req_size, begin_dex, dex);
+        }
+        else {
+            chunk_set->mem_chunk_list.emplace_back(
+                decx::MemChunk_D(alloc_size, req_size, begin_dex, dex));
+            chunk_set->list_length++;        // increase the length of chunk_set
+        }
+        _MBPtr = chunk_set->mem_chunk_list[dex].mem_block_list[0];
+        this->_status.on_os_alloc(alloc_size);
     }
-    else {
-        _MBPtr->_ref_times = 1;
+    return _MBPtr;
+}
+
+
+
+void decx::MemPool_D::_deallocate(decx::MemBlock* _ptr)
+{
+    decx::MemChunk_D* tmp_ptr = &this->mem_chunk_set_list[_ptr->_loc.x].mem_chunk_list[_ptr->_loc.y];
+    // free the block by labeling it idle
+    _ptr->_ref_times = 0;
+    _ptr->_idle = true;
+    tmp_ptr->check_to_merge(_ptr->_loc.z);
+
+    if (tmp_ptr->is_idle()) {
+        if (this->_status.reserved_bytes > this->_status.reserved_limit) {
+            this->_release_chunk(tmp_ptr);
+        }
+        else {
+            tmp_ptr->_idle_since = std::chrono::steady_clock::now();
+        }
+    }
+    if (this->_status.should_scan()) {
+        this->_trim(this->_status.idle_trim_ms);
     }
 }
 
 
 
+void decx::MemPool_D::_release_chunk(decx::MemChunk_D* _chunk)
+{
+    decx::alloc::free_D(_chunk->header_ptr);
+    this->_status.on_os_free(_chunk->chunk_size);
+    _chunk->reset();
+}
+
+
+
+void decx::MemPool_D::_trim(const uint idle_ms)
+{
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < this->list_length; ++i)
+    {
+        auto chunk_set = this->mem_chunk_set_list.begin() + i;
+        for (int j = 0; j < chunk_set->list_length; ++j)
+        {
+            decx::MemChunk_D* chunk = &chunk_set->mem_chunk_list[j];
+            if (chunk->is_idle() && now - chunk->_idle_since >= std::chrono::milliseconds(idle_ms)) {
+                this->_release_chunk(chunk);
+            }
+        }
+    }
+}
+
+
+
+void decx::MemPool_D::allocate(size_t req_size, decx::MemBlock** _ptr)
+{
+    std::lock_guard<std::mutex> lck(this->_mtx);
+    decx::MemBlock* _MBPtr = this->_allocate(req_size);
+    ++this->_status.alloc_num;
+
+    *_ptr = _MBPtr;                // assign the value to the pointer
+    _MBPtr->_ref_times = 1;        // set the reference time to one
+}
+
+
+
 void decx::MemPool_D::deallocate(decx::MemBlock* _ptr)
 {
-    decx::MemChunk_D* tmp_ptr = &this->mem_chunk_set_list[_ptr->_loc.x].mem_chunk_list[_ptr->_loc.y];
+    std::lock_guard<std::mutex> lck(this->_mtx);
     // if the reference time is 1, which means that it will be zero when deallocated.
     // So set this block idle and check if it can be merged
-    if (tmp_ptr->mem_block_list[_ptr->_loc.z]->_ref_times == 1) {
-        // free the block by labeling it idle
-        _ptr->_idle = true;
-        tmp_ptr->check_to_merge(_ptr->_loc.z);
+    if (_ptr->_ref_times == 1) {
+        this->_deallocate(_ptr);
+        ++this->_status.dealloc_num;
     }
     // otherwise, self-decrease one
     else {
-        tmp_ptr->mem_block_list[_ptr->_loc.z]->_ref_times --;
+        _ptr->_ref_times --;
     }
 }
 
@@ -163,28 +290,74 @@ void decx::MemPool_D::deallocate(decx::MemBlock* _ptr)
 
 void decx::MemPool_D::register_reference(decx::MemBlock* _ptr)
 {
+    std::lock_guard<std::mutex> lck(this->_mtx);
     // Increase one to the reference number
-    this->mem_chunk_set_list[_ptr->_loc.x].mem_chunk_list[_ptr->_loc.y].mem_block_list[_ptr->_loc.z]->_ref_times ++;
+    _ptr->_ref_times ++;
 }
 
 
 
 void decx::MemPool_D::release()
 {
+    std::lock_guard<std::mutex> lck(this->_mtx);
+    this->_trim(0);
+}
+
+
+
+void decx::MemPool_D::trim(const uint idle_ms)
+{
+    std::lock_guard<std::mutex> lck(this->_mtx);
+    this->_trim(idle_ms);
+}
+
+
+
+void decx::MemPool_D::set_limit(const size_t max_reserved_bytes)
+{
+    std::lock_guard<std::mutex> lck(this->_mtx);
+    this->_status.reserved_limit = max_reserved_bytes;
+    if (this->_status.reserved_bytes > max_reserved_bytes) {
+        this->_trim(0);
+    }
+}
+
+
+
+void decx::MemPool_D::set_trim_policy(const uint idle_ms)
+{
+    std::lock_guard<std::mutex> lck(this->_mtx);
+    this->_status.idle_trim_ms = idle_ms;
+}
+
+
+
+void decx::MemPool_D::get_stats(de::MemPoolStats* _stats)
+{
+    std::lock_guard<std::mutex> lck(this->_mtx);
+
+    memset(_stats, 0, sizeof(de::MemPoolStats));
+    this->_status.report(_stats);
+
     for (int i = 0; i < this->list_length; ++i)
     {
         auto chunk_set = this->mem_chunk_set_list.begin() + i;
         for (int j = 0; j < chunk_set->list_length; ++j)
         {
-            auto chunk = chunk_set->mem_chunk_list.begin() + j;
+            const decx::MemChunk_D* chunk = &chunk_set->mem_chunk_list[j];
             if (chunk->header_ptr != NULL) {
-                decx::alloc::free_D(chunk->header_ptr);
+                ++_stats->chunk_num;
+                for (int k = 0; k < chunk->list_length; ++k) {
+                    decx::MemPoolStatus::count_block(_stats, chunk->mem_block_list[k]);
+                }
             }
         }
     }
+    decx::MemPoolStatus::finalize(_stats);
 }
 
 
+
 decx::MemPool_D::~MemPool_D()
 {
     // I can not call this->release(), cudart.dll(.so) has already exited before this
@@ -12,9 +12,19 @@
 
 #include "../basic.h"
 #include "MemChunk_Hf.h"
+#include "MemCache.h"
+#include "MemPool_status.h"
 
 
 
+/**
+* Host (page-locked) memory pool. Each thread has a decx::MemCache in front of the pool, the pool
+* is locked only when it misses.
+* A chunk is freed when it is fully idle and the reserved bytes exceed this->_status.reserved_limit,
+* or it stays idle longer than this->_status.idle_trim_ms, or release() or trim() is called. The
+* freed chunk stays in its decx::MemChunkSet_Hf as an empty one (so the indices in
+* decx::MemBlock::_loc stay valid), and its slot is reused by the next new chunk of the set.
+*/
 class decx::MemPool_Hf
 {
 public:
@@ -23,6 +33,11 @@ public:
 
     std::mutex _mtx;
 
+    // raised when the pool is under pressure, asks all the caches to drain
+    std::atomic<uint64_t> _pressure_epoch;
+
+    decx::MemPoolStatus _status;
+
     /**
      * @brief Construct a new MemPool_Hf object
      *
@@ -55,9 +70,30 @@ public:
 
     ~MemPool_Hf();
 
-
+    /**
+    * @brief Free the fully idle chunks and reset their bookkeeping. The chunks which still have
+    * blocks in use are kept.
+    */
     void release();
 
+    /**
+    * @brief Free the chunks fully idle for at least idle_ms (0 for all of them)
+    */
+    void trim(const uint idle_ms);
+
+    /**
+    * @brief Set the most bytes kept reserved, the fully idle chunks beyond it are freed at once
+    */
+    void set_limit(const size_t max_reserved_bytes);
+
+    /**
+    * @brief Free the chunks which stay fully idle longer than idle_ms, 0 to disable
+    */
+    void set_trim_policy(const uint idle_ms);
+
+
+    void get_stats(de::MemPoolStats* _stats);
+
 private:
     /**
      * @brief Search for any possible idle block for recycling the memory block.
@@ -70,15 +106,45 @@ private:
      */
     bool search_for_idle(size_t req_size, int begin_dex, decx::MemBlock** _ptr);
 
+    /**
+    * @brief Take a block from the chunks, should be called with this->_mtx locked
+    */
+    decx::MemBlock* _allocate(size_t req_size);
+
+    /**
+    * @brief Label the block (no reference left) idle and check if it can be merged, should
+    * be called with this->_mtx locked
+    */
+    void _deallocate(decx::MemBlock* _ptr);
+
+    /**
+    * @brief Free the (fully idle) chunk and reset it, should be called with this->_mtx locked
+    */
+    void _release_chunk(decx::MemChunk_Hf* _chunk);
+
+    /**
+    * @brief Free the chunks fully idle for at least idle_ms (0 for all of them), should be
+    * called with this->_mtx locked
+    */
+    void _trim(const uint idle_ms);
+
+    friend class decx::MemCache<decx::MemPool_Hf>;
 };
 
 
+namespace decx
+{
+    thread_local decx::MemCache<decx::MemPool_Hf> _tl_mem_cache_Hf;
+}
+
+
 decx::MemPool_Hf::MemPool_Hf()
 {
     for (int i = 0; i < Init_Mem_Capacity; ++i) {
         this->mem_chunk_set_list.emplace_back(i);
     }
     this->list_length = Init_Mem_Capacity;
+    this->_pressure_epoch.store(0, std::memory_order_relaxed);
 }
 
 
@@ -117,7 +183,7 @@ bool decx::MemPool_Hf::search_for_idle(size_t req_size, int begin_dex, decx::Mem
 }
 
 
-void decx::MemPool_Hf::allocate(size_t req_size, decx::MemBlock** _ptr)
+decx::MemBlock* decx::MemPool_Hf::_allocate(size_t req_size)
 {
     int begin_dex = decx::utils::_GetHighest_abd(
         decx::utils::clamp_min<size_t>(req_size, Min_Alloc_Bytes)) - dex_to_pow_bias;
@@ -125,40 +191,117 @@ void decx::MemPool_Hf::allocate(size_t req_size, decx::MemBlock** _ptr)
     decx::MemBlock* _MBPtr = NULL;
 
     bool _found = this->search_for_idle(req_size, begin_dex, &_MBPtr);
-    *_ptr = _MBPtr;
 
     if (!_found)
     {
-        size_t alloc_size = 1 << (begin_dex + dex_to_pow_bias);
+        size_t alloc_size = (size_t)1 << (begin_dex + dex_to_pow_bias);
+        if (this->_status.reserved_bytes + alloc_size > this->_status.reserved_limit) {
+            this->_trim(0);
+        }
+
         auto chunk_set = this->mem_chunk_set_list.begin() + begin_dex;
-        chunk_set->mem_chunk_list.emplace_back(
-            decx::MemChunk_Hf(alloc_size, req_size, begin_dex, chunk_set->list_length));
+        // reuse the slot of an empty chunk if there is any
+        int dex = 0;
+        while (dex < chunk_set->list_length && chunk_set->mem_chunk_list[dex].header_ptr != NULL) {
+            ++dex;
+        }
+        if (dex < chunk_set->list_length) {
+            delete chunk_set->mem_chunk_list[dex].mem_block_list[0];
+            chunk_set->mem_chunk_list[dex] = decx::MemChunk_Hf(alloc_size, req_size, begin_dex, dex);
+        }
+        else {
+            chunk_set->mem_chunk_list.emplace_back(
+                decx::MemChunk_Hf(alloc_size, req_size, begin_dex, dex));
+            chunk_set->list_length++;        // increase the length of chunk_set
+        }
+        _MBPtr = chunk_set->mem_chunk_list[dex].mem_block_list[0];
+        this->_status.on_os_alloc(alloc_size);
+    }
+    return _MBPtr;
+}
+
+
 
-        _MBPtr = chunk_set->mem_chunk_list[chunk_set->list_length].mem_block_list[0];
-        *_ptr = _MBPtr;                    // assign the value to the pointer
-        chunk_set->list_length++;        // increase the length of chunk_set
-        _MBPtr->_ref_times = 1;            // set the reference time to one
+void decx::MemPool_Hf::_deallocate(decx::MemBlock* _ptr)
+{
+    decx::MemChunk_Hf* tmp_ptr = &this->mem_chunk_set_list[_ptr->_loc.x].mem_chunk_list[_ptr->_loc.y];
+    // free the block by labeling it idle
+    _ptr->_ref_times = 0;
+    _ptr->_idle = true;
+    tmp_ptr->check_to_merge(_ptr->_loc.z);
+
+    if (tmp_ptr->is_idle()) {
+        if (this->_status.reserved_bytes > this->_status.reserved_limit) {
+            this->_release_chunk(tmp_ptr);
+        }
+        else {
+            tmp_ptr->_idle_since = std::chrono::steady_clock::now();
+        }
     }
-    else {
-        _MBPtr->_ref_times = 1;
+    if (this->_status.should_scan()) {
+        this->_trim(this->_status.idle_trim_ms);
+    }
+}
+
+
+
+void decx::MemPool_Hf::_release_chunk(decx::MemChunk_Hf* _chunk)
+{
+    decx::alloc::aligned_free_Hf(_chunk->header_ptr);
+    this->_status.on_os_free(_chunk->chunk_size);
+    _chunk->reset();
+}
+
+
+
+void decx::MemPool_Hf::_trim(const uint idle_ms)
+{
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < this->list_length; ++i)
+    {
+        auto chunk_set = this->mem_chunk_set_list.begin() + i;
+        for (int j = 0; j < chunk_set->list_length; ++j)
+        {
+            decx::MemChunk_Hf* chunk = &chunk_set->mem_chunk_list[j];
+            if (chunk->is_idle() && now - chunk->_idle_since >= std::chrono::milliseconds(idle_ms)) {
+                this->_release_chunk(chunk);
+            }
+        }
     }
 }
 
 
 
+void decx::MemPool_Hf::allocate(size_t req_size, decx::MemBlock** _ptr)
+{
+    decx::MemBlock* _MBPtr = decx::_tl_mem_cache_Hf.pop(this, req_size);
+    if (_MBPtr == NULL) {
+        std::lock_guard<std::mutex> lck(this->_mtx);
+        _MBPtr = this->_allocate(req_size);
+        ++this->_status.alloc_num;
+    }
+    *_ptr = _MBPtr;                    // assign the value to the pointer
+    _MBPtr->_ref_times = 1;            // set the reference time to one
+}
+
+
+
 void decx::MemPool_Hf::deallocate(decx::MemBlock* _ptr)
 {
-    decx::MemChunk_Hf* tmp_ptr = &this->mem_chunk_set_list[_ptr->_loc.x].mem_chunk_list[_ptr->_loc.y];
     // if the reference time is 1, which means that it will be zero when deallocated.
-    // So set this block idle and check if it can be merged
-    if (tmp_ptr->mem_block_list[_ptr->_loc.z]->_ref_times == 1) {
-        // free the block by labeling it idle
-        _ptr->_idle = true;
-        tmp_ptr->check_to_merge(_ptr->_loc.z);
+    // So keep it in the cache of this thread, or set it idle and check if it can be merged
+    if (_ptr->_ref_times == 1 && decx::_tl_mem_cache_Hf.push(this, _ptr)) {
+        return;
     }
+    std::lock_guard<std::mutex> lck(this->_mtx);
     // otherwise, self-decrease one
+    if (_ptr->_ref_times > 1) {
+        _ptr->_ref_times--;
+    }
     else {
-        tmp_ptr->mem_block_list[_ptr->_loc.z]->_ref_times--;
+        this->_deallocate(_ptr);
+        ++this->_status.dealloc_num;
     }
 }
 
@@ -166,6 +309,7 @@ void decx::MemPool_Hf::deallocate(decx::MemBlock* _ptr)
 
 void decx::MemPool_Hf::register_reference(decx::MemBlock* _ptr)
 {
+    std::lock_guard<std::mutex> lck(this->_mtx);
     // Increase one to the reference number
     this->mem_chunk_set_list[_ptr->_loc.x].mem_chunk_list[_ptr->_loc.y].mem_block_list[_ptr->_loc.z]->_ref_times++;
 }
@@ -174,17 +318,67 @@ void decx::MemPool_Hf::register_reference(decx::MemBlock* _ptr)
 
 void decx::MemPool_Hf::release()
 {
+    // the caches of the other threads drain at their next use
+    this->_pressure_epoch.fetch_add(1, std::memory_order_relaxed);
+    decx::_tl_mem_cache_Hf.drain();
+
+    std::lock_guard<std::mutex> lck(this->_mtx);
+    this->_trim(0);
+}
+
+
+
+void decx::MemPool_Hf::trim(const uint idle_ms)
+{
+    std::lock_guard<std::mutex> lck(this->_mtx);
+    this->_trim(idle_ms);
+}
+
+
+
+void decx::MemPool_Hf::set_limit(const size_t max_reserved_bytes)
+{
+    std::lock_guard<std::mutex> lck(this->_mtx);
+    this->_status.reserved_limit = max_reserved_bytes;
+    if (this->_status.reserved_bytes > max_reserved_bytes) {
+        this->_trim(0);
+    }
+}
+
+
+
+void decx::MemPool_Hf::set_trim_policy(const uint idle_ms)
+{
+    std::lock_guard<std::mutex> lck(this->_mtx);
+    this->_status.idle_trim_ms = idle_ms;
+}
+
+
+
+void decx::MemPool_Hf::get_stats(de::MemPoolStats* _stats)
+{
+    decx::_tl_mem_cache_Hf.flush_stats();
+
+    std::lock_guard<std::mutex> lck(this->_mtx);
+
+    memset(_stats, 0, sizeof(de::MemPoolStats));
+    this->_status.report(_stats);
+
     for (int i = 0; i < this->list_length; ++i)
     {
         auto chunk_set = this->mem_chunk_set_list.begin() + i;
         for (int j = 0; j < chunk_set->list_length; ++j)
         {
-            auto chunk = chunk_set->mem_chunk_list.begin() + j;
+            const decx::MemChunk_Hf* chunk = &chunk_set->mem_chunk_list[j];
             if (chunk->header_ptr != NULL) {
-                decx::alloc::aligned_free_Hf(chunk->header_ptr);
+                ++_stats->chunk_num;
+                for (int k = 0; k < chunk->list_length; ++k) {
+                    decx::MemPoolStatus::count_block(_stats, chunk->mem_block_list[k]);
+                }
             }
         }
     }
+    decx::MemPoolStatus::finalize(_stats);
 }
 
 
@@ -11,32 +11,148 @@
 
 #include "../basic.h"
 #include "MemChunk_Hv.h"
+#include "MemCache.h"
+#include "MemPool_status.h"
 
 
+// number of the second-level size classes in each power of 2 (2^_HV_SL_LOG2_)
+#define _HV_SL_LOG2_ 4
+#define _HV_SL_NUM_ (1 << _HV_SL_LOG2_)
+
+// number of the first-level size classes, blocks up to 2^_HV_FL_NUM_ bytes
+#define _HV_FL_NUM_ 48
+
+// the least size of a chunk requested from the OS, larger requests get a chunk of their own size
+#define _HV_CHUNK_SIZE_ (4 << 20)
+
+
+/**
+* Host (pageable) memory pool, a two-level segregated fit (TLSF) allocator.
+*
+* The idle blocks are kept in free lists by size class. A size is mapped to the first level
+* fl = floor(log2(size)) and to the second level sl, which divides [2^fl, 2^(fl+1)) into
+* _HV_SL_NUM_ equal ranges. Two bitmaps record which classes have idle blocks, so a fitting
+* class is found with two bit scans, and allocate() and deallocate() take O(1) time no matter
+* how many blocks there are.
+*   allocate() : take an idle block from the smallest class whose blocks are all large enough,
+*                and split off the remainder (if it is at least Min_Alloc_Bytes) as a new idle block.
+*   deallocate() : merge the block with its idle physical neighbours right away, and put the
+*                merged block back into its class.
+* The sizes are rounded up to multiples of host_mem_alignment, so all the blocks are aligned.
+* Each thread has a decx::MemCache in front of the pool, the pool is locked only when it misses.
+*
+* A chunk is returned to the OS when it is fully idle and
+*   - the reserved bytes exceed this->_status.reserved_limit, or
+*   - it stays idle longer than this->_status.idle_trim_ms (checked on the locked paths), or
+*   - release() or trim() is called.
+*
+* decx::mem_pool_Hv and decx::mem_pool_Hh (the huge page pool, whose chunks are allocated by
+* decx::alloc::malloc_Hh() in multiples of _HUGE_PAGE_SIZE_) are both instances of it.
+*/
 class decx::MemPool_Hv
 {
-public:
-    std::vector<decx::MemChunkSet_Hv> mem_chunk_set_list;
-    int list_length;
+private:
+    uint64_t _fl_bitmap;
+    uint32_t _sl_bitmap[_HV_FL_NUM_];
+    decx::MemBlock* _free_lists[_HV_FL_NUM_][_HV_SL_NUM_];
+
+    std::vector<decx::MemChunk_Hv> _chunks;
+
+    // decx::MemBlock objects no longer describing any memory, linked by _free_next, reused by the splits
+    decx::MemBlock* _spare_blocks;
+
+    // returned when the OS fails to allocate, its _ptr is NULL
+    decx::MemBlock* _failed_block;
+
+    bool _huge_page;
+
+
+    static void _mapping(const size_t size, int* fl, int* sl);
+
+
+    void _insert_free(decx::MemBlock* _block);
+
+
+    void _remove_free(decx::MemBlock* _block);
+
+    /**
+    * @brief Take an idle block which is at least the size out of the free lists
+    * @return NULL if there is none
+    */
+    decx::MemBlock* _find_free(const size_t size);
+
+
+    decx::MemBlock* _new_block_object();
+
+
+    void _recycle_block_object(decx::MemBlock* _block);
+
+    /**
+    * @brief Request a new chunk from the OS
+    * @return The idle block covering the whole chunk (not in the free lists), NULL if failed
+    */
+    decx::MemBlock* _add_chunk(const size_t size);
 
+    /**
+    * @brief Take a block of the size (already rounded) from the free lists or a new chunk,
+    * should be called with this->_mtx locked
+    * @return NULL if the OS fails to allocate
+    */
+    decx::MemBlock* _allocate(const size_t size);
+
+    /**
+    * @brief Label the block (no reference left) idle and merge it with its idle neighbours,
+    * should be called with this->_mtx locked
+    */
+    void _deallocate(decx::MemBlock* _block);
+
+    /**
+    * @brief Find the chunk beginning at the block, should be called with this->_mtx locked
+    */
+    int _chunk_of(const decx::MemBlock* _first) const;
+
+    /**
+    * @brief Return the (fully idle) chunk to the OS, should be called with this->_mtx locked
+    */
+    void _release_chunk(const int dex);
+
+    /**
+    * @brief Return the chunks fully idle for at least idle_ms (0 for all of them) to the OS,
+    * should be called with this->_mtx locked
+    */
+    void _trim(const uint idle_ms);
+
+    // the cache of the calling thread in front of this pool
+    decx::MemCache<decx::MemPool_Hv>* _cache();
+
+    friend class decx::MemCache<decx::MemPool_Hv>;
+
+public:
     std::mutex _mtx;
 
+    // raised when the pool is under pressure, asks all the caches to drain
+    std::atomic<uint64_t> _pressure_epoch;
+
+    decx::MemPoolStatus _status;
+
     /**
-     * @brief Construct a new MemPool_Hf object
+     * @brief Construct a new MemPool_Hv object, no memory is allocated until the first request
      *
+     * @param huge_page Whether the chunks are backed by huge pages
      */
-    MemPool_Hv();
+    MemPool_Hv(const bool huge_page);
 
     /**
      * @brief allocate a memory for user, recycle as much as possible
      *
      * @param req_size Indicated by users
-     * @param _ptr The destinated pointer of decx::MemBlock
+     * @param _ptr The destinated pointer of decx::MemBlock. If the allocation fails, (*_ptr)->_ptr is NULL
      */
     void allocate(size_t req_size, decx::MemBlock** _ptr);
 
     /**
-     * @brief Deallocate a decx::MemBlock, precisely speaking, label it idle
+     * @brief Deallocate a decx::MemBlock, precisely speaking, label it idle and merge it with
+     * its idle neighbours
      *
      * @param _ptr The decx::MemBlock that is to be deallocated
      */
@@ -50,112 +166,372 @@ public:
      */
     void register_reference(decx::MemBlock* _ptr);
 
-
+    /**
+    * @brief Return the fully idle chunks to the OS. The chunks which still have blocks in use
+    * are kept.
+    */
     void release();
 
+    /**
+    * @brief Return the chunks fully idle for at least idle_ms (0 for all of them) to the OS
+    */
+    void trim(const uint idle_ms);
 
-    ~MemPool_Hv();
+    /**
+    * @brief Set the most bytes kept reserved, the fully idle chunks beyond it are returned at once
+    */
+    void set_limit(const size_t max_reserved_bytes);
 
-private:
     /**
-     * @brief Search for any possible idle block for recycling the memory block.
-     *
-     * @param req_size Indicated by users.
-     * @param _ptr The destinated decx::MemBlock ptr.
-     * @param begin_dex The index where the system start to search the decx::MemChunkSet
-     * @return true Found an idle block
-     * @return false Haven't found any idle block
-     */
-    bool search_for_idle(size_t req_size, int begin_dex, decx::MemBlock** _ptr);
+    * @brief Return the chunks which stay fully idle longer than idle_ms, 0 to disable
+    */
+    void set_trim_policy(const uint idle_ms);
+
+
+    void get_stats(de::MemPoolStats* _stats);
 
+
+    ~MemPool_Hv();
 };
 
 
-decx::MemPool_Hv::MemPool_Hv()
+namespace decx
+{
+    thread_local decx::MemCache<decx::MemPool_Hv> _tl_mem_cache_Hv;
+
+    thread_local decx::MemCache<decx::MemPool_Hv> _tl_mem_cache_Hh;
+}
+
+
+
+decx::MemPool_Hv::MemPool_Hv(const bool huge_page)
+{
+    this->_huge_page = huge_page;
+    this->_fl_bitmap = 0;
+    memset(this->_sl_bitmap, 0, sizeof(this->_sl_bitmap));
+    memset(this->_free_lists, 0, sizeof(this->_free_lists));
+    this->_spare_blocks = NULL;
+    this->_pressure_epoch.store(0, std::memory_order_relaxed);
+
+    decx::MemLoc _loc;
+    _loc.x = 0;     _loc.y = 0;     _loc.z = 0;
+    this->_failed_block = new decx::MemBlock(0, false, &_loc, NULL, NULL, NULL);
+}
+
+
+
+void decx::MemPool_Hv::_mapping(const size_t size, int* fl, int* sl)
 {
-    for (int i = 0; i < Init_Mem_Capacity; ++i) {
-        this->mem_chunk_set_list.emplace_back(i);
+    *fl = decx::utils::_highest_bit64(size);
+    *sl = (int)(size >> (*fl - _HV_SL_LOG2_)) ^ _HV_SL_NUM_;
+}
+
+
+
+void decx::MemPool_Hv::_insert_free(decx::MemBlock* _block)
+{
+    int fl, sl;
+    decx::MemPool_Hv::_mapping(_block->block_size, &fl, &sl);
+
+    decx::MemBlock* _head = this->_free_lists[fl][sl];
+    _block->_free_prev = NULL;
+    _block->_free_next = _head;
+    if (_head != NULL) {
+        _head->_free_prev = _block;
     }
-    this->list_length = Init_Mem_Capacity;
+    this->_free_lists[fl][sl] = _block;
+    _block->_loc.x = fl;        _block->_loc.y = sl;        _block->_loc.z = 0;
+
+    this->_fl_bitmap |= ((uint64_t)1 << fl);
+    this->_sl_bitmap[fl] |= (1U << sl);
 }
 
 
 
-bool decx::MemPool_Hv::search_for_idle(size_t req_size, int begin_dex, decx::MemBlock** _ptr)
+void decx::MemPool_Hv::_remove_free(decx::MemBlock* _block)
 {
-    bool _found = false;
+    const int fl = _block->_loc.x, sl = _block->_loc.y;
 
-    for (int i = begin_dex; i < this->list_length; ++i)
-    {
-        auto chunk_set = this->mem_chunk_set_list.begin() + i;
-        for (int j = 0; j < chunk_set->list_length; ++j)
-        {
-            auto chunk = chunk_set->mem_chunk_list.begin() + j;
-            for (int k = 0; k < chunk->list_length; ++k)
-            {
-                decx::MemBlock* _MBPtr = *(chunk->mem_block_list.begin() + k);
-                if (_MBPtr->_idle) {
-                    if (_MBPtr->block_size > req_size || _MBPtr->block_size == req_size) {
-                        _found = true;
-                        if (_MBPtr->block_size > req_size) {
-                            chunk->split(k, req_size);
-                        }
-                        *_ptr = _MBPtr;
-                        _MBPtr->_idle = false;        // lable as occupied
-                        break;
-                    }
-                }
-                if (_found) break;
-            }
-            if (_found) break;
+    if (_block->_free_prev != NULL) {
+        _block->_free_prev->_free_next = _block->_free_next;
+    }
+    else {
+        this->_free_lists[fl][sl] = _block->_free_next;
+    }
+    if (_block->_free_next != NULL) {
+        _block->_free_next->_free_prev = _block->_free_prev;
+    }
+    _block->_free_prev = _block->_free_next = NULL;
+
+    if (this->_free_lists[fl][sl] == NULL) {
+        this->_sl_bitmap[fl] &= ~(1U << sl);
+        if (this->_sl_bitmap[fl] == 0) {
+            this->_fl_bitmap &= ~((uint64_t)1 << fl);
         }
-        if (_found) break;
     }
-    return _found;
 }
 
 
-void decx::MemPool_Hv::allocate(size_t req_size, decx::MemBlock** _ptr)
+
+decx::MemBlock* decx::MemPool_Hv::_find_free(const size_t size)
 {
-    const int begin_dex = decx::utils::_GetHighest_abd(
-        decx::utils::clamp_min<size_t>(req_size, Min_Alloc_Bytes)) - dex_to_pow_bias;
-    decx::MemBlock* _MBPtr = NULL;
+    int fl, sl;
+    decx::MemPool_Hv::_mapping(size, &fl, &sl);
+    // round up to the next class, so that every block in the class found is large enough
+    decx::MemPool_Hv::_mapping(size + ((size_t)1 << (fl - _HV_SL_LOG2_)) - 1, &fl, &sl);
 
-    const bool _found = this->search_for_idle(req_size, begin_dex, &_MBPtr);
-    *_ptr = _MBPtr;
+    if (fl >= _HV_FL_NUM_) {
+        return NULL;
+    }
+
+    uint32_t _sl_map = this->_sl_bitmap[fl] & (~0U << sl);
+    if (_sl_map == 0) {
+        const uint64_t _fl_map = fl + 1 < 64 ? this->_fl_bitmap & (~(uint64_t)0 << (fl + 1)) : 0;
+        if (_fl_map == 0) {
+            return NULL;
+        }
+        fl = decx::utils::_lowest_bit64(_fl_map);
+        _sl_map = this->_sl_bitmap[fl];
+    }
+    sl = decx::utils::_lowest_bit64(_sl_map);
+
+    decx::MemBlock* _block = this->_free_lists[fl][sl];
+    this->_remove_free(_block);
+    return _block;
+}
+
+
+
+decx::MemBlock* decx::MemPool_Hv::_new_block_object()
+{
+    decx::MemBlock* _block = this->_spare_blocks;
+    if (_block != NULL) {
+        this->_spare_blocks = _block->_free_next;
+        _block->_free_next = NULL;
+        return _block;
+    }
+    decx::MemLoc _loc;
+    _loc.x = 0;     _loc.y = 0;     _loc.z = 0;
+    return new decx::MemBlock(0, true, &_loc, NULL, NULL, NULL);
+}
+
+
+
+void decx::MemPool_Hv::_recycle_block_object(decx::MemBlock* _block)
+{
+    _block->_ptr = NULL;
+    _block->block_size = 0;
+    _block->_prev = _block->_next = NULL;
+    _block->_free_prev = NULL;
+    _block->_free_next = this->_spare_blocks;
+    this->_spare_blocks = _block;
+}
+
+
+
+decx::MemBlock* decx::MemPool_Hv::_add_chunk(const size_t size)
+{
+    if (this->_status.reserved_bytes + size > this->_status.reserved_limit) {
+        this->_trim(0);
+    }
+    decx::MemBlock* _block = this->_new_block_object();
+    decx::MemChunk_Hv _chunk(size, _block, this->_huge_page);
 
-    if (!_found)
+    if (_chunk.header_ptr == NULL) {
+        this->_recycle_block_object(_block);
+        return NULL;
+    }
+    this->_chunks.push_back(_chunk);
+    this->_status.on_os_alloc(size);
+    return _block;
+}
+
+
+
+decx::MemBlock* decx::MemPool_Hv::_allocate(const size_t size)
+{
+    decx::MemBlock* _MBPtr = this->_find_free(size);
+    if (_MBPtr == NULL) {
+        size_t _chunk_size = decx::utils::clamp_min<size_t>(size, _HV_CHUNK_SIZE_);
+        if (this->_huge_page) {
+            _chunk_size = decx::utils::ceil<size_t>(_chunk_size, _HUGE_PAGE_SIZE_) * _HUGE_PAGE_SIZE_;
+        }
+        _MBPtr = this->_add_chunk(_chunk_size);
+        if (_MBPtr == NULL) {
+            return NULL;
+        }
+    }
+
+    // split off the remainder
+    if (_MBPtr->block_size - size >= Min_Alloc_Bytes) {
+        decx::MemBlock* _rest = this->_new_block_object();
+        _rest->_ptr = _MBPtr->_ptr + size;
+        _rest->block_size = _MBPtr->block_size - size;
+        _rest->_idle = true;
+        _rest->_ref_times = 0;
+
+        _rest->_prev = _MBPtr;
+        _rest->_next = _MBPtr->_next;
+        if (_MBPtr->_next != NULL) {
+            _MBPtr->_next->_prev = _rest;
+        }
+        _MBPtr->_next = _rest;
+        _MBPtr->block_size = size;
+
+        this->_insert_free(_rest);
+    }
+
+    _MBPtr->_idle = false;            // lable as occupied
+    return _MBPtr;
+}
+
+
+
+void decx::MemPool_Hv::_deallocate(decx::MemBlock* _block)
+{
+    _block->_ref_times = 0;
+    _block->_idle = true;
+
+    decx::MemBlock* _prev = _block->_prev;
+    if (_prev != NULL && _prev->_idle) {
+        this->_remove_free(_prev);
+        _prev->block_size += _block->block_size;
+        _prev->_next = _block->_next;
+        if (_block->_next != NULL) {
+            _block->_next->_prev = _prev;
+        }
+        this->_recycle_block_object(_block);
+        _block = _prev;
+    }
+    decx::MemBlock* _next = _block->_next;
+    if (_next != NULL && _next->_idle) {
+        this->_remove_free(_next);
+        _block->block_size += _next->block_size;
+        _block->_next = _next->_next;
+        if (_next->_next != NULL) {
+            _next->_next->_prev = _block;
+        }
+        this->_recycle_block_object(_next);
+    }
+
+    this->_insert_free(_block);
+
+    // the whole chunk is idle
+    if (_block->_prev == NULL && _block->_next == NULL) {
+        const int dex = this->_chunk_of(_block);
+        if (this->_status.reserved_bytes > this->_status.reserved_limit) {
+            this->_release_chunk(dex);
+        }
+        else {
+            this->_chunks[dex]._idle_since = std::chrono::steady_clock::now();
+        }
+    }
+    if (this->_status.should_scan()) {
+        this->_trim(this->_status.idle_trim_ms);
+    }
+}
+
+
+
+decx::MemCache<decx::MemPool_Hv>* decx::MemPool_Hv::_cache()
+{
+    return this->_huge_page ? &decx::_tl_mem_cache_Hh : &decx::_tl_mem_cache_Hv;
+}
+
+
+
+int decx::MemPool_Hv::_chunk_of(const decx::MemBlock* _first) const
+{
+    for (int i = 0; i < this->_chunks.size(); ++i) {
+        if (this->_chunks[i]._first == _first) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+
+
+void decx::MemPool_Hv::_release_chunk(const int dex)
+{
+    decx::MemChunk_Hv* _chunk = &this->_chunks[dex];
+
+    this->_remove_free(_chunk->_first);
+    this->_recycle_block_object(_chunk->_first);
+    _chunk->release_memory();
+    this->_status.on_os_free(_chunk->chunk_size);
+
+    this->_chunks[dex] = this->_chunks.back();
+    this->_chunks.pop_back();
+}
+
+
+
+void decx::MemPool_Hv::_trim(const uint idle_ms)
+{
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < this->_chunks.size();)
     {
-        size_t alloc_size = 1 << (begin_dex + dex_to_pow_bias);
-        auto chunk_set = this->mem_chunk_set_list.begin() + begin_dex;
-        chunk_set->mem_chunk_list.emplace_back(
-            decx::MemChunk_Hv(alloc_size, req_size, begin_dex, chunk_set->list_length));
+        const decx::MemChunk_Hv* _chunk = &this->_chunks[i];
+        if (_chunk->is_idle() && now - _chunk->_idle_since >= std::chrono::milliseconds(idle_ms)) {
+            this->_release_chunk(i);
+        }
+        else {
+            ++i;
+        }
+    }
+}
 
-        _MBPtr = chunk_set->mem_chunk_list[chunk_set->list_length].mem_block_list[0];
-        *_ptr = _MBPtr;                    // assign the value to the pointer
-        chunk_set->list_length++;        // increase the length of chunk_set
-        _MBPtr->_ref_times = 1;            // set the reference time to one
+
+
+void decx::MemPool_Hv::allocate(size_t req_size, decx::MemBlock** _ptr)
+{
+    const size_t _size = decx::utils::ceil<size_t>(
+        decx::utils::clamp_min<size_t>(req_size, Min_Alloc_Bytes), host_mem_alignment) * host_mem_alignment;
+
+    decx::MemBlock* _MBPtr = this->_cache()->pop(this, _size);
+    if (_MBPtr == NULL) {
+        std::lock_guard<std::mutex> lck(this->_mtx);
+        _MBPtr = this->_allocate(_size);
+        ++this->_status.alloc_num;
     }
-    else {
-        _MBPtr->_ref_times = 1;
+    if (_MBPtr == NULL) {
+        // out of memory, give the cached blocks back and try again
+        this->_pressure_epoch.fetch_add(1, std::memory_order_relaxed);
+        this->_cache()->drain();
+
+        std::lock_guard<std::mutex> lck(this->_mtx);
+        _MBPtr = this->_allocate(_size);
+        if (_MBPtr == NULL) {
+            *_ptr = this->_failed_block;
+            return;
+        }
     }
+
+    _MBPtr->_ref_times = 1;           // set the reference time to one
+    *_ptr = _MBPtr;
 }
 
 
 
 void decx::MemPool_Hv::deallocate(decx::MemBlock* _ptr)
 {
-    decx::MemChunk_Hv* tmp_ptr = &this->mem_chunk_set_list[_ptr->_loc.x].mem_chunk_list[_ptr->_loc.y];
+    if (_ptr == NULL || _ptr->_ptr == NULL) {
+        return;
+    }
     // if the reference time is 1, which means that it will be zero when deallocated.
-    // So set this block idle and check if it can be merged
-    if (tmp_ptr->mem_block_list[_ptr->_loc.z]->_ref_times == 1) {
-        // free the block by labeling it idle
-        _ptr->_idle = true;
-        tmp_ptr->check_to_merge(_ptr->_loc.z);
+    // So keep it in the cache of this thread, or set it idle in the pool
+    if (_ptr->_ref_times == 1 && this->_cache()->push(this, _ptr)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lck(this->_mtx);
+    if (_ptr->_ref_times > 1) {
+        _ptr->_ref_times--;
     }
-    // otherwise, self-decrease one
     else {
-        tmp_ptr->mem_block_list[_ptr->_loc.z]->_ref_times--;
+        this->_deallocate(_ptr);
+        ++this->_status.dealloc_num;
     }
 }
 
@@ -163,40 +539,89 @@ void decx::MemPool_Hv::deallocate(decx::MemBlock* _ptr)
 
 void decx::MemPool_Hv::register_reference(decx::MemBlock* _ptr)
 {
+    std::lock_guard<std::mutex> lck(this->_mtx);
     // Increase one to the reference number
-    this->mem_chunk_set_list[_ptr->_loc.x].mem_chunk_list[_ptr->_loc.y].mem_block_list[_ptr->_loc.z]->_ref_times++;
+    _ptr->_ref_times++;
 }
 
 
 
-decx::MemPool_Hv::~MemPool_Hv()
+void decx::MemPool_Hv::release()
 {
-    for (int i = 0; i < this->list_length; ++i)
-    {
-        auto chunk_set = this->mem_chunk_set_list.begin() + i;
-        for (int j = 0; j < chunk_set->list_length; ++j)
-        {
-            auto chunk = chunk_set->mem_chunk_list.begin() + j;
-            if (chunk->header_ptr != NULL) {
-                decx::alloc::aligned_free_Hv(chunk->header_ptr);
-            }
+    // the caches of the other threads drain at their next use
+    this->_pressure_epoch.fetch_add(1, std::memory_order_relaxed);
+    this->_cache()->drain();
+
+    std::lock_guard<std::mutex> lck(this->_mtx);
+    this->_trim(0);
+}
+
+
+
+void decx::MemPool_Hv::trim(const uint idle_ms)
+{
+    std::lock_guard<std::mutex> lck(this->_mtx);
+    this->_trim(idle_ms);
+}
+
+
+
+void decx::MemPool_Hv::set_limit(const size_t max_reserved_bytes)
+{
+    std::lock_guard<std::mutex> lck(this->_mtx);
+    this->_status.reserved_limit = max_reserved_bytes;
+    if (this->_status.reserved_bytes > max_reserved_bytes) {
+        this->_trim(0);
+    }
+}
+
+
+
+void decx::MemPool_Hv::set_trim_policy(const uint idle_ms)
+{
+    std::lock_guard<std::mutex> lck(this->_mtx);
+    this->_status.idle_trim_ms = idle_ms;
+}
+
+
+
+void decx::MemPool_Hv::get_stats(de::MemPoolStats* _stats)
+{
+    this->_cache()->flush_stats();
+
+    std::lock_guard<std::mutex> lck(this->_mtx);
+
+    memset(_stats, 0, sizeof(de::MemPoolStats));
+    this->_status.report(_stats);
+    _stats->chunk_num = this->_chunks.size();
+
+    for (int i = 0; i < this->_chunks.size(); ++i) {
+        const decx::MemBlock* _block = this->_chunks[i]._first;
+        while (_block != NULL) {
+            decx::MemPoolStatus::count_block(_stats, _block);
+            _block = _block->_next;
         }
     }
+    decx::MemPoolStatus::finalize(_stats);
 }
 
 
 
-void decx::MemPool_Hv::release()
+decx::MemPool_Hv::~MemPool_Hv()
 {
-    for (int i = 0; i < this->list_length; ++i)
-    {
-        auto chunk_set = this->mem_chunk_set_list.begin() + i;
-        for (int j = 0; j < chunk_set->list_length; ++j)
-        {
-            auto chunk = chunk_set->mem_chunk_list.begin() + j;
-            if (chunk->header_ptr != NULL) {
-                decx::alloc::aligned_free_Hv(chunk->header_ptr);
-            }
+    for (int i = 0; i < this->_chunks.size(); ++i) {
+        decx::MemBlock* _block = this->_chunks[i]._first;
+        while (_block != NULL) {
+            decx::MemBlock* _next = _block->_next;
+            delete _block;
+            _block = _next;
         }
+        this->_chunks[i].release_memory();
+    }
+    while (this->_spare_blocks != NULL) {
+        decx::MemBlock* _next = this->_spare_blocks->_free_next;
+        delete this->_spare_blocks;
+        this->_spare_blocks = _next;
     }
-}
\ No newline at end of file
+    delete this->_failed_block;
+}
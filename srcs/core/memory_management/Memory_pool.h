@@ -10,7 +10,9 @@
 namespace decx 
 {
 
-    decx::MemPool_Hv mem_pool_Hv;
+    decx::MemPool_Hv mem_pool_Hv(false);
+
+    decx::MemPool_Hv mem_pool_Hh(true);
 
     decx::MemPool_Hf mem_pool_Hf;
 
@@ -21,6 +23,40 @@ namespace decx
 namespace de
 {
     _DECX_API_ void release_all_tmp();
+
+    /**
+    * @brief Report the bytes reserved and in use (per size class), the fragmentation, the hit rate
+    * of the thread caches and the allocation counts of the memory pools. The hits counted by the
+    * caches of the other threads are added in batches, so they may lag a little behind.
+    */
+    _DECX_API_ de::MemoryStats GetMemoryStats();
+
+    /**
+    * @brief Set the most bytes the pool keeps reserved. The fully idle chunks beyond it are
+    * returned to the OS (or the device) at once. The allocations beyond it still succeed.
+    *
+    * @param pool One of de::DECX_MEM_POOL
+    * @param max_reserved_bytes (size_t)-1 to disable
+    */
+    _DECX_API_ de::DH SetMemoryPoolLimit(const int pool, const size_t max_reserved_bytes);
+
+    /**
+    * @brief Return the chunks which stay fully idle longer than idle_ms to the OS (or the device).
+    * It is checked when the pool is locked (on the misses of the thread caches), call
+    * de::TrimMemory() to trim an idle process.
+    *
+    * @param pool One of de::DECX_MEM_POOL
+    * @param idle_ms 0 to disable (default)
+    */
+    _DECX_API_ de::DH SetMemoryTrimPolicy(const int pool, const uint idle_ms);
+
+    /**
+    * @brief Return the chunks fully idle for at least idle_ms (0 for all of them) to the OS
+    * (or the device)
+    *
+    * @param pool One of de::DECX_MEM_POOL
+    */
+    _DECX_API_ de::DH TrimMemory(const int pool, const uint idle_ms);
 }
 
 
@@ -30,8 +66,114 @@ void de::release_all_tmp()
 
     decx::mem_pool_Hv.release();
 
+    decx::mem_pool_Hh.release();
+
     decx::mem_pool_Hf.release();
 
     decx::mem_pool_D.release();
 
-}
\ No newline at end of file
+}
+
+
+
+de::MemoryStats de::GetMemoryStats()
+{
+    de::MemoryStats res;
+
+    decx::mem_pool_Hv.get_stats(&res.Host_Virtual);
+
+    decx::mem_pool_Hh.get_stats(&res.Host_Huge);
+
+    decx::mem_pool_Hf.get_stats(&res.Host_Fixed);
+
+    decx::mem_pool_D.get_stats(&res.Device);
+
+    return res;
+}
+
+
+
+de::DH de::SetMemoryPoolLimit(const int pool, const size_t max_reserved_bytes)
+{
+    de::DH handle;
+
+    switch (pool)
+    {
+    case de::Pool_Host_Virtual:
+        decx::mem_pool_Hv.set_limit(max_reserved_bytes);
+        break;
+    case de::Pool_Host_Fixed:
+        decx::mem_pool_Hf.set_limit(max_reserved_bytes);
+        break;
+    case de::Pool_Device:
+        decx::mem_pool_D.set_limit(max_reserved_bytes);
+        break;
+    case de::Pool_Host_Huge:
+        decx::mem_pool_Hh.set_limit(max_reserved_bytes);
+        break;
+    default:
+        decx::MeaninglessFlag(&handle);
+        return handle;
+    }
+
+    decx::Success(&handle);
+    return handle;
+}
+
+
+
+de::DH de::SetMemoryTrimPolicy(const int pool, const uint idle_ms)
+{
+    de::DH handle;
+
+    switch (pool)
+    {
+    case de::Pool_Host_Virtual:
+        decx::mem_pool_Hv.set_trim_policy(idle_ms);
+        break;
+    case de::Pool_Host_Fixed:
+        decx::mem_pool_Hf.set_trim_policy(idle_ms);
+        break;
+    case de::Pool_Device:
+        decx::mem_pool_D.set_trim_policy(idle_ms);
+        break;
+    case de::Pool_Host_Huge:
+        decx::mem_pool_Hh.set_trim_policy(idle_ms);
+        break;
+    default:
+        decx::MeaninglessFlag(&handle);
+        return handle;
+    }
+
+    decx::Success(&handle);
+    return handle;
+}
+
+
+
+de::DH de::TrimMemory(const int pool, const uint idle_ms)
+{
+    de::DH handle;
+
+    switch (pool)
+    {
+    case de::Pool_Host_Virtual:
+        decx::mem_pool_Hv.trim(idle_ms);
+        break;
+    case de::Pool_Host_Fixed:
+        decx::mem_pool_Hf.trim(idle_ms);
+        break;
+    case de::Pool_Device:
+        decx::mem_pool_D.trim(idle_ms);
+        break;
+    case de::Pool_Host_Huge:
+        decx::mem_pool_Hh.trim(idle_ms);
+        break;
+    default:
+        decx::MeaninglessFlag(&handle);
+        return handle;
+    }
+
+    decx::Success(&handle);
+    return handle;
+}
@@ -11,8 +11,6 @@ namespace decx
     class MemChunk_D;
 
 
-    class MemChunkSet_Hv;
-
     class MemChunkSet_Hf;
 
     class MemChunkSet_D;
@@ -23,4 +21,8 @@ namespace decx
     class MemPool_Hf;
 
     class MemPool_D;
+
+
+    template <class _PoolType>
+    class MemCache;
 }
\ No newline at end of file
@@ -0,0 +1,98 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+#ifndef _LATCH_H_
+#define _LATCH_H_
+
+#include "../basic.h"
+#include <atomic>
+
+
+// how many times wait() polls the counter before it blocks on the condition variable
+#define _LATCH_SPIN_ROUNDS_ 256
+
+
+namespace decx
+{
+    class Latch;
+}
+
+
+/**
+* Single-use completion latch, the replacement of an array of std::future<void> in the
+* fork-join callers. Each task calls count_down() once, and the caller blocks in wait() until
+* all of them have arrived. The latch lives on the caller's stack, so wait() does not return
+* before the last count_down() has stopped touching the object.
+*/
+class decx::Latch
+{
+private:
+    std::atomic<int64_t> _count, _departed;
+    const int64_t _total;
+
+    std::mutex _mtx;
+    std::condition_variable _cv;
+    bool _released;
+
+public:
+    Latch(const int64_t count);
+
+
+    // n arrivals at once, for the ones that are known not to come (see decx::ThreadPool::withdraw_job())
+    void count_down(const int64_t n = 1);
+
+
+    void wait();
+};
+
+
+
+decx::Latch::Latch(const int64_t count) : _total(count)
+{
+    this->_count.store(count, std::memory_order_relaxed);
+    this->_departed.store(0, std::memory_order_relaxed);
+    this->_released = false;
+}
+
+
+
+void decx::Latch::count_down(const int64_t n)
+{
+    if (this->_count.fetch_sub(n, std::memory_order_acq_rel) == n) {
+        std::lock_guard<std::mutex> lck(this->_mtx);
+        this->_released = true;
+        this->_cv.notify_all();
+    }
+    // the last access to this object
+    this->_departed.fetch_add(n, std::memory_order_release);
+}
+
+
+
+void decx::Latch::wait()
+{
+    for (int i = 0; i < _LATCH_SPIN_ROUNDS_; ++i) {
+        if (this->_departed.load(std::memory_order_acquire) == this->_total) {
+            return;
+        }
+        _mm_pause();
+    }
+    {
+        std::unique_lock<std::mutex> lck(this->_mtx);
+        while (!this->_released) {
+            this->_cv.wait(lck);
+        }
+    }
+    while (this->_departed.load(std::memory_order_acquire) != this->_total) {
+        std::this_thread::yield();
+    }
+}
+
+
+#endif
@@ -0,0 +1,342 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+#ifndef _PARALLEL_FOR_H_
+#define _PARALLEL_FOR_H_
+
+#include "../basic.h"
+#include "thread_pool.h"
+#include "latch.h"
+
+
+// the least number of __m256 that one chunk of an element-wise kernel processes
+#define _EW_MIN_GRAIN_VEC_ 1024
+
+
+namespace decx
+{
+    enum PARALLEL_PARTITION
+    {
+        /* The range is divided into (at most) one chunk per thread, with the sizes of the chunks
+        * differ by one grain at most. Best for uniform work. */
+        Partition_Static = 0x00,
+
+        /* The range is divided into chunks of one grain, the threads take them one by one. Best
+        * for uneven work. */
+        Partition_Dynamic = 0x01,
+
+        /* The range is divided into one slice per NUMA node (in proportion to the workers on the node),
+        * and each slice is processed by the workers on its node. The split depends only on the range,
+        * so a buffer first touched by a parallel_for of this partition is processed by the same nodes
+        * in the later calls on the same range. The same as Partition_Static on the machines with one
+        * node, and on the 2D ranges. */
+        Partition_NUMA = 0x02
+    };
+
+
+    /**
+    * @brief Run f(_beg, _end) over [begin, end) on the thread pool, and return when all of it is done.
+    * The calling thread takes part in the work. If the range fits in one grain, or the caller is itself
+    * a worker of decx::thread_pool (a nested parallel_for), f is called on the calling thread directly.
+    * @param f : callable as f(const size_t _beg, const size_t _end)
+    * @param grain : The least length of a chunk. The boundaries of the chunks are multiples of grain
+    * (counting from begin)
+    * @param partition : decx::PARALLEL_PARTITION
+    */
+    template <typename _Func>
+    void parallel_for(const size_t begin, const size_t end, const _Func& f,
+        const size_t grain = 1, const int partition = decx::Partition_Static);
+
+
+    /**
+    * @brief 2D version of decx::parallel_for(), the tiles are processed by f(row_beg, row_end, col_beg, col_end).
+    * The static partition cuts the rows first, since the data are stored row by row.
+    * @param rows : The range of rows, [rows.x, rows.y)
+    * @param cols : The range of cols, [cols.x, cols.y)
+    * @param grain : .x -> grain on rows, .y -> grain on cols
+    */
+    template <typename _Func>
+    void parallel_for_2D(const ulong2 rows, const ulong2 cols, const _Func& f,
+        const ulong2 grain = make_ulong2(1, 1), const int partition = decx::Partition_Static);
+}
+
+
+
+namespace decx
+{
+    namespace utils
+    {
+        /**
+        * Shared by all the participants of one parallel_for. The chunks form a grid of
+        * (_grid.y rows, _grid.x cols), chunk c is (c / _grid.x, c % _grid.x). The range of the
+        * chunks are in units of grain, and the units are spread evenly over the grid.
+        */
+        template <typename _Func>
+        struct _parallel_for_ctx
+        {
+            const _Func* _f;
+
+            size_t _beg_r, _end_r, _beg_c, _end_c;
+            size_t _grain_r, _grain_c;
+            size_t _units_r, _units_c;
+            size_t _grid_r, _grid_c;
+
+            size_t _chunk_num;
+            std::atomic<size_t> _next_chunk;
+
+            decx::Latch* _latch;
+
+
+            void _exec_chunk(const size_t c) const;
+
+            // take chunks until there is none left
+            void _run();
+        };
+
+
+        template <typename _Func>
+        static void _THREAD_FUNCTION_ _parallel_for_task(decx::utils::_parallel_for_ctx<_Func>* ctx);
+
+
+        // the entry of the decx::ForkJob of a parallel_for
+        template <typename _Func>
+        static void _parallel_for_job_entry(void* ctx) { decx::utils::_parallel_for_task((decx::utils::_parallel_for_ctx<_Func>*)ctx); }
+
+
+        template <typename _Func>
+        struct _range_1D_adaptor
+        {
+            const _Func* _f;
+
+            void operator()(const size_t _beg_r, const size_t _end_r, const size_t _beg_c, const size_t _end_c) const {
+                (*this->_f)(_beg_c, _end_c);
+            }
+        };
+
+
+        template <typename _Func>
+        static void _parallel_for_launch(decx::utils::_parallel_for_ctx<_Func>* ctx, const size_t thread_num);
+
+
+        template <typename _Func>
+        static void _parallel_for_launch_NUMA(const size_t begin, const size_t end, const _Func* f, const size_t grain);
+    }
+}
+
+
+
+template <typename _Func>
+void decx::utils::_parallel_for_ctx<_Func>::_exec_chunk(const size_t c) const
+{
+    const size_t _r = c / this->_grid_c, _c = c % this->_grid_c;
+
+    const size_t _r0 = this->_beg_r + (_r * this->_units_r / this->_grid_r) * this->_grain_r;
+    const size_t _r1 = this->_beg_r + ((_r + 1) * this->_units_r / this->_grid_r) * this->_grain_r;
+    const size_t _c0 = this->_beg_c + (_c * this->_units_c / this->_grid_c) * this->_grain_c;
+    const size_t _c1 = this->_beg_c + ((_c + 1) * this->_units_c / this->_grid_c) * this->_grain_c;
+
+    (*this->_f)(_r0, _r1 < this->_end_r ? _r1 : this->_end_r,
+                _c0, _c1 < this->_end_c ? _c1 : this->_end_c);
+}
+
+
+
+template <typename _Func>
+void decx::utils::_parallel_for_ctx<_Func>::_run()
+{
+    size_t c = this->_next_chunk.fetch_add(1, std::memory_order_relaxed);
+    while (c < this->_chunk_num) {
+        this->_exec_chunk(c);
+        c = this->_next_chunk.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+
+
+template <typename _Func>
+static void _THREAD_FUNCTION_ decx::utils::_parallel_for_task(decx::utils::_parallel_for_ctx<_Func>* ctx)
+{
+    ctx->_run();
+    ctx->_latch->count_down();
+}
+
+
+
+template <typename _Func>
+static void decx::utils::_parallel_for_launch(decx::utils::_parallel_for_ctx<_Func>* ctx, const size_t thread_num)
+{
+    if (ctx->_chunk_num == 0) {
+        return;
+    }
+    // Nested in a task of the pool, the range runs on the calling worker alone. The latch counts the
+    // helpers, not the chunks, so if all the workers waited on it here no one would be left to run them
+    if (ctx->_chunk_num == 1 || thread_num < 2 || decx::_current_pool == &decx::thread_pool) {
+        for (size_t c = 0; c < ctx->_chunk_num; ++c) {
+            ctx->_exec_chunk(c);
+        }
+        return;
+    }
+
+    // the calling thread is one of the participants
+    const size_t _helper_num = (ctx->_chunk_num < thread_num ? ctx->_chunk_num : thread_num) - 1;
+
+    ctx->_next_chunk.store(0, std::memory_order_relaxed);
+    decx::Latch _latch(_helper_num);
+    ctx->_latch = &_latch;
+
+    // ctx is published once, the helpers claim the seats of the job. The slot is taken only when
+    // another thread outside the pool runs a parallel_for at the same time, a task per helper then
+    decx::ForkJob _job(decx::utils::_parallel_for_job_entry<_Func>, ctx);
+    if (decx::thread_pool.publish_job(&_job, (int64_t)_helper_num)) {
+        ctx->_run();
+        // the helpers which have not come by now find no chunk left, they are not waited for
+        const int64_t _unclaimed = decx::thread_pool.withdraw_job(&_job);
+        if (_unclaimed > 0) {
+            _latch.count_down(_unclaimed);
+        }
+    }
+    else {
+        for (size_t i = 0; i < _helper_num; ++i) {
+            decx::thread_pool.register_task_detached(decx::utils::_parallel_for_task<_Func>, ctx);
+        }
+        ctx->_run();
+    }
+
+    _latch.wait();
+}
+
+
+
+template <typename _Func>
+static void decx::utils::_parallel_for_launch_NUMA(const size_t begin, const size_t end, const _Func* f, const size_t grain)
+{
+    const size_t thread_num = decx::thread_pool.get_current_thread_num();
+    const int node_num = decx::utils::get_cpu_topology().numa_node_num < _MAX_NUMA_NODE_NUM_ ?
+        decx::utils::get_cpu_topology().numa_node_num : _MAX_NUMA_NODE_NUM_;
+
+    // one context per node, the slices are assigned by the number of the workers on each node
+    decx::utils::_parallel_for_ctx<_Func> ctx[_MAX_NUMA_NODE_NUM_];
+    size_t _node_thr[_MAX_NUMA_NODE_NUM_];
+
+    const size_t units = decx::utils::ceil<size_t>(end - begin, grain);
+    size_t _task_num = 0, _thr_sum = 0;
+
+    for (int node = 0; node < node_num; ++node) {
+        _node_thr[node] = decx::thread_pool.get_node_worker_num(node);
+    }
+    for (int node = 0; node < node_num; ++node) {
+        decx::utils::_parallel_for_ctx<_Func>* _ctx = ctx + node;
+        const size_t _u0 = (_thr_sum * units) / thread_num;
+        _thr_sum += _node_thr[node];
+        const size_t _u1 = (_thr_sum * units) / thread_num;
+
+        _ctx->_f = f;
+        _ctx->_beg_r = 0;             _ctx->_end_r = 1;
+        _ctx->_grain_r = 1;           _ctx->_units_r = 1;           _ctx->_grid_r = 1;
+        _ctx->_beg_c = begin + _u0 * grain;
+        _ctx->_end_c = begin + _u1 * grain < end ? begin + _u1 * grain : end;
+        _ctx->_grain_c = grain;
+        _ctx->_units_c = _u1 - _u0;
+        _ctx->_grid_c = _ctx->_units_c < _node_thr[node] ? _ctx->_units_c : _node_thr[node];
+        _ctx->_chunk_num = _ctx->_grid_c;
+        _ctx->_next_chunk.store(0, std::memory_order_relaxed);
+
+        _task_num += _ctx->_chunk_num;
+    }
+
+    // the calling thread only waits, it may be on any node
+    decx::Latch _latch(_task_num);
+    for (int node = 0; node < node_num; ++node) {
+        ctx[node]._latch = &_latch;
+        for (size_t i = 0; i < ctx[node]._chunk_num; ++i) {
+            decx::thread_pool.register_task_on_node(node, decx::utils::_parallel_for_task<_Func>, ctx + node);
+        }
+    }
+    _latch.wait();
+}
+
+
+
+template <typename _Func>
+void decx::parallel_for(const size_t begin, const size_t end, const _Func& f,
+    const size_t grain, const int partition)
+{
+    if (end <= begin) {
+        return;
+    }
+    decx::utils::_range_1D_adaptor<_Func> _adaptor;
+    _adaptor._f = &f;
+
+    const size_t thread_num = decx::thread_pool.get_current_thread_num();
+    const size_t _grain = grain == 0 ? 1 : grain;
+
+    // nested in a task of the pool, the range is run inline, see _parallel_for_launch()
+    if (partition == decx::Partition_NUMA && decx::utils::get_cpu_topology().numa_node_num > 1
+        && decx::_current_pool != &decx::thread_pool
+        && decx::utils::ceil<size_t>(end - begin, _grain) >= thread_num && thread_num > 1) {
+        decx::utils::_parallel_for_launch_NUMA(begin, end, &_adaptor, _grain);
+        return;
+    }
+
+    decx::utils::_parallel_for_ctx<decx::utils::_range_1D_adaptor<_Func>> ctx;
+    ctx._f = &_adaptor;
+    ctx._beg_r = 0;             ctx._end_r = 1;
+    ctx._grain_r = 1;           ctx._units_r = 1;           ctx._grid_r = 1;
+    ctx._beg_c = begin;         ctx._end_c = end;
+    ctx._grain_c = _grain;
+    ctx._units_c = decx::utils::ceil<size_t>(end - begin, _grain);
+
+    if (partition == decx::Partition_Dynamic) {
+        ctx._grid_c = ctx._units_c;
+    }
+    else {
+        ctx._grid_c = ctx._units_c < thread_num ? ctx._units_c : thread_num;
+    }
+    ctx._chunk_num = ctx._grid_c;
+
+    decx::utils::_parallel_for_launch(&ctx, thread_num);
+}
+
+
+
+template <typename _Func>
+void decx::parallel_for_2D(const ulong2 rows, const ulong2 cols, const _Func& f,
+    const ulong2 grain, const int partition)
+{
+    if (rows.y <= rows.x || cols.y <= cols.x) {
+        return;
+    }
+    const size_t thread_num = decx::thread_pool.get_current_thread_num();
+
+    decx::utils::_parallel_for_ctx<_Func> ctx;
+    ctx._f = &f;
+    ctx._beg_r = rows.x;        ctx._end_r = rows.y;
+    ctx._beg_c = cols.x;        ctx._end_c = cols.y;
+    ctx._grain_r = grain.x == 0 ? 1 : grain.x;
+    ctx._grain_c = grain.y == 0 ? 1 : grain.y;
+    ctx._units_r = decx::utils::ceil<size_t>(rows.y - rows.x, ctx._grain_r);
+    ctx._units_c = decx::utils::ceil<size_t>(cols.y - cols.x, ctx._grain_c);
+
+    if (partition == decx::Partition_Dynamic) {
+        ctx._grid_r = ctx._units_r;
+        ctx._grid_c = ctx._units_c;
+    }
+    else {
+        // rows first, then cut the cols only if there are not enough rows for all the threads
+        ctx._grid_r = ctx._units_r < thread_num ? ctx._units_r : thread_num;
+        const size_t _grid_c = decx::utils::ceil<size_t>(thread_num, ctx._grid_r);
+        ctx._grid_c = ctx._units_c < _grid_c ? ctx._units_c : _grid_c;
+    }
+    ctx._chunk_num = ctx._grid_r * ctx._grid_c;
+
+    decx::utils::_parallel_for_launch(&ctx, thread_num);
+}
+
+
+#endif
@@ -8,113 +8,425 @@
 */
 
 #ifndef _TASK_QUEUE_H_
-#define _TASK_QUEUE_H_  
+#define _TASK_QUEUE_H_
 
 #include "../basic.h"
 #include <queue>
+#include <atomic>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+
+
+// bytes of the inline storage of decx::Task, the bound callables larger than this are put on heap
+#define _TASK_INLINE_STORAGE_ 64
+
+// the initial and the maximal capacity (in tasks) of the inbox of each worker
+#define _TASK_QUEUE_INIT_CAPACITY_ 64
+#define _TASK_QUEUE_MAX_CAPACITY_ 4096
+
+// how many free tasks each thread keeps for itself, half of them are moved at a time
+#define _TASK_CACHE_SIZE_ 64
+
+// how many tasks are constructed at a time when there is no free task left
+#define _TASK_SLAB_SIZE_ 256
 
 
 namespace decx
 {
+    class Task;
+    class TaskAllocator;
     class ThreadTaskQueue;
 }
 
 
-typedef std::packaged_task<void()> Task;
 
+namespace decx
+{
+    namespace utils
+    {
+        // the callable and its arguments, the arguments are passed to the callable as lvalues (same as std::bind)
+        template <class FuncType, class ...Args>
+        struct _bound_call
+        {
+            std::tuple<typename std::decay<FuncType>::type, typename std::decay<Args>::type...> _pack;
 
-class decx::ThreadTaskQueue
+            template <class _F, class ..._A>
+            _bound_call(_F&& f, _A&& ...args) : _pack(std::forward<_F>(f), std::forward<_A>(args)...) {}
+
+
+            template <size_t ...I>
+            void _call(std::index_sequence<I...>) { std::get<0>(this->_pack)(std::get<I + 1>(this->_pack)...); }
+
+
+            static void _invoke(void* _this) {
+                ((_bound_call*)_this)->_call(std::make_index_sequence<sizeof...(Args)>());
+            }
+
+            static void _destroy(void* _this) { ((_bound_call*)_this)->~_bound_call(); }
+
+            static void _destroy_heap(void* _this) { delete (_bound_call*)_this; }
+        };
+    }
+}
+
+
+
+/**
+* Type-erased void() callable with inline storage. The bound state is constructed in
+* this->_storage when it fits (the callables registered in DECX are kernel function pointers
+* with a handful of pointer / int2 arguments, which always fit), so no heap allocation is needed.
+* The Task objects themselves are recycled by decx::TaskAllocator.
+*/
+class decx::Task
 {
 private:
-    void move_ahead();
+    typedef void (*_call_fn)(void*);
+
+    alignas(16) uchar _storage[_TASK_INLINE_STORAGE_];
+
+    void* _callable;
+    _call_fn _invoke, _destroy;
 
 public:
-    // private variables for each thread
-    std::mutex _mtx;
-    std::condition_variable _cv;
-    Task* _task_queue,
-        * begin_ptr,
-        * end_ptr;
+    // link of the free lists of decx::TaskAllocator
+    decx::Task* _next;
 
-    int _task_num;
-    bool _shutdown;
 
-    ThreadTaskQueue();
+    Task();
+
 
+    /**
+    * @brief Bind the callable and its arguments to this task. The previous one (if any) is released.
+    */
     template <class FuncType, class ...Args>
-    std::future<void> emplace_back(FuncType&& f, Args&& ...args);
+    void bind(FuncType&& f, Args&& ...args);
 
-    void pop_back();
 
-    void pop_front();
+    void operator()() { this->_invoke(this->_callable); }
 
 
-    ~ThreadTaskQueue();
+    // release the bound state
+    void reset();
+
+
+    ~Task() { this->reset(); }
 };
 
 
 
-void decx::ThreadTaskQueue::move_ahead()
+decx::Task::Task()
 {
-    int idle_size = (int)(this->begin_ptr - this->_task_queue);
+    this->_callable = NULL;
+    this->_invoke = NULL;
+    this->_destroy = NULL;
+    this->_next = NULL;
+}
+
+
 
-    memcpy(this->_task_queue, this->begin_ptr, idle_size * sizeof(Task));
-    if (this->_task_num - idle_size > 0)
-        memcpy(this->_task_queue + idle_size, this->begin_ptr + idle_size, (this->_task_num - idle_size) * sizeof(Task));
+template <class FuncType, class ...Args>
+void decx::Task::bind(FuncType&& f, Args&& ...args)
+{
+    typedef decx::utils::_bound_call<FuncType, Args...> _bound_type;
+
+    this->reset();
+
+    if (sizeof(_bound_type) <= _TASK_INLINE_STORAGE_ && alignof(_bound_type) <= 16) {
+        this->_callable = new(this->_storage) _bound_type(std::forward<FuncType>(f), std::forward<Args>(args)...);
+        this->_destroy = _bound_type::_destroy;
+    }
+    else {
+        this->_callable = new _bound_type(std::forward<FuncType>(f), std::forward<Args>(args)...);
+        this->_destroy = _bound_type::_destroy_heap;
+    }
+    this->_invoke = _bound_type::_invoke;
 }
 
 
 
-decx::ThreadTaskQueue::ThreadTaskQueue() {
-    this->_task_queue = (Task*)malloc(64 * sizeof(Task));
-    this->begin_ptr = this->_task_queue;
-    this->end_ptr = this->_task_queue + 64;
+void decx::Task::reset()
+{
+    if (this->_callable != NULL) {
+        this->_destroy(this->_callable);
+        this->_callable = NULL;
+    }
+}
 
-    this->_shutdown = false;
-    this->_task_num = 0;
+
+
+
+namespace decx
+{
+    namespace utils
+    {
+        // the free tasks owned by one thread, given back to decx::TaskAllocator when the thread exits
+        struct _task_cache
+        {
+            decx::Task* _head;
+            int _num;
+
+            _task_cache() : _head(NULL), _num(0) {}
+
+            ~_task_cache();
+        };
+    }
 }
 
 
+/**
+* Recycles decx::Task objects. Each thread takes tasks from and gives them back to its own
+* cache, without locking; only when the cache is empty (or full) half of _TASK_CACHE_SIZE_ tasks
+* are moved from (or to) the shared free list under the lock. The registering threads take tasks
+* and the workers give them back, so the tasks flow through the shared list in batches. New tasks
+* are constructed (_TASK_SLAB_SIZE_ at a time) only when the shared list is empty, so once the number
+* of tasks in flight stops growing, no more heap allocation is made.
+*/
+class decx::TaskAllocator
+{
+private:
+    std::mutex _mtx;
+    decx::Task* _free_list;
 
-template <class FuncType, class ...Args>
-std::future<void> decx::ThreadTaskQueue::emplace_back(FuncType&& f, Args&& ...args) {
-    new (this->begin_ptr + this->_task_num)Task(
-        std::bind(std::forward<FuncType>(f), std::forward<Args>(args)...));
+    std::vector<decx::Task*> _slabs;
 
-    ++this->_task_num;
-    return (this->begin_ptr + this->_task_num - 1)->get_future();
+    // move (at most) _num tasks from the shared list to the cache, called with this->_mtx locked
+    void _refill(decx::utils::_task_cache* cache, const int _num);
+
+public:
+    TaskAllocator();
+
+
+    decx::Task* allocate();
+
+    /**
+    * @brief Release the bound state of the task and recycle it
+    */
+    void deallocate(decx::Task* _task);
+
+
+    // give all the tasks in the cache back to the shared list
+    void _return_cache(decx::utils::_task_cache* cache);
+
+
+    ~TaskAllocator();
+};
+
+
+namespace decx
+{
+    decx::TaskAllocator task_allocator;
+
+    thread_local decx::utils::_task_cache _tl_task_cache;
 }
 
 
 
-void decx::ThreadTaskQueue::pop_back() {
-    --this->_task_num;
+decx::TaskAllocator::TaskAllocator()
+{
+    this->_free_list = NULL;
 }
 
 
 
-void decx::ThreadTaskQueue::pop_front()
+void decx::TaskAllocator::_refill(decx::utils::_task_cache* cache, const int _num)
 {
-    if (this->_task_num > 1) {
-        if (this->begin_ptr + 1 == this->end_ptr) {
-            this->move_ahead();
-            this->begin_ptr = this->_task_queue;
+    if (this->_free_list == NULL) {
+        decx::Task* _slab = new decx::Task[_TASK_SLAB_SIZE_];
+        this->_slabs.push_back(_slab);
+        for (int i = 0; i < _TASK_SLAB_SIZE_; ++i) {
+            _slab[i]._next = this->_free_list;
+            this->_free_list = _slab + i;
         }
-        else {
-            ++this->begin_ptr;
+    }
+    for (int i = 0; i < _num && this->_free_list != NULL; ++i) {
+        decx::Task* _task = this->_free_list;
+        this->_free_list = _task->_next;
+        _task->_next = cache->_head;
+        cache->_head = _task;
+        ++cache->_num;
+    }
+}
+
+
+
+decx::Task* decx::TaskAllocator::allocate()
+{
+    decx::utils::_task_cache* cache = &decx::_tl_task_cache;
+
+    if (cache->_head == NULL) {
+        std::lock_guard<std::mutex> lck(this->_mtx);
+        this->_refill(cache, _TASK_CACHE_SIZE_ / 2);
+    }
+    decx::Task* _task = cache->_head;
+    cache->_head = _task->_next;
+    --cache->_num;
+    return _task;
+}
+
+
+
+void decx::TaskAllocator::deallocate(decx::Task* _task)
+{
+    decx::utils::_task_cache* cache = &decx::_tl_task_cache;
+
+    _task->reset();
+    _task->_next = cache->_head;
+    cache->_head = _task;
+
+    if (++cache->_num > _TASK_CACHE_SIZE_) {
+        // keep the newest half (hot in cache), give the rest back
+        decx::Task* _last_kept = cache->_head;
+        for (int i = 1; i < _TASK_CACHE_SIZE_ / 2; ++i) {
+            _last_kept = _last_kept->_next;
+        }
+        decx::Task* _tail = _last_kept;
+        while (_tail->_next != NULL) {
+            _tail = _tail->_next;
         }
+
+        std::lock_guard<std::mutex> lck(this->_mtx);
+        _tail->_next = this->_free_list;
+        this->_free_list = _last_kept->_next;
+        _last_kept->_next = NULL;
+        cache->_num = _TASK_CACHE_SIZE_ / 2;
     }
-    else {
-        this->begin_ptr = this->_task_queue;
+}
+
+
+
+void decx::TaskAllocator::_return_cache(decx::utils::_task_cache* cache)
+{
+    if (cache->_head == NULL) {
+        return;
+    }
+    decx::Task* _tail = cache->_head;
+    while (_tail->_next != NULL) {
+        _tail = _tail->_next;
+    }
+
+    std::lock_guard<std::mutex> lck(this->_mtx);
+    _tail->_next = this->_free_list;
+    this->_free_list = cache->_head;
+    cache->_head = NULL;
+    cache->_num = 0;
+}
+
+
+
+decx::TaskAllocator::~TaskAllocator()
+{
+    for (int i = 0; i < this->_slabs.size(); ++i) {
+        delete[] this->_slabs[i];
+    }
+}
+
+
+
+decx::utils::_task_cache::~_task_cache()
+{
+    decx::task_allocator._return_cache(this);
+}
+
+
+
+
+/**
+* The inbox of each worker thread. Tasks registered from outside the pool are put here
+* (FIFO), and the owner worker moves them into its work-stealing deque. Other workers can
+* also take tasks from here when they are idle.
+* The ring starts with _TASK_QUEUE_INIT_CAPACITY_ slots and doubles when it is full, up to
+* _TASK_QUEUE_MAX_CAPACITY_ slots.
+*/
+class decx::ThreadTaskQueue
+{
+public:
+    std::mutex _mtx;
+    decx::Task** _task_queue;
+
+    int _front, _capacity;
+
+    // modified with this->_mtx locked, read without locking by the idle workers as a hint
+    std::atomic<int> _task_num;
+
+    ThreadTaskQueue();
+
+    /**
+    * @brief Should be called with this->_mtx locked
+    * @return false if the queue is full and has reached _TASK_QUEUE_MAX_CAPACITY_
+    */
+    bool push_back(decx::Task* _task);
+
+    /**
+    * @brief Should be called with this->_mtx locked
+    * @return NULL if the queue is empty
+    */
+    decx::Task* pop_front();
+
+
+    ~ThreadTaskQueue();
+};
+
+
+
+decx::ThreadTaskQueue::ThreadTaskQueue() {
+    this->_task_queue = (decx::Task**)malloc(_TASK_QUEUE_INIT_CAPACITY_ * sizeof(decx::Task*));
+    this->_front = 0;
+    this->_capacity = _TASK_QUEUE_INIT_CAPACITY_;
+    this->_task_num.store(0, std::memory_order_relaxed);
+}
+
+
+
+bool decx::ThreadTaskQueue::push_back(decx::Task* _task)
+{
+    const int _num = this->_task_num.load(std::memory_order_relaxed);
+    if (_num == this->_capacity) {
+        if (this->_capacity == _TASK_QUEUE_MAX_CAPACITY_) {
+            return false;
+        }
+        decx::Task** _new_queue = (decx::Task**)malloc(this->_capacity * 2 * sizeof(decx::Task*));
+        if (_new_queue == NULL) {
+            return false;
+        }
+        // unroll the ring to the front of the new one
+        for (int i = 0; i < _num; ++i) {
+            _new_queue[i] = this->_task_queue[(this->_front + i) % this->_capacity];
+        }
+        free(this->_task_queue);
+        this->_task_queue = _new_queue;
+        this->_front = 0;
+        this->_capacity *= 2;
     }
-    --this->_task_num;
+    this->_task_queue[(this->_front + _num) % this->_capacity] = _task;
+    this->_task_num.store(_num + 1, std::memory_order_release);
+    return true;
+}
+
+
+
+decx::Task* decx::ThreadTaskQueue::pop_front()
+{
+    const int _num = this->_task_num.load(std::memory_order_relaxed);
+    if (_num == 0) {
+        return NULL;
+    }
+    decx::Task* res = this->_task_queue[this->_front];
+    this->_front = (this->_front + 1) % this->_capacity;
+    this->_task_num.store(_num - 1, std::memory_order_release);
+    return res;
 }
 
 
 
 decx::ThreadTaskQueue::~ThreadTaskQueue() {
+    // the futures of the tasks never executed get std::future_errc::broken_promise
+    decx::Task* _left = NULL;
+    while ((_left = this->pop_front()) != NULL) {
+        decx::task_allocator.deallocate(_left);
+    }
     free(this->_task_queue);
 }
 
 
-#endif
\ No newline at end of file
+#endif
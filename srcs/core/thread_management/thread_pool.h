@@ -14,32 +14,133 @@
 
 #include "../basic.h"
 #include "task_queue.h"
+#include "work_stealing_deque.h"
+#include "../configs/cpu_topology.h"
 
+// the least number of workers a pool can hold, the pools can always grow to the number of the logical processors
 #define MAX_THREAD_NUM 16
 
+// the default idle policy (de::cpu::Idle_Balanced) : spin for _WS_IDLE_SPIN_US_ microseconds, then
+// yield _WS_IDLE_YIELD_ROUNDS_ times, then park on the condition variable
+#define _WS_IDLE_SPIN_US_ 20
+#define _WS_IDLE_YIELD_ROUNDS_ 64
+
+// how many _mm_pause() a spinning worker executes between two checks of the clock
+#define _WS_IDLE_SPIN_BATCH_ 64
+
 
 
-// 用一个mutex管理一个task_queue，用另一个mutex来wait()
 namespace decx
 {
     class ThreadPool;
-}
 
 
+    /**
+    * A fork-join job published in the one job slot of a pool (see ThreadPool::publish_job()). Each
+    * worker that claims one of the seats calls _entry(_arg) once, the caller of the job runs its own
+    * share and withdraws the job, the seats left unclaimed are returned to it.
+    */
+    struct ForkJob
+    {
+        void (*_entry)(void*);
+        void* _arg;
+        std::atomic<int64_t> _seats;
+
+        ForkJob(void (*entry)(void*), void* arg) : _entry(entry), _arg(arg) { this->_seats.store(0, std::memory_order_relaxed); }
+    };
+}
+
 
+/**
+* Work-stealing thread pool.
+*
+* Each worker owns an inbox (decx::ThreadTaskQueue, mutex protected) and a lock-free
+* decx::WorkStealingDeque. The scheduling rules are:
+*   1. register_task() called from outside the pool puts the task into the inbox of the workers
+*      in round-robin order. If every inbox is full (_TASK_QUEUE_MAX_CAPACITY_ tasks in each), the task
+*      is executed on the calling thread.
+*   2. register_task() called from a worker of this pool pushes the task to the bottom of its own
+*      deque, without locking.
+*   3. A worker looking for work moves its whole inbox into its deque, then pops from the bottom
+*      of its deque (LIFO). If its deque is empty, it visits the other workers in random order,
+*      stealing from the top of their deques (FIFO) and from their inboxes.
+*   4. Before all of the above, a worker claims a seat of the job in the job slot, if there is one
+*      (see publish_job()). decx::parallel_for() publishes its context there once, instead of
+*      registering one task per helper.
+*   5. A worker that finds nothing spins (with _mm_pause) for a window of time, then yields for
+*      some rounds, then parks until a task is registered. The window and the rounds are the idle
+*      policy, see set_idle_policy() and de::cpu::SetIdlePolicy().
+*
+* Placement: worker i is pinned to the i-th logical processor of decx::CPU_Topology::_placement,
+* so that the physical cores are used before the SMT siblings, and the workers are spread
+* over the NUMA nodes. The thieves visit the workers on their own node before the others.
+* register_task_on_node() puts a task into the inbox of a worker on the given node, this is how
+* decx::parallel_for() keeps a slice of data with the node that first touched it (see
+* decx::Partition_NUMA).
+*
+* Fairness and latency: the tasks registered by one caller are spread over all inboxes, and an
+* idle worker never stays idle while any queue in the pool is non-empty, so a task waits at most
+* for the task currently running on its worker, or for the first worker which becomes idle. The
+* order among tasks registered by the same caller is not guaranteed, which is fine for the
+* fork-join pattern that all the callers in DECX use (register N tasks, then wait for all of
+* them). A parked worker costs one futex wake (tens of microseconds) to resume, a spinning one
+* starts the task in well below a microsecond but keeps its core busy.
+*/
 class decx::ThreadPool
 {
 private:
     std::thread* _thr_list;
 
     decx::ThreadTaskQueue* _task_schd;
+    decx::WorkStealingDeque<decx::Task>* _deques;
+
+    // protects the parking of idle workers
     std::mutex _mtx;
+    std::condition_variable _cv;
+
+    // number of tasks that are registered but not taken by any worker yet
+    std::atomic<int64_t> _pending;
+    std::atomic<int> _sleeping;
+    std::atomic<uint> _next_queue;
+    std::atomic<bool> _shutdown;
 
-    size_t _max_thr_num, current_thread_num;
+    // the job slot, and the workers reading it right now (withdraw_job() waits for them to leave)
+    std::atomic<decx::ForkJob*> _job;
+    std::atomic<int> _job_visitors;
+
+    size_t _max_thr_num;
+    std::atomic<size_t> current_thread_num;
     bool _all_shutdown;
 
+    // the idle policy
+    std::atomic<uint> _idle_spin_us, _idle_yield_rounds;
+    size_t _logical_cpu_num;
+
+    // the NUMA node of each worker
+    int* _worker_node;
+    std::atomic<uint> _next_queue_on_node[_MAX_NUMA_NODE_NUM_];
+
+    // set up the queues (and the node) of the workers [_beg, _end) before they start
+    void _init_worker_slots(const size_t _beg, const size_t _end);
+
+    // pick the inbox for the next task registered from outside the pool (round-robin)
     void _find_task_queue_id(size_t* id);
 
+
+    void _submit(decx::Task* _task);
+
+    /**
+    * @brief Look for a task in the own inbox, the own deque and then in the other workers'
+    * @return NULL if there is nothing to do
+    */
+    decx::Task* _acquire_task(const size_t pool_id, uint* seed);
+
+    /**
+    * @brief Claim a seat of the job in the job slot and run it
+    * @return false if there is no job or no seat left
+    */
+    bool _try_run_job();
+
     // main_loop callback function running on each thread
     void _thread_main_loop(const size_t pool_id);
 
@@ -54,6 +155,42 @@ public:
     std::future<void> register_task(FuncType&& f, Args&& ...args);
 
 
+    /**
+    * @brief Same as register_task(), but no future is returned. The caller has to synchronize
+    * with the task by itself (e.g. by a decx::Latch). This path does not allocate on heap
+    * once the pool is warmed up, while register_task() always allocates the shared state of
+    * the future.
+    */
+    template <class FuncType, class ...Args>
+    void register_task_detached(FuncType&& f, Args&& ...args);
+
+
+    /**
+    * @brief Register a task to the workers on the NUMA node (see decx::CPU_Topology). No future is
+    * returned, same as register_task_detached(). The task can still be stolen by the workers on
+    * the other nodes when they run out of work.
+    * @param node : The NUMA node, (compacted) 0, 1, ... If there is no worker on the node, the
+    * task is registered the same way as register_task_detached()
+    */
+    template <class FuncType, class ...Args>
+    void register_task_on_node(const int node, FuncType&& f, Args&& ...args);
+
+
+    /**
+    * @brief Publish job with seats seats for the workers, at the cost of a few atomics however many
+    * seats there are. The caller has to withdraw_job() it before job goes out of scope.
+    * @return false if the slot is taken by the job of another thread, nothing is published then
+    */
+    bool publish_job(decx::ForkJob* job, const int64_t seats);
+
+
+    /**
+    * @brief Take the job out of the slot. No worker claims a seat of it after this returns.
+    * @return The number of the seats no worker has claimed
+    */
+    int64_t withdraw_job(decx::ForkJob* job);
+
+
     template <class FuncType, class ...Args>
     std::future<void> register_task_by_id(size_t id, FuncType&& f, Args&& ...args);
 
@@ -61,6 +198,23 @@ public:
     void add_thread(const int add_thread_num);
 
 
+    size_t get_current_thread_num() const { return this->current_thread_num.load(); }
+
+
+    int get_worker_node(const size_t id) const { return this->_worker_node[id]; }
+
+
+    /**
+    * @brief Set how an idle worker waits for the next task. It spins for spin_us microseconds
+    * first, then yields yield_rounds times, then parks. Takes effect the next time a worker goes idle.
+    */
+    void set_idle_policy(const uint spin_us, const uint yield_rounds);
+
+
+    // number of the workers (running now) on the NUMA node
+    size_t get_node_worker_num(const int node) const;
+
+
     void TerminateAllThreads();
 
 
@@ -69,68 +223,257 @@ public:
 
 
 
+namespace decx
+{
+    // the pool (and the slot in it) which the calling thread works for, NULL for non-worker threads
+    thread_local decx::ThreadPool* _current_pool = NULL;
+    thread_local size_t _current_worker_id = 0;
+}
+
+
 
 void decx::ThreadPool::_find_task_queue_id(size_t* id)
 {
-    size_t task_que_len = this->current_thread_num;
-    size_t res_id = 0,
-        least_len = (this->_task_schd)->_task_num;
+    *id = this->_next_queue.fetch_add(1, std::memory_order_relaxed) % this->current_thread_num.load();
+}
 
-    if (least_len != 0) {
-        for (size_t i = 1; i < task_que_len; ++i)
-        {
-            decx::ThreadTaskQueue* tmp_iter = this->_task_schd + i;
 
-            size_t current_len = tmp_iter->_task_num;
 
-            if (current_len != 0) {
-                if (current_len < least_len)
-                    least_len = current_len;
-            }
-            else {
-                least_len = i;
-                break;
+void decx::ThreadPool::_submit(decx::Task* _task)
+{
+    this->_pending.fetch_add(1);
+
+    if (decx::_current_pool == this) {
+        this->_deques[decx::_current_worker_id].push_bottom(_task);
+    }
+    else {
+        const size_t _thr_num = this->current_thread_num.load();
+        size_t id;
+        this->_find_task_queue_id(&id);
+
+        bool _pushed = false;
+        for (size_t i = 0; i < _thr_num && !_pushed; ++i) {
+            decx::ThreadTaskQueue* tmp_task_que = &(this->_task_schd[(id + i) % _thr_num]);
+            std::lock_guard<std::mutex> lck(tmp_task_que->_mtx);
+            _pushed = tmp_task_que->push_back(_task);
+        }
+        if (!_pushed) {
+            // every inbox is full, run it on the calling thread
+            this->_pending.fetch_sub(1);
+            (*_task)();
+            decx::task_allocator.deallocate(_task);
+            return;
+        }
+    }
+
+    if (this->_sleeping.load() > 0) {
+        std::lock_guard<std::mutex> lck(this->_mtx);
+        this->_cv.notify_one();
+    }
+}
+
+
+
+bool decx::ThreadPool::_try_run_job()
+{
+    if (this->_job.load(std::memory_order_relaxed) == NULL) {
+        return false;
+    }
+
+    this->_job_visitors.fetch_add(1);
+    decx::ForkJob* _job = this->_job.load();
+    const bool _claimed = _job != NULL && _job->_seats.fetch_sub(1) > 0;
+    // the job may be gone once the visitor has left, _arg is kept alive by the latch of the caller
+    void (*_entry)(void*) = _claimed ? _job->_entry : NULL;
+    void* _arg = _claimed ? _job->_arg : NULL;
+    this->_job_visitors.fetch_sub(1);
+
+    if (!_claimed) {
+        return false;
+    }
+    this->_pending.fetch_sub(1);
+    _entry(_arg);
+    return true;
+}
+
+
+
+bool decx::ThreadPool::publish_job(decx::ForkJob* job, const int64_t seats)
+{
+    job->_seats.store(seats);
+    // counted before it is visible, so that no claim takes _pending below the real count
+    this->_pending.fetch_add(seats);
+
+    decx::ForkJob* _expected = NULL;
+    if (!this->_job.compare_exchange_strong(_expected, job)) {
+        this->_pending.fetch_sub(seats);
+        return false;
+    }
+    if (this->_sleeping.load() > 0) {
+        std::lock_guard<std::mutex> lck(this->_mtx);
+        this->_cv.notify_all();
+    }
+    return true;
+}
+
+
+
+int64_t decx::ThreadPool::withdraw_job(decx::ForkJob* job)
+{
+    this->_job.store(NULL);
+    const int64_t _left = job->_seats.exchange(0);
+    // a visitor that read the slot before it was cleared may still be claiming
+    while (this->_job_visitors.load() != 0) {
+        _mm_pause();
+    }
+
+    const int64_t _unclaimed = _left > 0 ? _left : 0;
+    this->_pending.fetch_sub(_unclaimed);
+    return _unclaimed;
+}
+
+
+
+decx::Task* decx::ThreadPool::_acquire_task(const size_t pool_id, uint* seed)
+{
+    decx::WorkStealingDeque<decx::Task>* _local = this->_deques + pool_id;
+    decx::ThreadTaskQueue* _inbox = this->_task_schd + pool_id;
+
+    if (_inbox->_task_num.load(std::memory_order_acquire) != 0) {
+        std::lock_guard<std::mutex> lck(_inbox->_mtx);
+        decx::Task* _moved = NULL;
+        while ((_moved = _inbox->pop_front()) != NULL) {
+            _local->push_bottom(_moved);
+        }
+    }
+
+    decx::Task* task = _local->pop_bottom();
+
+    if (task == NULL) {
+        const size_t _thr_num = this->current_thread_num.load();
+        // xorshift, to spread the thieves over the victims
+        *seed ^= *seed << 13;       *seed ^= *seed >> 17;       *seed ^= *seed << 5;
+        const size_t _begin = *seed % _thr_num;
+        const int _node = this->_worker_node[pool_id];
+
+        // pass 0 : the workers on the same NUMA node, pass 1 : the others
+        for (int pass = 0; pass < 2 && task == NULL; ++pass) {
+            for (size_t i = 0; i < _thr_num && task == NULL; ++i) {
+                const size_t victim = (_begin + i) % _thr_num;
+                if (victim == pool_id || (this->_worker_node[victim] == _node) != (pass == 0)) {
+                    continue;
+                }
+                task = this->_deques[victim].steal();
+
+                decx::ThreadTaskQueue* _victim_inbox = this->_task_schd + victim;
+                if (task == NULL && _victim_inbox->_task_num.load(std::memory_order_acquire) != 0) {
+                    if (_victim_inbox->_mtx.try_lock()) {
+                        task = _victim_inbox->pop_front();
+                        _victim_inbox->_mtx.unlock();
+                    }
+                }
             }
         }
-        *id = least_len;
     }
-    else {
-        *id = res_id;
+
+    if (task != NULL) {
+        this->_pending.fetch_sub(1);
     }
+    return task;
 }
 
 
 
 void decx::ThreadPool::_thread_main_loop(const size_t pool_id)
 {
-    decx::ThreadTaskQueue* thread_unit = &(this->_task_schd[pool_id]);
+    decx::_current_pool = this;
+    decx::_current_worker_id = pool_id;
+
+    decx::utils::get_cpu_topology().bind_current_thread(pool_id);
+
+    uint seed = (uint)pool_id * 2654435761U + 1;
 
-    while (!thread_unit->_shutdown) 
+    bool _idle = false;
+    std::chrono::steady_clock::time_point _idle_begin;
+    uint _yield_rounds = 0;
+
+    while (true)
     {
-        std::unique_lock<std::mutex> lock{ thread_unit->_mtx };
-        while ((thread_unit->_task_num == 0) && (!thread_unit->_shutdown)) {
-            thread_unit->_cv.wait(lock);
+        if (this->_try_run_job()) {
+            _idle = false;
+            continue;
         }
-        
-        if (thread_unit->_task_num != 0) {
-            Task* task = thread_unit->begin_ptr + thread_unit->_task_num - 1;
+
+        decx::Task* task = this->_acquire_task(pool_id, &seed);
+        if (task != NULL) {
             (*task)();     // execute the tast
-            thread_unit->pop_back();
+            decx::task_allocator.deallocate(task);
+            _idle = false;
+            continue;
+        }
+
+        if (this->_shutdown.load()) {
+            break;
+        }
+        if (!_idle) {
+            _idle = true;
+            _idle_begin = std::chrono::steady_clock::now();
+            _yield_rounds = 0;
+        }
+
+        // 1. spin, checking only the counter of the pending tasks. Never when there are more workers
+        // than logical processors, the spinning workers would take the time slices of the busy ones
+        const uint _spin_us = this->_idle_spin_us.load(std::memory_order_relaxed);
+        if (_spin_us > 0 && this->current_thread_num.load(std::memory_order_relaxed) <= this->_logical_cpu_num &&
+            std::chrono::steady_clock::now() - _idle_begin < std::chrono::microseconds(_spin_us)) {
+            for (int i = 0; i < _WS_IDLE_SPIN_BATCH_ && this->_pending.load(std::memory_order_relaxed) == 0; ++i) {
+                _mm_pause();
+            }
+            continue;
+        }
+        // 2. yield
+        if (_yield_rounds < this->_idle_yield_rounds.load(std::memory_order_relaxed)) {
+            ++_yield_rounds;
+            std::this_thread::yield();
+            continue;
+        }
+        // 3. park
+        std::unique_lock<std::mutex> lock{ this->_mtx };
+        this->_sleeping.fetch_add(1);
+        while (this->_pending.load() == 0 && !this->_shutdown.load()) {
+            this->_cv.wait(lock);
         }
+        this->_sleeping.fetch_sub(1);
+        _idle = false;
     }
     return;
 }
 
 
 
+void decx::ThreadPool::_init_worker_slots(const size_t _beg, const size_t _end)
+{
+    const decx::CPU_Topology& _topo = decx::utils::get_cpu_topology();
+
+    for (size_t i = _beg; i < _end; ++i) {
+        new(this->_task_schd + i) decx::ThreadTaskQueue();
+        new(this->_deques + i) decx::WorkStealingDeque<decx::Task>();
+
+        const int _node = _topo.node_of_worker(i);
+        this->_worker_node[i] = _node < _MAX_NUMA_NODE_NUM_ ? _node : _node % _MAX_NUMA_NODE_NUM_;
+    }
+}
+
+
+
 void decx::ThreadPool::Start()
 {
     // 仅创建可以 concurrent 的线程
     this->_all_shutdown = false;
+    this->_shutdown.store(false);
+
+    this->_init_worker_slots(0, this->current_thread_num);
 
-    for (int i = 0; i < this->current_thread_num; ++i) {
-        new(this->_task_schd + i) decx::ThreadTaskQueue();
-    }
     for (size_t i = 0; i < this->current_thread_num; ++i) {
         new(this->_thr_list + i) std::thread(&decx::ThreadPool::_thread_main_loop, this, i);
     }
@@ -141,13 +484,32 @@ void decx::ThreadPool::Start()
 decx::ThreadPool::ThreadPool(const int thread_num, const bool start_at_begin)
 {
     this->_all_shutdown = true;
+    this->current_thread_num.store(thread_num);
+
+    this->_logical_cpu_num = decx::utils::get_cpu_topology().logical_cpu_num();
     this->_max_thr_num = MAX_THREAD_NUM;
-    this->current_thread_num = thread_num;
+    if (this->_max_thr_num < this->_logical_cpu_num)  { this->_max_thr_num = this->_logical_cpu_num; }
+    if (this->_max_thr_num < thread_num)        { this->_max_thr_num = thread_num; }
+
+    for (int i = 0; i < _MAX_NUMA_NODE_NUM_; ++i) {
+        this->_next_queue_on_node[i].store(0);
+    }
+    this->_idle_spin_us.store(_WS_IDLE_SPIN_US_);
+    this->_idle_yield_rounds.store(_WS_IDLE_YIELD_ROUNDS_);
+
+    this->_pending.store(0);
+    this->_sleeping.store(0);
+    this->_next_queue.store(0);
+    this->_shutdown.store(true);
+    this->_job.store(NULL);
+    this->_job_visitors.store(0);
 
     this->_hardware_concurrent = std::thread::hardware_concurrency();
 
     this->_task_schd = (decx::ThreadTaskQueue*)malloc(this->_max_thr_num * sizeof(decx::ThreadTaskQueue));
+    this->_deques = (decx::WorkStealingDeque<decx::Task>*)malloc(this->_max_thr_num * sizeof(decx::WorkStealingDeque<decx::Task>));
     this->_thr_list = (std::thread*)malloc(this->_max_thr_num * sizeof(std::thread));
+    this->_worker_node = (int*)malloc(this->_max_thr_num * sizeof(int));
 
     if (start_at_begin) {
         Start();
@@ -159,27 +521,124 @@ decx::ThreadPool::ThreadPool(const int thread_num, const bool start_at_begin)
 template <class FuncType, class ...Args>
 std::future<void> decx::ThreadPool::register_task(FuncType&& f, Args&& ...args)
 {
-    size_t id;
-    this->_find_task_queue_id(&id);
+    std::packaged_task<void()> _pkg(std::bind(std::forward<FuncType>(f), std::forward<Args>(args)...));
+    // get the future before submitting, the task is released right after it is executed
+    std::future<void> fut = _pkg.get_future();
+
+    decx::Task* _task = decx::task_allocator.allocate();
+    _task->bind(std::move(_pkg));
+    this->_submit(_task);
 
-    decx::ThreadTaskQueue* tmp_task_que = &(this->_task_schd[id]);
-    tmp_task_que->_mtx.lock();
-    std::future<void> fut = tmp_task_que->emplace_back(std::forward<FuncType>(f), std::forward<Args>(args)...);
-    tmp_task_que->_mtx.unlock();
-    tmp_task_que->_cv.notify_one();
-    
     return fut;
 }
 
 
 
+template <class FuncType, class ...Args>
+void decx::ThreadPool::register_task_detached(FuncType&& f, Args&& ...args)
+{
+    decx::Task* _task = decx::task_allocator.allocate();
+    _task->bind(std::forward<FuncType>(f), std::forward<Args>(args)...);
+    this->_submit(_task);
+}
+
+
+
+
+template <class FuncType, class ...Args>
+void decx::ThreadPool::register_task_on_node(const int node, FuncType&& f, Args&& ...args)
+{
+    decx::Task* _task = decx::task_allocator.allocate();
+    _task->bind(std::forward<FuncType>(f), std::forward<Args>(args)...);
+
+    const size_t _thr_num = this->current_thread_num.load();
+    const size_t _node_thr_num = this->get_node_worker_num(node);
+    if (_node_thr_num == 0) {
+        this->_submit(_task);
+        return;
+    }
+
+    // the k-th worker on the node, in round-robin order
+    size_t k = this->_next_queue_on_node[node % _MAX_NUMA_NODE_NUM_].fetch_add(1, std::memory_order_relaxed) % _node_thr_num;
+    size_t id = 0;
+    for (; id < _thr_num; ++id) {
+        if (this->_worker_node[id] == node) {
+            if (k == 0) { break; }
+            --k;
+        }
+    }
+
+    decx::ThreadTaskQueue* tmp_task_que = &(this->_task_schd[id]);
+    bool _pushed;
+    this->_pending.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lck(tmp_task_que->_mtx);
+        _pushed = tmp_task_que->push_back(_task);
+    }
+    if (_pushed) {
+        if (this->_sleeping.load() > 0) {
+            // wake up all, to give the workers on the node a chance to take it first
+            std::lock_guard<std::mutex> lck(this->_mtx);
+            this->_cv.notify_all();
+        }
+    }
+    else {
+        this->_pending.fetch_sub(1);
+        this->_submit(_task);
+    }
+}
+
+
+
+void decx::ThreadPool::set_idle_policy(const uint spin_us, const uint yield_rounds)
+{
+    this->_idle_spin_us.store(spin_us, std::memory_order_relaxed);
+    this->_idle_yield_rounds.store(yield_rounds, std::memory_order_relaxed);
+}
+
+
+
+size_t decx::ThreadPool::get_node_worker_num(const int node) const
+{
+    const size_t _thr_num = this->current_thread_num.load();
+    size_t res = 0;
+    for (size_t i = 0; i < _thr_num; ++i) {
+        if (this->_worker_node[i] == node) {
+            ++res;
+        }
+    }
+    return res;
+}
+
+
 
 template <class FuncType, class ...Args>
 std::future<void> decx::ThreadPool::register_task_by_id(size_t id, FuncType&& f, Args&& ...args)
 {
+    std::packaged_task<void()> _pkg(std::bind(std::forward<FuncType>(f), std::forward<Args>(args)...));
+    std::future<void> fut = _pkg.get_future();
+
+    decx::Task* _task = decx::task_allocator.allocate();
+    _task->bind(std::move(_pkg));
+
     decx::ThreadTaskQueue* tmp_task_que = &(this->_task_schd[id]);
-    std::future<void> fut = tmp_task_que->emplace_back(std::forward<FuncType>(f), std::forward<Args>(args)...);
-    tmp_task_que->_cv.notify_one();
+    bool _pushed;
+    this->_pending.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lck(tmp_task_que->_mtx);
+        _pushed = tmp_task_que->push_back(_task);
+    }
+    if (_pushed) {
+        if (this->_sleeping.load() > 0) {
+            // the owner has to be woken up, no matter which worker is parked
+            std::lock_guard<std::mutex> lck(this->_mtx);
+            this->_cv.notify_all();
+        }
+    }
+    else {
+        this->_pending.fetch_sub(1);
+        this->_submit(_task);
+    }
 
     return fut;
 }
@@ -189,16 +648,19 @@ std::future<void> decx::ThreadPool::register_task_by_id(size_t id, FuncType&& f,
 
 void decx::ThreadPool::add_thread(const int add_thread_num)
 {
-    if (this->current_thread_num + add_thread_num > this->_max_thr_num) {
+    const size_t _prev_thr_num = this->current_thread_num.load();
+
+    if (_prev_thr_num + add_thread_num > this->_max_thr_num) {
         return;
     }
     else {
-        for (int i = 0; i < add_thread_num; ++i) {
-            new(this->_task_schd + this->current_thread_num + i) decx::ThreadTaskQueue();
-        }
+        this->_init_worker_slots(_prev_thr_num, _prev_thr_num + add_thread_num);
+        // publish the new queues to the thieves before the new workers start
+        this->current_thread_num.store(_prev_thr_num + add_thread_num);
+
         for (size_t i = 0; i < add_thread_num; ++i) {
-            new(this->_thr_list + this->current_thread_num + i) std::thread(
-                &decx::ThreadPool::_thread_main_loop, this, i);
+            new(this->_thr_list + _prev_thr_num + i) std::thread(
+                &decx::ThreadPool::_thread_main_loop, this, _prev_thr_num + i);
         }
     }
 }
@@ -208,15 +670,14 @@ void decx::ThreadPool::add_thread(const int add_thread_num)
 
 void decx::ThreadPool::TerminateAllThreads()
 {
+    {
+        std::unique_lock<std::mutex> lck(this->_mtx);
+        this->_shutdown.store(true);
+    }
+    this->_cv.notify_all();
+
     for (int i = 0; i < this->current_thread_num; ++i) {
-        std::thread* _iter = this->_thr_list + i;
-        decx::ThreadTaskQueue* Tschd_iter = this->_task_schd + i;
-        {
-            std::unique_lock<std::mutex> lck(Tschd_iter->_mtx);
-            Tschd_iter->_shutdown = true;
-        }
-        Tschd_iter->_cv.notify_one();
-        _iter->join();
+        this->_thr_list[i].join();
     }
 
     this->_all_shutdown = true;
@@ -231,12 +692,22 @@ decx::ThreadPool::~ThreadPool() {
     for (int i = 0; i < this->current_thread_num; ++i) {
         std::thread* _iter = this->_thr_list + i;
         decx::ThreadTaskQueue* Tschd_iter = this->_task_schd + i;
+        decx::WorkStealingDeque<decx::Task>* _deque_iter = this->_deques + i;
+
+        decx::Task* _left = NULL;
+        while ((_left = _deque_iter->pop_bottom()) != NULL) {
+            decx::task_allocator.deallocate(_left);
+        }
+
         Tschd_iter->~ThreadTaskQueue();
+        _deque_iter->~WorkStealingDeque();
         _iter->~thread();
     }
 
     free(this->_task_schd);
+    free(this->_deques);
     free(this->_thr_list);
+    free(this->_worker_node);
 }
 
 
@@ -248,9 +719,82 @@ namespace decx
 
 
 
+#ifdef _DECX_CPU_CODES_
+namespace de
+{
+    namespace cpu
+    {
+        enum DECX_IDLE_POLICY
+        {
+            /* The workers spin for 200us before they yield, and yield 256 rounds before they park.
+            * For the back-to-back calls on small data, at the cost of the CPU time spent spinning. */
+            Idle_Latency = 0,
+
+            /* Spin for 20us, yield 64 rounds, then park. The default. */
+            Idle_Balanced = 1,
+
+            /* Park as soon as there is nothing to do. Every call pays a wake-up for each worker. */
+            Idle_PowerSaving = 2
+        };
+
+
+        /**
+        * @brief Set how the worker threads wait for work between two calls
+        * @param policy : de::cpu::DECX_IDLE_POLICY
+        */
+        _DECX_API_ de::DH SetIdlePolicy(const int policy);
+
+
+        /**
+        * @brief Set the idle policy by the window of spinning (in microseconds) and the rounds of yielding
+        */
+        _DECX_API_ de::DH SetIdlePolicy(const uint spin_us, const uint yield_rounds);
+    }
+}
+
+
+
+_DECX_API_ de::DH de::cpu::SetIdlePolicy(const int policy)
+{
+    de::DH handle;
+
+    switch (policy)
+    {
+    case de::cpu::Idle_Latency:
+        decx::thread_pool.set_idle_policy(200, 256);
+        break;
+    case de::cpu::Idle_Balanced:
+        decx::thread_pool.set_idle_policy(_WS_IDLE_SPIN_US_, _WS_IDLE_YIELD_ROUNDS_);
+        break;
+    case de::cpu::Idle_PowerSaving:
+        decx::thread_pool.set_idle_policy(0, 0);
+        break;
+    default:
+        decx::MeaninglessFlag(&handle);
+        return handle;
+    }
+
+    decx::Success(&handle);
+    return handle;
+}
+
+
+
+_DECX_API_ de::DH de::cpu::SetIdlePolicy(const uint spin_us, const uint yield_rounds)
+{
+    de::DH handle;
+    decx::thread_pool.set_idle_policy(spin_us, yield_rounds);
+
+    decx::Success(&handle);
+    return handle;
+}
+#endif
+
+
+
 #ifdef _DECX_CPU_CODES_
 #define _THREAD_FUNCTION_
 #endif
 
 
-#endif
\ No newline at end of file
+#endif
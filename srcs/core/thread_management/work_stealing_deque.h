@@ -0,0 +1,214 @@
+/**
+*    ---------------------------------------------------------------------
+*    Author : Wayne Anderson
+*    Date   : 2021.04.16
+*    ---------------------------------------------------------------------
+*    This is a part of the open source program named "DECX", copyright c Wayne,
+*    2021.04.16
+*/
+
+#ifndef _WORK_STEALING_DEQUE_H_
+#define _WORK_STEALING_DEQUE_H_
+
+#include "../basic.h"
+#include <atomic>
+
+
+// initial capacity of each deque, in slots (must be a power of 2)
+#define _WS_DEQUE_INIT_CAPACITY_ 256
+
+
+namespace decx
+{
+    template <typename _Ty>
+    class WorkStealingDeque;
+}
+
+
+/**
+* Lock-free work-stealing deque (Chase & Lev, 2005; with the C11 memory orderings of Le et al., 2013).
+* Only the owner thread is allowed to call push_bottom() and pop_bottom(). Any other thread may
+* call steal(), which takes elements from the top. The owner works LIFO (hot caches) while the
+* thieves work FIFO (take the oldest, usually the largest, piece of work).
+* The ring grows when it is full. Retired rings are kept until the deque is destroyed, since a
+* thief may still be reading from them.
+*/
+template <typename _Ty>
+class decx::WorkStealingDeque
+{
+private:
+    struct _ring
+    {
+        int64_t _capacity, _mask;
+        std::atomic<_Ty*>* _buf;
+
+        _ring(const int64_t capacity);
+
+        _Ty* get(const int64_t i) { return this->_buf[i & this->_mask].load(std::memory_order_relaxed); }
+
+        void put(const int64_t i, _Ty* x) { this->_buf[i & this->_mask].store(x, std::memory_order_relaxed); }
+
+        ~_ring() { delete[] this->_buf; }
+    };
+
+    std::atomic<int64_t> _top, _bottom;
+    std::atomic<_ring*> _array;
+
+    // rings replaced by _grow(), released in the destructor
+    std::vector<_ring*> _retired;
+
+    _ring* _grow(_ring* _old, const int64_t b, const int64_t t);
+
+public:
+    WorkStealingDeque();
+
+    /**
+    * @brief Owner only. Push an element to the bottom of the deque
+    */
+    void push_bottom(_Ty* x);
+
+    /**
+    * @brief Owner only. Pop an element from the bottom of the deque
+    * @return NULL if the deque is empty or the last element has been stolen
+    */
+    _Ty* pop_bottom();
+
+    /**
+    * @brief Any thread. Take an element from the top of the deque
+    * @return NULL if the deque is empty or the race to the element is lost
+    */
+    _Ty* steal();
+
+    /**
+    * @brief Approximated number of the elements, only for heuristics
+    */
+    int64_t size() const;
+
+
+    ~WorkStealingDeque();
+};
+
+
+
+template <typename _Ty>
+decx::WorkStealingDeque<_Ty>::_ring::_ring(const int64_t capacity)
+{
+    this->_capacity = capacity;
+    this->_mask = capacity - 1;
+    this->_buf = new std::atomic<_Ty*>[capacity];
+}
+
+
+
+template <typename _Ty>
+decx::WorkStealingDeque<_Ty>::WorkStealingDeque()
+{
+    this->_top.store(0, std::memory_order_relaxed);
+    this->_bottom.store(0, std::memory_order_relaxed);
+    this->_array.store(new _ring(_WS_DEQUE_INIT_CAPACITY_), std::memory_order_relaxed);
+}
+
+
+
+template <typename _Ty>
+typename decx::WorkStealingDeque<_Ty>::_ring*
+decx::WorkStealingDeque<_Ty>::_grow(_ring* _old, const int64_t b, const int64_t t)
+{
+    _ring* _new = new _ring(_old->_capacity << 1);
+    for (int64_t i = t; i < b; ++i) {
+        _new->put(i, _old->get(i));
+    }
+    this->_retired.push_back(_old);
+    this->_array.store(_new, std::memory_order_release);
+    return _new;
+}
+
+
+
+template <typename _Ty>
+void decx::WorkStealingDeque<_Ty>::push_bottom(_Ty* x)
+{
+    const int64_t b = this->_bottom.load(std::memory_order_relaxed);
+    const int64_t t = this->_top.load(std::memory_order_acquire);
+    _ring* a = this->_array.load(std::memory_order_relaxed);
+
+    if (b - t > a->_capacity - 1) {
+        a = this->_grow(a, b, t);
+    }
+    a->put(b, x);
+    std::atomic_thread_fence(std::memory_order_release);
+    this->_bottom.store(b + 1, std::memory_order_relaxed);
+}
+
+
+
+template <typename _Ty>
+_Ty* decx::WorkStealingDeque<_Ty>::pop_bottom()
+{
+    const int64_t b = this->_bottom.load(std::memory_order_relaxed) - 1;
+    _ring* a = this->_array.load(std::memory_order_relaxed);
+    this->_bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = this->_top.load(std::memory_order_relaxed);
+
+    _Ty* x = NULL;
+    if (t <= b) {
+        x = a->get(b);
+        if (t == b) {
+            // the last element, race against the thieves
+            if (!this->_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                x = NULL;
+            }
+            this->_bottom.store(b + 1, std::memory_order_relaxed);
+        }
+    }
+    else {
+        // empty
+        this->_bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return x;
+}
+
+
+
+template <typename _Ty>
+_Ty* decx::WorkStealingDeque<_Ty>::steal()
+{
+    int64_t t = this->_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t b = this->_bottom.load(std::memory_order_acquire);
+
+    _Ty* x = NULL;
+    if (t < b) {
+        _ring* a = this->_array.load(std::memory_order_acquire);
+        x = a->get(t);
+        if (!this->_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return NULL;
+        }
+    }
+    return x;
+}
+
+
+
+template <typename _Ty>
+int64_t decx::WorkStealingDeque<_Ty>::size() const
+{
+    const int64_t b = this->_bottom.load(std::memory_order_relaxed);
+    const int64_t t = this->_top.load(std::memory_order_relaxed);
+    return b > t ? b - t : 0;
+}
+
+
+
+template <typename _Ty>
+decx::WorkStealingDeque<_Ty>::~WorkStealingDeque()
+{
+    delete this->_array.load(std::memory_order_relaxed);
+    for (int i = 0; i < this->_retired.size(); ++i) {
+        delete this->_retired[i];
+    }
+}
+
+
+#endif
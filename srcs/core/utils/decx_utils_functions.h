@@ -63,10 +63,48 @@ namespace decx
         constexpr inline static int Iabs(int n) noexcept {
             return (n ^ (n >> 31)) - (n >> 31);
         }
+
+#ifndef __CUDA_ARCH__
+        /*
+        * @return The index of the lowest set bit, __x should not be 0
+        */
+        inline static int _lowest_bit64(uint64_t __x) noexcept;
+
+        /*
+        * @return The index of the highest set bit, __x should not be 0
+        */
+        inline static int _highest_bit64(uint64_t __x) noexcept;
+#endif
     }
 }
 
 
+#ifndef __CUDA_ARCH__
+inline static int decx::utils::_lowest_bit64(uint64_t __x) noexcept
+{
+#ifdef _MSC_VER
+    unsigned long res;
+    _BitScanForward64(&res, __x);
+    return (int)res;
+#else
+    return __builtin_ctzll(__x);
+#endif
+}
+
+
+inline static int decx::utils::_highest_bit64(uint64_t __x) noexcept
+{
+#ifdef _MSC_VER
+    unsigned long res;
+    _BitScanReverse64(&res, __x);
+    return (int)res;
+#else
+    return 63 - __builtin_clzll(__x);
+#endif
+}
+#endif
+
+
 
 constexpr
 static int decx::utils::_GetHighest_abd(size_t __x) noexcept
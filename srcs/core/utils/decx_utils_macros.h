@@ -45,6 +45,7 @@
 #define _DOUBLE_        de::Matrix<double>
 #define _SHORT_            de::Matrix<short>
 #define _UCHAR_            de::Matrix<uchar>
+#define _CHAR_             de::Matrix<signed char>        // int8, the operands of the quantized GEMM
 
 
 #define _VINT_          de::Vector<int>
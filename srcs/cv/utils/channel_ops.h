@@ -38,23 +38,31 @@ namespace de
         };
 
 #ifdef _DECX_CPU_CODES_
-        _DECX_API_ de::DH merge_channel(de::vis::Img& src, de::vis::Img& dst, const int flag);
+        /**
+        * @param store : one of de::cpu::StoreMode, the stores of dst of BGR_to_Gray (see core/configs/store_mode.h)
+        */
+        _DECX_API_ de::DH merge_channel(de::vis::Img& src, de::vis::Img& dst, const int flag,
+            const int store = de::cpu::Store_Auto);
 #endif
     }
 }
 
 #ifdef _DECX_CPU_CODES_
-de::DH de::vis::merge_channel(de::vis::Img& src, de::vis::Img& dst, const int flag)
+de::DH de::vis::merge_channel(de::vis::Img& src, de::vis::Img& dst, const int flag, const int store)
 {
     de::DH handle;
     decx::_Img* _src = dynamic_cast<decx::_Img*>(&src);
     decx::_Img* _dst = dynamic_cast<decx::_Img*>(&dst);
 
+    if (!decx::_check_store_mode(store, &handle)) {
+        return handle;
+    }
+
     switch (flag)
     {
     case de::vis::ImgChannelMergeType::BGR_to_Gray:
         decx::_BGR2Gray_UC2UC_caller(
-            reinterpret_cast<float*>(_src->Mat.ptr), reinterpret_cast<float*>(_dst->Mat.ptr), make_int2(_src->pitch, _src->height));
+            reinterpret_cast<float*>(_src->Mat.ptr), reinterpret_cast<float*>(_dst->Mat.ptr), make_int2(_src->pitch, _src->height), store);
         break;
 
     case de::vis::ImgChannelMergeType::Preserve_B:
@@ -13,7 +13,8 @@
 #pragma once
 
 #ifdef _DECX_CPU_CODES_
-#include "../../core/thread_management/thread_pool.h"
+#include "../../core/thread_management/parallel_for.h"
+#include "../../core/configs/store_mode.h"
 #include "../cv_classes/cv_classes.h"
 
 
@@ -27,8 +28,9 @@ namespace decx
     /*
     * dims.x : It is the true pitch of pixel data matrix, scale of uchar
     * dims.y : It is the height of pixel data matrix
+    * store : one of de::cpu::StoreMode, the stores of dst
     */
-    _DECX_API_ void _BGR2Gray_UC2UC_caller(float* src, float* dst, const int2 dims);
+    _DECX_API_ void _BGR2Gray_UC2UC_caller(float* src, float* dst, const int2 dims, const int store);
 
     /*
     * dims.x : It is the true pitch of pixel data matrix, scale of uchar
@@ -60,13 +62,6 @@ namespace decx
 
 namespace decx
 {
-    /*
-    * src and dst have two different scale of pitch, take dst's as scale, which is 16x
-    * dims : The dims info of processed area, dims.x : pitch(16x); dims.y : height
-    */
-    static void _THREAD_FUNCTION_ _BGR2Gray_ST_UC2UC(float* src, float* dst, const int2 dims);
-
-
     /*
     * src and dst have two different scale of pitch, take dst's as scale, which is 16x
     * dims : The dims info of processed area, dims.x : pitch(16x); dims.y : height
@@ -94,63 +89,175 @@ namespace decx
 
 
 
-static void _THREAD_FUNCTION_ decx::_BGR2Gray_ST_UC2UC(float* src, float* dst, const int2 dims)
-{
-    size_t glo_dex_src = 0, glo_dex_dst = 0;
-    __m128i __recv, __recv_cvt0;
-    __m128 pixel_f, __recv_cvt1,
-        scalar = _mm_set_ps(0, 0.299f, 0.587f, 0.114f);
+// ----------------------------------- BGR to gray, for each ISA -----------------------------------
 
-    float res;
+// gray = B * 0.114 + G * 0.587 + R * 0.299, truncated, the same order of the operations on all the ISAs
+#define _GRAY_WEIGHT_B_ 0.114f
+#define _GRAY_WEIGHT_G_ 0.587f
+#define _GRAY_WEIGHT_R_ 0.299f
 
-    uchar4 reg_dst;
 
-    for (int i = 0; i < dims.y; ++i) {
-        for (int j = 0; j < dims.x; ++j) {
-            *((__m128*)&__recv) = _mm_load_ps(src + glo_dex_src);
-            glo_dex_src += 4;
-
-            ((float*)&__recv_cvt0)[0] = ((float*)&__recv)[0];
-            *((__m128i*)&__recv_cvt1) = _mm_cvtepi8_epi32(__recv_cvt0);
-            pixel_f = _mm_cvtepi32_ps(*((__m128i*)&__recv_cvt1));
+namespace decx
+{
+    /*
+    * src and dst have two different scale of pitch, take dst's as scale
+    * dims : The dims info of processed area, dims.x : pitch / 4 (in the groups of 4 pixels); dims.y : height
+    * The number of the pixels of the area is a multiple of 8.
+    */
+    typedef void (*_BGR2Gray_kernel_ptr)(const float*, float*, const int2);
 
-            __recv_cvt1 = _mm_mul_ps(pixel_f, scalar);
 
-            res = decx::utils::_mm128_h_sum(__recv_cvt1);
-            reg_dst.x = (uchar)res;
+    // the kernel of the de::CPU_ISA in use, and the one with the non-temporal stores (see core/configs/store_mode.h)
+    decx::_BGR2Gray_kernel_ptr _BGR2Gray_ST_UC2UC, _BGR2Gray_ST_UC2UC_nt;
+}
 
-            ((float*)&__recv_cvt0)[0] = ((float*)&__recv)[1];
-            *((__m128i*) & __recv_cvt1) = _mm_cvtepi8_epi32(__recv_cvt0);
-            pixel_f = _mm_cvtepi32_ps(*((__m128i*) & __recv_cvt1));
 
-            __recv_cvt1 = _mm_mul_ps(pixel_f, scalar);
+_DECX_ISA_BEGIN_SSE42_
+namespace decx
+{
+    namespace sse42
+    {
+        template <bool _nt>
+        static void _THREAD_FUNCTION_ _BGR2Gray_ST_UC2UC(const float* src, float* dst, const int2 dims)
+        {
+            const size_t _pixel_num = (size_t)dims.x * (size_t)dims.y * 4;
+            const __m128i _mask = _mm_set1_epi32(0xff);
+            const __m128 _wb = _mm_set1_ps(_GRAY_WEIGHT_B_), _wg = _mm_set1_ps(_GRAY_WEIGHT_G_),
+                _wr = _mm_set1_ps(_GRAY_WEIGHT_R_);
+
+            const __m128i* _src = (const __m128i*)src;
+            int* _dst = (int*)dst;
+            for (size_t i = 0; i < _pixel_num; i += 4) {
+                const __m128i _px = _mm_load_si128(_src++);
+                const __m128 _b = _mm_cvtepi32_ps(_mm_and_si128(_px, _mask));
+                const __m128 _g = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(_px, 8), _mask));
+                const __m128 _r = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(_px, 16), _mask));
+
+                const __m128 _gray = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_b, _wb), _mm_mul_ps(_g, _wg)), _mm_mul_ps(_r, _wr));
+
+                __m128i _res = _mm_cvttps_epi32(_gray);
+                _res = _mm_packus_epi32(_res, _res);
+                _res = _mm_packus_epi16(_res, _res);
+                if (_nt) { _mm_stream_si32(_dst++, _mm_cvtsi128_si32(_res)); }
+                else { *(_dst++) = _mm_cvtsi128_si32(_res); }
+            }
+            if (_nt) { _mm_sfence(); }
+        }
+    }
+}
+_DECX_ISA_END_
 
-            res = decx::utils::_mm128_h_sum(__recv_cvt1);
-            reg_dst.y = (uchar)res;
 
-            ((float*)&__recv_cvt0)[0] = ((float*)&__recv)[2];
-            *((__m128i*) & __recv_cvt1) = _mm_cvtepi8_epi32(__recv_cvt0);
-            pixel_f = _mm_cvtepi32_ps(*((__m128i*) & __recv_cvt1));
 
-            __recv_cvt1 = _mm_mul_ps(pixel_f, scalar);
+_DECX_ISA_BEGIN_AVX2_
+namespace decx
+{
+    namespace avx2
+    {
+        template <bool _nt>
+        static void _THREAD_FUNCTION_ _BGR2Gray_ST_UC2UC(const float* src, float* dst, const int2 dims)
+        {
+            const size_t _pixel_num = (size_t)dims.x * (size_t)dims.y * 4;
+            const __m256i _mask = _mm256_set1_epi32(0xff);
+            const __m256 _wb = _mm256_set1_ps(_GRAY_WEIGHT_B_), _wg = _mm256_set1_ps(_GRAY_WEIGHT_G_),
+                _wr = _mm256_set1_ps(_GRAY_WEIGHT_R_);
+            // gathers the lowest bytes of the two 128-bit lanes after the packings
+            const __m256i _perm = _mm256_setr_epi32(0, 4, 0, 4, 0, 4, 0, 4);
+
+            const __m256i* _src = (const __m256i*)src;
+            __m128i* _dst = (__m128i*)dst;
+            for (size_t i = 0; i < _pixel_num; i += 8) {
+                const __m256i _px = _mm256_load_si256(_src++);
+                const __m256 _b = _mm256_cvtepi32_ps(_mm256_and_si256(_px, _mask));
+                const __m256 _g = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(_px, 8), _mask));
+                const __m256 _r = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(_px, 16), _mask));
+
+                const __m256 _gray = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_b, _wb), _mm256_mul_ps(_g, _wg)),
+                    _mm256_mul_ps(_r, _wr));
+
+                __m256i _res = _mm256_cvttps_epi32(_gray);
+                _res = _mm256_packus_epi32(_res, _res);
+                _res = _mm256_packus_epi16(_res, _res);
+                _res = _mm256_permutevar8x32_epi32(_res, _perm);
+                if (_nt) { _mm_stream_si64((long long*)_dst, _mm_cvtsi128_si64(_mm256_castsi256_si128(_res))); }
+                else { _mm_storel_epi64(_dst, _mm256_castsi256_si128(_res)); }
+                _dst = (__m128i*)((uchar*)_dst + 8);
+            }
+            if (_nt) { _mm_sfence(); }
+        }
+    }
+}
+_DECX_ISA_END_
 
-            res = decx::utils::_mm128_h_sum(__recv_cvt1);
-            reg_dst.z = (uchar)res;
 
-            ((float*)&__recv_cvt0)[0] = ((float*)&__recv)[3];
-            *((__m128i*) & __recv_cvt1) = _mm_cvtepi8_epi32(__recv_cvt0);
-            pixel_f = _mm_cvtepi32_ps(*((__m128i*) & __recv_cvt1));
 
-            __recv_cvt1 = _mm_mul_ps(pixel_f, scalar);
+_DECX_ISA_BEGIN_AVX512_
+namespace decx
+{
+    namespace avx512
+    {
+        template <bool _nt>
+        static void _THREAD_FUNCTION_ _BGR2Gray_ST_UC2UC(const float* src, float* dst, const int2 dims)
+        {
+            const size_t _pixel_num = (size_t)dims.x * (size_t)dims.y * 4;
+            const __m512i _mask = _mm512_set1_epi32(0xff);
+            const __m512 _wb = _mm512_set1_ps(_GRAY_WEIGHT_B_), _wg = _mm512_set1_ps(_GRAY_WEIGHT_G_),
+                _wr = _mm512_set1_ps(_GRAY_WEIGHT_R_);
+
+            size_t i = 0;
+            for (; i + 16 <= _pixel_num; i += 16) {
+                // the rows are aligned to 32 bytes only
+                const __m512i _px = _mm512_loadu_si512(src + i);
+                const __m512 _b = _mm512_cvtepi32_ps(_mm512_and_si512(_px, _mask));
+                const __m512 _g = _mm512_cvtepi32_ps(_mm512_and_si512(_mm512_srli_epi32(_px, 8), _mask));
+                const __m512 _r = _mm512_cvtepi32_ps(_mm512_and_si512(_mm512_srli_epi32(_px, 16), _mask));
+
+                const __m512 _gray = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(_b, _wb), _mm512_mul_ps(_g, _wg)),
+                    _mm512_mul_ps(_r, _wr));
+
+                const __m128i _res = _mm512_cvtepi32_epi8(_mm512_cvttps_epi32(_gray));
+                if (_nt) {
+                    // the rows of dst are aligned to 8 bytes only
+                    _mm_stream_si64((long long*)((uchar*)dst + i), _mm_cvtsi128_si64(_res));
+                    _mm_stream_si64((long long*)((uchar*)dst + i + 8), _mm_extract_epi64(_res, 1));
+                }
+                else { _mm_storeu_si128((__m128i*)((uchar*)dst + i), _res); }
+            }
+            // the last 8 pixels, fenced there
+            if (i < _pixel_num) {
+                decx::avx2::_BGR2Gray_ST_UC2UC<_nt>(src + i, (float*)((uchar*)dst + i), make_int2(2, 1));
+            }
+            else if (_nt) { _mm_sfence(); }
+        }
+    }
+}
+_DECX_ISA_END_
 
-            res = decx::utils::_mm128_h_sum(__recv_cvt1);
-            reg_dst.w = (uchar)res;
 
-            dst[glo_dex_dst] = *((float*)&reg_dst);
 
-            ++glo_dex_dst;
+namespace decx
+{
+    static void _select_BGR2Gray_kernel(const int isa)
+    {
+        switch (isa)
+        {
+        case de::CPU_ISA::ISA_AVX512:
+            decx::_BGR2Gray_ST_UC2UC = &decx::avx512::_BGR2Gray_ST_UC2UC<false>;
+            decx::_BGR2Gray_ST_UC2UC_nt = &decx::avx512::_BGR2Gray_ST_UC2UC<true>;
+            break;
+        case de::CPU_ISA::ISA_AVX2:
+            decx::_BGR2Gray_ST_UC2UC = &decx::avx2::_BGR2Gray_ST_UC2UC<false>;
+            decx::_BGR2Gray_ST_UC2UC_nt = &decx::avx2::_BGR2Gray_ST_UC2UC<true>;
+            break;
+        default:
+            decx::_BGR2Gray_ST_UC2UC = &decx::sse42::_BGR2Gray_ST_UC2UC<false>;
+            decx::_BGR2Gray_ST_UC2UC_nt = &decx::sse42::_BGR2Gray_ST_UC2UC<true>;
+            break;
         }
     }
+
+
+    static decx::_ISA_dispatch_reg _BGR2Gray_kernel_reg(&decx::_select_BGR2Gray_kernel);
 }
 
 
@@ -261,28 +368,19 @@ static void _THREAD_FUNCTION_ decx::_Preserve_A_ST_UC2UC(float* src, float* dst,
 // --------------------------------------- CALLERS --------------------------------------------------------
 
 
-void decx::_BGR2Gray_UC2UC_caller(float* src, float* dst, const int2 dims)
+void decx::_BGR2Gray_UC2UC_caller(float* src, float* dst, const int2 dims, const int store)
 {
-    int _concurrent = (int)decx::thread_pool._hardware_concurrent;
-    int2 sub_dims = make_int2(dims.x / 4, dims.y / _concurrent);
-    size_t fragment = (size_t)sub_dims.x * (size_t)sub_dims.y, offset = 0;
-
-    std::future<void>* _thread_handle = new std::future<void>[12];
-
-    for (int i = 0; i < _concurrent - 1; ++i) {
-        _thread_handle[i] = decx::thread_pool.register_task(decx::_BGR2Gray_ST_UC2UC, src + (offset << 2), dst + offset, sub_dims);
-        offset += fragment;
-    }
-
-    sub_dims.y = dims.y - (_concurrent - 1) * sub_dims.y;
-    _thread_handle[decx::thread_pool._hardware_concurrent - 1] = 
-        decx::thread_pool.register_task(decx::_BGR2Gray_ST_UC2UC, src + (offset << 2), dst + offset, sub_dims);
-    
-    for (int i = 0; i < _concurrent; ++i) {
-        _thread_handle[i].get();
-    }
-
-    delete[] _thread_handle;
+    const size_t _row_frag = (size_t)(dims.x / 4);
+    // at least (_EW_MIN_GRAIN_VEC_ * 8) pixels for each chunk
+    const size_t _grain = decx::utils::clamp_min<size_t>((_EW_MIN_GRAIN_VEC_ << 3) / decx::utils::clamp_min<size_t>(dims.x, 1), 1);
+
+    // one byte of dst a pixel
+    const decx::_BGR2Gray_kernel_ptr _kernel = decx::_use_streaming_store(store, (size_t)dims.x * (size_t)dims.y) ?
+        decx::_BGR2Gray_ST_UC2UC_nt : decx::_BGR2Gray_ST_UC2UC;
+    decx::parallel_for(0, dims.y, [&](const size_t _beg, const size_t _end) {
+        _kernel(src + ((_beg * _row_frag) << 2), dst + _beg * _row_frag,
+            make_int2(dims.x / 4, (int)(_end - _beg)));
+    }, _grain, decx::Partition_NUMA);
 }
 
 
@@ -291,103 +389,55 @@ void decx::_BGR2Gray_UC2UC_caller(float* src, float* dst, const int2 dims)
 
 void decx::_Preserve_B_UC2UC_caller(float* src, float* dst, const int2 dims)
 {
-    int _concurrent = (int)decx::thread_pool._hardware_concurrent;
-    int2 sub_dims = make_int2(dims.x / 4, dims.y / _concurrent);
-    size_t fragment = (size_t)sub_dims.x * (size_t)sub_dims.y, offset = 0;
-
-    std::future<void>* _thread_handle = new std::future<void>[12];
-
-    for (int i = 0; i < _concurrent - 1; ++i) {
-        _thread_handle[i] = decx::thread_pool.register_task(decx::_Preserve_B_ST_UC2UC, src + (offset << 2), dst + offset, sub_dims);
-        offset += fragment;
-    }
-
-    sub_dims.y = dims.y - (_concurrent - 1) * sub_dims.y;
-    _thread_handle[decx::thread_pool._hardware_concurrent - 1] =
-        decx::thread_pool.register_task(decx::_Preserve_B_ST_UC2UC, src + (offset << 2), dst + offset, sub_dims);
-
-    for (int i = 0; i < _concurrent; ++i) {
-        _thread_handle[i].get();
-    }
-
-    delete[] _thread_handle;
+    const size_t _row_frag = (size_t)(dims.x / 4);
+    // at least (_EW_MIN_GRAIN_VEC_ * 8) pixels for each chunk
+    const size_t _grain = decx::utils::clamp_min<size_t>((_EW_MIN_GRAIN_VEC_ << 3) / decx::utils::clamp_min<size_t>(dims.x, 1), 1);
+
+    decx::parallel_for(0, dims.y, [&](const size_t _beg, const size_t _end) {
+        decx::_Preserve_B_ST_UC2UC(src + ((_beg * _row_frag) << 2), dst + _beg * _row_frag,
+            make_int2(dims.x / 4, (int)(_end - _beg)));
+    }, _grain, decx::Partition_NUMA);
 }
 
 
 
 void decx::_Preserve_G_UC2UC_caller(float* src, float* dst, const int2 dims)
 {
-    int _concurrent = (int)decx::thread_pool._hardware_concurrent;
-    int2 sub_dims = make_int2(dims.x / 4, dims.y / _concurrent);
-    size_t fragment = (size_t)sub_dims.x * (size_t)sub_dims.y, offset = 0;
-
-    std::future<void>* _thread_handle = new std::future<void>[12];
-
-    for (int i = 0; i < _concurrent - 1; ++i) {
-        _thread_handle[i] = decx::thread_pool.register_task(decx::_Preserve_G_ST_UC2UC, src + (offset << 2), dst + offset, sub_dims);
-        offset += fragment;
-    }
-
-    sub_dims.y = dims.y - (_concurrent - 1) * sub_dims.y;
-    _thread_handle[decx::thread_pool._hardware_concurrent - 1] =
-        decx::thread_pool.register_task(decx::_Preserve_G_ST_UC2UC, src + (offset << 2), dst + offset, sub_dims);
-
-    for (int i = 0; i < _concurrent; ++i) {
-        _thread_handle[i].get();
-    }
-
-    delete[] _thread_handle;
+    const size_t _row_frag = (size_t)(dims.x / 4);
+    // at least (_EW_MIN_GRAIN_VEC_ * 8) pixels for each chunk
+    const size_t _grain = decx::utils::clamp_min<size_t>((_EW_MIN_GRAIN_VEC_ << 3) / decx::utils::clamp_min<size_t>(dims.x, 1), 1);
+
+    decx::parallel_for(0, dims.y, [&](const size_t _beg, const size_t _end) {
+        decx::_Preserve_G_ST_UC2UC(src + ((_beg * _row_frag) << 2), dst + _beg * _row_frag,
+            make_int2(dims.x / 4, (int)(_end - _beg)));
+    }, _grain, decx::Partition_NUMA);
 }
 
 
 
 void decx::_Preserve_R_UC2UC_caller(float* src, float* dst, const int2 dims)
 {
-    int _concurrent = (int)decx::thread_pool._hardware_concurrent;
-    int2 sub_dims = make_int2(dims.x / 4, dims.y / _concurrent);
-    size_t fragment = (size_t)sub_dims.x * (size_t)sub_dims.y, offset = 0;
-
-    std::future<void>* _thread_handle = new std::future<void>[12];
-
-    for (int i = 0; i < _concurrent - 1; ++i) {
-        _thread_handle[i] = decx::thread_pool.register_task(decx::_Preserve_R_ST_UC2UC, src + (offset << 2), dst + offset, sub_dims);
-        offset += fragment;
-    }
-
-    sub_dims.y = dims.y - (_concurrent - 1) * sub_dims.y;
-    _thread_handle[decx::thread_pool._hardware_concurrent - 1] =
-        decx::thread_pool.register_task(decx::_Preserve_R_ST_UC2UC, src + (offset << 2), dst + offset, sub_dims);
-
-    for (int i = 0; i < _concurrent; ++i) {
-        _thread_handle[i].get();
-    }
-
-    delete[] _thread_handle;
+    const size_t _row_frag = (size_t)(dims.x / 4);
+    // at least (_EW_MIN_GRAIN_VEC_ * 8) pixels for each chunk
+    const size_t _grain = decx::utils::clamp_min<size_t>((_EW_MIN_GRAIN_VEC_ << 3) / decx::utils::clamp_min<size_t>(dims.x, 1), 1);
+
+    decx::parallel_for(0, dims.y, [&](const size_t _beg, const size_t _end) {
+        decx::_Preserve_R_ST_UC2UC(src + ((_beg * _row_frag) << 2), dst + _beg * _row_frag,
+            make_int2(dims.x / 4, (int)(_end - _beg)));
+    }, _grain, decx::Partition_NUMA);
 }
 
 
 void decx::_Preserve_A_UC2UC_caller(float* src, float* dst, const int2 dims)
 {
-    int _concurrent = (int)decx::thread_pool._hardware_concurrent;
-    int2 sub_dims = make_int2(dims.x / 4, dims.y / _concurrent);
-    size_t fragment = (size_t)sub_dims.x * (size_t)sub_dims.y, offset = 0;
-
-    std::future<void>* _thread_handle = new std::future<void>[12];
-
-    for (int i = 0; i < _concurrent - 1; ++i) {
-        _thread_handle[i] = decx::thread_pool.register_task(decx::_Preserve_A_ST_UC2UC, src + (offset << 2), dst + offset, sub_dims);
-        offset += fragment;
-    }
-
-    sub_dims.y = dims.y - (_concurrent - 1) * sub_dims.y;
-    _thread_handle[decx::thread_pool._hardware_concurrent - 1] =
-        decx::thread_pool.register_task(decx::_Preserve_A_ST_UC2UC, src + (offset << 2), dst + offset, sub_dims);
-
-    for (int i = 0; i < _concurrent; ++i) {
-        _thread_handle[i].get();
-    }
-
-    delete[] _thread_handle;
+    const size_t _row_frag = (size_t)(dims.x / 4);
+    // at least (_EW_MIN_GRAIN_VEC_ * 8) pixels for each chunk
+    const size_t _grain = decx::utils::clamp_min<size_t>((_EW_MIN_GRAIN_VEC_ << 3) / decx::utils::clamp_min<size_t>(dims.x, 1), 1);
+
+    decx::parallel_for(0, dims.y, [&](const size_t _beg, const size_t _end) {
+        decx::_Preserve_A_ST_UC2UC(src + ((_beg * _row_frag) << 2), dst + _beg * _row_frag,
+            make_int2(dims.x / 4, (int)(_end - _beg)));
+    }, _grain, decx::Partition_NUMA);
 }
 
 
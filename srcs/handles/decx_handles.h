@@ -34,7 +34,15 @@ namespace decx
 
         DECX_FAIL_MNumNotMatching    = 0x0f,
 
-        DECX_FAIL_ALLOCATION        = 0x10
+        DECX_FAIL_ALLOCATION        = 0x10,
+
+        DECX_FAIL_ISA_NotSupported    = 0x11,
+
+        DECX_FAIL_PackedLayout        = 0x12,
+
+        DECX_FAIL_OperandAliasing     = 0x13,
+
+        DECX_FAIL_FileIO              = 0x14
     };
 }
 
@@ -0,0 +1,140 @@
+// bcast_bench.cpp : the broadcast element-wise operators of the CPU (decx::ew_bcast_m, the engine of
+// de::cpu::Add() ... of the operands of different shapes) against expanding the small operand to the shape
+// of dst first and adding two full operands. dst = A + B of float is timed over about 16M elements for a row
+// vector, a column vector and a scalar against a matrix, and for a bias of the channels and a plane of the
+// pixels against a tensor. The time of expanding and adding, of adding alone (the operand already expanded)
+// and of broadcasting is printed. Pass 1, 2 or 3 to force SSE4.2, AVX2 or AVX-512.
+//
+
+#define _DECX_CPU_CODES_
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <immintrin.h>
+
+#include "../../../srcs/core/configs/config.h"
+#include "../../../srcs/basic_calculations/operators/ew_bcast_exec.h"
+
+
+using namespace std;
+typedef chrono::high_resolution_clock _clock;
+
+
+struct aligned_buffer
+{
+    float* ptr;
+    size_t len;
+
+    aligned_buffer(const size_t _len, const float val) : len(_len)
+    {
+        ptr = (float*)_mm_malloc(_len * sizeof(float), 64);
+        for (size_t i = 0; i < _len; ++i) {
+            ptr[i] = val;
+        }
+    }
+    ~aligned_buffer() { _mm_free(ptr); }
+};
+
+
+struct bench_case
+{
+    const char* name;
+    size_t width, height, depth;        // of dst (and A), the depth is 1 of a matrix
+    size_t b_width, b_height, b_depth;  // of B
+};
+
+
+template <typename _Func>
+static double time_of(const _Func& f)
+{
+    const int round_num = 10;
+    f();
+
+    _clock::time_point s = _clock::now();
+    for (int r = 0; r < round_num; ++r) {
+        f();
+    }
+    return chrono::duration<double>(_clock::now() - s).count() / round_num;
+}
+
+
+// the elements of a pixel and of a row, padded as de::Matrix and de::Tensor do
+static void pitches_of(const size_t width, const size_t depth, const bool tensor, size_t* dpitch, size_t* pitch)
+{
+    *dpitch = tensor ? decx::utils::ceil<size_t>(depth, 4) * 4 : 1;
+    *pitch = tensor ? decx::utils::ceil<size_t>(width, 4) * 4 * *dpitch : decx::utils::ceil<size_t>(width, 8) * 8;
+}
+
+
+static void bench(const bench_case& c)
+{
+    decx::_ew_bcast_layout layout;
+    layout.rows = c.height;
+    layout.width = c.width;
+    pitches_of(c.width, c.depth, c.depth > 1, &layout.dpitch, &layout.pitch);
+
+    size_t b_dpitch, b_pitch;
+    pitches_of(c.b_width, c.b_depth, c.depth > 1, &b_dpitch, &b_pitch);
+
+    aligned_buffer A(layout.pitch * c.height, 1.f), B(b_pitch * c.b_height, 2.f), dst(layout.pitch * c.height, 0.f),
+        B_full(layout.pitch * c.height, 0.f);
+
+    decx::_ew_bcast_operand<float> opA = { A.ptr, layout.pitch, layout.dpitch, _EW_BC_FULL_ };
+    decx::_ew_bcast_operand<float> opB = { B.ptr, c.b_height == 1 ? 0 : b_pitch, b_dpitch,
+        decx::_ew_bcast_kind(c.b_width, c.b_depth, c.width, c.depth) };
+    decx::_ew_bcast_operand<float> opB_full = { B_full.ptr, layout.pitch, layout.dpitch, _EW_BC_FULL_ };
+
+    // B expanded to the shape of dst, element by element
+    auto expand = [&]() {
+        for (size_t i = 0; i < c.height; ++i) {
+            const float* row = B.ptr + (c.b_height == 1 ? 0 : i * b_pitch);
+            for (size_t w = 0; w < c.width; ++w) {
+                for (size_t d = 0; d < c.depth; ++d) {
+                    B_full.ptr[i * layout.pitch + w * layout.dpitch + d] =
+                        row[(c.b_width == 1 ? 0 : w) * b_dpitch + (c.b_depth == 1 ? 0 : d)];
+                }
+            }
+        }
+    };
+
+    // dst is cached in all three, the non-temporal stores are timed by stream_bench
+    const int store = de::cpu::Store_Cached;
+    const double t_add = time_of([&]() { decx::ew_bcast_m<float>(_EW_ADD_, &opA, &opB_full, dst.ptr, &layout, store); });
+    const double t_exp = time_of([&]() {
+        expand();
+        decx::ew_bcast_m<float>(_EW_ADD_, &opA, &opB_full, dst.ptr, &layout, store);
+    });
+    const double t_bc = time_of([&]() { decx::ew_bcast_m<float>(_EW_ADD_, &opA, &opB, dst.ptr, &layout, store); });
+
+    cout << fixed << setprecision(2);
+    cout << setw(22) << c.name << setw(14) << t_exp * 1e3 << setw(12) << t_add * 1e3 << setw(13) << t_bc * 1e3
+        << setw(10) << t_exp / t_bc << endl;
+}
+
+
+int main(int argc, char** argv)
+{
+    de::InitCPUInfo();
+    if (argc > 1) {
+        de::SetCPUISA(atoi(argv[1]));
+    }
+
+    cout << setw(22) << "B" << setw(14) << "expand (ms)" << setw(12) << "add (ms)" << setw(13) << "bcast (ms)"
+        << setw(10) << "speedup" << endl;
+
+    const bench_case cases[] = {
+        { "row vector 1x4096", 4096, 4096, 1, 4096, 1, 1 },
+        { "column vector 4096x1", 4096, 4096, 1, 1, 4096, 1 },
+        { "scalar 1x1", 4096, 4096, 1, 1, 1, 1 },
+        { "channels 1x1x64", 512, 512, 64, 1, 1, 64 },
+        { "channels 1x1x3", 2048, 2048, 3, 1, 1, 3 },
+        { "pixels 512x512x1", 512, 512, 64, 512, 512, 1 } };
+
+    for (const auto& c : cases) {
+        bench(c);
+    }
+
+    decx::thread_pool.TerminateAllThreads();
+    return 0;
+}
@@ -0,0 +1,205 @@
+// dgemm_igemm_check.cpp : the correctness of the DGEMM and of the int8 x int8 -> int32 GEMM of the CPU
+// (decx::gemm_blocked of decx::_dgemm_blocked_info and decx::_igemm_blocked_info, the engines of de::cpu::GEMM()
+// of double and of signed char). C = alpha * op(A) * op(B) + beta * S is checked for the four combinations of
+// the transposes, beta of 0, 1 and 2, and S being C, on shapes off the multiples of the micro-kernel and of kc.
+// The double results are compared with a long double reference (in units of K * eps * sum(|a * b|)), the int8
+// ones must be exact, also for operands of all -128, all 127 and -128 against 127. Pass 1, 2 or 3 to force
+// SSE4.2, AVX2 or AVX-512.
+//
+
+#define _DECX_CPU_CODES_
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cfloat>
+
+#include "../../../srcs/core/configs/config.h"
+#include "../../../srcs/GEMM/CPU/dgemm.h"
+#include "../../../srcs/GEMM/CPU/igemm.h"
+
+
+using namespace std;
+
+
+struct gemm_case
+{
+    int M, N, K;
+    bool transA, transB;
+    int beta;
+    bool in_place;      // S is C
+};
+
+
+static mt19937 rng(1);
+
+
+static const char* trans_name(const gemm_case& c)
+{
+    return c.transA ? (c.transB ? "TT" : "TN") : (c.transB ? "NT" : "NN");
+}
+
+
+// fills the info of the case for A, B and C of the pitches lda, ldb and ldc, de::cpu::GEMM() passes no S if beta is 0
+template <typename _Info, typename _Ti, typename _To>
+static void fill_info(_Info* info, const gemm_case& c, const _Ti* A, const size_t lda, const _Ti* B, const size_t ldb,
+    _To* C, const _To* S, const size_t ldc, const _To alpha)
+{
+    info->A = A;    info->lda = lda;
+    info->B = B;    info->ldb = ldb;
+    info->C = C;    info->ldc = ldc;
+    info->M = c.M;  info->N = c.N;  info->K = c.K;
+    info->alpha = alpha;
+    info->beta = (_To)c.beta;
+    info->S = c.beta != 0 ? (c.in_place ? C : S) : NULL;
+    info->lds = ldc;
+    info->transA = c.transA;
+    info->transB = c.transB;
+}
+
+
+// the largest error of the DGEMM in units of the bound
+static double check_double(const gemm_case& c)
+{
+    const double alpha = -0.75;
+    const int rows_A = c.transA ? c.K : c.M, cols_A = c.transA ? c.M : c.K;
+    const int rows_B = c.transB ? c.N : c.K, cols_B = c.transB ? c.K : c.N;
+    const size_t lda = cols_A + 1, ldb = cols_B + 3, ldc = c.N + 5;
+
+    uniform_real_distribution<double> dist(-1, 1);
+    vector<double> A(rows_A * lda + 1), B(rows_B * ldb + 1), C(c.M * ldc + 1), S(c.M * ldc + 1);
+    for (double& x : A) x = dist(rng);
+    for (double& x : B) x = dist(rng);
+    for (double& x : C) x = dist(rng);
+    for (double& x : S) x = dist(rng);
+    const vector<double> _S = c.in_place ? C : S;
+
+    decx::_dgemm_blocked_info info;
+    fill_info(&info, c, A.data(), lda, B.data(), ldb, C.data(), S.data(), ldc, alpha);
+    if (!decx::gemm_blocked(&info, (double*)NULL)) {
+        return INFINITY;
+    }
+
+    double err = 0;
+    for (int i = 0; i < c.M; ++i) {
+        for (int j = 0; j < c.N; ++j) {
+            long double acc = 0, mag = 0;
+            for (int k = 0; k < c.K; ++k) {
+                const long double a = c.transA ? A[k * lda + i] : A[i * lda + k];
+                const long double b = c.transB ? B[j * ldb + k] : B[k * ldb + j];
+                acc += a * b;
+                mag += fabsl(a * b);
+            }
+            const long double s = c.beta != 0 ? (long double)c.beta * _S[i * ldc + j] : 0;
+            const long double ref = alpha * acc + s;
+            const long double bound = (c.K + 2) * DBL_EPSILON * (fabsl(alpha) * mag + fabsl(s)) + DBL_MIN;
+            err = fmax(err, (double)(fabsl(C[i * ldc + j] - ref) / bound));
+        }
+    }
+    return err;
+}
+
+
+// the number of wrong elements of the int8 GEMM, A and B are drawn from [lo_A, hi_A] and [lo_B, hi_B]
+static size_t check_int8(const gemm_case& c, const int lo_A, const int hi_A, const int lo_B, const int hi_B)
+{
+    const int alpha = 3;
+    const int rows_A = c.transA ? c.K : c.M, cols_A = c.transA ? c.M : c.K;
+    const int rows_B = c.transB ? c.N : c.K, cols_B = c.transB ? c.K : c.N;
+    const size_t lda = cols_A + 1, ldb = cols_B + 3, ldc = c.N + 5;
+
+    uniform_int_distribution<int> dist_A(lo_A, hi_A), dist_B(lo_B, hi_B), dist_C(-100000, 100000);
+    vector<signed char> A(rows_A * lda + 1), B(rows_B * ldb + 1);
+    vector<int> C(c.M * ldc + 1), S(c.M * ldc + 1);
+    for (signed char& x : A) x = (signed char)dist_A(rng);
+    for (signed char& x : B) x = (signed char)dist_B(rng);
+    for (int& x : C) x = dist_C(rng);
+    for (int& x : S) x = dist_C(rng);
+    const vector<int> _S = c.in_place ? C : S;
+
+    decx::_igemm_blocked_info info;
+    fill_info(&info, c, A.data(), lda, B.data(), ldb, C.data(), S.data(), ldc, alpha);
+    if (!decx::gemm_blocked(&info, (short*)NULL)) {
+        return (size_t)c.M * c.N;
+    }
+
+    size_t wrong = 0;
+    for (int i = 0; i < c.M; ++i) {
+        for (int j = 0; j < c.N; ++j) {
+            int64_t acc = 0;
+            for (int k = 0; k < c.K; ++k) {
+                const int a = c.transA ? A[k * lda + i] : A[i * lda + k];
+                const int b = c.transB ? B[j * ldb + k] : B[k * ldb + j];
+                acc += a * b;
+            }
+            const int64_t ref = alpha * acc + (c.beta != 0 ? (int64_t)c.beta * _S[i * ldc + j] : 0);
+            wrong += (int64_t)C[i * ldc + j] != ref;
+        }
+    }
+    return wrong;
+}
+
+
+
+int main(int argc, char** argv)
+{
+    de::InitCPUInfo();
+    if (argc > 1) {
+        de::SetCPUISA(atoi(argv[1]));
+    }
+
+    const decx::_dgemm_blocked_info _dprobe;
+    const decx::_igemm_blocked_info _iprobe;
+    cout << "double micro-kernel : " << _dprobe.uk.mr << " x " << _dprobe.uk.nr << ", kc = " << _dprobe.bs.kc << endl;
+    cout << "int8 micro-kernel : " << _iprobe.uk.mr << " x " << _iprobe.uk.nr << ", kc = " << _iprobe.bs.kc << endl;
+
+    const int dMR = _dprobe.uk.mr, dNR = _dprobe.uk.nr, dkc = _dprobe.bs.kc;
+    const int iMR = _iprobe.uk.mr, iNR = _iprobe.uk.nr, ikc = _iprobe.bs.kc;
+    // { M, N, K }, the int8 K is odd too (K is packed in pairs)
+    const int d_shapes[][3] = { { 1, 1, 1 }, { dMR + 1, dNR - 1, 13 }, { 3 * dMR - 1, 2 * dNR + 3, dkc + 7 }, { 67, 45, 2 * dkc + 1 } };
+    const int i_shapes[][3] = { { 1, 1, 1 }, { iMR + 1, iNR - 1, 13 }, { 3 * iMR - 1, 2 * iNR + 3, ikc + 7 }, { 67, 45, 2 * ikc + 1 } };
+    const int betas[] = { 0, 1, 2 };
+
+    bool pass = true;
+
+    cout << endl << setw(6) << "M" << setw(6) << "N" << setw(6) << "K" << setw(8) << "trans" << setw(6) << "beta"
+        << setw(10) << "in place" << setw(16) << "double err" << setw(14) << "int8 wrong" << endl;
+    for (int s = 0; s < 4; ++s) {
+        for (int t = 0; t < 4; ++t) {
+            for (const int beta : betas) {
+                for (int in_place = 0; in_place < 2; ++in_place) {
+                    const gemm_case dc = { d_shapes[s][0], d_shapes[s][1], d_shapes[s][2], (t & 1) != 0, (t & 2) != 0, beta, in_place != 0 };
+                    const gemm_case ic = { i_shapes[s][0], i_shapes[s][1], i_shapes[s][2], (t & 1) != 0, (t & 2) != 0, beta, in_place != 0 };
+                    const double err = check_double(dc);
+                    const size_t wrong = check_int8(ic, -128, 127, -128, 127);
+                    const bool ok = err <= 1 && wrong == 0;
+                    pass &= ok;
+
+                    cout << setw(6) << dc.M << setw(6) << dc.N << setw(6) << dc.K << setw(8) << trans_name(dc)
+                        << setw(6) << beta << setw(10) << (dc.in_place ? "yes" : "no") << setw(16) << setprecision(3) << err
+                        << setw(14) << wrong << (ok ? "" : "  FAILED") << endl;
+                }
+            }
+        }
+    }
+
+    // the ends of the range, the products of pairs reach 2 * 128^2 = 2^15, past int16
+    const int ends[][4] = { { -128, -128, -128, -128 }, { 127, 127, 127, 127 }, { -128, -128, 127, 127 }, { -128, 127, -128, 127 } };
+    const char* end_names[] = { "-128 * -128", "127 * 127", "-128 * 127", "{-128, 127}" };
+    cout << endl;
+    for (int e = 0; e < 4; ++e) {
+        size_t wrong = 0;
+        for (int t = 0; t < 4; ++t) {
+            const gemm_case ic = { 2 * iMR + 1, 2 * iNR + 1, 2 * ikc + 3, (t & 1) != 0, (t & 2) != 0, 1, false };
+            wrong += check_int8(ic, ends[e][0], ends[e][1], ends[e][2], ends[e][3]);
+        }
+        pass &= wrong == 0;
+        cout << "int8 " << setw(12) << end_names[e] << " : " << wrong << " wrong" << (wrong == 0 ? "" : "  FAILED") << endl;
+    }
+
+    cout << (pass ? "all passed" : "FAILED") << endl;
+    decx::thread_pool.TerminateAllThreads();
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,101 @@
+// expr_bench.cpp : (A * B + C) / D on the CPU, by the separate element-wise callers (decx::Kmul_m,
+// Kadd_m, Kdiv_m, 3 passes and 3 dispatches of the thread pool) against one fused pass of the lazy
+// expression (decx::expr_eval, the engine of de::cpu::Eval). The time and the bandwidth of both are
+// reported for the lengths from L2 to DRAM, the fused pass streams 5 arrays instead of 9 (the
+// separate calls are in place on dst). Pass 1, 2 or 3 to force SSE4.2, AVX2 or AVX-512.
+//
+
+#define _DECX_CPU_CODES_
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <immintrin.h>
+
+#include "../../../srcs/core/configs/config.h"
+#include "../../../srcs/basic_calculations/operators/Add_exec.h"
+#include "../../../srcs/basic_calculations/operators/Mul_exec.h"
+#include "../../../srcs/basic_calculations/operators/Div_exec.h"
+#include "../../../srcs/basic_calculations/operators/Expr_exec.h"
+
+
+using namespace std;
+typedef chrono::high_resolution_clock _clock;
+
+
+struct aligned_buffer
+{
+    float* ptr;
+    size_t len;
+
+    aligned_buffer(const size_t _len, const float val) : len(_len)
+    {
+        ptr = (float*)_mm_malloc(_len * sizeof(float), 64);
+        for (size_t i = 0; i < _len; ++i) {
+            ptr[i] = val + (float)(i % 7);
+        }
+    }
+    ~aligned_buffer() { _mm_free(ptr); }
+};
+
+
+
+int main(int argc, char** argv)
+{
+    de::InitCPUInfo();
+    if (argc > 1) {
+        de::SetCPUISA(atoi(argv[1]));
+    }
+
+    cout << setw(12) << "length" << setw(16) << "separate (ms)" << setw(10) << "GB/s"
+        << setw(14) << "fused (ms)" << setw(10) << "GB/s" << setw(10) << "speedup" << setw(12) << "max diff" << endl;
+
+    const size_t lengths[] = { 1 << 16, 1 << 20, 1 << 24, 1 << 26 };
+    for (const size_t len : lengths) {
+        aligned_buffer A(len, 1.f), B(len, 2.f), C(len, 3.f), D(len, 4.f), dst_sep(len, 0.f), dst_fused(len, 0.f);
+
+        const uint dims[4] = { 1, (uint)len, 1, 1 };
+        const de::cpu::Expr<float> _A(decx::_expr_leaf<float>(A.ptr, len, dims)), _B(decx::_expr_leaf<float>(B.ptr, len, dims)),
+            _C(decx::_expr_leaf<float>(C.ptr, len, dims)), _D(decx::_expr_leaf<float>(D.ptr, len, dims));
+
+        const int round_num = (int)decx::utils::clamp_min<size_t>((1 << 28) / len, 3);
+
+        // warm up, and first touch of dst
+        decx::Kmul_m(A.ptr, B.ptr, dst_sep.ptr, len, de::cpu::Store_Cached);
+        decx::_expr_program<float> prog;
+        decx::_expr_compile(((_A * _B + _C) / _D)._node.get(), &prog);
+        decx::expr_eval(&prog, dst_fused.ptr);
+
+        _clock::time_point s = _clock::now();
+        for (int r = 0; r < round_num; ++r) {
+            decx::Kmul_m(A.ptr, B.ptr, dst_sep.ptr, len, de::cpu::Store_Cached);
+            decx::Kadd_m(dst_sep.ptr, C.ptr, dst_sep.ptr, len, de::cpu::Store_Cached);
+            decx::Kdiv_m(dst_sep.ptr, D.ptr, dst_sep.ptr, len, de::cpu::Store_Cached);
+        }
+        const double t_sep = chrono::duration<double>(_clock::now() - s).count() / round_num;
+
+        // the tree is built and compiled in each round, as de::cpu::Eval() does
+        s = _clock::now();
+        for (int r = 0; r < round_num; ++r) {
+            decx::_expr_program<float> _prog;
+            decx::_expr_compile(((_A * _B + _C) / _D)._node.get(), &_prog);
+            decx::expr_eval(&_prog, dst_fused.ptr);
+        }
+        const double t_fused = chrono::duration<double>(_clock::now() - s).count() / round_num;
+
+        double diff = 0;
+        for (size_t i = 0; i < len; ++i) {
+            diff = fmax(diff, fabs(dst_sep.ptr[i] - dst_fused.ptr[i]));
+        }
+
+        const double bytes = (double)len * sizeof(float);
+        cout << fixed << setprecision(3);
+        cout << setw(12) << len << setw(16) << t_sep * 1e3 << setw(10) << setprecision(1) << 9 * bytes / t_sep * 1e-9
+            << setw(14) << setprecision(3) << t_fused * 1e3 << setw(10) << setprecision(1) << 5 * bytes / t_fused * 1e-9
+            << setw(10) << setprecision(2) << t_sep / t_fused << setw(12) << scientific << diff << endl;
+    }
+
+    decx::thread_pool.TerminateAllThreads();
+    return 0;
+}
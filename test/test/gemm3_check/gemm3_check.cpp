@@ -0,0 +1,141 @@
+// gemm3_check.cpp : the correctness of the batched GEMM of the CPU (decx::gemm_blocked_batched, the engine of
+// de::cpu::GEMM3()) against a reference in long double. Every product of the batch is checked, for B of each
+// product, B shared by all of them (packed once), dst[i] = A[i] * B[i] + C[i] with C apart from dst and C being
+// dst, of float and of double, for batches of many small products and of a few large ones. The largest error of
+// each case is printed in units of the bound K * eps * sum(|a * b|), and the program returns 1 if any exceeds it.
+// Pass 1, 2 or 3 to force SSE4.2, AVX2 or AVX-512.
+//
+
+#define _DECX_CPU_CODES_
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cfloat>
+
+#include "../../../srcs/core/configs/config.h"
+#include "../../../srcs/GEMM/CPU/sgemm_blocked.h"
+#include "../../../srcs/GEMM/CPU/dgemm.h"
+
+
+using namespace std;
+
+
+enum batch_form
+{
+    Form_PerEntryB,
+    Form_SharedB,
+    Form_AddC,
+    Form_AddC_InPlace,      // dst is C
+};
+
+
+static const char* form_names[] = { "A[i] * B[i]", "A[i] * B", "A[i] * B[i] + C[i]", "C[i] += A[i] * B[i]" };
+
+
+static mt19937 rng(1);
+
+
+// the largest error in units of the bound over all the products of the batch
+template <typename T, typename _info_type>
+static double check(const batch_form form, const size_t batch, const int M, const int N, const int K)
+{
+    const T eps = sizeof(T) == 4 ? FLT_EPSILON : DBL_EPSILON;
+    // the pitches and the planes are padded, as the ones of de::MatrixArray are
+    const size_t lda = K + 3, ldb = N + 1, ldc = N + 5;
+    const size_t plane_A = M * lda + 7, plane_B = K * ldb + 9, plane_C = M * ldc + 11;
+    const bool shared_B = form == Form_SharedB, add_C = form == Form_AddC || form == Form_AddC_InPlace;
+
+    uniform_real_distribution<double> dist(-1, 1);
+    vector<T> A(batch * plane_A), B((shared_B ? 1 : batch) * plane_B), C(batch * plane_C), dst(batch * plane_C);
+    for (T& x : A) x = (T)dist(rng);
+    for (T& x : B) x = (T)dist(rng);
+    for (T& x : C) x = (T)dist(rng);
+    for (T& x : dst) x = (T)dist(rng);
+    if (form == Form_AddC_InPlace) {
+        C = dst;
+    }
+    const vector<T> S = C;
+
+    _info_type info;
+    info.A = A.data();      info.lda = lda;
+    info.B = B.data();      info.ldb = ldb;
+    info.C = dst.data();    info.ldc = ldc;
+    info.M = M;     info.N = N;     info.K = K;
+    info.alpha = 1;
+    info.beta = 1;
+    info.S = add_C ? (form == Form_AddC_InPlace ? dst.data() : C.data()) : NULL;
+    info.lds = ldc;
+
+    decx::_gemm_batch_strides strides;
+    strides.A = plane_A;
+    strides.B = shared_B ? 0 : plane_B;
+    strides.C = plane_C;
+    strides.S = add_C ? plane_C : 0;
+
+    if (!decx::gemm_blocked_batched(&info, batch, &strides)) {
+        return INFINITY;
+    }
+
+    double err = 0;
+    for (size_t b = 0; b < batch; ++b) {
+        const T* _A = A.data() + b * plane_A, * _B = B.data() + (shared_B ? 0 : b * plane_B);
+        const T* _S = S.data() + b * plane_C, * _dst = dst.data() + b * plane_C;
+
+        for (int i = 0; i < M; ++i) {
+            for (int j = 0; j < N; ++j) {
+                long double acc = 0, mag = 0;
+                for (int k = 0; k < K; ++k) {
+                    acc += (long double)_A[i * lda + k] * _B[k * ldb + j];
+                    mag += fabsl((long double)_A[i * lda + k] * _B[k * ldb + j]);
+                }
+                if (add_C) {
+                    acc += _S[i * ldc + j];
+                    mag += fabsl(_S[i * ldc + j]);
+                }
+                const long double bound = (K + 2) * eps * mag + (sizeof(T) == 4 ? FLT_MIN : DBL_MIN);
+                err = fmax(err, (double)(fabsl(_dst[i * ldc + j] - acc) / bound));
+            }
+        }
+    }
+    return err;
+}
+
+
+
+int main(int argc, char** argv)
+{
+    de::InitCPUInfo();
+    if (argc > 1) {
+        de::SetCPUISA(atoi(argv[1]));
+    }
+
+    const decx::_sgemm_blocked_info _probe;
+    const int kc = _probe.bs.kc;
+
+    // { batch, M, N, K } : many small products (one per thread), a few large ones (cut inside), K past kc
+    const int shapes[][4] = { { 1, 1, 1, 1 }, { 64, 7, 9, 5 }, { 37, 16, 16, 16 }, { 3, 61, 67, 53 }, { 2, 45, 37, kc + 9 } };
+
+    bool pass = true;
+    cout << setw(22) << "form" << setw(7) << "batch" << setw(5) << "M" << setw(5) << "N" << setw(6) << "K"
+        << setw(12) << "float err" << setw(12) << "double err" << endl;
+
+    for (const auto& s : shapes) {
+        for (int f = 0; f < 4; ++f) {
+            const batch_form form = (batch_form)f;
+            const double err_f = check<float, decx::_sgemm_blocked_info>(form, s[0], s[1], s[2], s[3]);
+            const double err_d = check<double, decx::_dgemm_blocked_info>(form, s[0], s[1], s[2], s[3]);
+            const bool ok = err_f <= 1 && err_d <= 1;
+            pass &= ok;
+
+            cout << setw(22) << form_names[f] << setw(7) << s[0] << setw(5) << s[1] << setw(5) << s[2] << setw(6) << s[3]
+                << setw(12) << setprecision(3) << err_f << setw(12) << err_d << (ok ? "" : "  FAILED") << endl;
+        }
+    }
+
+    cout << (pass ? "all passed" : "FAILED") << endl;
+    decx::thread_pool.TerminateAllThreads();
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,154 @@
+// gemm_check.cpp : the correctness of the SGEMM of the CPU (decx::sgemm_blocked and decx::sgemm_small, the
+// engines of de::cpu::GEMM()) against a reference in double. C = alpha * op(A) * op(B) + beta * S is checked
+// for the four combinations of the transposes, beta of 0, 1 and 2, S apart from C and S being C (accumulating
+// in place), K of 0, and M, N and K that are not multiples of the MR x NR micro-kernel or of kc. Each case
+// prints its largest error in units of the bound K * eps * sum(|a * b|), and the program returns 1 if any
+// exceeds it. Pass 1, 2 or 3 to force SSE4.2, AVX2 or AVX-512.
+//
+
+#define _DECX_CPU_CODES_
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cfloat>
+
+#include "../../../srcs/core/configs/config.h"
+#include "../../../srcs/GEMM/CPU/sgemm_blocked.h"
+#include "../../../srcs/GEMM/CPU/sgemm_small.h"
+
+
+using namespace std;
+
+
+struct gemm_case
+{
+    int M, N, K;
+    bool transA, transB;
+    float beta;
+    bool in_place;      // S is C
+};
+
+
+static mt19937 rng(1);
+
+
+static void fill(vector<float>& v)
+{
+    uniform_real_distribution<float> dist(-1.f, 1.f);
+    for (float& x : v) {
+        x = dist(rng);
+    }
+}
+
+
+// the largest |C - ref| / bound of the case, the blocked engine if force_blocked, the one de::cpu::GEMM() picks otherwise
+static double check(const gemm_case& c, const bool force_blocked)
+{
+    const float alpha = 1.5f;
+    // the stored A is K x M if transposed, the pitches are padded to catch the reads past the rows
+    const int rows_A = c.transA ? c.K : c.M, cols_A = c.transA ? c.M : c.K;
+    const int rows_B = c.transB ? c.N : c.K, cols_B = c.transB ? c.K : c.N;
+    const size_t lda = cols_A + 3, ldb = cols_B + 5, ldc = c.N + 7;
+
+    vector<float> A(rows_A * lda + 1), B(rows_B * ldb + 1), C(c.M * ldc + 1), S(c.M * ldc + 1);
+    fill(A);    fill(B);    fill(C);    fill(S);
+    if (c.in_place) {
+        S = C;
+    }
+
+    vector<double> ref(c.M * c.N), bound(c.M * c.N);
+    for (int i = 0; i < c.M; ++i) {
+        for (int j = 0; j < c.N; ++j) {
+            double acc = 0, mag = 0;
+            for (int k = 0; k < c.K; ++k) {
+                const double a = c.transA ? A[k * lda + i] : A[i * lda + k];
+                const double b = c.transB ? B[j * ldb + k] : B[k * ldb + j];
+                acc += a * b;
+                mag += fabs(a * b);
+            }
+            const double s = c.beta != 0 ? (double)c.beta * S[i * ldc + j] : 0;
+            ref[i * c.N + j] = alpha * acc + s;
+            bound[i * c.N + j] = (c.K + 2) * FLT_EPSILON * (fabs(alpha) * mag + fabs(s)) + FLT_MIN;
+        }
+    }
+
+    decx::_sgemm_blocked_info info;
+    info.A = A.data();      info.lda = lda;
+    info.B = B.data();      info.ldb = ldb;
+    info.C = C.data();      info.ldc = ldc;
+    info.M = c.M;   info.N = c.N;   info.K = c.K;
+    info.alpha = alpha;
+    info.beta = c.beta;
+    // de::cpu::GEMM() passes no S if beta is 0
+    info.S = c.beta != 0 ? (c.in_place ? C.data() : S.data()) : NULL;
+    info.lds = ldc;
+    info.transA = c.transA;
+    info.transB = c.transB;
+
+    if (!force_blocked && decx::sgemm_small_eligible(&info)) {
+        decx::sgemm_small(&info);
+    }
+    else if (!decx::sgemm_blocked(&info, NULL)) {
+        return INFINITY;
+    }
+
+    double err = 0;
+    for (int i = 0; i < c.M; ++i) {
+        for (int j = 0; j < c.N; ++j) {
+            err = fmax(err, fabs(C[i * ldc + j] - ref[i * c.N + j]) / bound[i * c.N + j]);
+        }
+    }
+    return err;
+}
+
+
+
+int main(int argc, char** argv)
+{
+    de::InitCPUInfo();
+    if (argc > 1) {
+        de::SetCPUISA(atoi(argv[1]));
+    }
+
+    const decx::_sgemm_blocked_info _probe;
+    const int MR = _probe.uk.mr, NR = _probe.uk.nr, kc = _probe.bs.kc;
+    cout << "micro-kernel : " << MR << " x " << NR << ", kc = " << kc << endl;
+
+    // { M, N, K } : the small ones, the edges of the micro-kernel, more than one kc-block, and K = 0
+    const int shapes[][3] = {
+        { 1, 1, 1 }, { 5, 7, 9 }, { 16, 16, 16 }, { 32, 32, 32 },
+        { MR + 1, NR - 1, 17 }, { 3 * MR - 1, 2 * NR + 3, kc + 7 }, { 2 * MR + 3, NR + 1, 2 * kc + 1 },
+        { 131, 97, 3 * kc - 5 }, { 7, 5, 0 }, { 2 * MR + 1, 2 * NR + 1, 0 },
+    };
+    const float betas[] = { 0.f, 1.f, 2.f };
+
+    bool pass = true;
+    cout << setw(6) << "M" << setw(6) << "N" << setw(6) << "K" << setw(8) << "trans" << setw(6) << "beta"
+        << setw(10) << "in place" << setw(14) << "err (chosen)" << setw(15) << "err (blocked)" << endl;
+
+    for (const auto& shape : shapes) {
+        for (int t = 0; t < 4; ++t) {
+            for (const float beta : betas) {
+                for (int in_place = 0; in_place < 2; ++in_place) {
+                    const gemm_case c = { shape[0], shape[1], shape[2], (t & 1) != 0, (t & 2) != 0, beta, in_place != 0 };
+                    const double err_chosen = check(c, false), err_blocked = check(c, true);
+                    const bool ok = err_chosen <= 1 && err_blocked <= 1;
+                    pass &= ok;
+
+                    cout << setw(6) << c.M << setw(6) << c.N << setw(6) << c.K
+                        << setw(8) << (t == 0 ? "NN" : t == 1 ? "TN" : t == 2 ? "NT" : "TT")
+                        << setw(6) << beta << setw(10) << (c.in_place ? "yes" : "no")
+                        << setw(14) << setprecision(3) << err_chosen << setw(15) << err_blocked
+                        << (ok ? "" : "  FAILED") << endl;
+                }
+            }
+        }
+    }
+
+    cout << (pass ? "all passed" : "FAILED") << endl;
+    decx::thread_pool.TerminateAllThreads();
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+// gemv_check.cpp : de::cpu::GEMV() and de::cpu::GER() of float and double against scalar loops in long double.
+// GEMV is checked in the N (y = alpha * A * x) and T (y = alpha * A^T * x) forms, without z, with z apart from y
+// and with z being y (in place), and GER (A += alpha * x * y^T) on its own. The shapes are off the multiples of
+// the vectors and of the blocking of the kernels (4 rows, 32 cols, _GEMV_T_BLOCK_ of the T form), and large enough
+// for the calls cut among the threads. y being x must be rejected by DECX_FAIL_OperandAliasing. Prints the largest
+// error of each form in units of the bound n * eps * sum(|a * x|), returns 1 if any check fails. Pass 1, 2 or 3
+// to force SSE4.2, AVX2 or AVX-512.
+//
+
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <cmath>
+#include <cfloat>
+#include <vector>
+
+#pragma comment(lib, "../../../bin/x64/DECX_cpu.lib")
+
+#include "../../../APIs/DECX.h"
+
+
+using namespace std;
+
+
+static mt19937 rng(1);
+static bool pass = true;
+
+
+template <typename T>
+static void fill(de::Matrix<T>& mat)
+{
+    uniform_real_distribution<double> dist(-1, 1);
+    for (uint i = 0; i < mat.Height(); ++i) {
+        for (uint j = 0; j < mat.Width(); ++j) {
+            mat.index(i, j) = (T)dist(rng);
+        }
+    }
+}
+
+
+template <typename T>
+static void fill(de::Vector<T>& vec)
+{
+    uniform_real_distribution<double> dist(-1, 1);
+    for (uint i = 0; i < vec.Len(); ++i) {
+        vec.index(i) = (T)dist(rng);
+    }
+}
+
+
+// the largest error of y = alpha * op(A) * x + beta * z (z of the values before the call, NULL for none)
+template <typename T>
+static double gemv_error(de::Matrix<T>& A, de::Vector<T>& x, const T* z, de::Vector<T>& y, const T alpha, const T beta,
+    const bool trans)
+{
+    const T eps = sizeof(T) == 4 ? FLT_EPSILON : DBL_EPSILON;
+    const uint len_y = trans ? A.Width() : A.Height(), len_x = trans ? A.Height() : A.Width();
+    if (y.Len() != len_y) {
+        return INFINITY;
+    }
+
+    double err = 0;
+    for (uint i = 0; i < len_y; ++i) {
+        long double acc = 0, mag = 0;
+        for (uint k = 0; k < len_x; ++k) {
+            const long double ax = (long double)(trans ? A.index(k, i) : A.index(i, k)) * x.index(k);
+            acc += ax;
+            mag += fabsl(ax);
+        }
+        const long double s = z != NULL ? (long double)beta * z[i] : 0;
+        const long double bound = (len_x + 2) * eps * (fabsl(alpha) * mag + fabsl(s)) + (sizeof(T) == 4 ? FLT_MIN : DBL_MIN);
+        err = fmax(err, (double)(fabsl(y.index(i) - (alpha * acc + s)) / bound));
+    }
+    return err;
+}
+
+
+template <typename T>
+static void check(const char* type_name, const int M, const int N)
+{
+    const T alpha = (T)1.5, beta = (T)-0.5;
+    de::Matrix<T>& A = de::CreateMatrixRef<T>(N, M, de::DATA_STORE_TYPE::Page_Default);
+    de::Vector<T>& x_N = de::CreateVectorRef<T>(N, de::DATA_STORE_TYPE::Page_Default);
+    de::Vector<T>& x_T = de::CreateVectorRef<T>(M, de::DATA_STORE_TYPE::Page_Default);
+    de::Vector<T>& z_N = de::CreateVectorRef<T>(M, de::DATA_STORE_TYPE::Page_Default);
+    de::Vector<T>& z_T = de::CreateVectorRef<T>(N, de::DATA_STORE_TYPE::Page_Default);
+    de::Vector<T>& y = de::CreateVectorRef<T>();
+    fill(A);    fill(x_N);  fill(x_T);  fill(z_N);  fill(z_T);
+
+    double err[7] = { 0 };
+    vector<T> _z(M > N ? M : N);
+
+    // N and T, without z
+    de::cpu::GEMV(A, x_N, y, alpha);
+    err[0] = gemv_error<T>(A, x_N, NULL, y, alpha, 0, false);
+    de::cpu::GEMV(A, x_T, y, alpha, de::cpu::GEMM_TransA);
+    err[1] = gemv_error<T>(A, x_T, NULL, y, alpha, 0, true);
+
+    // with z apart from y
+    for (int i = 0; i < M; ++i) { _z[i] = z_N.index(i); }
+    de::cpu::GEMV(A, x_N, z_N, y, alpha, beta);
+    err[2] = gemv_error<T>(A, x_N, _z.data(), y, alpha, beta, false);
+    for (int i = 0; i < N; ++i) { _z[i] = z_T.index(i); }
+    de::cpu::GEMV(A, x_T, z_T, y, alpha, beta, de::cpu::GEMM_TransA);
+    err[3] = gemv_error<T>(A, x_T, _z.data(), y, alpha, beta, true);
+
+    // z being y
+    for (int i = 0; i < M; ++i) { _z[i] = z_N.index(i); }
+    de::cpu::GEMV(A, x_N, z_N, z_N, alpha, beta);
+    err[4] = gemv_error<T>(A, x_N, _z.data(), z_N, alpha, beta, false);
+    for (int i = 0; i < N; ++i) { _z[i] = z_T.index(i); }
+    de::cpu::GEMV(A, x_T, z_T, z_T, alpha, beta, de::cpu::GEMM_TransA);
+    err[5] = gemv_error<T>(A, x_T, _z.data(), z_T, alpha, beta, true);
+
+    // GER, A += alpha * x_T * x_N^T
+    vector<T> A0((size_t)M * N);
+    for (int i = 0; i < M; ++i) {
+        for (int j = 0; j < N; ++j) { A0[(size_t)i * N + j] = A.index(i, j); }
+    }
+    de::cpu::GER(x_T, x_N, A, alpha);
+    const T eps = sizeof(T) == 4 ? FLT_EPSILON : DBL_EPSILON;
+    for (int i = 0; i < M; ++i) {
+        for (int j = 0; j < N; ++j) {
+            const long double a0 = A0[(size_t)i * N + j], axy = (long double)alpha * x_T.index(i) * x_N.index(j);
+            const long double bound = 3 * eps * (fabsl(a0) + fabsl(axy))
+                + (sizeof(T) == 4 ? FLT_MIN : DBL_MIN);
+            err[6] = fmax(err[6], (double)(fabsl(A.index(i, j) - (a0 + axy)) / bound));
+        }
+    }
+
+    // y being x
+    const bool rejected = de::cpu::GEMV(A, x_N, x_N, alpha).error_type == de::DECX_FAIL_OperandAliasing &&
+        de::cpu::GEMV(A, x_N, z_N, x_N, alpha, beta).error_type == de::DECX_FAIL_OperandAliasing;
+
+    bool ok = rejected;
+    for (int i = 0; i < 7; ++i) {
+        ok &= err[i] <= 1;
+    }
+    pass &= ok;
+
+    cout << setw(7) << type_name << setw(6) << M << setw(6) << N << setprecision(3);
+    for (int i = 0; i < 7; ++i) {
+        cout << setw(9) << err[i];
+    }
+    cout << setw(10) << (rejected ? "yes" : "no") << (ok ? "" : "  FAILED") << endl;
+
+    A.release();    x_N.release();  x_T.release();
+    z_N.release();  z_T.release();  y.release();
+}
+
+
+
+int main(int argc, char** argv)
+{
+    de::InitCPUInfo();
+    if (argc > 1) {
+        de::SetCPUISA(atoi(argv[1]));
+    }
+
+    // { M, N } : below a vector, off the 4 rows and 32 cols, past _GEMV_T_BLOCK_ (1024), cut among the threads
+    const int shapes[][2] = { { 1, 1 }, { 3, 5 }, { 7, 31 }, { 33, 9 }, { 67, 129 }, { 5, 1031 }, { 1029, 3 }, { 523, 2053 } };
+
+    cout << setw(7) << "type" << setw(6) << "M" << setw(6) << "N" << setw(9) << "N" << setw(9) << "T"
+        << setw(9) << "N + z" << setw(9) << "T + z" << setw(9) << "N, z=y" << setw(9) << "T, z=y" << setw(9) << "GER"
+        << setw(10) << "y=x rej." << endl;
+    for (const auto& s : shapes) {
+        check<float>("float", s[0], s[1]);
+        check<double>("double", s[0], s[1]);
+    }
+
+    cout << (pass ? "all passed" : "FAILED") << endl;
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+// huge_page_bench.cpp : element-wise calls and a TLB-bound column walk on the matrices stored in
+// the default pageable pages and in the huge pages (de::DATA_STORE_TYPE::Page_Huge)
+//
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+#pragma comment(lib, "../../../bin/x64/DECX_cpu.lib")
+
+#include "../../../APIs/DECX.h"
+
+
+using namespace std;
+typedef chrono::high_resolution_clock _clock;
+
+
+struct _result
+{
+    double add_ms, mul_ms, walk_ms;
+};
+
+
+// walk down the columns, two consecutive reads are one pitch (32KB) apart, so every read of the
+// default pages lands on another 4KB page, while a 2MB page covers 64 rows
+static float column_walk(de::Matrix<float>& A)
+{
+    float sum = 0;
+    for (int j = 0; j < A.Width(); j += 16) {
+        for (int i = 0; i < A.Height(); ++i) {
+            sum += A.index(i, j);
+        }
+    }
+    return sum;
+}
+
+
+
+static _result bench(const int store_type)
+{
+    const int round_num = 10;
+    const int height = 8192, width = 8192;
+
+    de::Matrix<float>& A = de::CreateMatrixRef<float>(width, height, store_type);
+    de::Matrix<float>& B = de::CreateMatrixRef<float>(width, height, store_type);
+    de::Matrix<float>& C = de::CreateMatrixRef<float>(width, height, store_type);
+
+    for (int i = 0; i < height; ++i) {
+        for (int j = 0; j < width; ++j) {
+            A.index(i, j) = (float)(j & 15);
+            B.index(i, j) = 2.f;
+        }
+    }
+
+    // warm up the pages and the workers
+    de::cpu::Add(A, B, C);
+
+    _result res = { 0, 0, 0 };
+    float sink = 0;
+    for (int r = 0; r < round_num; ++r) {
+        _clock::time_point s = _clock::now();
+        de::cpu::Add(A, B, C);
+        res.add_ms += chrono::duration<double, std::milli>(_clock::now() - s).count();
+
+        s = _clock::now();
+        de::cpu::Mul(A, B, C);
+        res.mul_ms += chrono::duration<double, std::milli>(_clock::now() - s).count();
+
+        s = _clock::now();
+        sink += column_walk(A);
+        res.walk_ms += chrono::duration<double, std::milli>(_clock::now() - s).count();
+    }
+    res.add_ms /= round_num;
+    res.mul_ms /= round_num;
+    res.walk_ms /= round_num;
+
+    cout << "(checksum " << sink << ")" << endl;
+
+    A.release();
+    B.release();
+    C.release();
+    return res;
+}
+
+
+
+int main()
+{
+    de::InitCPUInfo();
+
+    const _result _default = bench(de::DATA_STORE_TYPE::Page_Default);
+    const _result _huge = bench(de::DATA_STORE_TYPE::Page_Huge);
+
+    cout << fixed << setprecision(3);
+    cout << setw(14) << "" << setw(14) << "Page_Default" << setw(14) << "Page_Huge" << setw(10) << "speedup" << endl;
+    cout << setw(14) << "Add (ms)" << setw(14) << _default.add_ms << setw(14) << _huge.add_ms
+        << setw(10) << _default.add_ms / _huge.add_ms << endl;
+    cout << setw(14) << "Mul (ms)" << setw(14) << _default.mul_ms << setw(14) << _huge.mul_ms
+        << setw(10) << _default.mul_ms / _huge.mul_ms << endl;
+    cout << setw(14) << "walk (ms)" << setw(14) << _default.walk_ms << setw(14) << _huge.walk_ms
+        << setw(10) << _default.walk_ms / _huge.walk_ms << endl;
+
+    de::MemoryStats stats = de::GetMemoryStats();
+    cout << "huge page pool peak reserved : " << (stats.Host_Huge.peak_reserved_bytes >> 20) << " MB" << endl;
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+// idle_policy_bench.cpp : latency of back-to-back small element-wise calls under each idle policy
+// of the CPU worker threads (de::cpu::SetIdlePolicy)
+//
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <thread>
+
+#pragma comment(lib, "../../../bin/x64/DECX_cpu.lib")
+
+#include "../../../APIs/DECX.h"
+
+
+using namespace std;
+typedef chrono::high_resolution_clock _clock;
+
+
+// call Add and Mul back to back, with gap_us of idle time between two rounds
+static void bench(const int policy, const char* name, const uint gap_us,
+    de::Matrix<float>& A, de::Matrix<float>& B, de::Matrix<float>& C)
+{
+    const int round_num = 5000;
+    std::vector<double> samples(round_num);
+
+    de::cpu::SetIdlePolicy(policy);
+
+    for (int i = 0; i < round_num; ++i) {
+        if (gap_us > 0) {
+            _clock::time_point _until = _clock::now() + chrono::microseconds(gap_us);
+            while (_clock::now() < _until) {}
+        }
+        _clock::time_point s = _clock::now();
+        de::cpu::Add(A, B, C);
+        de::cpu::Mul(A, C, C);
+        samples[i] = chrono::duration<double, std::micro>(_clock::now() - s).count();
+    }
+
+    std::sort(samples.begin(), samples.end());
+    cout << setw(18) << name << " gap " << setw(5) << gap_us << " us : p50 = " << setw(8) << samples[round_num / 2]
+        << " us, p99 = " << setw(8) << samples[(round_num * 99) / 100] << " us" << endl;
+}
+
+
+
+int main()
+{
+    de::InitCPUInfo();
+
+    // 256 x 256 floats, split into a few chunks only
+    de::Matrix<float>& A = de::CreateMatrixRef<float>(256, 256, de::DATA_STORE_TYPE::Page_Default);
+    de::Matrix<float>& B = de::CreateMatrixRef<float>(256, 256, de::DATA_STORE_TYPE::Page_Default);
+    de::Matrix<float>& C = de::CreateMatrixRef<float>(256, 256, de::DATA_STORE_TYPE::Page_Default);
+
+    for (int i = 0; i < A.Height(); ++i) {
+        for (int j = 0; j < A.Width(); ++j) {
+            A.index(i, j) = 1.f;
+            B.index(i, j) = 2.f;
+        }
+    }
+
+    const uint gaps[3] = { 0, 50, 1000 };
+    for (int g = 0; g < 3; ++g) {
+        bench(de::cpu::Idle_Latency, "Idle_Latency", gaps[g], A, B, C);
+        bench(de::cpu::Idle_Balanced, "Idle_Balanced", gaps[g], A, B, C);
+        bench(de::cpu::Idle_PowerSaving, "Idle_PowerSaving", gaps[g], A, B, C);
+        cout << endl;
+    }
+
+    de::cpu::SetIdlePolicy(de::cpu::Idle_Balanced);
+
+    A.release();
+    B.release();
+    C.release();
+    return 0;
+}
@@ -0,0 +1,108 @@
+// isa_dispatch_bench.cpp : the CPU operators with the kernels of each instruction set forced by
+// de::SetCPUISA(), from SSE4.2 up to the highest level the host supports
+//
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+#pragma comment(lib, "../../../bin/x64/DECX_cpu.lib")
+
+#include "../../../APIs/DECX.h"
+
+
+using namespace std;
+typedef chrono::high_resolution_clock _clock;
+
+
+static const char* isa_names[] = { "Auto", "SSE4.2", "AVX2", "AVX-512" };
+
+
+struct _result
+{
+    double add_ms, mul_c_ms, div_ms, gemm_gflops, gray_ms;
+};
+
+
+
+template <typename _Func>
+static double time_ms(_Func f, const int round_num)
+{
+    f();            // warm up
+    _clock::time_point s = _clock::now();
+    for (int r = 0; r < round_num; ++r) {
+        f();
+    }
+    return chrono::duration<double, std::milli>(_clock::now() - s).count() / round_num;
+}
+
+
+
+static _result bench(de::Matrix<float>& A, de::Matrix<float>& B, de::Matrix<float>& C,
+    de::Matrix<float>& gA, de::Matrix<float>& gB, de::Matrix<float>& gC, de::vis::Img& img, de::vis::Img& gray)
+{
+    _result res;
+    res.add_ms = time_ms([&]() { de::cpu::Add(A, B, C); }, 20);
+    res.mul_c_ms = time_ms([&]() { de::cpu::Mul(A, 1.0001f, C); }, 20);
+    res.div_ms = time_ms([&]() { de::cpu::Div(A, B, C); }, 20);
+
+    const double gemm_ms = time_ms([&]() { de::cpu::sgemm(gA, gB, gC); }, 5);
+    res.gemm_gflops = 2.0 * gA.Height() * gB.Width() * gA.Width() / (gemm_ms * 1e6);
+
+    res.gray_ms = time_ms([&]() { de::vis::merge_channel(img, gray, de::vis::ImgChannelMergeType::BGR_to_Gray); }, 20);
+    return res;
+}
+
+
+
+int main()
+{
+    de::InitCPUInfo();
+    const int detected = de::GetCPUISA();
+    cout << "highest ISA supported : " << isa_names[detected] << endl << endl;
+
+    const int ew_size = 4096, gemm_size = 1536, img_size = 4096;
+
+    de::Matrix<float>& A = de::CreateMatrixRef<float>(ew_size, ew_size, de::DATA_STORE_TYPE::Page_Default);
+    de::Matrix<float>& B = de::CreateMatrixRef<float>(ew_size, ew_size, de::DATA_STORE_TYPE::Page_Default);
+    de::Matrix<float>& C = de::CreateMatrixRef<float>(ew_size, ew_size, de::DATA_STORE_TYPE::Page_Default);
+    for (int i = 0; i < ew_size; ++i) {
+        for (int j = 0; j < ew_size; ++j) {
+            A.index(i, j) = (float)(j & 255);
+            B.index(i, j) = (float)((i & 15) + 1);
+        }
+    }
+
+    de::Matrix<float>& gA = de::CreateMatrixRef<float>(gemm_size, gemm_size, de::DATA_STORE_TYPE::Page_Default);
+    de::Matrix<float>& gB = de::CreateMatrixRef<float>(gemm_size, gemm_size, de::DATA_STORE_TYPE::Page_Default);
+    de::Matrix<float>& gC = de::CreateMatrixRef<float>(gemm_size, gemm_size, de::DATA_STORE_TYPE::Page_Default);
+    for (int i = 0; i < gemm_size; ++i) {
+        for (int j = 0; j < gemm_size; ++j) {
+            gA.index(i, j) = (float)((i + j) % 7) - 3.f;
+            gB.index(i, j) = (float)((i * j) % 5) - 2.f;
+        }
+    }
+
+    de::vis::Img& img = de::vis::CreateImgRef(img_size, img_size, de::vis::ImgConstructType::DE_UC4);
+    de::vis::Img& gray = de::vis::CreateImgRef(img_size, img_size, de::vis::ImgConstructType::DE_UC1);
+
+    _result res[4];
+    for (int isa = de::CPU_ISA::ISA_SSE42; isa <= detected; ++isa) {
+        de::SetCPUISA(isa);
+        res[isa] = bench(A, B, C, gA, gB, gC, img, gray);
+    }
+    de::SetCPUISA(de::CPU_ISA::ISA_Auto);
+
+    cout << fixed << setprecision(3);
+    cout << setw(10) << "ISA" << setw(12) << "Add (ms)" << setw(14) << "Mul_c (ms)" << setw(12) << "Div (ms)"
+        << setw(16) << "sgemm GFLOPS" << setw(14) << "Gray (ms)" << endl;
+    for (int isa = de::CPU_ISA::ISA_SSE42; isa <= detected; ++isa) {
+        cout << setw(10) << isa_names[isa] << setw(12) << res[isa].add_ms << setw(14) << res[isa].mul_c_ms
+            << setw(12) << res[isa].div_ms << setw(16) << res[isa].gemm_gflops << setw(14) << res[isa].gray_ms << endl;
+    }
+
+    A.release();        B.release();        C.release();
+    gA.release();       gB.release();       gC.release();
+    img.release();      gray.release();
+    return 0;
+}
@@ -0,0 +1,119 @@
+// mem_pool_bench.cpp : stress benchmark of decx::MemPool_Hv with the thread-local caches
+// N threads allocate and deallocate blocks of mixed sizes (1KB to 1MB, log-uniform), each
+// keeping a window of live blocks. Reports the operations/sec of the pool and of malloc/free
+// for N = 1, 2, 4, ... up to the number of the hardware threads.
+//
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <thread>
+#include <random>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+#include "../../../srcs/core/memory_management/MemoryPool_Hv.h"
+
+
+using namespace std;
+typedef chrono::high_resolution_clock _clock;
+
+
+#define _LIVE_WINDOW_ 16
+#define _OPS_PER_THREAD_ 1000000
+
+
+decx::MemPool_Hv pool(false);
+
+
+// the sizes used by all the threads, log-uniform from 1KB to 1MB
+static vector<size_t> make_sizes(const size_t num, const unsigned seed)
+{
+    mt19937 rng(seed);
+    uniform_real_distribution<double> dist(10, 20);
+    vector<size_t> sizes(num);
+    for (size_t i = 0; i < num; ++i) {
+        sizes[i] = (size_t)pow(2.0, dist(rng));
+    }
+    return sizes;
+}
+
+
+
+static void pool_worker(const vector<size_t>* sizes, const unsigned seed)
+{
+    mt19937 rng(seed);
+    decx::MemBlock* live[_LIVE_WINDOW_] = { NULL };
+
+    for (size_t i = 0; i < _OPS_PER_THREAD_; ++i) {
+        const int slot = rng() % _LIVE_WINDOW_;
+        if (live[slot] != NULL) {
+            pool.deallocate(live[slot]);
+        }
+        pool.allocate((*sizes)[i % sizes->size()], &live[slot]);
+        live[slot]->_ptr[0] = (uchar)i;          // touch it
+    }
+    for (int i = 0; i < _LIVE_WINDOW_; ++i) {
+        if (live[i] != NULL) {
+            pool.deallocate(live[i]);
+        }
+    }
+}
+
+
+
+static void malloc_worker(const vector<size_t>* sizes, const unsigned seed)
+{
+    mt19937 rng(seed);
+    uchar* live[_LIVE_WINDOW_] = { NULL };
+
+    for (size_t i = 0; i < _OPS_PER_THREAD_; ++i) {
+        const int slot = rng() % _LIVE_WINDOW_;
+        free(live[slot]);
+        live[slot] = (uchar*)malloc((*sizes)[i % sizes->size()]);
+        live[slot][0] = (uchar)i;
+    }
+    for (int i = 0; i < _LIVE_WINDOW_; ++i) {
+        free(live[i]);
+    }
+}
+
+
+
+// @return operations (one alloc + one free) per second, summed over all the threads
+static double run(void (*worker)(const vector<size_t>*, const unsigned), const vector<size_t>& sizes, const int thread_num)
+{
+    vector<thread> threads;
+    _clock::time_point s = _clock::now();
+    for (int i = 0; i < thread_num; ++i) {
+        threads.emplace_back(worker, &sizes, (unsigned)i + 1);
+    }
+    for (int i = 0; i < thread_num; ++i) {
+        threads[i].join();
+    }
+    _clock::time_point e = _clock::now();
+
+    return (double)thread_num * _OPS_PER_THREAD_ / chrono::duration<double>(e - s).count();
+}
+
+
+
+int main()
+{
+    const int max_thread_num = max(1, (int)thread::hardware_concurrency());
+    const vector<size_t> sizes = make_sizes(4096, 0);
+
+    // warm up, let the pool reach its steady size
+    run(pool_worker, sizes, 1);
+
+    cout << setw(8) << "threads" << setw(20) << "MemPool_Hv (ops/s)" << setw(20) << "malloc (ops/s)" << endl;
+    for (int n = 1; n <= max_thread_num; n *= 2) {
+        const double pool_ops = run(pool_worker, sizes, n);
+        const double malloc_ops = run(malloc_worker, sizes, n);
+        cout << setw(8) << n << setw(20) << (size_t)pool_ops << setw(20) << (size_t)malloc_ops << endl;
+    }
+
+    return 0;
+}
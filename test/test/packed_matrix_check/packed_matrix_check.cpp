@@ -0,0 +1,214 @@
+// packed_matrix_check.cpp : de::cpu::PackedMatrix, the prepacked B of de::cpu::GEMM(). Checks
+//   1. de::cpu::PackMatrix() of B and of B transposed (de::cpu::GEMM_TransB), the GEMMs against the packed B
+//      (with and without C, with de::cpu::GEMM_TransA) against a reference in double and against de::cpu::GEMM()
+//      of the unpacked B;
+//   2. de::cpu::SavePackedMatrix() and de::cpu::LoadPackedMatrix() round trip, the GEMM against the loaded
+//      matrix is the same as against the saved one to the bit;
+//   3. DECX_FAIL_PackedLayout of a file of a broken header, of a file cut short (the loaded matrix is released),
+//      and of a matrix packed under a micro-kernel of other NR (by de::SetCPUISA());
+//   4. DECX_FAIL_FileNotExist of a missing file, and DECX_FAIL_FileIO of a failed write (to /dev/full) and of
+//      a failed read (of a directory), where the system has them.
+// Returns 1 if any check fails. Pass 1, 2 or 3 to force SSE4.2, AVX2 or AVX-512.
+//
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <cstring>
+
+#pragma comment(lib, "../../../bin/x64/DECX_cpu.lib")
+
+#include "../../../APIs/DECX.h"
+
+
+using namespace std;
+
+
+static mt19937 rng(1);
+static bool pass = true;
+
+
+static void report(const char* name, const bool ok)
+{
+    pass &= ok;
+    cout << setw(52) << left << name << (ok ? "ok" : "FAILED") << right << endl;
+}
+
+
+static void fill(de::Matrix<float>& mat)
+{
+    uniform_real_distribution<float> dist(-1.f, 1.f);
+    for (uint i = 0; i < mat.Height(); ++i) {
+        for (uint j = 0; j < mat.Width(); ++j) {
+            mat.index(i, j) = dist(rng);
+        }
+    }
+}
+
+
+// dst = alpha * op(A) * op(B) + beta * C (C ignored if NULL), in units of the bound K * eps * sum(|a * b|)
+static double max_error(de::Matrix<float>& A, de::Matrix<float>& B, de::Matrix<float>* C, de::Matrix<float>& dst,
+    const float alpha, const float beta, const bool transA, const bool transB)
+{
+    const int M = transA ? A.Width() : A.Height(), K = transA ? A.Height() : A.Width();
+    const int N = transB ? B.Height() : B.Width();
+    if ((int)dst.Width() != N || (int)dst.Height() != M) {
+        return INFINITY;
+    }
+
+    double err = 0;
+    for (int i = 0; i < M; ++i) {
+        for (int j = 0; j < N; ++j) {
+            double acc = 0, mag = 0;
+            for (int k = 0; k < K; ++k) {
+                const double ab = (double)(transA ? A.index(k, i) : A.index(i, k)) * (transB ? B.index(j, k) : B.index(k, j));
+                acc += ab;
+                mag += fabs(ab);
+            }
+            const double s = C != NULL ? (double)beta * C->index(i, j) : 0;
+            const double bound = (K + 2) * FLT_EPSILON * (fabs(alpha) * mag + fabs(s)) + FLT_MIN;
+            err = fmax(err, fabs(dst.index(i, j) - (alpha * acc + s)) / bound);
+        }
+    }
+    return err;
+}
+
+
+static bool same_bits(de::Matrix<float>& a, de::Matrix<float>& b)
+{
+    if (a.Width() != b.Width() || a.Height() != b.Height()) {
+        return false;
+    }
+    for (uint i = 0; i < a.Height(); ++i) {
+        for (uint j = 0; j < a.Width(); ++j) {
+            if (memcmp(&a.index(i, j), &b.index(i, j), sizeof(float)) != 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+// copies the first bytes of the file src to dst, overwriting the magic if broken_magic
+static void copy_prefix(const char* src, const char* dst, const size_t bytes, const bool broken_magic)
+{
+    FILE* fs = fopen(src, "rb");
+    FILE* fd = fopen(dst, "wb");
+    vector<char> buf(bytes);
+    const size_t _read = fread(buf.data(), 1, bytes, fs);
+    if (broken_magic) {
+        buf[0] = 'X';
+    }
+    fwrite(buf.data(), 1, _read, fd);
+    fclose(fs);
+    fclose(fd);
+}
+
+
+
+int main(int argc, char** argv)
+{
+    de::InitCPUInfo();
+    if (argc > 1) {
+        de::SetCPUISA(atoi(argv[1]));
+    }
+    const int isa = de::GetCPUISA();
+
+    // M, N and K off the multiples of the micro-kernels, K past kc of all of them
+    const int M = 77, N = 53, K = 803;
+    de::Matrix<float>& A = de::CreateMatrixRef<float>(K, M, de::DATA_STORE_TYPE::Page_Default);
+    de::Matrix<float>& AT = de::CreateMatrixRef<float>(M, K, de::DATA_STORE_TYPE::Page_Default);
+    de::Matrix<float>& B = de::CreateMatrixRef<float>(N, K, de::DATA_STORE_TYPE::Page_Default);
+    de::Matrix<float>& BT = de::CreateMatrixRef<float>(K, N, de::DATA_STORE_TYPE::Page_Default);
+    de::Matrix<float>& C = de::CreateMatrixRef<float>(N, M, de::DATA_STORE_TYPE::Page_Default);
+    de::Matrix<float>& dst = de::CreateMatrixRef<float>();
+    de::Matrix<float>& ref = de::CreateMatrixRef<float>();
+    fill(A);    fill(AT);   fill(B);    fill(BT);   fill(C);
+
+    de::cpu::PackedMatrix& pB = de::cpu::CreatePackedMatrixRef();
+    de::cpu::PackedMatrix& pBT = de::cpu::CreatePackedMatrixRef();
+    de::cpu::PackedMatrix& loaded = de::cpu::CreatePackedMatrixRef();
+
+    // 1. packing and the GEMMs against the packed B
+    report("PackMatrix(B)", de::cpu::PackMatrix(B, pB).error_type == de::DECX_SUCCESS &&
+        pB.Width() == N && pB.Height() == K);
+    report("PackMatrix(B, GEMM_TransB)", de::cpu::PackMatrix(BT, pBT, de::cpu::GEMM_TransB).error_type == de::DECX_SUCCESS &&
+        pBT.Width() == N && pBT.Height() == K);
+
+    de::cpu::GEMM(A, pB, dst, 1.5f);
+    report("GEMM(A, packed B) against the reference", max_error(A, B, NULL, dst, 1.5f, 0, false, false) <= 1);
+    de::cpu::GEMM(A, B, ref, 1.5f);
+    report("GEMM(A, packed B) against GEMM(A, B)", max_error(A, B, NULL, ref, 1.5f, 0, false, false) <= 1 &&
+        same_bits(dst, ref));
+
+    de::cpu::GEMM(A, pBT, dst, 1.5f);
+    report("GEMM(A, packed B^T) against the reference", max_error(A, BT, NULL, dst, 1.5f, 0, false, true) <= 1);
+
+    de::cpu::GEMM(AT, pB, C, dst, -0.5f, 2.f, de::cpu::GEMM_TransA);
+    report("GEMM(A^T, packed B, C)", max_error(AT, B, &C, dst, -0.5f, 2.f, true, false) <= 1);
+
+    // 2. the round trip
+    const char* path = "packed_matrix_check.pkb";
+    report("SavePackedMatrix", de::cpu::SavePackedMatrix(pBT, path).error_type == de::DECX_SUCCESS);
+    report("LoadPackedMatrix", de::cpu::LoadPackedMatrix(path, loaded).error_type == de::DECX_SUCCESS &&
+        loaded.Width() == N && loaded.Height() == K && loaded.TotalBytes() == pBT.TotalBytes());
+    de::cpu::GEMM(A, pBT, ref, 1.f);
+    de::cpu::GEMM(A, loaded, dst, 1.f);
+    report("GEMM against the loaded matrix, bit-exact", same_bits(dst, ref));
+
+    // 3. the broken files and the layouts
+    FILE* fp = fopen(path, "rb");
+    fseek(fp, 0, SEEK_END);
+    const size_t file_bytes = (size_t)ftell(fp);
+    fclose(fp);
+
+    const char* broken = "packed_matrix_check_broken.pkb";
+    copy_prefix(path, broken, file_bytes, true);
+    report("broken magic : DECX_FAIL_PackedLayout",
+        de::cpu::LoadPackedMatrix(broken, loaded).error_type == de::DECX_FAIL_PackedLayout);
+
+    de::cpu::LoadPackedMatrix(path, loaded);
+    copy_prefix(path, broken, file_bytes / 2, false);
+    report("short file : DECX_FAIL_PackedLayout, released",
+        de::cpu::LoadPackedMatrix(broken, loaded).error_type == de::DECX_FAIL_PackedLayout &&
+        loaded.Width() == 0 && loaded.Height() == 0 && loaded.TotalBytes() == 0);
+    remove(broken);
+
+    // NR is 8 on SSE4.2, 16 on AVX2 and 32 on AVX-512, packed under one and used under another
+    const int other_isa = isa == de::CPU_ISA::ISA_SSE42 ? de::CPU_ISA::ISA_AVX2 : de::CPU_ISA::ISA_SSE42;
+    if (de::SetCPUISA(other_isa).error_type == de::DECX_SUCCESS) {
+        report("other NR, GEMM : DECX_FAIL_PackedLayout",
+            de::cpu::GEMM(A, pB, dst, 1.f).error_type == de::DECX_FAIL_PackedLayout);
+        report("other NR, LoadPackedMatrix : DECX_FAIL_PackedLayout",
+            de::cpu::LoadPackedMatrix(path, loaded).error_type == de::DECX_FAIL_PackedLayout);
+        de::SetCPUISA(isa);
+    }
+    else {
+        cout << "other NR : skipped, the host has SSE4.2 only" << endl;
+    }
+    remove(path);
+
+    // 4. the errors of the files
+    report("missing file : DECX_FAIL_FileNotExist",
+        de::cpu::LoadPackedMatrix("packed_matrix_check_missing.pkb", loaded).error_type == de::DECX_FAIL_FileNotExist);
+#ifndef _WIN32
+    report("write to /dev/full : DECX_FAIL_FileIO",
+        de::cpu::SavePackedMatrix(pB, "/dev/full").error_type == de::DECX_FAIL_FileIO);
+    report("read of a directory : DECX_FAIL_FileIO",
+        de::cpu::LoadPackedMatrix(".", loaded).error_type == de::DECX_FAIL_FileIO);
+#else
+    cout << "the failed write and read : skipped, no /dev/full on Windows" << endl;
+#endif
+
+    cout << (pass ? "all passed" : "FAILED") << endl;
+
+    A.release();    AT.release();   B.release();    BT.release();
+    C.release();    dst.release();  ref.release();
+    pB.release();   pBT.release();  loaded.release();
+    return pass ? 0 : 1;
+}
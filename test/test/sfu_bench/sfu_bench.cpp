@@ -0,0 +1,286 @@
+// sfu_bench.cpp : the vectorized transcendental functions of the CPU (decx::sfu_eval and decx::sfu_pow, the
+// engine of de::cpu::Exp() ...) against the loops of the scalar std:: functions, over 16M elements of float
+// and of double. The time of the fast and the accurate variants, their speedup over std:: and the largest
+// error in ulp of the element type are printed for each function. The errors are measured on every 61st element
+// against a reference in double-double (about 100 bits, of the error-free products of std::fma, so also where
+// long double is double). Pass 1, 2 or 3 to force SSE4.2, AVX2 or AVX-512.
+//
+
+#define _DECX_CPU_CODES_
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <limits>
+#include <immintrin.h>
+
+#include "../../../srcs/core/configs/config.h"
+#include "../../../srcs/basic_calculations/SFU/sfu_exec.h"
+
+
+using namespace std;
+typedef chrono::high_resolution_clock _clock;
+
+
+template <typename T>
+struct aligned_buffer
+{
+    T* ptr;
+    size_t len;
+
+    aligned_buffer(const size_t _len) : len(_len) { ptr = (T*)_mm_malloc(_len * sizeof(T), 64); }
+    ~aligned_buffer() { _mm_free(ptr); }
+};
+
+
+// pow is timed of p = 2.5
+#define _BENCH_POW_ _SFU_FUNC_NUM_
+#define _BENCH_POW_P_ 2.5
+
+
+static const char* names[] = { "exp", "log", "sin", "cos", "tan", "tanh", "sigmoid", "pow" };
+
+
+// the inputs of each function, in a range where none overflows
+static void range_of(const int op, double* lo, double* hi)
+{
+    switch (op)
+    {
+    case _SFU_EXP_:     *lo = -80; *hi = 80;        break;
+    case _SFU_LOG_:     *lo = 1e-3; *hi = 1e3;      break;
+    case _SFU_TANH_:    *lo = -10; *hi = 10;        break;
+    case _SFU_SIGMOID_: *lo = -20; *hi = 20;        break;
+    case _BENCH_POW_:   *lo = 1e-3; *hi = 1e3;      break;
+    default:            *lo = -100; *hi = 100;      break;
+    }
+}
+
+
+template <typename T>
+static T std_calc(const int op, const T x)
+{
+    switch (op)
+    {
+    case _SFU_EXP_:     return std::exp(x);
+    case _SFU_LOG_:     return std::log(x);
+    case _SFU_SIN_:     return std::sin(x);
+    case _SFU_COS_:     return std::cos(x);
+    case _SFU_TAN_:     return std::tan(x);
+    case _SFU_TANH_:    return std::tanh(x);
+    case _SFU_SIGMOID_: return (T)1 / ((T)1 + std::exp(-x));
+    default:            return std::pow(x, (T)_BENCH_POW_P_);
+    }
+}
+
+
+template <typename T>
+static void sfu_calc(const int op, const aligned_buffer<T>& src, aligned_buffer<T>& dst, const bool acc)
+{
+    if (op == _BENCH_POW_) {
+        decx::sfu_pow<T>(src.ptr, (T)_BENCH_POW_P_, dst.ptr, src.len, acc);
+    }
+    else {
+        decx::sfu_eval<T>(op, src.ptr, dst.ptr, src.len, acc);
+    }
+}
+
+
+template <typename _Func>
+static double time_of(const _Func& f)
+{
+    const int round_num = 5;
+    f();
+
+    _clock::time_point s = _clock::now();
+    for (int r = 0; r < round_num; ++r) {
+        f();
+    }
+    return chrono::duration<double>(_clock::now() - s).count() / round_num;
+}
+
+
+// a double-double, hi + lo, |lo| <= ulp(hi) / 2
+struct dd
+{
+    double hi, lo;
+};
+
+
+static dd quick_two_sum(const double a, const double b)
+{
+    const double s = a + b;
+    return { s, b - (s - a) };
+}
+
+
+static dd two_sum(const double a, const double b)
+{
+    const double s = a + b, bb = s - a;
+    return { s, (a - (s - bb)) + (b - bb) };
+}
+
+
+static dd operator+(const dd a, const dd b)
+{
+    const dd s = two_sum(a.hi, b.hi), t = two_sum(a.lo, b.lo);
+    const dd u = quick_two_sum(s.hi, s.lo + t.hi);
+    return quick_two_sum(u.hi, u.lo + t.lo);
+}
+
+
+static dd operator*(const dd a, const dd b)
+{
+    const double p = a.hi * b.hi;
+    return quick_two_sum(p, std::fma(a.hi, b.hi, -p) + (a.hi * b.lo + a.lo * b.hi));
+}
+
+
+static dd operator/(const dd a, const dd b)
+{
+    const double q1 = a.hi / b.hi;
+    const dd r1 = a + b * dd{ -q1, 0 };
+    const double q2 = r1.hi / b.hi;
+    const dd r2 = r1 + b * dd{ -q2, 0 };
+    return quick_two_sum(q1, q2) + dd{ r2.hi / b.hi, 0 };
+}
+
+
+static dd dd_exp(const dd x)
+{
+    if (x.hi > 709.8) {
+        return { INFINITY, 0 };
+    }
+    if (x.hi < -745.2) {
+        return { 0, 0 };
+    }
+    const dd ln2 = { 6.931471805599452862e-01, 2.319046813846299558e-17 };
+    const double n = nearbyint(x.hi / ln2.hi);
+    // r = (x - n * ln2) / 2^10, e^r - 1 by Taylor, then e^2r - 1 = (e^r - 1) * (e^r + 1) ten times
+    dd r = x + ln2 * dd{ -n, 0 };
+    r = { ldexp(r.hi, -10), ldexp(r.lo, -10) };
+    dd em1 = { 0, 0 };
+    for (int k = 12; k > 0; --k) {
+        em1 = r / dd{ (double)k, 0 } * (em1 + dd{ 1, 0 });
+    }
+    for (int i = 0; i < 10; ++i) {
+        em1 = em1 * (em1 + dd{ 2, 0 });
+    }
+    const dd res = em1 + dd{ 1, 0 };
+    return { ldexp(res.hi, (int)n), ldexp(res.lo, (int)n) };
+}
+
+
+// a Newton step from std::log(x), y + x * e^-y - 1
+static dd dd_log(const double x)
+{
+    const double y = std::log(x);
+    return dd{ y, 0 } + (dd_exp(dd{ -y, 0 }) * dd{ x, 0 } + dd{ -1, 0 });
+}
+
+
+// sin(x) (cos(x) if _cos) of x = q * pi / 2 + r, pi / 2 in three parts, sin(r) and cos(r) by Taylor
+static dd dd_sin(const double x, const bool _cos)
+{
+    const dd pio2 = { 1.570796326794896558e+00, 6.123233995736766036e-17 };
+    const double pio2_3 = -1.497384904859169777e-33;
+    const double q = nearbyint(x / pio2.hi);
+    const dd r = dd{ x, 0 } + pio2 * dd{ -q, 0 } + dd{ -q * pio2_3, 0 };
+    const dd z = r * r;
+    dd s = { 1, 0 }, c = { 1, 0 };
+    for (int k = 13; k > 0; --k) {
+        s = dd{ 1, 0 } + z * s / dd{ -(double)(2 * k * (2 * k + 1)), 0 };
+        c = dd{ 1, 0 } + z * c / dd{ -(double)((2 * k - 1) * 2 * k), 0 };
+    }
+    s = r * s;
+    const int quad = ((int)q + (_cos ? 1 : 0)) & 3;
+    const dd res = (quad & 1) ? c : s;
+    return (quad & 2) ? dd{ -res.hi, -res.lo } : res;
+}
+
+
+static dd ref_calc(const int op, const double x)
+{
+    switch (op)
+    {
+    case _SFU_EXP_:     return dd_exp(dd{ x, 0 });
+    case _SFU_LOG_:     return dd_log(x);
+    case _SFU_SIN_:     return dd_sin(x, false);
+    case _SFU_COS_:     return dd_sin(x, true);
+    case _SFU_TAN_:     return dd_sin(x, false) / dd_sin(x, true);
+    case _SFU_TANH_: {
+        const dd e = dd_exp(dd{ 2 * x, 0 });
+        return (e + dd{ -1, 0 }) / (e + dd{ 1, 0 });
+    }
+    case _SFU_SIGMOID_: return dd{ 1, 0 } / (dd{ 1, 0 } + dd_exp(dd{ -x, 0 }));
+    default:            return dd_exp(dd_log(x) * dd{ _BENCH_POW_P_, 0 });
+    }
+}
+
+
+// the largest error of dst, in the ulp of T, against the reference in double-double
+template <typename T>
+static double max_ulp(const int op, const aligned_buffer<T>& src, const aligned_buffer<T>& dst)
+{
+    double res = 0;
+    for (size_t i = 0; i < src.len; i += 61) {
+        const dd ref = ref_calc(op, (double)src.ptr[i]);
+        int e;
+        frexp(ref.hi, &e);
+        const double err = fabs(((double)dst.ptr[i] - ref.hi) - ref.lo);
+        res = max(res, err / ldexp(1.0, max(e, numeric_limits<T>::min_exponent) - numeric_limits<T>::digits));
+    }
+    return res;
+}
+
+
+template <typename T>
+static void bench(const char* type_name)
+{
+    const size_t len = (size_t)1 << 24;
+    aligned_buffer<T> src(len), dst(len);
+    mt19937 gen(1);
+
+    cout << type_name << endl;
+    for (int op = 0; op <= _BENCH_POW_; ++op) {
+        double lo, hi;
+        range_of(op, &lo, &hi);
+        uniform_real_distribution<double> dist(lo, hi);
+        for (size_t i = 0; i < len; ++i) {
+            src.ptr[i] = (T)dist(gen);
+        }
+
+        const double t_std = time_of([&]() {
+            for (size_t i = 0; i < len; ++i) {
+                dst.ptr[i] = std_calc<T>(op, src.ptr[i]);
+            }
+        });
+        const double t_fast = time_of([&]() { sfu_calc<T>(op, src, dst, false); });
+        const double ulp_fast = max_ulp(op, src, dst);
+        const double t_acc = time_of([&]() { sfu_calc<T>(op, src, dst, true); });
+        const double ulp_acc = max_ulp(op, src, dst);
+
+        cout << fixed << setprecision(2);
+        cout << setw(9) << names[op] << setw(11) << t_std * 1e3 << setw(11) << t_fast * 1e3 << setw(9) << t_std / t_fast
+            << setw(11) << t_acc * 1e3 << setw(9) << t_std / t_acc << setw(10) << ulp_fast << setw(10) << ulp_acc << endl;
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    de::InitCPUInfo();
+    if (argc > 1) {
+        de::SetCPUISA(atoi(argv[1]));
+    }
+
+    cout << setw(9) << "function" << setw(11) << "std (ms)" << setw(11) << "fast (ms)" << setw(9) << "speedup"
+        << setw(11) << "acc. (ms)" << setw(9) << "speedup" << setw(10) << "ulp fast" << setw(10) << "ulp acc." << endl;
+
+    bench<float>("float");
+    bench<double>("double");
+
+    decx::thread_pool.TerminateAllThreads();
+    return 0;
+}
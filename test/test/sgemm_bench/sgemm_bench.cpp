@@ -0,0 +1,188 @@
+// sgemm_bench.cpp : the packed, cache-blocked SGEMM (decx::sgemm_blocked) against the former
+// kernels (decx::sgemm_caller) on square problems. The peak is measured by an FMA throughput loop
+// (of the widest vectors of the de::CPU_ISA in use) on all the hardware threads, and the GFLOPS of
+// both are reported with their share of it. Pass 1, 2 or 3 to force SSE4.2, AVX2 or AVX-512.
+//
+
+#define _DECX_CPU_CODES_
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <thread>
+#include <random>
+#include <cmath>
+#include <immintrin.h>
+
+#include "../../../srcs/core/configs/config.h"
+#include "../../../srcs/GEMM/CPU/sgemm_blocked.h"
+#include "../../../srcs/GEMM/CPU/sgemm_callers.h"
+
+
+using namespace std;
+typedef chrono::high_resolution_clock _clock;
+
+
+// FLOPs per second of one thread, 10 independent chains of FMA hide the latency
+static double fma_probe(const size_t iter)
+{
+    __m256 c0 = _mm256_set1_ps(0.f), c1 = _mm256_set1_ps(1.f), c2 = _mm256_set1_ps(2.f), c3 = _mm256_set1_ps(3.f),
+        c4 = _mm256_set1_ps(4.f), c5 = _mm256_set1_ps(5.f), c6 = _mm256_set1_ps(6.f), c7 = _mm256_set1_ps(7.f),
+        c8 = _mm256_set1_ps(8.f), c9 = _mm256_set1_ps(9.f);
+    const __m256 a = _mm256_set1_ps(0.999999f), b = _mm256_set1_ps(1e-7f);
+
+    _clock::time_point s = _clock::now();
+    for (size_t i = 0; i < iter; ++i) {
+        c0 = _mm256_fmadd_ps(c0, a, b);     c1 = _mm256_fmadd_ps(c1, a, b);
+        c2 = _mm256_fmadd_ps(c2, a, b);     c3 = _mm256_fmadd_ps(c3, a, b);
+        c4 = _mm256_fmadd_ps(c4, a, b);     c5 = _mm256_fmadd_ps(c5, a, b);
+        c6 = _mm256_fmadd_ps(c6, a, b);     c7 = _mm256_fmadd_ps(c7, a, b);
+        c8 = _mm256_fmadd_ps(c8, a, b);     c9 = _mm256_fmadd_ps(c9, a, b);
+    }
+    const double sec = chrono::duration<double>(_clock::now() - s).count();
+
+    const __m256 sum = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(c0, c1), _mm256_add_ps(c2, c3)),
+        _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(c4, c5), _mm256_add_ps(c6, c7)), _mm256_add_ps(c8, c9)));
+    volatile float sink = _mm256_cvtss_f32(sum);
+    (void)sink;
+
+    return (double)iter * 10 * 16 / sec;
+}
+
+
+
+// the same with __m512, for the hosts running the AVX-512 kernels
+static double fma_probe_512(const size_t iter)
+{
+    __m512 c0 = _mm512_set1_ps(0.f), c1 = _mm512_set1_ps(1.f), c2 = _mm512_set1_ps(2.f), c3 = _mm512_set1_ps(3.f),
+        c4 = _mm512_set1_ps(4.f), c5 = _mm512_set1_ps(5.f), c6 = _mm512_set1_ps(6.f), c7 = _mm512_set1_ps(7.f),
+        c8 = _mm512_set1_ps(8.f), c9 = _mm512_set1_ps(9.f);
+    const __m512 a = _mm512_set1_ps(0.999999f), b = _mm512_set1_ps(1e-7f);
+
+    _clock::time_point s = _clock::now();
+    for (size_t i = 0; i < iter; ++i) {
+        c0 = _mm512_fmadd_ps(c0, a, b);     c1 = _mm512_fmadd_ps(c1, a, b);
+        c2 = _mm512_fmadd_ps(c2, a, b);     c3 = _mm512_fmadd_ps(c3, a, b);
+        c4 = _mm512_fmadd_ps(c4, a, b);     c5 = _mm512_fmadd_ps(c5, a, b);
+        c6 = _mm512_fmadd_ps(c6, a, b);     c7 = _mm512_fmadd_ps(c7, a, b);
+        c8 = _mm512_fmadd_ps(c8, a, b);     c9 = _mm512_fmadd_ps(c9, a, b);
+    }
+    const double sec = chrono::duration<double>(_clock::now() - s).count();
+
+    const __m512 sum = _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(c0, c1), _mm512_add_ps(c2, c3)),
+        _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(c4, c5), _mm512_add_ps(c6, c7)), _mm512_add_ps(c8, c9)));
+    volatile float sink = _mm512_reduce_add_ps(sum);
+    (void)sink;
+
+    return (double)iter * 10 * 32 / sec;
+}
+
+
+
+static double measure_peak()
+{
+    const uint thread_num = std::thread::hardware_concurrency();
+    const bool _512 = de::GetCPUISA() == de::CPU_ISA::ISA_AVX512;
+    std::vector<double> res(thread_num);
+    std::vector<std::thread> thr;
+    for (uint i = 0; i < thread_num; ++i) {
+        thr.emplace_back([&res, i, _512]() { res[i] = _512 ? fma_probe_512(100000000) : fma_probe(100000000); });
+    }
+    double peak = 0;
+    for (uint i = 0; i < thread_num; ++i) {
+        thr[i].join();
+        peak += res[i];
+    }
+    return peak;
+}
+
+
+
+// the former kernels load A and the packed B aligned to 32 bytes
+struct aligned_buffer
+{
+    float* ptr;
+    size_t len;
+
+    aligned_buffer(const size_t _len) : len(_len) { ptr = (float*)_mm_malloc(_len * sizeof(float), 64); }
+    ~aligned_buffer() { _mm_free(ptr); }
+};
+
+
+
+static double max_error(const aligned_buffer& C, const aligned_buffer& ref)
+{
+    double err = 0;
+    for (size_t i = 0; i < C.len; ++i) {
+        err = fmax(err, fabs((double)C.ptr[i] - (double)ref.ptr[i]) / fmax(1.0, fabs((double)ref.ptr[i])));
+    }
+    return err;
+}
+
+
+
+int main(int argc, char** argv)
+{
+    de::InitCPUInfo();
+    if (argc > 1) {
+        de::SetCPUISA(atoi(argv[1]));
+    }
+
+    const double peak = measure_peak();
+    // the micro-kernel and the block sizes of the de::CPU_ISA in use
+    const decx::_sgemm_blocked_info _probe;
+    cout << "peak (FMA probe, all threads) : " << peak * 1e-9 << " GFLOPS" << endl;
+    cout << "micro-kernel : " << _probe.uk.mr << " x " << _probe.uk.nr << ", block sizes : mc = " << _probe.bs.mc
+        << ", kc = " << _probe.bs.kc << ", nc = " << _probe.bs.nc << endl << endl;
+
+    cout << setw(6) << "N" << setw(16) << "blocked GFLOPS" << setw(10) << "% peak"
+        << setw(16) << "former GFLOPS" << setw(10) << "% peak" << setw(12) << "rel. diff" << endl;
+
+    mt19937 rng(1);
+    uniform_real_distribution<float> dist(-1.f, 1.f);
+
+    const int sizes[] = { 256, 512, 1024, 2048, 4096 };
+    for (const int N : sizes) {
+        const size_t len = (size_t)N * N;
+        aligned_buffer A(len), B(len), C(len), C_former(len), tmp_B(len);
+        for (size_t i = 0; i < len; ++i) {
+            A.ptr[i] = dist(rng);
+            B.ptr[i] = dist(rng);
+        }
+
+        decx::_sgemm_blocked_info info;
+        info.A = A.ptr;      info.lda = N;
+        info.B = B.ptr;      info.ldb = N;
+        info.C = C.ptr;      info.ldc = N;
+        info.M = N;     info.N = N;     info.K = N;
+
+        const int4 glo_dim = make_int4(N, N, N, 0);
+        const int round_num = N <= 1024 ? 10 : 3;
+        const double flop = 2.0 * N * N * N;
+
+        // warm up
+        decx::sgemm_blocked(&info, NULL);
+        decx::sgemm_caller(A.ptr, B.ptr, tmp_B.ptr, C_former.ptr, &glo_dim);
+
+        _clock::time_point s = _clock::now();
+        for (int r = 0; r < round_num; ++r) {
+            decx::sgemm_blocked(&info, NULL);
+        }
+        const double t_blocked = chrono::duration<double>(_clock::now() - s).count() / round_num;
+
+        s = _clock::now();
+        for (int r = 0; r < round_num; ++r) {
+            decx::sgemm_caller(A.ptr, B.ptr, tmp_B.ptr, C_former.ptr, &glo_dim);
+        }
+        const double t_former = chrono::duration<double>(_clock::now() - s).count() / round_num;
+
+        cout << fixed << setprecision(1);
+        cout << setw(6) << N << setw(16) << flop / t_blocked * 1e-9 << setw(10) << 100 * flop / t_blocked / peak
+            << setw(16) << flop / t_former * 1e-9 << setw(10) << 100 * flop / t_former / peak
+            << setw(12) << scientific << setprecision(2) << max_error(C, C_former) << endl;
+    }
+
+    decx::thread_pool.TerminateAllThreads();
+    return 0;
+}
@@ -0,0 +1,128 @@
+// sgemm_small_check.cpp : the small SGEMM (decx::sgemm_small, C = alpha * A * B + beta * S on the calling thread)
+// against the blocked one (decx::sgemm_blocked) and a reference in double, for every N in 1 .. 32 (the kernels
+// specialized on N = 4, 8, 16, 32 and the generic one), K from 1 to 32, with and without S, under each de::CPU_ISA
+// the host has. So the masked loads and stores of the tails of the AVX2 kernels and the stack buffer of the tails
+// of the SSE4.2 ones are covered. The cols of C past N are filled with a guard value, which must be left as is.
+// Prints the largest error of each ISA in units of the bound K * eps * sum(|a * b|), returns 1 if any check fails.
+//
+
+#define _DECX_CPU_CODES_
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cfloat>
+
+#include "../../../srcs/core/configs/config.h"
+#include "../../../srcs/GEMM/CPU/sgemm_blocked.h"
+#include "../../../srcs/GEMM/CPU/sgemm_small.h"
+
+
+using namespace std;
+
+
+static mt19937 rng(1);
+static const float guard = -12345.f;
+
+
+struct case_result
+{
+    double err_small, err_blocked;
+    bool guard_kept;
+};
+
+
+static case_result check(const int M, const int N, const int K, const bool with_S)
+{
+    // the pitches leave room past N for the guard
+    const size_t lda = K + 1, ldb = N + 3, ldc = N + 9;
+    uniform_real_distribution<float> dist(-1.f, 1.f);
+    vector<float> A(M * lda), B(K * ldb), S(M * ldc), C_small(M * ldc, guard), C_blocked(M * ldc, guard);
+    for (float& x : A) x = dist(rng);
+    for (float& x : B) x = dist(rng);
+    for (float& x : S) x = dist(rng);
+
+    decx::_sgemm_blocked_info info;
+    info.A = A.data();      info.lda = lda;
+    info.B = B.data();      info.ldb = ldb;
+    info.ldc = ldc;
+    info.M = M;     info.N = N;     info.K = K;
+    info.alpha = 0.5f;
+    info.beta = with_S ? -2.f : 0.f;
+    info.S = with_S ? S.data() : NULL;
+    info.lds = ldc;
+
+    info.C = C_small.data();
+    decx::sgemm_small(&info);
+    info.C = C_blocked.data();
+    decx::sgemm_blocked(&info, NULL);
+
+    case_result res = { 0, 0, true };
+    for (int i = 0; i < M; ++i) {
+        for (int j = 0; j < N; ++j) {
+            double acc = 0, mag = 0;
+            for (int k = 0; k < K; ++k) {
+                acc += (double)A[i * lda + k] * B[k * ldb + j];
+                mag += fabs((double)A[i * lda + k] * B[k * ldb + j]);
+            }
+            const double s = with_S ? (double)info.beta * S[i * ldc + j] : 0;
+            const double ref = info.alpha * acc + s;
+            const double bound = (K + 2) * FLT_EPSILON * (fabs(info.alpha) * mag + fabs(s)) + FLT_MIN;
+            res.err_small = fmax(res.err_small, fabs(C_small[i * ldc + j] - ref) / bound);
+            res.err_blocked = fmax(res.err_blocked, fabs(C_blocked[i * ldc + j] - ref) / bound);
+        }
+        for (size_t j = N; j < ldc; ++j) {
+            res.guard_kept &= C_small[i * ldc + j] == guard;
+        }
+    }
+    return res;
+}
+
+
+
+int main()
+{
+    de::InitCPUInfo();
+    const int detected = de::GetCPUISA();
+    const char* isa_names[] = { "Auto", "SSE4.2", "AVX2", "AVX-512" };
+
+    const int Ks[] = { 1, 3, 4, 8, 9, 16, 17, 32 };
+    const int Ms[] = { 1, 5, 6, 8, 13, 32 };
+    bool pass = true;
+
+    for (int isa = de::CPU_ISA::ISA_SSE42; isa <= detected; ++isa) {
+        de::SetCPUISA(isa);
+        double err_small = 0, err_blocked = 0;
+        size_t fails = 0, cases = 0;
+
+        for (int N = 1; N <= 32; ++N) {
+            for (const int K : Ks) {
+                for (const int M : Ms) {
+                    for (int with_S = 0; with_S < 2; ++with_S) {
+                        const case_result r = check(M, N, K, with_S != 0);
+                        err_small = fmax(err_small, r.err_small);
+                        err_blocked = fmax(err_blocked, r.err_blocked);
+                        const bool ok = r.err_small <= 1 && r.err_blocked <= 1 && r.guard_kept;
+                        if (!ok) {
+                            cout << "  FAILED : M = " << M << ", N = " << N << ", K = " << K << (with_S ? ", with S" : "")
+                                << ", err small " << r.err_small << ", blocked " << r.err_blocked
+                                << (r.guard_kept ? "" : ", wrote past N") << endl;
+                        }
+                        fails += !ok;
+                        ++cases;
+                    }
+                }
+            }
+        }
+        pass &= fails == 0;
+        cout << setw(8) << isa_names[isa] << " : " << cases << " cases, " << fails << " failed, largest err small "
+            << setprecision(3) << err_small << ", blocked " << err_blocked << endl;
+    }
+    de::SetCPUISA(de::CPU_ISA::ISA_Auto);
+
+    cout << (pass ? "all passed" : "FAILED") << endl;
+    decx::thread_pool.TerminateAllThreads();
+    return pass ? 0 : 1;
+}
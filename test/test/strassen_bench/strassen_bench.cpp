@@ -0,0 +1,165 @@
+// strassen_bench.cpp : the Strassen-Winograd recursion (decx::sgemm_strassen) of 1 and 2 levels against
+// the classic blocked SGEMM (decx::sgemm_blocked) on square problems. The time, the GFLOPS (counted
+// as 2 N^3 for all) and the error of both against a double precision product of sampled rows are
+// reported. The error is max |C - C_ref| / (N max|A| max|B|), the quantity the normwise bound of
+// sgemm_strassen.h covers, and the relative error of the smallest rows when the rows of A are scaled
+// from 1 down to 1e-4, which the recursion does not keep. Pass 1, 2 or 3 to force SSE4.2, AVX2 or AVX-512.
+//
+
+#define _DECX_CPU_CODES_
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <immintrin.h>
+
+#include "../../../srcs/core/configs/config.h"
+#include "../../../srcs/GEMM/CPU/sgemm_strassen.h"
+
+
+using namespace std;
+typedef chrono::high_resolution_clock _clock;
+
+
+#define _SAMPLED_ROWS_ 32
+
+
+struct aligned_buffer
+{
+    float* ptr;
+    size_t len;
+
+    aligned_buffer(const size_t _len) : len(_len) { ptr = (float*)_mm_malloc(_len * sizeof(float), 64); }
+    ~aligned_buffer() { _mm_free(ptr); }
+};
+
+
+
+// the rows of C in rows[], in double precision
+static void reference_rows(const aligned_buffer& A, const aligned_buffer& B, const int N, const vector<int>& rows,
+    vector<double>& ref)
+{
+    ref.assign(rows.size() * N, 0);
+    for (size_t r = 0; r < rows.size(); ++r) {
+        double* dst = ref.data() + r * N;
+        for (int k = 0; k < N; ++k) {
+            const double a = A.ptr[(size_t)rows[r] * N + k];
+            const float* b = B.ptr + (size_t)k * N;
+            for (int j = 0; j < N; ++j) {
+                dst[j] += a * b[j];
+            }
+        }
+    }
+}
+
+
+
+// max |C - ref| over the sampled rows, divided by scale (normwise), or by |ref| row by row (relative)
+static double sampled_error(const aligned_buffer& C, const int N, const vector<int>& rows, const vector<double>& ref,
+    const double scale, const bool relative)
+{
+    double err = 0;
+    for (size_t r = 0; r < rows.size(); ++r) {
+        double row_max = 0, row_err = 0;
+        for (int j = 0; j < N; ++j) {
+            const double _ref = ref[r * N + j];
+            row_max = fmax(row_max, fabs(_ref));
+            row_err = fmax(row_err, fabs((double)C.ptr[(size_t)rows[r] * N + j] - _ref));
+        }
+        err = fmax(err, row_err / (relative ? row_max : scale));
+    }
+    return err;
+}
+
+
+
+static double time_of(const decx::_sgemm_blocked_info* info, const int levels, const int round_num)
+{
+    levels > 0 ? decx::sgemm_strassen(info, levels) : decx::sgemm_blocked(info, NULL);
+
+    _clock::time_point s = _clock::now();
+    for (int r = 0; r < round_num; ++r) {
+        levels > 0 ? decx::sgemm_strassen(info, levels) : decx::sgemm_blocked(info, NULL);
+    }
+    return chrono::duration<double>(_clock::now() - s).count() / round_num;
+}
+
+
+
+int main(int argc, char** argv)
+{
+    de::InitCPUInfo();
+    if (argc > 1) {
+        de::SetCPUISA(atoi(argv[1]));
+    }
+
+    cout << "crossover : " << _SGEMM_STRASSEN_CROSSOVER_ << ", the levels de::cpu::sgemm() would apply are marked *"
+        << endl << endl;
+    cout << setw(6) << "N" << setw(8) << "levels" << setw(12) << "time (ms)" << setw(10) << "GFLOPS"
+        << setw(10) << "speedup" << setw(14) << "normwise err" << setw(14) << "scaled rows" << endl;
+
+    mt19937 rng(1);
+    uniform_real_distribution<float> dist(-1.f, 1.f);
+
+    // 3001 takes the peeling of the odd row, col and k at both levels
+    const int sizes[] = { 1024, 2048, 3001, 4096, 8192 };
+    for (const int N : sizes) {
+        const size_t len = (size_t)N * N;
+        aligned_buffer A(len), A_scaled(len), B(len), C(len);
+        for (size_t i = 0; i < len; ++i) {
+            A.ptr[i] = dist(rng);
+            B.ptr[i] = dist(rng);
+        }
+        // row i of A_scaled is scaled by 10^(-4 i / N)
+        for (int i = 0; i < N; ++i) {
+            const float s = (float)pow(10.0, -4.0 * i / N);
+            for (int k = 0; k < N; ++k) {
+                A_scaled.ptr[(size_t)i * N + k] = A.ptr[(size_t)i * N + k] * s;
+            }
+        }
+
+        vector<int> rows(_SAMPLED_ROWS_);
+        for (int r = 0; r < _SAMPLED_ROWS_; ++r) {
+            rows[r] = N - 1 - r * (N / 4) / _SAMPLED_ROWS_;       // the last quarter, the smallest of A_scaled
+        }
+        vector<double> ref, ref_scaled;
+        reference_rows(A, B, N, rows, ref);
+        reference_rows(A_scaled, B, N, rows, ref_scaled);
+
+        decx::_sgemm_blocked_info info;
+        info.B = B.ptr;      info.ldb = N;
+        info.C = C.ptr;      info.ldc = N;
+        info.lda = N;
+        info.M = N;     info.N = N;     info.K = N;
+
+        const int round_num = N <= 2048 ? 5 : 2;
+        const double flop = 2.0 * N * N * N;
+        const int _applied = decx::sgemm_strassen_depth(N, N, N, _SGEMM_STRASSEN_MAX_LEVELS_);
+        double t_classic = 0;
+
+        for (int levels = 0; levels <= _SGEMM_STRASSEN_MAX_LEVELS_; ++levels) {
+            info.A = A.ptr;
+            const double t = time_of(&info, levels, round_num);
+            const double err = sampled_error(C, N, rows, ref, N, false);
+            if (levels == 0) {
+                t_classic = t;
+            }
+
+            info.A = A_scaled.ptr;
+            levels > 0 ? decx::sgemm_strassen(&info, levels) : decx::sgemm_blocked(&info, NULL);
+            const double err_scaled = sampled_error(C, N, rows, ref_scaled, 0, true);
+
+            cout << fixed << setprecision(1);
+            cout << setw(6) << N << setw(7) << levels << (levels == _applied ? '*' : ' ')
+                << setw(12) << t * 1e3 << setw(10) << flop / t * 1e-9 << setw(10) << setprecision(2) << t_classic / t
+                << setw(14) << scientific << err << setw(14) << err_scaled << endl;
+        }
+        cout << endl;
+    }
+
+    decx::thread_pool.TerminateAllThreads();
+    return 0;
+}
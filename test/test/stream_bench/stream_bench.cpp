@@ -0,0 +1,112 @@
+// stream_bench.cpp : the cached stores of the element-wise operators of the CPU against the non-temporal
+// (streaming) ones, decx::Kadd_m of float (dst = A + B) and decx::_BGR2Gray_UC2UC_caller (the conversion
+// of de::vis::merge_channel) forced to de::cpu::Store_Cached and Store_Streaming. The time and the bandwidth
+// (the bytes of the inputs and of dst, not counting the reads for ownership of the cached stores) are printed
+// for the sizes of dst from within L3 up to 512 MB, with the choice of Store_Auto on this host. Pass 1, 2 or 3
+// to force SSE4.2, AVX2 or AVX-512.
+//
+
+#define _DECX_CPU_CODES_
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <immintrin.h>
+
+#include "../../../srcs/core/configs/config.h"
+#include "../../../srcs/basic_calculations/operators/Add_exec.h"
+#include "../../../srcs/cv/utils/cvt_colors.h"
+
+
+using namespace std;
+typedef chrono::high_resolution_clock _clock;
+
+
+struct aligned_buffer
+{
+    float* ptr;
+    size_t len;
+
+    aligned_buffer(const size_t _len, const float val) : len(_len)
+    {
+        ptr = (float*)_mm_malloc(_len * sizeof(float), 64);
+        for (size_t i = 0; i < _len; ++i) {
+            ptr[i] = val;
+        }
+    }
+    ~aligned_buffer() { _mm_free(ptr); }
+};
+
+
+template <typename _Func>
+static double time_of(const _Func& f, const size_t bytes)
+{
+    const int round_num = (int)decx::utils::clamp_min<size_t>(((size_t)1 << 31) / bytes, 3);
+    f();
+
+    _clock::time_point s = _clock::now();
+    for (int r = 0; r < round_num; ++r) {
+        f();
+    }
+    return chrono::duration<double>(_clock::now() - s).count() / round_num;
+}
+
+
+static void print_row(const char* name, const size_t dst_bytes, const size_t moved_bytes, const double t_cached,
+    const double t_stream)
+{
+    cout << fixed << setprecision(2);
+    cout << setw(10) << name << setw(10) << (dst_bytes >> 20) << setw(13) << t_cached * 1e3
+        << setw(9) << moved_bytes / t_cached * 1e-9 << setw(13) << t_stream * 1e3 << setw(9) << moved_bytes / t_stream * 1e-9
+        << setw(9) << t_cached / t_stream
+        << setw(11) << (decx::_use_streaming_store(de::cpu::Store_Auto, dst_bytes) ? "stream" : "cached") << endl;
+}
+
+
+static void bench_add(const size_t dst_mb)
+{
+    const size_t len = (dst_mb << 20) / sizeof(float);
+    aligned_buffer A(len, 1.f), B(len, 2.f), dst(len, 0.f);
+
+    const double t_cached = time_of([&]() { decx::Kadd_m(A.ptr, B.ptr, dst.ptr, len, de::cpu::Store_Cached); }, len * 12);
+    const double t_stream = time_of([&]() { decx::Kadd_m(A.ptr, B.ptr, dst.ptr, len, de::cpu::Store_Streaming); }, len * 12);
+    print_row("add", len * 4, len * 12, t_cached, t_stream);
+}
+
+
+// BGR (uchar4) to gray (uchar), 4 bytes read a byte of dst
+static void bench_gray(const size_t dst_mb)
+{
+    const size_t pixels = dst_mb << 20;
+    const int2 dims = make_int2(4096, (int)(pixels / 4096));
+    aligned_buffer src(pixels, 0.f), dst(pixels / 4, 0.f);
+
+    const double t_cached = time_of([&]() { decx::_BGR2Gray_UC2UC_caller(src.ptr, dst.ptr, dims, de::cpu::Store_Cached); }, pixels * 5);
+    const double t_stream = time_of([&]() { decx::_BGR2Gray_UC2UC_caller(src.ptr, dst.ptr, dims, de::cpu::Store_Streaming); }, pixels * 5);
+    print_row("BGR2Gray", pixels, pixels * 5, t_cached, t_stream);
+}
+
+
+int main(int argc, char** argv)
+{
+    de::InitCPUInfo();
+    if (argc > 1) {
+        de::SetCPUISA(atoi(argv[1]));
+    }
+
+    cout << "L3 : " << (decx::cpI.L3_size >> 20) << " MB" << endl;
+    cout << setw(10) << "kernel" << setw(10) << "dst (MB)" << setw(13) << "cached (ms)" << setw(9) << "GB/s"
+        << setw(13) << "stream (ms)" << setw(9) << "GB/s" << setw(9) << "speedup" << setw(11) << "auto" << endl;
+
+    const size_t add_sizes[] = { 4, 16, 64, 256, 512 };
+    for (const size_t mb : add_sizes) {
+        bench_add(mb);
+    }
+    const size_t gray_sizes[] = { 4, 16, 64, 256 };
+    for (const size_t mb : gray_sizes) {
+        bench_gray(mb);
+    }
+
+    decx::thread_pool.TerminateAllThreads();
+    return 0;
+}
@@ -0,0 +1,103 @@
+// tensor_ew_bench.cpp : the two strategies of the element-wise callers of the tensors on the CPU
+// (decx::ew_tensor_m, the engine of de::cpu::Add(de::Tensor ...) and the others), going flat over the
+// padded _element_num against skipping the padding of the widths row by row. dst = A + B of float is
+// timed over about 16M elements for several widths and depths, with the share of the padding, the
+// time of both and the strategy decx::_ew_skip_padding() picks. Pass 1, 2 or 3 to force SSE4.2, AVX2 or AVX-512.
+//
+
+#define _DECX_CPU_CODES_
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <immintrin.h>
+
+#include "../../../srcs/core/configs/config.h"
+#include "../../../srcs/basic_calculations/operators/ew_tensor_exec.h"
+
+
+using namespace std;
+typedef chrono::high_resolution_clock _clock;
+
+
+struct aligned_buffer
+{
+    float* ptr;
+    size_t len;
+
+    aligned_buffer(const size_t _len, const float val) : len(_len)
+    {
+        ptr = (float*)_mm_malloc(_len * sizeof(float), 64);
+        for (size_t i = 0; i < _len; ++i) {
+            ptr[i] = val;
+        }
+    }
+    ~aligned_buffer() { _mm_free(ptr); }
+};
+
+
+
+// the layout of decx::_Tensor<float> of width x height x depth
+static decx::_ew_tensor_layout layout_of(const uint width, const uint height, const uint depth)
+{
+    const size_t wpitch = decx::utils::ceil<uint>(width, 4) * 4;
+    const size_t dpitch = decx::utils::ceil<uint>(depth, 4) * 4;        // _TENSOR_ALIGN_4B_
+
+    decx::_ew_tensor_layout layout;
+    layout.rows = height;
+    layout.row_len = width * dpitch;
+    layout.pitch = wpitch * dpitch;
+    layout.total = layout.pitch * height;
+    return layout;
+}
+
+
+
+static double time_of(const aligned_buffer& A, const aligned_buffer& B, aligned_buffer& dst,
+    const decx::_ew_tensor_layout* layout, const bool skip)
+{
+    const int round_num = 10;
+    decx::ew_tensor_m<float>(_EW_ADD_, A.ptr, B.ptr, dst.ptr, layout, skip, de::cpu::Store_Cached);
+
+    _clock::time_point s = _clock::now();
+    for (int r = 0; r < round_num; ++r) {
+        decx::ew_tensor_m<float>(_EW_ADD_, A.ptr, B.ptr, dst.ptr, layout, skip, de::cpu::Store_Cached);
+    }
+    return chrono::duration<double>(_clock::now() - s).count() / round_num;
+}
+
+
+
+int main(int argc, char** argv)
+{
+    de::InitCPUInfo();
+    if (argc > 1) {
+        de::SetCPUISA(atoi(argv[1]));
+    }
+
+    cout << setw(7) << "width" << setw(7) << "depth" << setw(10) << "padding" << setw(12) << "flat (ms)"
+        << setw(12) << "skip (ms)" << setw(10) << "speedup" << setw(8) << "picks" << endl;
+
+    // { width, depth }, the padding of the widths is (wpitch - width) * dpitch elements a row
+    const uint shapes[][2] = { { 1, 4 }, { 5, 4 }, { 61, 4 }, { 1, 8 }, { 5, 8 }, { 1, 16 }, { 13, 16 },
+        { 1, 64 }, { 5, 64 }, { 61, 64 }, { 125, 64 }, { 5, 256 }, { 1, 1024 }, { 2, 1024 } };
+
+    for (const auto& shape : shapes) {
+        const uint height = (uint)((1 << 24) / layout_of(shape[0], 1, shape[1]).pitch);
+        const decx::_ew_tensor_layout layout = layout_of(shape[0], height, shape[1]);
+
+        aligned_buffer A(layout.total, 1.f), B(layout.total, 2.f), dst(layout.total, 0.f);
+
+        const double t_flat = time_of(A, B, dst, &layout, false);
+        const double t_skip = time_of(A, B, dst, &layout, true);
+
+        cout << fixed << setprecision(3);
+        cout << setw(7) << shape[0] << setw(7) << shape[1] << setw(10) << 1.0 - (double)layout.row_len / layout.pitch
+            << setw(12) << setprecision(2) << t_flat * 1e3 << setw(12) << t_skip * 1e3 << setw(10) << t_flat / t_skip
+            << setw(8) << (decx::_ew_skip_padding<float>(&layout) ? "skip" : "flat") << endl;
+    }
+
+    decx::thread_pool.TerminateAllThreads();
+    return 0;
+}
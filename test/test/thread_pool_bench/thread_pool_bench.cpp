@@ -0,0 +1,149 @@
+// thread_pool_bench.cpp : microbenchmark of the task submission path of decx::ThreadPool
+// Reports tasks/sec, the submit-to-start latency (p50/p99), the number of heap
+// allocations made in the steady state, and the round trip of an empty decx::parallel_for.
+//
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+
+#include "../../../srcs/core/thread_management/thread_pool.h"
+#include "../../../srcs/core/thread_management/latch.h"
+#include "../../../srcs/core/thread_management/parallel_for.h"
+
+
+using namespace std;
+typedef chrono::high_resolution_clock _clock;
+
+
+// counts every operator new in the process
+static std::atomic<size_t> g_alloc_count(0);
+
+void* operator new(size_t size)
+{
+    g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    void* p = malloc(size == 0 ? 1 : size);
+    if (p == NULL) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+
+
+static void empty_kernel(decx::Latch* latch)
+{
+    latch->count_down();
+}
+
+
+static void stamp_kernel(_clock::time_point submitted, double* dst, decx::Latch* latch)
+{
+    *dst = chrono::duration<double, std::micro>(_clock::now() - submitted).count();
+    latch->count_down();
+}
+
+
+
+// register task_num empty tasks and wait for them, with or without futures
+static double throughput(const size_t task_num, const bool with_future, size_t* alloc_num)
+{
+    decx::Latch latch(task_num);
+    std::vector<std::future<void>> futs;
+    if (with_future) {
+        futs.reserve(task_num);
+    }
+
+    const size_t alloc_begin = g_alloc_count.load();
+    _clock::time_point s = _clock::now();
+
+    for (size_t i = 0; i < task_num; ++i) {
+        if (with_future) {
+            futs.push_back(decx::thread_pool.register_task(empty_kernel, &latch));
+        }
+        else {
+            decx::thread_pool.register_task_detached(empty_kernel, &latch);
+        }
+    }
+    latch.wait();
+
+    _clock::time_point e = _clock::now();
+    *alloc_num = g_alloc_count.load() - alloc_begin;
+
+    return (double)task_num / chrono::duration<double>(e - s).count();
+}
+
+
+
+// register a burst of tasks (one per thread) at a time, and record how long each waited before it started
+static void latency(const size_t round_num, double* p50, double* p99)
+{
+    const size_t burst = decx::thread_pool.get_current_thread_num();
+    std::vector<double> samples(round_num * burst);
+
+    for (size_t r = 0; r < round_num; ++r) {
+        decx::Latch latch(burst);
+        for (size_t i = 0; i < burst; ++i) {
+            decx::thread_pool.register_task_detached(stamp_kernel, _clock::now(), &samples[r * burst + i], &latch);
+        }
+        latch.wait();
+    }
+
+    std::sort(samples.begin(), samples.end());
+    *p50 = samples[samples.size() / 2];
+    *p99 = samples[(samples.size() * 99) / 100];
+}
+
+
+
+// an empty decx::parallel_for of one chunk per thread, the cost of publishing the job and joining it
+static double fork_join_us(const size_t round_num)
+{
+    const size_t thread_num = decx::thread_pool.get_current_thread_num();
+    std::atomic<size_t> acc(0);
+
+    _clock::time_point s = _clock::now();
+    for (size_t r = 0; r < round_num; ++r) {
+        decx::parallel_for(0, thread_num, [&](const size_t _beg, const size_t _end) {
+            acc.fetch_add(_end - _beg, std::memory_order_relaxed);
+        });
+    }
+    return chrono::duration<double, std::micro>(_clock::now() - s).count() / round_num;
+}
+
+
+
+int main()
+{
+    const size_t task_num = 1000000;
+    size_t alloc_num = 0;
+
+    cout << "threads : " << decx::thread_pool.get_current_thread_num() << endl;
+
+    // warm up, let the task allocator and the queues reach their steady sizes
+    throughput(task_num, false, &alloc_num);
+
+    double tps = throughput(task_num, false, &alloc_num);
+    cout << "register_task_detached : " << setw(12) << (size_t)tps << " tasks/sec, "
+        << alloc_num << " heap allocations" << endl;
+
+    tps = throughput(task_num, true, &alloc_num);
+    cout << "register_task (future) : " << setw(12) << (size_t)tps << " tasks/sec, "
+        << alloc_num << " heap allocations" << endl;
+
+    double p50, p99;
+    latency(20000, &p50, &p99);
+    cout << "submit-to-start latency : p50 = " << p50 << " us, p99 = " << p99 << " us" << endl;
+
+    cout << "parallel_for fork-join : " << fork_join_us(200000) << " us" << endl;
+
+    return 0;
+}